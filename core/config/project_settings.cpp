@@ -35,6 +35,7 @@
 #include "core/input/input_map.h"
 #include "core/io/dir_access.h"
 #include "core/io/file_access.h"
+#include "core/io/file_access_compressed.h"
 #include "core/io/file_access_network.h"
 #include "core/io/file_access_pack.h"
 #include "core/io/marshalls.h"
@@ -522,6 +523,9 @@ Error ProjectSettings::setup(const String &p_path, const String &p_main_pack, bo
 
 	Compression::gzip_level = GLOBAL_GET("compression/formats/gzip/compression_level");
 
+	// Keep the block size in the range the setting allows, 0 would divide by zero when saving.
+	FileAccessCompressed::default_block_size = CLAMP(int(GLOBAL_GET("compression/compressed_files/block_size")), 4096, 4194304);
+
 	return err;
 }
 
@@ -1118,6 +1122,9 @@ ProjectSettings::ProjectSettings() {
 	GLOBAL_DEF("debug/settings/profiler/max_functions", 16384);
 	custom_prop_info["debug/settings/profiler/max_functions"] = PropertyInfo(Variant::INT, "debug/settings/profiler/max_functions", PROPERTY_HINT_RANGE, "128,65535,1");
 
+	GLOBAL_DEF("compression/compressed_files/block_size", FileAccessCompressed::default_block_size);
+	custom_prop_info["compression/compressed_files/block_size"] = PropertyInfo(Variant::INT, "compression/compressed_files/block_size", PROPERTY_HINT_RANGE, "4096,4194304,4096");
+
 	GLOBAL_DEF("compression/formats/zstd/long_distance_matching", Compression::zstd_long_distance_matching);
 	custom_prop_info["compression/formats/zstd/long_distance_matching"] = PropertyInfo(Variant::BOOL, "compression/formats/zstd/long_distance_matching");
 	GLOBAL_DEF("compression/formats/zstd/compression_level", Compression::zstd_level);
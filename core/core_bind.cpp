@@ -45,8 +45,16 @@
 
 _ResourceLoader *_ResourceLoader::singleton = nullptr;
 
-Error _ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads) {
-	return ResourceLoader::load_threaded_request(p_path, p_type_hint, p_use_sub_threads);
+Error _ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, float p_priority) {
+	return ResourceLoader::load_threaded_request(p_path, p_type_hint, p_use_sub_threads, ResourceFormatLoader::CACHE_MODE_REUSE, String(), p_priority);
+}
+
+Error _ResourceLoader::load_threaded_set_priority(const String &p_path, float p_priority) {
+	return ResourceLoader::load_threaded_set_priority(p_path, p_priority);
+}
+
+Error _ResourceLoader::load_threaded_cancel(const String &p_path) {
+	return ResourceLoader::load_threaded_cancel(p_path);
 }
 
 _ResourceLoader::ThreadLoadStatus _ResourceLoader::load_threaded_get_status(const String &p_path, Array r_progress) {
@@ -108,7 +116,9 @@ bool _ResourceLoader::exists(const String &p_path, const String &p_type_hint) {
 }
 
 void _ResourceLoader::_bind_methods() {
-	ClassDB::bind_method(D_METHOD("load_threaded_request", "path", "type_hint", "use_sub_threads"), &_ResourceLoader::load_threaded_request, DEFVAL(""), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("load_threaded_request", "path", "type_hint", "use_sub_threads", "priority"), &_ResourceLoader::load_threaded_request, DEFVAL(""), DEFVAL(false), DEFVAL(0.0));
+	ClassDB::bind_method(D_METHOD("load_threaded_set_priority", "path", "priority"), &_ResourceLoader::load_threaded_set_priority);
+	ClassDB::bind_method(D_METHOD("load_threaded_cancel", "path"), &_ResourceLoader::load_threaded_cancel);
 	ClassDB::bind_method(D_METHOD("load_threaded_get_status", "path", "progress"), &_ResourceLoader::load_threaded_get_status, DEFVAL(Array()));
 	ClassDB::bind_method(D_METHOD("load_threaded_get", "path"), &_ResourceLoader::load_threaded_get);
 
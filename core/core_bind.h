@@ -65,7 +65,9 @@ public:
 
 	static _ResourceLoader *get_singleton() { return singleton; }
 
-	Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false);
+	Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false, float p_priority = 0.0);
+	Error load_threaded_set_priority(const String &p_path, float p_priority);
+	Error load_threaded_cancel(const String &p_path);
 	ThreadLoadStatus load_threaded_get_status(const String &p_path, Array r_progress = Array());
 	RES load_threaded_get(const String &p_path);
 
@@ -37,6 +37,7 @@
 #include "core/input/input.h"
 #include "core/object/script_language.h"
 #include "core/os/os.h"
+#include "core/os/spin_lock.h"
 #include "scene/main/node.h"
 #include "servers/display_server.h"
 
@@ -421,6 +422,152 @@ struct RemoteDebugger::PerformanceProfiler {
 	}
 };
 
+// Samples one out of every N allocations with its callstack, and sends the
+// aggregated samples every second. The sampler can run on any thread and from
+// inside any allocation, so it only writes to preallocated tables.
+struct RemoteDebugger::AllocationProfiler {
+	enum {
+		MAX_FRAMES = 16,
+		SKIP_FRAMES = 2, // The sampler and the allocation function.
+		TABLE_SIZE = 256,
+	};
+
+	struct Sample {
+		uint32_t hash = 0;
+		uint32_t frame_count = 0; // Zero if the slot is unused.
+		Memory::Tag tag = Memory::TAG_DEFAULT;
+		uint64_t count = 0;
+		uint64_t bytes = 0;
+		void *frames[MAX_FRAMES];
+	};
+
+	static AllocationProfiler *singleton;
+
+	// Samples are written to the active table, tick() swaps the tables and
+	// reads the other one, so nothing allocates while holding the lock.
+	SpinLock lock;
+	Sample *tables[2] = {};
+	uint32_t active = 0;
+	uint64_t dropped = 0;
+
+	uint32_t interval = 0;
+	uint64_t last_send_time = 0;
+	HashMap<uint64_t, String> symbols;
+
+	static void _sample(size_t p_bytes, Memory::Tag p_tag) {
+		void *frames[MAX_FRAMES + SKIP_FRAMES];
+		int frame_count = OS::get_singleton()->get_backtrace(frames, MAX_FRAMES + SKIP_FRAMES) - SKIP_FRAMES;
+		if (frame_count <= 0) {
+			return;
+		}
+
+		uint32_t hash = hash_djb2_one_32(p_tag);
+		for (int i = 0; i < frame_count; i++) {
+			hash = uint32_t(hash_djb2_one_64(uint64_t(frames[i + SKIP_FRAMES]), hash));
+		}
+
+		AllocationProfiler *prof = singleton;
+		if (!prof) {
+			return;
+		}
+		prof->lock.lock();
+		Sample *table = prof->tables[prof->active];
+		uint32_t pos = hash % TABLE_SIZE;
+		for (int i = 0; i < TABLE_SIZE; i++) {
+			Sample &s = table[pos];
+			if (s.frame_count == 0) {
+				s.hash = hash;
+				s.tag = p_tag;
+				s.frame_count = frame_count;
+				memcpy(s.frames, frames + SKIP_FRAMES, sizeof(void *) * frame_count);
+			} else if (s.hash != hash || s.tag != p_tag || s.frame_count != uint32_t(frame_count) || memcmp(s.frames, frames + SKIP_FRAMES, sizeof(void *) * frame_count) != 0) {
+				pos = (pos + 1) % TABLE_SIZE;
+				continue;
+			}
+			s.count++;
+			s.bytes += p_bytes;
+			prof->lock.unlock();
+			return;
+		}
+		prof->dropped++;
+		prof->lock.unlock();
+	}
+
+	void toggle(bool p_enable, const Array &p_opts) {
+		Memory::set_allocation_sampling(nullptr, 0);
+		if (!p_enable) {
+			return;
+		}
+		if (!tables[0]) {
+			tables[0] = memnew_arr(Sample, TABLE_SIZE);
+			tables[1] = memnew_arr(Sample, TABLE_SIZE);
+		}
+		interval = p_opts.size() > 0 ? MAX(int(p_opts[0]), 1) : 1000;
+		last_send_time = OS::get_singleton()->get_ticks_msec();
+		Memory::set_allocation_sampling(&AllocationProfiler::_sample, interval);
+	}
+
+	void add(const Array &p_data) {}
+
+	void tick(float p_frame_time, float p_idle_time, float p_physics_time, float p_physics_frame_time) {
+		uint64_t pt = OS::get_singleton()->get_ticks_msec();
+		if (!tables[0] || pt - last_send_time < 1000) {
+			return;
+		}
+		last_send_time = pt;
+
+		lock.lock();
+		Sample *table = tables[active];
+		active = 1 - active;
+		uint64_t lost = dropped;
+		dropped = 0;
+		lock.unlock();
+
+		// Format: interval, dropped samples, then for each callstack: tag name, sample count, sampled bytes, frames.
+		Array arr;
+		arr.push_back(interval);
+		arr.push_back(lost);
+		for (int i = 0; i < TABLE_SIZE; i++) {
+			Sample &s = table[i];
+			if (s.frame_count == 0) {
+				continue;
+			}
+			PackedStringArray frames;
+			frames.resize(s.frame_count);
+			for (uint32_t j = 0; j < s.frame_count; j++) {
+				String *symbol = symbols.getptr(uint64_t(s.frames[j]));
+				if (!symbol) {
+					symbol = &symbols.set(uint64_t(s.frames[j]), OS::get_singleton()->get_backtrace_symbol(s.frames[j]))->value();
+				}
+				frames.write[j] = *symbol;
+			}
+			arr.push_back(Memory::get_tag_name(s.tag));
+			arr.push_back(s.count);
+			arr.push_back(s.bytes);
+			arr.push_back(frames);
+			s = Sample();
+		}
+		if (arr.size() > 2) {
+			EngineDebugger::get_singleton()->send_message("allocations:samples", arr);
+		}
+	}
+
+	AllocationProfiler() {
+		singleton = this;
+	}
+
+	~AllocationProfiler() {
+		Memory::set_allocation_sampling(nullptr, 0);
+		if (tables[0]) {
+			memdelete_arr(tables[0]);
+			memdelete_arr(tables[1]);
+		}
+		singleton = nullptr;
+	}
+};
+
+RemoteDebugger::AllocationProfiler *RemoteDebugger::AllocationProfiler::singleton = nullptr;
+
 void RemoteDebugger::_send_resource_usage() {
 	DebuggerMarshalls::ResourceUsage usage;
 
@@ -948,6 +1095,10 @@ RemoteDebugger::RemoteDebugger(Ref<RemoteDebuggerPeer> p_peer) {
 		profiler_enable("performance", true);
 	}
 
+	// Allocation Profiler (sampled callstacks, debug builds only)
+	allocation_profiler = memnew(AllocationProfiler);
+	_bind_profiler("allocations", allocation_profiler);
+
 	// Core and profiler captures.
 	Capture core_cap(this,
 			[](void *p_user, const String &p_cmd, const Array &p_data, bool &r_captured) {
@@ -980,9 +1131,11 @@ RemoteDebugger::~RemoteDebugger() {
 	if (EngineDebugger::has_profiler("performance")) {
 		EngineDebugger::get_singleton()->unregister_profiler("performance");
 	}
+	EngineDebugger::get_singleton()->unregister_profiler("allocations");
 	memdelete(servers_profiler);
 	memdelete(network_profiler);
 	memdelete(visual_profiler);
+	memdelete(allocation_profiler);
 	if (performance_profiler) {
 		memdelete(performance_profiler);
 	}
@@ -54,11 +54,13 @@ private:
 	struct ScriptsProfiler;
 	struct VisualProfiler;
 	struct PerformanceProfiler;
+	struct AllocationProfiler;
 
 	NetworkProfiler *network_profiler = nullptr;
 	ServersProfiler *servers_profiler = nullptr;
 	VisualProfiler *visual_profiler = nullptr;
 	PerformanceProfiler *performance_profiler = nullptr;
+	AllocationProfiler *allocation_profiler = nullptr;
 
 	Ref<RemoteDebuggerPeer> peer;
 
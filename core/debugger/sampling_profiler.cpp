@@ -0,0 +1,243 @@
+/*************************************************************************/
+/*  sampling_profiler.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "sampling_profiler.h"
+
+#include "core/debugger/thread_buffer_registry.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "core/templates/hash_map.h"
+
+// Written only by its thread. A push bumps the change counter before and after
+// writing the frame (odd while in progress), so the sampler can tell whether the
+// frames it copied were replaced meanwhile. Lines are updated without it, a
+// sample may have a line that is a few instructions late.
+struct SamplingThreadStack {
+	SamplingProfiler::Frame frames[SamplingProfiler::MAX_DEPTH];
+	SamplingProfiler::Frame overflow; // Handed out for frames deeper than MAX_DEPTH, which are not sampled.
+	std::atomic<uint32_t> depth;
+	std::atomic<uint64_t> changes;
+	uint64_t thread_id = 0;
+
+	SamplingThreadStack() {
+		depth.store(0);
+		changes.store(0);
+	}
+};
+
+struct SampledFrame {
+	const char *name = nullptr;
+	int line = 0;
+};
+
+struct SampledStack {
+	SamplingThreadStack *thread = nullptr;
+	LocalVector<SampledFrame> frames;
+};
+
+struct SampledStackHasher {
+	static _FORCE_INLINE_ uint32_t hash(const SampledStack &p_stack) {
+		uint64_t h = hash_djb2_one_64((uint64_t)p_stack.thread);
+		for (uint32_t i = 0; i < p_stack.frames.size(); i++) {
+			h = hash_djb2_one_64((uint64_t)p_stack.frames[i].name, h);
+			h = hash_djb2_one_64((uint64_t)p_stack.frames[i].line, h);
+		}
+		return hash_one_uint64(h);
+	}
+};
+
+struct SampledStackComparator {
+	static bool compare(const SampledStack &p_lhs, const SampledStack &p_rhs) {
+		if (p_lhs.thread != p_rhs.thread || p_lhs.frames.size() != p_rhs.frames.size()) {
+			return false;
+		}
+		for (uint32_t i = 0; i < p_lhs.frames.size(); i++) {
+			if (p_lhs.frames[i].name != p_rhs.frames[i].name || p_lhs.frames[i].line != p_rhs.frames[i].line) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+std::atomic<bool> SamplingProfiler::running(false);
+
+// The registry mutex also protects the samples.
+static ThreadBufferRegistry<SamplingThreadStack> sampling_threads;
+static HashMap<SampledStack, uint64_t, SampledStackHasher, SampledStackComparator> sampled_stacks;
+static uint64_t sample_count = 0;
+static uint32_t sampling_interval_usec = SamplingProfiler::DEFAULT_INTERVAL_USEC;
+static Thread sampling_thread;
+
+// Copies the frames of the stack, retrying a few times if frames were pushed meanwhile.
+static bool _copy_stack(SamplingThreadStack *p_stack, LocalVector<SampledFrame> &r_frames) {
+	for (int attempt = 0; attempt < 4; attempt++) {
+		uint64_t changes = p_stack->changes.load(std::memory_order_acquire);
+		if (changes & 1) {
+			continue;
+		}
+		uint32_t depth = MIN(p_stack->depth.load(std::memory_order_acquire), (uint32_t)SamplingProfiler::MAX_DEPTH);
+		r_frames.resize(depth);
+		for (uint32_t i = 0; i < depth; i++) {
+			r_frames[i].name = p_stack->frames[i].name.load(std::memory_order_relaxed);
+			r_frames[i].line = p_stack->frames[i].line.load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (p_stack->changes.load(std::memory_order_relaxed) == changes) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void _take_samples() {
+	MutexLock lock(sampling_threads.mutex);
+
+	SampledStack sample;
+	for (uint32_t i = 0; i < sampling_threads.buffers.size(); i++) {
+		sample.thread = sampling_threads.buffers[i];
+		if (!_copy_stack(sample.thread, sample.frames) || sample.frames.is_empty()) {
+			continue; // Busy or not running scripts.
+		}
+		uint64_t *count = sampled_stacks.getptr(sample);
+		if (count) {
+			(*count)++;
+		} else {
+			sampled_stacks.set(sample, 1);
+		}
+		sample_count++;
+	}
+}
+
+static void _sampling_thread_func(void *p_userdata) {
+	Thread::set_name("Sampling profiler");
+	while (SamplingProfiler::is_running()) {
+		OS::get_singleton()->delay_usec(sampling_interval_usec);
+		_take_samples();
+	}
+}
+
+void SamplingProfiler::start(uint32_t p_interval_usec) {
+	ERR_FAIL_COND_MSG(p_interval_usec == 0, "The sampling interval must be at least one microsecond.");
+	if (is_running()) {
+		return;
+	}
+	sampling_interval_usec = p_interval_usec;
+	running.store(true);
+	sampling_thread.start(_sampling_thread_func, nullptr);
+}
+
+void SamplingProfiler::stop() {
+	if (!is_running()) {
+		return;
+	}
+	running.store(false);
+	sampling_thread.wait_to_finish();
+}
+
+SamplingProfiler::Frame *SamplingProfiler::push(const char *p_name, int p_line) {
+	SamplingThreadStack *stack = sampling_threads.get_thread_buffer();
+	if (unlikely(!stack)) {
+		stack = sampling_threads.register_thread_buffer(memnew(SamplingThreadStack));
+	}
+	uint32_t depth = stack->depth.load(std::memory_order_relaxed);
+	Frame *frame = depth < MAX_DEPTH ? &stack->frames[depth] : &stack->overflow;
+
+	uint64_t changes = stack->changes.load(std::memory_order_relaxed);
+	stack->changes.store(changes + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	frame->name.store(p_name, std::memory_order_relaxed);
+	frame->line.store(p_line, std::memory_order_relaxed);
+	stack->depth.store(depth + 1, std::memory_order_relaxed);
+	stack->changes.store(changes + 2, std::memory_order_release);
+	return frame;
+}
+
+void SamplingProfiler::pop() {
+	SamplingThreadStack *stack = sampling_threads.get_thread_buffer();
+	ERR_FAIL_COND(!stack || stack->depth.load(std::memory_order_relaxed) == 0);
+	// Frames below the new depth are untouched, so no change needs to be signaled.
+	stack->depth.store(stack->depth.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
+
+const char *SamplingProfiler::intern(const String &p_name) {
+	return DebugThreadNames::intern(p_name);
+}
+
+uint64_t SamplingProfiler::get_sample_count() {
+	MutexLock lock(sampling_threads.mutex);
+	return sample_count;
+}
+
+String SamplingProfiler::get_collapsed_stacks() {
+	MutexLock lock(sampling_threads.mutex);
+
+	Vector<String> lines;
+	const SampledStack *key = nullptr;
+	while ((key = sampled_stacks.next(key))) {
+		String line = DebugThreadNames::get_thread_name(key->thread->thread_id);
+		if (line.is_empty()) {
+			line = "Thread " + String::num_uint64(key->thread->thread_id);
+		}
+		for (uint32_t i = 0; i < key->frames.size(); i++) {
+			// Semicolons separate frames in this format.
+			line += ";" + String::utf8(key->frames[i].name).replace(";", ":") + ":" + itos(key->frames[i].line);
+		}
+		lines.push_back(line + " " + String::num_uint64(*sampled_stacks.getptr(*key)));
+	}
+	lines.sort();
+
+	String collapsed;
+	for (int i = 0; i < lines.size(); i++) {
+		collapsed += lines[i] + "\n";
+	}
+	return collapsed;
+}
+
+Error SamplingProfiler::save(const String &p_path) {
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Can't open sampling profile file for writing: " + p_path + ".");
+
+	f->store_string(get_collapsed_stacks());
+	return OK;
+}
+
+void SamplingProfiler::clear() {
+	MutexLock lock(sampling_threads.mutex);
+	sampled_stacks.clear();
+	sample_count = 0;
+}
+
+void SamplingProfiler::finish() {
+	stop();
+	clear();
+	sampling_threads.clear();
+}
@@ -1,5 +1,5 @@
 /*************************************************************************/
-/*  renderer_thread_pool.h                                               */
+/*  sampling_profiler.h                                                  */
 /*************************************************************************/
 /*                       This file is part of:                           */
 /*                           GODOT ENGINE                                */
@@ -28,18 +28,57 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 
-#ifndef RENDERERTHREADPOOL_H
-#define RENDERERTHREADPOOL_H
+#ifndef SAMPLING_PROFILER_H
+#define SAMPLING_PROFILER_H
 
-#include "core/templates/thread_work_pool.h"
+#include "core/string/ustring.h"
+#include "core/typedefs.h"
+
+#include <atomic>
+
+// Statistical profiler for script call stacks. Script languages publish the
+// frames they execute on a stack owned by the thread, and while the profiler
+// runs a separate thread copies every stack at a fixed interval and counts
+// identical ones. Nothing is measured on the executing threads, so hot code is
+// not distorted like with per-call instrumentation.
+//
+// Samples are saved in the collapsed stack format read by flamegraph tools:
+// one "frame;frame;frame count" line per distinct stack, root first.
+//
+// Frame names must outlive the profiler, use intern().
+
+class SamplingProfiler {
+	static std::atomic<bool> running;
 
-class RendererThreadPool {
 public:
-	ThreadWorkPool thread_work_pool;
+	enum {
+		DEFAULT_INTERVAL_USEC = 1000,
+		MAX_DEPTH = 512,
+	};
+
+	struct Frame {
+		std::atomic<const char *> name;
+		std::atomic<int> line;
+	};
+
+	static void start(uint32_t p_interval_usec = DEFAULT_INTERVAL_USEC);
+	static void stop();
+	_FORCE_INLINE_ static bool is_running() { return running.load(std::memory_order_relaxed); }
+
+	// Returns the frame to update with the current line, until the matching pop().
+	static Frame *push(const char *p_name, int p_line);
+	static void pop();
+
+	static const char *intern(const String &p_name);
 
-	static RendererThreadPool *singleton;
-	RendererThreadPool();
-	~RendererThreadPool();
+	static uint64_t get_sample_count();
+	static String get_collapsed_stacks();
+	static Error save(const String &p_path);
+	// Discards the samples taken so far.
+	static void clear();
+	// Stops profiling and frees the stacks, no other thread may be running scripts anymore.
+	// Profiling can be started again afterwards.
+	static void finish();
 };
 
-#endif // RENDERERTHREADPOOL_H
+#endif // SAMPLING_PROFILER_H
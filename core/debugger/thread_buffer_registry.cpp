@@ -1,5 +1,5 @@
 /*************************************************************************/
-/*  renderer_thread_pool.cpp                                             */
+/*  thread_buffer_registry.cpp                                           */
 /*************************************************************************/
 /*                       This file is part of:                           */
 /*                           GODOT ENGINE                                */
@@ -28,15 +28,39 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 
-#include "renderer_thread_pool.h"
+#include "thread_buffer_registry.h"
 
-RendererThreadPool *RendererThreadPool::singleton = nullptr;
+#include "core/templates/hash_map.h"
 
-RendererThreadPool::RendererThreadPool() {
-	singleton = this;
-	thread_work_pool.init();
+static BinaryMutex names_mutex;
+static HashMap<String, CharString> interned_names;
+static HashMap<uint64_t, String> thread_names;
+
+const char *DebugThreadNames::intern(const String &p_name) {
+	MutexLock lock(names_mutex);
+	CharString *name = interned_names.getptr(p_name);
+	if (!name) {
+		name = &interned_names.set(p_name, p_name.utf8())->value();
+	}
+	return name->get_data();
+}
+
+void DebugThreadNames::set_thread_name(const String &p_name) {
+	MutexLock lock(names_mutex);
+	thread_names[Thread::get_caller_id()] = p_name;
+}
+
+String DebugThreadNames::get_thread_name(uint64_t p_thread_id) {
+	MutexLock lock(names_mutex);
+	const String *name = thread_names.getptr(p_thread_id);
+	if (name) {
+		return *name;
+	}
+	return p_thread_id == Thread::get_main_id() ? "Main" : "";
 }
 
-RendererThreadPool::~RendererThreadPool() {
-	thread_work_pool.finish();
+void DebugThreadNames::cleanup() {
+	MutexLock lock(names_mutex);
+	interned_names.clear();
+	thread_names.clear();
 }
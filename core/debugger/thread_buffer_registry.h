@@ -0,0 +1,112 @@
+/*************************************************************************/
+/*  thread_buffer_registry.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef THREAD_BUFFER_REGISTRY_H
+#define THREAD_BUFFER_REGISTRY_H
+
+#include "core/os/memory.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+
+#include <atomic>
+
+// Thread names and interned strings, shared by the diagnostic tools that
+// record into per-thread buffers (Trace and SamplingProfiler).
+class DebugThreadNames {
+public:
+	// The returned string lives until cleanup().
+	static const char *intern(const String &p_name);
+	// Can be called before any tool starts, the name is kept for the thread.
+	static void set_thread_name(const String &p_name);
+	// Empty if the thread was never named, except for the main thread.
+	static String get_thread_name(uint64_t p_thread_id);
+	static void cleanup();
+};
+
+// Buffers of type T (with a thread_id member), one per thread. Each thread
+// registers its own buffer on first use and is the only one writing to it,
+// readers go through the buffers while holding the mutex.
+//
+// clear() frees every buffer. Threads still pointing to one notice it through
+// the generation and register a new buffer on their next write.
+template <class T>
+class ThreadBufferRegistry {
+	static thread_local T *thread_buffer;
+	static thread_local uint32_t thread_generation;
+
+	std::atomic<uint32_t> generation;
+
+public:
+	BinaryMutex mutex;
+	LocalVector<T *> buffers;
+
+	// Null if the calling thread has no buffer yet, or it was freed.
+	_FORCE_INLINE_ T *get_thread_buffer() const {
+		T *buffer = thread_buffer;
+		if (likely(buffer && thread_generation == generation.load(std::memory_order_acquire))) {
+			return buffer;
+		}
+		return nullptr;
+	}
+
+	// Takes ownership of the buffer and makes it the calling thread's one.
+	T *register_thread_buffer(T *p_buffer) {
+		p_buffer->thread_id = Thread::get_caller_id();
+
+		MutexLock lock(mutex);
+		buffers.push_back(p_buffer);
+		thread_buffer = p_buffer;
+		thread_generation = generation.load(std::memory_order_relaxed);
+		return p_buffer;
+	}
+
+	// No other thread may be writing to its buffer anymore.
+	void clear() {
+		MutexLock lock(mutex);
+		for (uint32_t i = 0; i < buffers.size(); i++) {
+			memdelete(buffers[i]);
+		}
+		buffers.clear();
+		generation.fetch_add(1, std::memory_order_release);
+	}
+
+	ThreadBufferRegistry() {
+		generation.store(0);
+	}
+};
+
+template <class T>
+thread_local T *ThreadBufferRegistry<T>::thread_buffer = nullptr;
+template <class T>
+thread_local uint32_t ThreadBufferRegistry<T>::thread_generation = 0;
+
+#endif // THREAD_BUFFER_REGISTRY_H
@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  trace.cpp                                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "trace.h"
+
+#include "core/debugger/thread_buffer_registry.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+
+struct TraceEvent {
+	const char *name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+// Written only by its thread. Readers copy the events and then discard the ones
+// that may have been overwritten meanwhile, using the written count.
+struct TraceThreadBuffer {
+	TraceEvent *events = nullptr;
+	uint32_t mask = 0;
+	std::atomic<uint64_t> written;
+	uint64_t thread_id = 0;
+
+	TraceThreadBuffer(uint32_t p_events) {
+		events = memnew_arr(TraceEvent, p_events);
+		mask = p_events - 1;
+		written.store(0);
+	}
+	~TraceThreadBuffer() {
+		memdelete_arr(events);
+	}
+};
+
+std::atomic<bool> Trace::enabled(false);
+
+static ThreadBufferRegistry<TraceThreadBuffer> trace_threads;
+static uint32_t trace_events_per_thread = Trace::DEFAULT_EVENTS_PER_THREAD; // Protected by the registry mutex.
+
+static TraceThreadBuffer *_create_thread_buffer() {
+	uint32_t events;
+	{
+		MutexLock lock(trace_threads.mutex);
+		events = trace_events_per_thread;
+	}
+	return trace_threads.register_thread_buffer(memnew(TraceThreadBuffer(events)));
+}
+
+void Trace::start(uint32_t p_events_per_thread) {
+	ERR_FAIL_COND_MSG(p_events_per_thread < 2, "Trace buffers need at least two events.");
+	uint32_t events_per_thread = next_power_of_2(p_events_per_thread);
+	{
+		MutexLock lock(trace_threads.mutex);
+		ERR_FAIL_COND_MSG(trace_threads.buffers.size() > 0 && events_per_thread != trace_events_per_thread, "Can't change the trace buffer size once tracing has started.");
+		trace_events_per_thread = events_per_thread;
+	}
+	enabled.store(true);
+}
+
+void Trace::stop() {
+	enabled.store(false);
+}
+
+uint64_t Trace::get_ticks_usec() {
+	return OS::get_singleton()->get_ticks_usec();
+}
+
+void Trace::add_zone(const char *p_name, uint64_t p_begin_usec, uint64_t p_end_usec) {
+	TraceThreadBuffer *buffer = trace_threads.get_thread_buffer();
+	if (unlikely(!buffer)) {
+		buffer = _create_thread_buffer();
+	}
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	TraceEvent &event = buffer->events[index & buffer->mask];
+	event.name = p_name;
+	event.begin = p_begin_usec;
+	event.end = p_end_usec;
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+const char *Trace::intern(const String &p_name) {
+	return DebugThreadNames::intern(p_name);
+}
+
+Error Trace::save(const String &p_path) {
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Can't open trace file for writing: " + p_path + ".");
+
+	MutexLock lock(trace_threads.mutex);
+
+	int pid = OS::get_singleton()->get_process_id();
+	LocalVector<TraceEvent> events;
+	bool first = true;
+
+	f->store_string("{\"traceEvents\":[\n");
+	for (uint32_t i = 0; i < trace_threads.buffers.size(); i++) {
+		TraceThreadBuffer *buffer = trace_threads.buffers[i];
+		uint64_t capacity = buffer->mask + 1;
+
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t from = written > capacity ? written - capacity : 0;
+		events.resize(written - from);
+		for (uint64_t j = from; j < written; j++) {
+			events[j - from] = buffer->events[j & buffer->mask];
+		}
+		// Skip events the thread may have overwritten while they were copied.
+		uint64_t now_written = buffer->written.load(std::memory_order_acquire);
+		uint64_t valid_from = now_written >= capacity ? now_written - capacity + 1 : 0;
+
+		String ids = "\"pid\":" + itos(pid) + ",\"tid\":" + String::num_uint64(buffer->thread_id);
+		String name = DebugThreadNames::get_thread_name(buffer->thread_id);
+		if (!name.is_empty()) {
+			f->store_string(String(first ? "" : ",\n") + "{\"name\":\"thread_name\",\"ph\":\"M\"," + ids + ",\"args\":{\"name\":\"" + name.json_escape() + "\"}}");
+			first = false;
+		}
+		for (uint64_t j = MAX(from, valid_from); j < written; j++) {
+			const TraceEvent &event = events[j - from];
+			f->store_string(String(first ? "" : ",\n") + "{\"name\":\"" + String::utf8(event.name).json_escape() + "\",\"ph\":\"X\"," + ids + ",\"ts\":" + String::num_uint64(event.begin) + ",\"dur\":" + String::num_uint64(event.end - event.begin) + "}");
+			first = false;
+		}
+	}
+	f->store_string("\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return OK;
+}
+
+void Trace::finish() {
+	enabled.store(false);
+	trace_threads.clear();
+}
@@ -1,5 +1,5 @@
 /*************************************************************************/
-/*  thread_work_pool.cpp                                                 */
+/*  trace.h                                                              */
 /*************************************************************************/
 /*                       This file is part of:                           */
 /*                           GODOT ENGINE                                */
@@ -28,54 +28,63 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 
-#include "thread_work_pool.h"
+#ifndef TRACE_H
+#define TRACE_H
 
-#include "core/os/os.h"
+#include "core/string/ustring.h"
+#include "core/typedefs.h"
 
-void ThreadWorkPool::_thread_function(void *p_user) {
-	ThreadData *thread = static_cast<ThreadData *>(p_user);
-	while (true) {
-		thread->start.wait();
-		if (thread->exit.load()) {
-			break;
-		}
-		thread->work->work();
-		thread->completed.post();
-	}
-}
+#include <atomic>
 
-void ThreadWorkPool::init(int p_thread_count) {
-	ERR_FAIL_COND(threads != nullptr);
-	if (p_thread_count < 0) {
-		p_thread_count = OS::get_singleton()->get_processor_count();
-	}
+// Zone tracing for diagnosing hitches. When enabled, each zone is recorded as
+// a complete event into a ring buffer owned by the thread, which keeps the
+// most recent events, and all buffers can be saved in the Chrome trace event
+// format (loadable in Perfetto or chrome://tracing).
+//
+// Zone names must outlive the trace, use string literals or intern().
 
-	thread_count = p_thread_count;
-	threads = memnew_arr(ThreadData, thread_count);
+class Trace {
+	static std::atomic<bool> enabled;
 
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(false);
-		threads[i].thread.start(&ThreadWorkPool::_thread_function, &threads[i]);
-	}
-}
+public:
+	enum {
+		DEFAULT_EVENTS_PER_THREAD = 65536
+	};
 
-void ThreadWorkPool::finish() {
-	if (threads == nullptr) {
-		return;
-	}
+	static void start(uint32_t p_events_per_thread = DEFAULT_EVENTS_PER_THREAD);
+	static void stop();
+	_FORCE_INLINE_ static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+	static uint64_t get_ticks_usec();
+	static void add_zone(const char *p_name, uint64_t p_begin_usec, uint64_t p_end_usec);
 
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(true);
-		threads[i].start.post();
+	static const char *intern(const String &p_name);
+
+	static Error save(const String &p_path);
+	// Frees the buffers, no other thread may be recording zones anymore. Tracing
+	// can be started again afterwards.
+	static void finish();
+};
+
+class TraceZone {
+	const char *name = nullptr;
+	uint64_t begin = 0;
+
+public:
+	// A null name disables the zone.
+	_FORCE_INLINE_ TraceZone(const char *p_name) {
+		if (unlikely(Trace::is_enabled()) && p_name) {
+			name = p_name;
+			begin = Trace::get_ticks_usec();
+		}
 	}
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].thread.wait_to_finish();
+	_FORCE_INLINE_ ~TraceZone() {
+		if (unlikely(name)) {
+			Trace::add_zone(name, begin, Trace::get_ticks_usec());
+		}
 	}
+};
 
-	memdelete_arr(threads);
-	threads = nullptr;
-}
+#define TRACE_ZONE(m_name) TraceZone _trace_zone(m_name)
 
-ThreadWorkPool::~ThreadWorkPool() {
-	finish();
-}
+#endif // TRACE_H
@@ -110,6 +110,13 @@ public:
 	virtual real_t get_real() const;
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const; ///< get an array of bytes
+	/**
+	 * Returns the next p_length bytes without copying them and moves past them,
+	 * or nullptr without moving when this file can't (not in memory, or fewer
+	 * bytes left), in which case get_buffer() has to be used.
+	 * The data stays valid while the file is open.
+	 */
+	virtual const uint8_t *get_buffer_view(uint64_t p_length) const { return nullptr; }
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(const String &p_delim = ",") const;
@@ -146,6 +153,13 @@ public:
 
 	virtual bool file_exists(const String &p_name) = 0; ///< return true if a file exists
 
+	/**
+	 * Maps the whole file in memory for reading, without moving the position.
+	 * Returns nullptr when this kind of file can't be mapped.
+	 * The mapping stays valid until the file is closed.
+	 */
+	virtual const uint8_t *map_read_only() { return nullptr; }
+
 	virtual Error reopen(const String &p_path, int p_mode_flags); ///< does not change the AccessType
 
 	static FileAccess *create(AccessType p_access); /// Create a file access (for the current platform) this is the only portable way of accessing files.
@@ -30,8 +30,14 @@
 
 #include "file_access_compressed.h"
 
+#include "core/os/worker_thread_pool.h"
 #include "core/string/print_string.h"
 
+// Upper bound for the memory used by the decompressed read-ahead window.
+#define READ_AHEAD_MAX_SIZE (4 * 1024 * 1024)
+
+uint32_t FileAccessCompressed::default_block_size = 65536;
+
 void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, uint32_t p_block_size) {
 	magic = p_magic.ascii().get_data();
 	if (magic.length() > 4) {
@@ -43,7 +49,7 @@ void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_
 	}
 
 	cmode = p_mode;
-	block_size = p_block_size;
+	block_size = p_block_size > 0 ? p_block_size : default_block_size;
 }
 
 #define WRITE_FIT(m_bytes)                                  \
@@ -69,32 +75,92 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	read_total = f->get_32();
 	uint32_t bc = (read_total / block_size) + 1;
 	uint64_t acc_ofs = f->get_position() + bc * 4;
-	uint32_t max_bs = 0;
 	for (uint32_t i = 0; i < bc; i++) {
 		ReadBlock rb;
 		rb.offset = acc_ofs;
 		rb.csize = f->get_32();
 		acc_ofs += rb.csize;
-		max_bs = MAX(max_bs, rb.csize);
 		read_blocks.push_back(rb);
 	}
 
-	comp_buffer.resize(max_bs);
-	buffer.resize(block_size);
-	read_ptr = buffer.ptrw();
-	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
-	at_end = false;
+	// Blocks ahead of a sequential reader are decompressed together, up to one per worker thread.
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	read_ahead = pool ? MIN((uint32_t)pool->get_thread_count(), bc) : 1;
+	read_ahead = CLAMP(READ_AHEAD_MAX_SIZE / block_size, 1u, read_ahead);
+
+	comp_buffer.clear();
+	buffer.resize((uint64_t)read_ahead * block_size);
+	window_size = 1;
+	window_start = 0;
+	window_count = 0;
+	at_end = read_total == 0;
 	read_eof = false;
 	read_block_count = bc;
-	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
 
-	Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
-	read_block = 0;
+	_load_block(0, false);
 	read_pos = 0;
 
 	return OK;
 }
 
+void FileAccessCompressed::_compress_block_task(uint32_t p_block, CompressBlocks *p_work) const {
+	uint32_t bl = p_block == (p_work->count - 1) ? write_max % block_size : block_size;
+	const uint8_t *bp = &p_work->src[(uint64_t)p_block * block_size];
+
+	Vector<uint8_t> &cblock = p_work->blocks[p_block];
+	cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
+	int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
+	cblock.resize(MAX(s, 0));
+}
+
+void FileAccessCompressed::_decompress_block_task(uint32_t p_index, uint8_t *p_dst) const {
+	const ReadBlock &rb = read_blocks[window_start + p_index];
+	const uint8_t *src = comp_buffer.ptr() + (rb.offset - read_blocks[window_start].offset);
+	Compression::decompress(p_dst + (uint64_t)p_index * block_size, block_size, src, rb.csize, cmode);
+}
+
+void FileAccessCompressed::_load_block(uint32_t p_block, bool p_sequential) const {
+	if (p_block < window_start || p_block >= window_start + window_count) {
+		// Random seeks only load the block they need, the window doubles
+		// while the reader keeps moving to the next block.
+		window_size = p_sequential ? MIN(window_size * 2, read_ahead) : 1;
+
+		// The compressed blocks are stored contiguously, read the whole window at once.
+		window_start = p_block;
+		window_count = MIN(window_size, read_block_count - p_block);
+
+		const ReadBlock &last = read_blocks[p_block + window_count - 1];
+		uint64_t span = last.offset + last.csize - read_blocks[p_block].offset;
+		if ((uint64_t)comp_buffer.size() < span) {
+			comp_buffer.resize(span);
+		}
+		f->seek(read_blocks[p_block].offset);
+		f->get_buffer(comp_buffer.ptrw(), span);
+
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		if (pool && window_count > 1) {
+			pool->do_work(window_count, this, &FileAccessCompressed::_decompress_block_task, buffer.ptrw());
+		} else {
+			_decompress_block_task(0, buffer.ptrw());
+		}
+	}
+
+	read_block = p_block;
+	read_ptr = buffer.ptrw() + (uint64_t)(p_block - window_start) * block_size;
+	read_block_size = p_block == read_block_count - 1 ? read_total % block_size : block_size;
+}
+
+void FileAccessCompressed::_next_block() const {
+	if (read_block + 1 < read_block_count) {
+		_load_block(read_block + 1, true);
+		read_pos = 0;
+		// Only the last block can be empty, when the size is a multiple of the block size.
+		at_end = read_block_size == 0;
+	} else {
+		at_end = true;
+	}
+}
+
 Error FileAccessCompressed::_open(const String &p_path, int p_mode_flags) {
 	ERR_FAIL_COND_V(p_mode_flags == READ_WRITE, ERR_UNAVAILABLE);
 
@@ -150,28 +216,30 @@ void FileAccessCompressed::close() {
 		f->store_32(write_max); //max amount of data written 4
 		uint32_t bc = (write_max / block_size) + 1;
 
-		for (uint32_t i = 0; i < bc; i++) {
-			f->store_32(0); //compressed sizes, will update later
-		}
+		// Blocks are compressed independently, so they can be compressed in parallel.
+		Vector<Vector<uint8_t>> blocks;
+		blocks.resize(bc);
 
-		Vector<int> block_sizes;
-		for (uint32_t i = 0; i < bc; i++) {
-			uint32_t bl = i == (bc - 1) ? write_max % block_size : block_size;
-			uint8_t *bp = &write_ptr[i * block_size];
+		CompressBlocks work;
+		work.src = write_ptr;
+		work.count = bc;
+		work.blocks = blocks.ptrw();
 
-			Vector<uint8_t> cblock;
-			cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
-
-			f->store_buffer(cblock.ptr(), s);
-			block_sizes.push_back(s);
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		if (pool && bc > 1) {
+			pool->do_work(bc, this, &FileAccessCompressed::_compress_block_task, &work);
+		} else {
+			for (uint32_t i = 0; i < bc; i++) {
+				_compress_block_task(i, &work);
+			}
 		}
 
-		f->seek(16); //ok write block sizes
 		for (uint32_t i = 0; i < bc; i++) {
-			f->store_32(block_sizes[i]);
+			f->store_32(blocks[i].size()); //compressed sizes
+		}
+		for (uint32_t i = 0; i < bc; i++) {
+			f->store_buffer(blocks[i].ptr(), blocks[i].size());
 		}
-		f->seek_end();
 		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //magic at the end too
 
 		buffer.clear();
@@ -180,6 +248,7 @@ void FileAccessCompressed::close() {
 		comp_buffer.clear();
 		buffer.clear();
 		read_blocks.clear();
+		window_count = 0;
 	}
 
 	memdelete(f);
@@ -205,15 +274,7 @@ void FileAccessCompressed::seek(uint64_t p_position) {
 		} else {
 			at_end = false;
 			read_eof = false;
-			uint32_t block_idx = p_position / block_size;
-			if (block_idx != read_block) {
-				read_block = block_idx;
-				f->seek(read_blocks[read_block].offset);
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			}
-
+			_load_block(p_position / block_size, false);
 			read_pos = p_position % block_size;
 		}
 	}
@@ -268,19 +329,7 @@ uint8_t FileAccessCompressed::get_8() const {
 
 	read_pos++;
 	if (read_pos >= read_block_size) {
-		read_block++;
-
-		if (read_block < read_block_count) {
-			//read another block of compressed data
-			f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-			Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			read_pos = 0;
-
-		} else {
-			read_block--;
-			at_end = true;
-		}
+		_next_block();
 	}
 
 	return ret;
@@ -296,26 +345,20 @@ uint64_t FileAccessCompressed::get_buffer(uint8_t *p_dst, uint64_t p_length) con
 		return 0;
 	}
 
-	for (uint64_t i = 0; i < p_length; i++) {
-		p_dst[i] = read_ptr[read_pos];
-		read_pos++;
+	uint64_t dst_pos = 0;
+	while (dst_pos < p_length) {
+		uint64_t to_copy = MIN(p_length - dst_pos, (uint64_t)read_block_size - read_pos);
+		memcpy(p_dst + dst_pos, read_ptr + read_pos, to_copy);
+		dst_pos += to_copy;
+		read_pos += to_copy;
+
 		if (read_pos >= read_block_size) {
-			read_block++;
-
-			if (read_block < read_block_count) {
-				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-				read_pos = 0;
-
-			} else {
-				read_block--;
-				at_end = true;
-				if (i < p_length - 1) {
+			_next_block();
+			if (at_end) {
+				if (dst_pos < p_length) {
 					read_eof = true;
 				}
-				return i;
+				return dst_pos;
 			}
 		}
 	}
@@ -51,20 +51,38 @@ class FileAccessCompressed : public FileAccess {
 	};
 
 	mutable Vector<uint8_t> comp_buffer;
-	uint8_t *read_ptr = nullptr;
+	mutable uint8_t *read_ptr = nullptr;
 	mutable uint32_t read_block = 0;
 	uint32_t read_block_count = 0;
 	mutable uint32_t read_block_size = 0;
 	mutable uint64_t read_pos = 0;
 	Vector<ReadBlock> read_blocks;
 	uint64_t read_total = 0;
+	uint32_t read_ahead = 1;
+	mutable uint32_t window_size = 1; // Blocks decompressed by the next window, grows while reads are sequential.
+	mutable uint32_t window_start = 0;
+	mutable uint32_t window_count = 0;
 
 	String magic = "GCMP";
 	mutable Vector<uint8_t> buffer;
 	FileAccess *f = nullptr;
 
+	struct CompressBlocks {
+		const uint8_t *src = nullptr;
+		uint32_t count = 0;
+		Vector<uint8_t> *blocks = nullptr;
+	};
+
+	void _compress_block_task(uint32_t p_block, CompressBlocks *p_work) const;
+	void _decompress_block_task(uint32_t p_index, uint8_t *p_dst) const;
+	void _load_block(uint32_t p_block, bool p_sequential) const;
+	void _next_block() const;
+
 public:
-	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = 4096);
+	static uint32_t default_block_size;
+
+	// A block size of 0 uses default_block_size.
+	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = 0);
 
 	Error open_after_magic(FileAccess *p_base);
 
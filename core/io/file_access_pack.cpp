@@ -31,10 +31,14 @@
 #include "file_access_pack.h"
 
 #include "core/io/file_access_encrypted.h"
+#include "core/io/file_access_memory.h"
+#include "core/io/marshalls.h"
 #include "core/object/script_language.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/version.h"
 
 #include <stdio.h>
+#include <zstd.h>
 
 Error PackedData::add_pack(const String &p_path, bool p_replace_files, uint64_t p_offset) {
 	for (int i = 0; i < sources.size(); i++) {
@@ -46,13 +50,14 @@ Error PackedData::add_pack(const String &p_path, bool p_replace_files, uint64_t
 	return ERR_FILE_UNRECOGNIZED;
 }
 
-void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted) {
+void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted, bool p_compressed) {
 	PathMD5 pmd5(p_path.md5_buffer());
 
 	bool exists = files.has(pmd5);
 
 	PackedFile pf;
 	pf.encrypted = p_encrypted;
+	pf.compressed = p_compressed;
 	pf.pack = p_pkg_path;
 	pf.offset = p_ofs;
 	pf.size = p_size;
@@ -96,6 +101,7 @@ void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64
 
 void PackedData::add_pack_source(PackSource *p_source) {
 	if (p_source != nullptr) {
+		p_source->packed_data = this;
 		sources.push_back(p_source);
 	}
 }
@@ -103,7 +109,9 @@ void PackedData::add_pack_source(PackSource *p_source) {
 PackedData *PackedData::singleton = nullptr;
 
 PackedData::PackedData() {
-	singleton = this;
+	if (!singleton) {
+		singleton = this;
+	}
 	root = memnew(PackedDir);
 
 	add_pack_source(memnew(PackedSourcePCK));
@@ -121,6 +129,9 @@ PackedData::~PackedData() {
 		memdelete(sources[i]);
 	}
 	_free_packed_dirs(root);
+	if (singleton == this) {
+		singleton = nullptr;
+	}
 }
 
 //////////////////////////////////////////////////////////////////
@@ -170,7 +181,7 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 	uint32_t ver_minor = f->get_32();
 	f->get_32(); // patch number, not used for validation.
 
-	if (version != PACK_FORMAT_VERSION) {
+	if (version < PACK_FORMAT_VERSION_MIN || version > PACK_FORMAT_VERSION) {
 		f->close();
 		memdelete(f);
 		ERR_FAIL_V_MSG(false, "Pack version unsupported: " + itos(version) + ".");
@@ -186,13 +197,39 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 
 	bool enc_directory = (pack_flags & PACK_DIR_ENCRYPTED);
 
-	for (int i = 0; i < 16; i++) {
+	int reserved = 16;
+	uint64_t dictionary_ofs = 0;
+	uint64_t dictionary_size = 0;
+	if (version >= 3) {
+		dictionary_ofs = f->get_64();
+		dictionary_size = f->get_64();
+		reserved -= 4;
+	}
+	for (int i = 0; i < reserved; i++) {
 		//reserved
 		f->get_32();
 	}
 
 	int file_count = f->get_32();
 
+	Vector<uint8_t> dictionary;
+	if (dictionary_size > 0) {
+		if (dictionary_size > PACK_COMPRESSED_BLOCK_SIZE * 8) {
+			f->close();
+			memdelete(f);
+			ERR_FAIL_V_MSG(false, "Pack compression dictionary is too large: " + itos(dictionary_size) + " bytes.");
+		}
+		uint64_t directory_ofs = f->get_position();
+		dictionary.resize(dictionary_size);
+		f->seek(file_base + dictionary_ofs + p_offset);
+		if (f->get_buffer(dictionary.ptrw(), dictionary_size) != dictionary_size) {
+			f->close();
+			memdelete(f);
+			ERR_FAIL_V_MSG(false, "Can't read pack compression dictionary.");
+		}
+		f->seek(directory_ofs);
+	}
+
 	if (enc_directory) {
 		FileAccessEncrypted *fae = memnew(FileAccessEncrypted);
 		if (!fae) {
@@ -233,16 +270,69 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 		f->get_buffer(md5, 16);
 		uint32_t flags = f->get_32();
 
-		PackedData::get_singleton()->add_path(p_path, path, ofs + p_offset, size, md5, this, p_replace_files, (flags & PACK_FILE_ENCRYPTED));
+		packed_data->add_path(p_path, path, ofs + p_offset, size, md5, this, p_replace_files, (flags & PACK_FILE_ENCRYPTED), (flags & PACK_FILE_COMPRESSED));
 	}
 
 	f->close();
 	memdelete(f);
+
+	Map<String, Pack>::Element *E = packs.find(p_path);
+	if (!E) {
+		E = packs.insert(p_path, Pack());
+		_map_pack(E->get(), p_path);
+	}
+	if (dictionary.size() && !E->get().dictionary) {
+		// The dictionary is only used to decompress, it can be shared by all threads reading from the pack.
+		E->get().dictionary = ZSTD_createDDict(dictionary.ptr(), dictionary.size());
+		ERR_FAIL_COND_V_MSG(!E->get().dictionary, false, "Can't load pack compression dictionary.");
+	}
 	return true;
 }
 
+void PackedSourcePCK::_map_pack(Pack &r_pack, const String &p_path) {
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		return;
+	}
+	const uint8_t *data = f->map_read_only();
+	if (!data) {
+		memdelete(f);
+		return;
+	}
+
+	r_pack.file = f;
+	r_pack.data = data;
+	r_pack.size = f->get_length();
+}
+
 FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
-	return memnew(FileAccessPack(p_path, *p_file));
+	Map<String, Pack>::Element *E = packs.find(p_file->pack);
+	FileAccessPack *fa;
+	if (!E) {
+		fa = memnew(FileAccessPack(p_path, *p_file));
+	} else if (E->get().data && p_file->offset <= E->get().size) {
+		const Pack &pack = E->get();
+		fa = memnew(FileAccessPack(p_path, *p_file, pack.data + p_file->offset, pack.size - p_file->offset, pack.dictionary));
+	} else {
+		fa = memnew(FileAccessPack(p_path, *p_file, nullptr, 0, E->get().dictionary));
+	}
+	if (!fa->is_open()) {
+		// Corrupt compressed files, or packs that can't be read anymore.
+		memdelete(fa);
+		return nullptr;
+	}
+	return fa;
+}
+
+PackedSourcePCK::~PackedSourcePCK() {
+	for (Map<String, Pack>::Element *E = packs.front(); E; E = E->next()) {
+		if (E->get().file) {
+			memdelete(E->get().file);
+		}
+		if (E->get().dictionary) {
+			ZSTD_freeDDict(E->get().dictionary);
+		}
+	}
 }
 
 //////////////////////////////////////////////////////////////////
@@ -253,11 +343,18 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 }
 
 void FileAccessPack::close() {
-	f->close();
+	if (f) {
+		f->close();
+	}
+	data = nullptr;
+	compressed_data = nullptr;
 }
 
 bool FileAccessPack::is_open() const {
-	return f->is_open();
+	if (data || compressed_data) {
+		return true;
+	}
+	return f && f->is_open();
 }
 
 void FileAccessPack::seek(uint64_t p_position) {
@@ -267,7 +364,9 @@ void FileAccessPack::seek(uint64_t p_position) {
 		eof = false;
 	}
 
-	f->seek(off + p_position);
+	if (f && !pf.compressed) {
+		f->seek(off + p_position);
+	}
 	pos = p_position;
 }
 
@@ -293,6 +392,17 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (data) {
+		return data[pos++];
+	}
+	if (pf.compressed) {
+		ERR_FAIL_COND_V(block_size == 0, 0);
+		uint32_t b = pos / block_size;
+		if (!_load_block(b)) {
+			return 0;
+		}
+		return block[pos++ - (uint64_t)b * block_size];
+	}
 	pos++;
 	return f->get_8();
 }
@@ -310,19 +420,38 @@ uint64_t FileAccessPack::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
 		to_read = (int64_t)pf.size - (int64_t)pos;
 	}
 
+	uint64_t from = pos;
 	pos += p_length;
 
 	if (to_read <= 0) {
 		return 0;
 	}
-	f->get_buffer(p_dst, to_read);
+	if (data) {
+		memcpy(p_dst, data + from, to_read);
+	} else if (pf.compressed) {
+		return _get_compressed_buffer(from, p_dst, to_read);
+	} else {
+		f->get_buffer(p_dst, to_read);
+	}
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_buffer_view(uint64_t p_length) const {
+	if (!data || eof || pos > pf.size || p_length > pf.size - pos) {
+		return nullptr;
+	}
+
+	const uint8_t *view = data + pos;
+	pos += p_length;
+	return view;
+}
+
 void FileAccessPack::set_big_endian(bool p_big_endian) {
 	FileAccess::set_big_endian(p_big_endian);
-	f->set_big_endian(p_big_endian);
+	if (f) {
+		f->set_big_endian(p_big_endian);
+	}
 }
 
 Error FileAccessPack::get_error() const {
@@ -348,14 +477,227 @@ bool FileAccessPack::file_exists(const String &p_name) {
 	return false;
 }
 
-FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) :
-		pf(p_file),
-		f(FileAccess::open(pf.pack, FileAccess::READ)) {
-	ERR_FAIL_COND_MSG(!f, "Can't open pack-referenced file '" + String(pf.pack) + "'.");
+const uint8_t *FileAccessPack::map_read_only() {
+	return data;
+}
+
+Error FileAccessPack::_read_block_index() {
+	uint8_t header[16];
+	ERR_FAIL_COND_V(!_read_stored(0, header, 16), ERR_FILE_CORRUPT);
+	block_size = decode_uint32(header);
+	uint32_t block_count = decode_uint32(&header[4]);
+	uint32_t flags = decode_uint32(&header[8]);
+
+	ERR_FAIL_COND_V(block_size == 0 || block_size > PACK_COMPRESSED_BLOCK_SIZE * 8, ERR_FILE_CORRUPT);
+	ERR_FAIL_COND_V(block_count != (pf.size + block_size - 1) / block_size, ERR_FILE_CORRUPT);
+	if (flags & PACK_COMPRESSED_DICTIONARY) {
+		ERR_FAIL_COND_V_MSG(!dictionary, ERR_FILE_CORRUPT, "Compressed file needs the compression dictionary of its pack.");
+	} else {
+		dictionary = nullptr;
+	}
+
+	Vector<uint8_t> ends;
+	ends.resize(block_count * 8);
+	ERR_FAIL_COND_V(!_read_stored(16, ends.ptrw(), ends.size()), ERR_FILE_CORRUPT);
+	block_ends.resize(block_count);
+	uint64_t *ends_ptr = block_ends.ptrw();
+	for (uint32_t i = 0; i < block_count; i++) {
+		ends_ptr[i] = decode_uint64(&ends[i * 8]);
+		ERR_FAIL_COND_V(ends_ptr[i] < _get_block_start(i), ERR_FILE_CORRUPT);
+	}
+	blocks_offset = 16 + ends.size();
 
-	f->seek(pf.offset);
+	if (compressed_data && block_count > 0) {
+		ERR_FAIL_COND_V(blocks_offset + block_ends[block_count - 1] > compressed_data_size, ERR_FILE_CORRUPT);
+	}
+	return OK;
+}
+
+bool FileAccessPack::_read_stored(uint64_t p_from, uint8_t *p_dst, uint64_t p_length) const {
+	if (compressed_data) {
+		if (p_from > compressed_data_size || p_length > compressed_data_size - p_from) {
+			return false;
+		}
+		memcpy(p_dst, compressed_data + p_from, p_length);
+		return true;
+	}
+	f->seek(off + p_from);
+	return f->get_buffer(p_dst, p_length) == p_length;
+}
+
+bool FileAccessPack::_decompress_block(uint32_t p_block, const uint8_t *p_src, uint8_t *p_dst, ZSTD_DCtx_s *p_context) const {
+	uint64_t stored = block_ends[p_block] - _get_block_start(p_block);
+	uint32_t length = _get_block_length(p_block);
+	if (stored == length) {
+		// Stored as is, it didn't compress.
+		memcpy(p_dst, p_src, length);
+		return true;
+	}
+
+	size_t ret;
+	if (dictionary) {
+		ret = ZSTD_decompress_usingDDict(p_context, p_dst, length, p_src, stored, dictionary);
+	} else {
+		ret = ZSTD_decompressDCtx(p_context, p_dst, length, p_src, stored);
+	}
+	return !ZSTD_isError(ret) && ret == length;
+}
+
+void FileAccessPack::_decompress_range(DecompressBlocks *p_work, uint32_t p_from, uint32_t p_to, ZSTD_DCtx_s *p_context) const {
+	for (uint32_t i = p_from; i < p_to; i++) {
+		const uint8_t *src = p_work->src + (_get_block_start(i) - p_work->src_offset);
+		uint8_t *dst = p_work->dst + (uint64_t)(i - p_work->from) * block_size;
+		if (!_decompress_block(i, src, dst, p_context)) {
+			p_work->failed.set();
+			return;
+		}
+	}
+}
+
+void FileAccessPack::_decompress_blocks_task(uint32_t p_task, DecompressBlocks *p_work) const {
+	uint32_t from = p_work->from + p_task * p_work->per_task;
+	uint32_t to = MIN(from + p_work->per_task, p_work->from + p_work->count);
+
+	ZSTD_DCtx *task_context = ZSTD_createDCtx();
+	if (!task_context) {
+		p_work->failed.set();
+		return;
+	}
+	_decompress_range(p_work, from, to, task_context);
+	ZSTD_freeDCtx(task_context);
+}
+
+bool FileAccessPack::_decompress_blocks(uint32_t p_from, uint32_t p_count, uint8_t *p_dst) const {
+	DecompressBlocks work;
+	work.src_offset = _get_block_start(p_from);
+	work.dst = p_dst;
+	work.from = p_from;
+	work.count = p_count;
+
+	Vector<uint8_t> stored;
+	if (compressed_data) {
+		work.src = compressed_data + blocks_offset + work.src_offset;
+	} else {
+		// Read all the blocks at once, so the file is only accessed from this thread.
+		stored.resize(block_ends[p_from + p_count - 1] - work.src_offset);
+		if (!_read_stored(blocks_offset + work.src_offset, stored.ptrw(), stored.size())) {
+			return false;
+		}
+		work.src = stored.ptr();
+	}
+
+	// Big reads, like whole textures or meshes, are decompressed on the worker threads.
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	uint32_t tasks = 1;
+	if (pool && p_count >= 4) {
+		tasks = MIN(p_count, (uint32_t)pool->get_thread_count());
+	}
+	work.per_task = (p_count + tasks - 1) / tasks;
+	tasks = (p_count + work.per_task - 1) / work.per_task;
+
+	if (tasks > 1) {
+		pool->do_work(tasks, this, &FileAccessPack::_decompress_blocks_task, &work);
+	} else {
+		if (!context) {
+			context = ZSTD_createDCtx();
+			ERR_FAIL_COND_V(!context, false);
+		}
+		_decompress_range(&work, p_from, p_from + p_count, context);
+	}
+	return !work.failed.is_set();
+}
+
+bool FileAccessPack::_load_block(uint32_t p_block) const {
+	if (current_block == p_block) {
+		return true;
+	}
+
+	uint64_t start = _get_block_start(p_block);
+	const uint8_t *src;
+	if (compressed_data) {
+		src = compressed_data + blocks_offset + start;
+	} else {
+		stored_block.resize(block_ends[p_block] - start);
+		ERR_FAIL_COND_V(!_read_stored(blocks_offset + start, stored_block.ptrw(), stored_block.size()), false);
+		src = stored_block.ptr();
+	}
+
+	if (!context) {
+		context = ZSTD_createDCtx();
+		ERR_FAIL_COND_V(!context, false);
+	}
+	block.resize(block_size);
+	current_block = -1;
+	ERR_FAIL_COND_V_MSG(!_decompress_block(p_block, src, block.ptrw(), context), false, "Can't decompress pack-referenced file '" + String(pf.pack) + "'.");
+	current_block = p_block;
+	return true;
+}
+
+uint64_t FileAccessPack::_get_compressed_buffer(uint64_t p_from, uint8_t *p_dst, uint64_t p_length) const {
+	ERR_FAIL_COND_V(block_size == 0, 0);
+	uint64_t end = p_from + p_length;
+	uint64_t done = 0;
+	while (done < p_length) {
+		uint64_t at = p_from + done;
+		uint32_t b = at / block_size;
+		uint32_t in_block = at % block_size;
+
+		// Blocks read whole are decompressed straight to p_dst, the last block of the file can be short.
+		uint32_t whole_end = end == pf.size ? block_ends.size() : end / block_size;
+		if (in_block == 0 && whole_end > b && current_block != b) {
+			if (!_decompress_blocks(b, whole_end - b, p_dst + done)) {
+				ERR_FAIL_V_MSG(done, "Can't decompress pack-referenced file '" + String(pf.pack) + "'.");
+			}
+			done = MIN((uint64_t)whole_end * block_size, pf.size) - p_from;
+			continue;
+		}
+
+		if (!_load_block(b)) {
+			return done;
+		}
+		uint64_t n = MIN((uint64_t)_get_block_length(b) - in_block, p_length - done);
+		memcpy(p_dst + done, block.ptr() + in_block, n);
+		done += n;
+	}
+	return done;
+}
+
+FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const uint8_t *p_mapped, uint64_t p_mapped_size, const ZSTD_DDict_s *p_dictionary) :
+		pf(p_file) {
+	pos = 0;
+	eof = false;
 	off = pf.offset;
 
+	if (pf.compressed) {
+		dictionary = p_dictionary;
+		if (p_mapped && !pf.encrypted) {
+			compressed_data = p_mapped;
+			compressed_data_size = p_mapped_size;
+			if (_read_block_index() != OK) {
+				compressed_data = nullptr;
+				block_size = 0;
+				block_ends.clear();
+				ERR_FAIL_MSG("Can't read compressed pack-referenced file '" + String(pf.pack) + "'.");
+			}
+			return;
+		}
+	} else if (p_mapped && !pf.encrypted && pf.size <= p_mapped_size) {
+		data = p_mapped;
+		return;
+	}
+
+	if (p_mapped) {
+		// Encrypted files are decrypted from the mapping, so the pack isn't opened again.
+		FileAccessMemory *fam = memnew(FileAccessMemory);
+		fam->open_custom(p_mapped, p_mapped_size);
+		f = fam;
+		off = 0;
+	} else {
+		f = FileAccess::open(pf.pack, FileAccess::READ);
+		ERR_FAIL_COND_MSG(!f, "Can't open pack-referenced file '" + String(pf.pack) + "'.");
+		f->seek(pf.offset);
+	}
+
 	if (pf.encrypted) {
 		FileAccessEncrypted *fae = memnew(FileAccessEncrypted);
 		if (!fae) {
@@ -376,8 +718,13 @@ FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFil
 		f = fae;
 		off = 0;
 	}
-	pos = 0;
-	eof = false;
+
+	if (pf.compressed && _read_block_index() != OK) {
+		f->close();
+		block_size = 0;
+		block_ends.clear();
+		ERR_FAIL_MSG("Can't read compressed pack-referenced file '" + String(pf.pack) + "'.");
+	}
 }
 
 FileAccessPack::~FileAccessPack() {
@@ -385,6 +732,9 @@ FileAccessPack::~FileAccessPack() {
 		f->close();
 		memdelete(f);
 	}
+	if (context) {
+		ZSTD_freeDCtx(context);
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////////////
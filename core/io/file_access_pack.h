@@ -34,6 +34,7 @@
 #include "core/io/dir_access.h"
 #include "core/io/file_access.h"
 #include "core/string/print_string.h"
+#include "core/templates/safe_refcount.h"
 #include "core/templates/list.h"
 #include "core/templates/map.h"
 #include "core/templates/set.h"
@@ -41,18 +42,38 @@
 // Godot's packed file magic header ("GDPC" in ASCII).
 #define PACK_HEADER_MAGIC 0x43504447
 // The current packed file format version number.
-#define PACK_FORMAT_VERSION 2
+#define PACK_FORMAT_VERSION 3
+// The oldest packed file format version that can still be read. Version 3 added
+// compressed files, and the pack's compression dictionary in the reserved header.
+#define PACK_FORMAT_VERSION_MIN 2
 
 enum PackFlags {
 	PACK_DIR_ENCRYPTED = 1 << 0
 };
 
 enum PackFileFlags {
-	PACK_FILE_ENCRYPTED = 1 << 0
+	PACK_FILE_ENCRYPTED = 1 << 0,
+	PACK_FILE_COMPRESSED = 1 << 1
 };
 
+// Compressed files are split in blocks of PACK_COMPRESSED_BLOCK_SIZE bytes,
+// compressed independently so reads can start anywhere in the file. They are
+// stored after a header (block size, block count, PackCompressedFlags and a
+// reserved 32-bit field) and the 64-bit end offset of every block, relative to
+// the first one. Blocks that don't compress are stored as they are.
+#define PACK_COMPRESSED_BLOCK_SIZE 131072
+
+enum PackCompressedFlags {
+	PACK_COMPRESSED_DICTIONARY = 1 << 0
+};
+
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
 class PackSource;
 
+// The first instance is the global one, used by the file system. Others can
+// be created to read packs without adding their files to res://.
 class PackedData {
 	friend class FileAccessPack;
 	friend class DirAccessPack;
@@ -66,6 +87,7 @@ public:
 		uint8_t md5[16];
 		PackSource *src;
 		bool encrypted;
+		bool compressed;
 	};
 
 private:
@@ -112,7 +134,7 @@ private:
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false); // for PackSource
+	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false, bool p_compressed = false); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
@@ -131,6 +153,11 @@ public:
 };
 
 class PackSource {
+	friend class PackedData;
+
+protected:
+	PackedData *packed_data = nullptr; // The one the source was added to, which gets the files.
+
 public:
 	virtual bool try_open_pack(const String &p_path, bool p_replace_files, uint64_t p_offset) = 0;
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file) = 0;
@@ -138,9 +165,26 @@ public:
 };
 
 class PackedSourcePCK : public PackSource {
+	struct Pack {
+		// Each pack is mapped once, its files are then read from memory instead
+		// of opening the pack again. Packs that can't be mapped are read as files.
+		FileAccess *file = nullptr;
+		const uint8_t *data = nullptr;
+		uint64_t size = 0;
+
+		// Shared by the small compressed files of the pack, if it has any.
+		ZSTD_DDict_s *dictionary = nullptr;
+	};
+
+	Map<String, Pack> packs;
+
+	void _map_pack(Pack &r_pack, const String &p_path);
+
 public:
 	virtual bool try_open_pack(const String &p_path, bool p_replace_files, uint64_t p_offset);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	virtual ~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -150,7 +194,44 @@ class FileAccessPack : public FileAccess {
 	mutable bool eof;
 	uint64_t off;
 
-	FileAccess *f;
+	// Contents in the mapped pack, f is only used when this is null.
+	const uint8_t *data = nullptr;
+	FileAccess *f = nullptr;
+
+	// Compressed files keep their block index, and the last decompressed block.
+	// Their stored blocks are read from compressed_data when the pack is mapped.
+	const uint8_t *compressed_data = nullptr;
+	uint64_t compressed_data_size = 0;
+	const ZSTD_DDict_s *dictionary = nullptr;
+	uint32_t block_size = 0;
+	uint64_t blocks_offset = 0;
+	Vector<uint64_t> block_ends;
+	mutable Vector<uint8_t> block;
+	mutable Vector<uint8_t> stored_block;
+	mutable int64_t current_block = -1;
+	mutable ZSTD_DCtx_s *context = nullptr;
+
+	struct DecompressBlocks {
+		const uint8_t *src = nullptr;
+		uint64_t src_offset = 0;
+		uint8_t *dst = nullptr;
+		uint32_t from = 0;
+		uint32_t count = 0;
+		uint32_t per_task = 0;
+		SafeFlag failed;
+	};
+
+	Error _read_block_index();
+	bool _read_stored(uint64_t p_from, uint8_t *p_dst, uint64_t p_length) const;
+	_FORCE_INLINE_ uint64_t _get_block_start(uint32_t p_block) const { return p_block == 0 ? 0 : block_ends[p_block - 1]; }
+	_FORCE_INLINE_ uint32_t _get_block_length(uint32_t p_block) const { return MIN((uint64_t)block_size, pf.size - (uint64_t)p_block * block_size); }
+	bool _decompress_block(uint32_t p_block, const uint8_t *p_src, uint8_t *p_dst, ZSTD_DCtx_s *p_context) const;
+	void _decompress_range(DecompressBlocks *p_work, uint32_t p_from, uint32_t p_to, ZSTD_DCtx_s *p_context) const;
+	void _decompress_blocks_task(uint32_t p_task, DecompressBlocks *p_work) const;
+	bool _decompress_blocks(uint32_t p_from, uint32_t p_count, uint8_t *p_dst) const;
+	bool _load_block(uint32_t p_block) const;
+	uint64_t _get_compressed_buffer(uint64_t p_from, uint8_t *p_dst, uint64_t p_length) const;
+
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 	virtual uint32_t _get_unix_permissions(const String &p_file) { return 0; }
@@ -170,6 +251,7 @@ public:
 	virtual uint8_t get_8() const;
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const;
+	virtual const uint8_t *get_buffer_view(uint64_t p_length) const;
 
 	virtual void set_big_endian(bool p_big_endian);
 
@@ -182,7 +264,11 @@ public:
 
 	virtual bool file_exists(const String &p_name);
 
-	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file);
+	virtual const uint8_t *map_read_only();
+
+	// p_mapped points to the file in the mapped pack, and p_mapped_size is
+	// what is mapped from there to the end of the pack.
+	FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file, const uint8_t *p_mapped = nullptr, uint64_t p_mapped_size = 0, const ZSTD_DDict_s *p_dictionary = nullptr);
 	~FileAccessPack();
 };
 
@@ -31,11 +31,21 @@
 #include "pck_packer.h"
 
 #include "core/crypto/crypto_core.h"
+#include "core/io/compression.h"
 #include "core/io/file_access.h"
 #include "core/io/file_access_encrypted.h"
 #include "core/io/file_access_pack.h" // PACK_HEADER_MAGIC, PACK_FORMAT_VERSION
+#include "core/io/marshalls.h"
 #include "core/version.h"
 
+#include <zstd.h>
+
+// Compressed files up to this size share the pack's dictionary, when there
+// are enough of them to sample it from.
+static const uint64_t DICTIONARY_FILE_SIZE_MAX = 16384;
+static const int DICTIONARY_FILES_MIN = 8;
+static const int DICTIONARY_SIZE_MAX = 65536;
+
 static int _get_pad(int p_alignment, int p_n) {
 	int rest = p_n % p_alignment;
 	int pad = 0;
@@ -46,9 +56,77 @@ static int _get_pad(int p_alignment, int p_n) {
 	return pad;
 }
 
+// Encrypted files store a hash, their size and the IV before their data,
+// which is padded to the encryption block size.
+static uint64_t _get_encrypted_size(uint64_t p_size) {
+	if (p_size % 16) {
+		p_size += 16 - (p_size % 16);
+	}
+	return p_size + 16 + 8 + 16;
+}
+
+// The dictionary is raw content, the start of each small file, where headers
+// and the most repeated strings are. Only that start is read.
+static Vector<uint8_t> _build_dictionary(const Vector<String> &p_samples) {
+	Vector<uint8_t> dictionary;
+	if (p_samples.size() < DICTIONARY_FILES_MIN) {
+		return dictionary;
+	}
+
+	int sample_max = DICTIONARY_SIZE_MAX / p_samples.size();
+	for (int i = 0; i < p_samples.size(); i++) {
+		FileAccessRef f = FileAccess::open(p_samples[i], FileAccess::READ);
+		ERR_CONTINUE(!f);
+		int from = dictionary.size();
+		dictionary.resize(from + sample_max);
+		uint64_t read = f->get_buffer(dictionary.ptrw() + from, sample_max);
+		dictionary.resize(from + read);
+	}
+	return dictionary;
+}
+
+static Vector<uint8_t> _compress_blocks(const Vector<uint8_t> &p_data, ZSTD_CCtx *p_context, const ZSTD_CDict *p_dictionary) {
+	const uint64_t size = p_data.size();
+	const uint32_t block_count = (size + PACK_COMPRESSED_BLOCK_SIZE - 1) / PACK_COMPRESSED_BLOCK_SIZE;
+	const uint64_t blocks_offset = 16 + (uint64_t)block_count * 8;
+
+	Vector<uint8_t> stored;
+	stored.resize(blocks_offset + ZSTD_compressBound(PACK_COMPRESSED_BLOCK_SIZE) * block_count);
+	uint8_t *w = stored.ptrw();
+	encode_uint32(PACK_COMPRESSED_BLOCK_SIZE, &w[0]);
+	encode_uint32(block_count, &w[4]);
+	encode_uint32(p_dictionary ? PACK_COMPRESSED_DICTIONARY : 0, &w[8]);
+	encode_uint32(0, &w[12]); // reserved
+
+	uint64_t end = 0;
+	for (uint32_t i = 0; i < block_count; i++) {
+		const uint8_t *src = p_data.ptr() + (uint64_t)i * PACK_COMPRESSED_BLOCK_SIZE;
+		const size_t length = MIN((uint64_t)PACK_COMPRESSED_BLOCK_SIZE, size - (uint64_t)i * PACK_COMPRESSED_BLOCK_SIZE);
+		uint8_t *dst = w + blocks_offset + end;
+		const size_t capacity = stored.size() - blocks_offset - end;
+
+		size_t ret;
+		if (p_dictionary) {
+			ret = ZSTD_compress_usingCDict(p_context, dst, capacity, src, length, p_dictionary);
+		} else {
+			ret = ZSTD_compressCCtx(p_context, dst, capacity, src, length, Compression::zstd_level);
+		}
+		if (ZSTD_isError(ret) || ret >= length) {
+			// Store the block as is, the reader tells them apart by their size.
+			memcpy(dst, src, length);
+			ret = length;
+		}
+		end += ret;
+		encode_uint64(end, &w[16 + i * 8]);
+	}
+
+	stored.resize(blocks_offset + end);
+	return stored;
+}
+
 void PCKPacker::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment", "key", "encrypt_directory"), &PCKPacker::pck_start, DEFVAL(0), DEFVAL(String()), DEFVAL(false));
-	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "encrypt"), &PCKPacker::add_file, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "encrypt", "compress"), &PCKPacker::add_file, DEFVAL(false), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush, DEFVAL(false));
 }
 
@@ -110,7 +188,7 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment, const String &
 	return OK;
 }
 
-Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encrypt) {
+Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encrypt, bool p_compress) {
 	FileAccess *f = FileAccess::open(p_src, FileAccess::READ);
 	if (!f) {
 		return ERR_FILE_CANT_OPEN;
@@ -119,7 +197,6 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encr
 	File pf;
 	pf.path = p_file;
 	pf.src_path = p_src;
-	pf.ofs = ofs;
 	pf.size = f->get_length();
 
 	Vector<uint8_t> data = FileAccess::get_file_as_array(p_src);
@@ -132,19 +209,7 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encr
 		}
 	}
 	pf.encrypted = p_encrypt;
-
-	uint64_t _size = pf.size;
-	if (p_encrypt) { // Add encryption overhead.
-		if (_size % 16) { // Pad to encryption block size.
-			_size += 16 - (_size % 16);
-		}
-		_size += 16; // hash
-		_size += 8; // data size
-		_size += 16; // iv
-	}
-
-	int pad = _get_pad(alignment, ofs + _size);
-	ofs = ofs + _size + pad;
+	pf.compressed = p_compress;
 
 	files.push_back(pf);
 
@@ -157,53 +222,42 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_encr
 Error PCKPacker::flush(bool p_verbose) {
 	ERR_FAIL_COND_V_MSG(!file, ERR_INVALID_PARAMETER, "File must be opened before use.");
 
+	Vector<String> samples;
+	for (int i = 0; i < files.size(); i++) {
+		if (files[i].compressed && files[i].size <= DICTIONARY_FILE_SIZE_MAX) {
+			samples.push_back(files[i].src_path);
+		}
+	}
+	Vector<uint8_t> dictionary = _build_dictionary(samples);
+
 	int64_t file_base_ofs = file->get_position();
 	file->store_64(0); // files base
 
-	for (int i = 0; i < 16; i++) {
+	file->store_64(0); // dictionary offset, from files base
+	file->store_64(dictionary.size()); // dictionary size
+	for (int i = 0; i < 12; i++) {
 		file->store_32(0); // reserved
 	}
 
 	// write the index
 	file->store_32(files.size());
 
-	FileAccessEncrypted *fae = nullptr;
-	FileAccess *fhead = file;
-
-	if (enc_dir) {
-		fae = memnew(FileAccessEncrypted);
-		ERR_FAIL_COND_V(!fae, ERR_CANT_CREATE);
-
-		Error err = fae->open_and_parse(file, key, FileAccessEncrypted::MODE_WRITE_AES256, false);
-		ERR_FAIL_COND_V(err != OK, ERR_CANT_CREATE);
-
-		fhead = fae;
-	}
-
+	// The offsets of compressed files are only known once they are written, so
+	// the directory is written last. Its size doesn't depend on them.
+	uint64_t dir_ofs = file->get_position();
+	uint64_t dir_size = 0;
 	for (int i = 0; i < files.size(); i++) {
 		int string_len = files[i].path.utf8().length();
-		int pad = _get_pad(4, string_len);
-
-		fhead->store_32(string_len + pad);
-		fhead->store_buffer((const uint8_t *)files[i].path.utf8().get_data(), string_len);
-		for (int j = 0; j < pad; j++) {
-			fhead->store_8(0);
-		}
-
-		fhead->store_64(files[i].ofs);
-		fhead->store_64(files[i].size); // pay attention here, this is where file is
-		fhead->store_buffer(files[i].md5.ptr(), 16); //also save md5 for file
-
-		uint32_t flags = 0;
-		if (files[i].encrypted) {
-			flags |= PACK_FILE_ENCRYPTED;
-		}
-		fhead->store_32(flags);
+		dir_size += 4 + string_len + _get_pad(4, string_len) + 8 + 8 + 16 + 4;
 	}
-
-	if (fae) {
-		fae->release();
-		memdelete(fae);
+	if (enc_dir) {
+		dir_size = _get_encrypted_size(dir_size);
+	}
+	{
+		Vector<uint8_t> reserved;
+		reserved.resize(dir_size);
+		reserved.fill(0);
+		file->store_buffer(reserved.ptr(), reserved.size());
 	}
 
 	int header_padding = _get_pad(alignment, file->get_position());
@@ -216,17 +270,32 @@ Error PCKPacker::flush(bool p_verbose) {
 	file->store_64(file_base); // update files base
 	file->seek(file_base);
 
+	if (dictionary.size()) {
+		file->store_buffer(dictionary.ptr(), dictionary.size());
+		int pad = _get_pad(alignment, file->get_position());
+		for (int j = 0; j < pad; j++) {
+			file->store_8(Math::rand() % 256);
+		}
+	}
+
+	ZSTD_CCtx *context = nullptr;
+	ZSTD_CDict *cdict = nullptr;
+	if (dictionary.size()) {
+		cdict = ZSTD_createCDict(dictionary.ptr(), dictionary.size(), Compression::zstd_level);
+		ERR_FAIL_COND_V(!cdict, ERR_CANT_CREATE);
+	}
+
 	const uint32_t buf_max = 65536;
 	uint8_t *buf = memnew_arr(uint8_t, buf_max);
 
 	int count = 0;
 	for (int i = 0; i < files.size(); i++) {
-		FileAccess *src = FileAccess::open(files[i].src_path, FileAccess::READ);
-		uint64_t to_write = files[i].size;
+		File &pf = files.write[i];
+		pf.ofs = file->get_position() - file_base;
 
-		fae = nullptr;
+		FileAccessEncrypted *fae = nullptr;
 		FileAccess *ftmp = file;
-		if (files[i].encrypted) {
+		if (pf.encrypted) {
 			fae = memnew(FileAccessEncrypted);
 			ERR_FAIL_COND_V(!fae, ERR_CANT_CREATE);
 
@@ -235,10 +304,25 @@ Error PCKPacker::flush(bool p_verbose) {
 			ftmp = fae;
 		}
 
-		while (to_write > 0) {
-			uint64_t read = src->get_buffer(buf, MIN(to_write, buf_max));
-			ftmp->store_buffer(buf, read);
-			to_write -= read;
+		if (pf.compressed) {
+			// Only one compressed file is held at a time.
+			if (!context) {
+				context = ZSTD_createCCtx();
+				ERR_FAIL_COND_V(!context, ERR_CANT_CREATE);
+			}
+			Vector<uint8_t> data = FileAccess::get_file_as_array(pf.src_path);
+			Vector<uint8_t> stored = _compress_blocks(data, context, pf.size <= DICTIONARY_FILE_SIZE_MAX ? cdict : nullptr);
+			ftmp->store_buffer(stored.ptr(), stored.size());
+		} else {
+			FileAccess *src = FileAccess::open(pf.src_path, FileAccess::READ);
+			uint64_t to_write = pf.size;
+			while (to_write > 0) {
+				uint64_t read = src->get_buffer(buf, MIN(to_write, buf_max));
+				ftmp->store_buffer(buf, read);
+				to_write -= read;
+			}
+			src->close();
+			memdelete(src);
 		}
 
 		if (fae) {
@@ -251,8 +335,6 @@ Error PCKPacker::flush(bool p_verbose) {
 			file->store_8(Math::rand() % 256);
 		}
 
-		src->close();
-		memdelete(src);
 		count += 1;
 		const int file_num = files.size();
 		if (p_verbose && (file_num > 0)) {
@@ -267,9 +349,61 @@ Error PCKPacker::flush(bool p_verbose) {
 		printf("\n");
 	}
 
-	file->close();
+	if (context) {
+		ZSTD_freeCCtx(context);
+	}
+	if (cdict) {
+		ZSTD_freeCDict(cdict);
+	}
 	memdelete_arr(buf);
 
+	file->seek(dir_ofs);
+
+	FileAccessEncrypted *fae = nullptr;
+	FileAccess *fhead = file;
+
+	if (enc_dir) {
+		fae = memnew(FileAccessEncrypted);
+		ERR_FAIL_COND_V(!fae, ERR_CANT_CREATE);
+
+		Error err = fae->open_and_parse(file, key, FileAccessEncrypted::MODE_WRITE_AES256, false);
+		ERR_FAIL_COND_V(err != OK, ERR_CANT_CREATE);
+
+		fhead = fae;
+	}
+
+	for (int i = 0; i < files.size(); i++) {
+		int string_len = files[i].path.utf8().length();
+		int pad = _get_pad(4, string_len);
+
+		fhead->store_32(string_len + pad);
+		fhead->store_buffer((const uint8_t *)files[i].path.utf8().get_data(), string_len);
+		for (int j = 0; j < pad; j++) {
+			fhead->store_8(0);
+		}
+
+		fhead->store_64(files[i].ofs);
+		fhead->store_64(files[i].size); // pay attention here, this is where file is
+		fhead->store_buffer(files[i].md5.ptr(), 16); //also save md5 for file
+
+		uint32_t flags = 0;
+		if (files[i].encrypted) {
+			flags |= PACK_FILE_ENCRYPTED;
+		}
+		if (files[i].compressed) {
+			flags |= PACK_FILE_COMPRESSED;
+		}
+		fhead->store_32(flags);
+	}
+
+	if (fae) {
+		fae->release();
+		memdelete(fae);
+	}
+	ERR_FAIL_COND_V(file->get_position() != dir_ofs + dir_size, ERR_BUG);
+
+	file->close();
+
 	return OK;
 }
 
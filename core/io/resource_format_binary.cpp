@@ -105,14 +105,19 @@ StringName ResourceLoaderBinary::_get_string() {
 	uint32_t id = f->get_32();
 	if (id & 0x80000000) {
 		uint32_t len = id & 0x7FFFFFFF;
-		if ((int)len > str_buf.size()) {
-			str_buf.resize(len);
-		}
 		if (len == 0) {
 			return StringName();
 		}
-		f->get_buffer((uint8_t *)&str_buf[0], len);
 		String s;
+		const uint8_t *view = f->get_buffer_view(len);
+		if (view) {
+			s.parse_utf8((const char *)view, len);
+			return s;
+		}
+		if ((int)len > str_buf.size()) {
+			str_buf.resize(len);
+		}
+		f->get_buffer((uint8_t *)&str_buf[0], len);
 		s.parse_utf8(&str_buf[0]);
 		return s;
 	}
@@ -321,6 +326,16 @@ Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 						path += res_path + "::" + itos(index);
 					}
 
+					if (!internal_index_cache.has(path) && internal_index.has(path)) {
+						// Not materialized yet, load it from its offset and come back.
+						uint64_t pos = f->get_position();
+						Error err = _load_internal_resource(internal_index[path]);
+						f->seek(pos);
+						if (err != OK) {
+							return err;
+						}
+					}
+
 					//always use internal cache for loading internal resources
 					if (!internal_index_cache.has(path)) {
 						WARN_PRINT(String("Couldn't load resource (no cache): " + path).utf8().get_data());
@@ -360,6 +375,14 @@ Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 						WARN_PRINT("Broken external resource! (index out of size)");
 						r_v = Variant();
 					} else {
+						if (!external_resources[erindex].requested) {
+							// Sub-resource loads only request the dependencies they use.
+							Error err = _request_external_resource(erindex);
+							if (err != OK) {
+								return err;
+							}
+						}
+
 						if (external_resources[erindex].cache.is_null()) {
 							//cache not here yet, wait for it?
 							if (use_sub_threads) {
@@ -612,13 +635,7 @@ Ref<Resource> ResourceLoaderBinary::get_resource() {
 	return resource;
 }
 
-Error ResourceLoaderBinary::load() {
-	if (error != OK) {
-		return error;
-	}
-
-	int stage = 0;
-
+void ResourceLoaderBinary::_remap_external_resources() {
 	for (int i = 0; i < external_resources.size(); i++) {
 		String path = external_resources[i].path;
 
@@ -632,153 +649,220 @@ Error ResourceLoaderBinary::load() {
 		}
 
 		external_resources.write[i].path = path; //remap happens here, not on load because on load it can actually be used for filesystem dock resource remap
+	}
+}
 
-		if (!use_sub_threads) {
-			external_resources.write[i].cache = ResourceLoader::load(path, external_resources[i].type);
+Error ResourceLoaderBinary::_request_external_resource(int p_index) {
+	ExtResource &er = external_resources.write[p_index];
+	er.requested = true;
 
-			if (external_resources[i].cache.is_null()) {
-				if (!ResourceLoader::get_abort_on_missing_resources()) {
-					ResourceLoader::notify_dependency_error(local_path, path, external_resources[i].type);
-				} else {
-					error = ERR_FILE_MISSING_DEPENDENCIES;
-					ERR_FAIL_V_MSG(error, "Can't load dependency: " + path + ".");
-				}
-			}
+	if (!use_sub_threads) {
+		er.cache = ResourceLoader::load(er.path, er.type);
 
-		} else {
-			Error err = ResourceLoader::load_threaded_request(path, external_resources[i].type, use_sub_threads, ResourceFormatLoader::CACHE_MODE_REUSE, local_path);
-			if (err != OK) {
-				if (!ResourceLoader::get_abort_on_missing_resources()) {
-					ResourceLoader::notify_dependency_error(local_path, path, external_resources[i].type);
-				} else {
-					error = ERR_FILE_MISSING_DEPENDENCIES;
-					ERR_FAIL_V_MSG(error, "Can't load dependency: " + path + ".");
-				}
+		if (er.cache.is_null()) {
+			if (!ResourceLoader::get_abort_on_missing_resources()) {
+				ResourceLoader::notify_dependency_error(local_path, er.path, er.type);
+			} else {
+				error = ERR_FILE_MISSING_DEPENDENCIES;
+				ERR_FAIL_V_MSG(error, "Can't load dependency: " + er.path + ".");
 			}
 		}
 
-		stage++;
+	} else {
+		Error err = ResourceLoader::load_threaded_request(er.path, er.type, use_sub_threads, ResourceFormatLoader::CACHE_MODE_REUSE, local_path);
+		if (err != OK) {
+			if (!ResourceLoader::get_abort_on_missing_resources()) {
+				ResourceLoader::notify_dependency_error(local_path, er.path, er.type);
+			} else {
+				error = ERR_FILE_MISSING_DEPENDENCIES;
+				ERR_FAIL_V_MSG(error, "Can't load dependency: " + er.path + ".");
+			}
+		}
 	}
 
-	for (int i = 0; i < internal_resources.size(); i++) {
-		bool main = i == (internal_resources.size() - 1);
+	return OK;
+}
 
-		//maybe it is loaded already
-		String path;
-		String id;
+void ResourceLoaderBinary::_index_internal_resources() {
+	// The main resource is last, and is only loaded by load().
+	for (int i = 0; i < internal_resources.size() - 1; i++) {
+		IntResource &ir = internal_resources.write[i];
+		if (ir.path.begins_with("local://")) {
+			ir.id = ir.path.replace_first("local://", "");
+			ir.path = res_path + "::" + ir.id;
+		}
+		internal_index[ir.path] = i;
+	}
+}
 
-		if (!main) {
-			path = internal_resources[i].path;
+Error ResourceLoaderBinary::_load_internal_resource(int p_index) {
+	bool main = p_index == (internal_resources.size() - 1);
 
-			if (path.begins_with("local://")) {
-				path = path.replace_first("local://", "");
-				id = path;
-				path = res_path + "::" + path;
+	//maybe it is loaded already
+	String path;
+	String id = internal_resources[p_index].id;
 
-				internal_resources.write[i].path = path; // Update path.
-			}
+	if (!main) {
+		path = internal_resources[p_index].path;
 
-			if (cache_mode == ResourceFormatLoader::CACHE_MODE_REUSE) {
-				if (ResourceCache::has(path)) {
-					//already loaded, don't do anything
-					stage++;
-					error = OK;
-					continue;
-				}
-			}
-		} else {
-			if (cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE && !ResourceCache::has(res_path)) {
-				path = res_path;
+		if (internal_index_cache.has(path)) {
+			return OK;
+		}
+
+		if (cache_mode == ResourceFormatLoader::CACHE_MODE_REUSE) {
+			if (ResourceCache::has(path)) {
+				//already loaded, reuse it
+				internal_index_cache[path] = RES(ResourceCache::get(path));
+				return OK;
 			}
 		}
+	} else {
+		if (cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE && !ResourceCache::has(res_path)) {
+			path = res_path;
+		}
+	}
 
-		uint64_t offset = internal_resources[i].offset;
+	uint64_t offset = internal_resources[p_index].offset;
 
-		f->seek(offset);
+	f->seek(offset);
 
-		String t = get_unicode_string();
+	String t = get_unicode_string();
 
-		RES res;
+	RES res;
 
-		if (cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE && ResourceCache::has(path)) {
-			//use the existing one
-			Resource *r = ResourceCache::get(path);
-			if (r->get_class() == t) {
-				r->reset_state();
-				res = Ref<Resource>(r);
-			}
+	if (cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE && ResourceCache::has(path)) {
+		//use the existing one
+		Resource *r = ResourceCache::get(path);
+		if (r->get_class() == t) {
+			r->reset_state();
+			res = Ref<Resource>(r);
 		}
+	}
 
-		if (res.is_null()) {
-			//did not replace
+	if (res.is_null()) {
+		//did not replace
 
-			Object *obj = ClassDB::instantiate(t);
-			if (!obj) {
-				error = ERR_FILE_CORRUPT;
-				ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, local_path + ":Resource of unrecognized type in file: " + t + ".");
-			}
-
-			Resource *r = Object::cast_to<Resource>(obj);
-			if (!r) {
-				String obj_class = obj->get_class();
-				error = ERR_FILE_CORRUPT;
-				memdelete(obj); //bye
-				ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, local_path + ":Resource type in resource field not a resource, type is: " + obj_class + ".");
-			}
+		Object *obj = ClassDB::instantiate(t);
+		if (!obj) {
+			error = ERR_FILE_CORRUPT;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, local_path + ":Resource of unrecognized type in file: " + t + ".");
+		}
 
-			res = RES(r);
-			if (path != String() && cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
-				r->set_path(path, cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE); //if got here because the resource with same path has different type, replace it
-			}
-			r->set_scene_unique_id(id);
+		Resource *r = Object::cast_to<Resource>(obj);
+		if (!r) {
+			String obj_class = obj->get_class();
+			error = ERR_FILE_CORRUPT;
+			memdelete(obj); //bye
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, local_path + ":Resource type in resource field not a resource, type is: " + obj_class + ".");
 		}
 
-		if (!main) {
-			internal_index_cache[path] = res;
+		res = RES(r);
+		if (path != String() && cache_mode != ResourceFormatLoader::CACHE_MODE_IGNORE) {
+			r->set_path(path, cache_mode == ResourceFormatLoader::CACHE_MODE_REPLACE); //if got here because the resource with same path has different type, replace it
 		}
+		r->set_scene_unique_id(id);
+	}
 
-		int pc = f->get_32();
+	if (!main) {
+		// Before its properties, so references back to it resolve.
+		internal_index_cache[path] = res;
+	}
 
-		//set properties
+	int pc = f->get_32();
 
-		for (int j = 0; j < pc; j++) {
-			StringName name = _get_string();
+	//set properties
 
-			if (name == StringName()) {
-				error = ERR_FILE_CORRUPT;
-				ERR_FAIL_V(ERR_FILE_CORRUPT);
-			}
+	for (int j = 0; j < pc; j++) {
+		StringName name = _get_string();
 
-			Variant value;
+		if (name == StringName()) {
+			error = ERR_FILE_CORRUPT;
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		}
 
-			error = parse_variant(value);
-			if (error) {
-				return error;
-			}
+		Variant value;
 
-			res->set(name, value);
+		error = parse_variant(value);
+		if (error) {
+			return error;
 		}
+
+		res->set(name, value);
+	}
 #ifdef TOOLS_ENABLED
-		res->set_edited(false);
+	res->set_edited(false);
 #endif
-		stage++;
 
-		if (progress) {
-			*progress = (i + 1) / float(internal_resources.size());
+	internal_loaded++;
+	if (progress) {
+		*progress = internal_loaded / float(internal_resources.size());
+	}
+
+	resource_cache.push_back(res);
+
+	if (main) {
+		resource = res;
+		resource->set_as_translation_remapped(translation_remapped);
+	}
+	return OK;
+}
+
+Error ResourceLoaderBinary::load() {
+	if (error != OK) {
+		return error;
+	}
+
+	_remap_external_resources();
+	for (int i = 0; i < external_resources.size(); i++) {
+		error = _request_external_resource(i);
+		if (error != OK) {
+			return error;
 		}
+	}
 
-		resource_cache.push_back(res);
+	if (internal_resources.is_empty()) {
+		return ERR_FILE_EOF;
+	}
+	_index_internal_resources();
 
-		if (main) {
-			f->close();
-			resource = res;
-			resource->set_as_translation_remapped(translation_remapped);
-			error = OK;
-			return OK;
+	// In file order, resources are saved after the ones they reference, so
+	// these are usually materialized already when they are needed.
+	for (int i = 0; i < internal_resources.size(); i++) {
+		error = _load_internal_resource(i);
+		if (error != OK) {
+			return error;
 		}
 	}
 
-	return ERR_FILE_EOF;
+	f->close();
+	error = OK;
+	return OK;
+}
+
+Error ResourceLoaderBinary::load_sub_resource(const String &p_id) {
+	if (error != OK) {
+		return error;
+	}
+
+	_remap_external_resources();
+	_index_internal_resources();
+
+	String path = res_path + "::" + p_id;
+	Map<String, int>::Element *E = internal_index.find(path);
+	if (!E) {
+		error = ERR_DOES_NOT_EXIST;
+		ERR_FAIL_V_MSG(error, "No sub-resource '" + p_id + "' in file: " + local_path + ".");
+	}
+
+	// Only this resource and the ones it references are loaded.
+	error = _load_internal_resource(E->get());
+	if (error != OK) {
+		return error;
+	}
+
+	f->close();
+	resource = internal_index_cache[path];
+	return OK;
 }
 
 void ResourceLoaderBinary::set_translation_remapped(bool p_remapped) {
@@ -803,14 +887,19 @@ static String get_ustring(FileAccess *f) {
 
 String ResourceLoaderBinary::get_unicode_string() {
 	int len = f->get_32();
+	if (len <= 0) {
+		return String();
+	}
+	String s;
+	const uint8_t *view = f->get_buffer_view(len);
+	if (view) {
+		s.parse_utf8((const char *)view, len);
+		return s;
+	}
 	if (len > str_buf.size()) {
 		str_buf.resize(len);
 	}
-	if (len == 0) {
-		return String();
-	}
 	f->get_buffer((uint8_t *)&str_buf[0], len);
-	String s;
 	s.parse_utf8(&str_buf[0]);
 	return s;
 }
@@ -1012,27 +1101,49 @@ ResourceLoaderBinary::~ResourceLoaderBinary() {
 	}
 }
 
+bool ResourceFormatLoaderBinary::recognize_path(const String &p_path, const String &p_for_type) const {
+	int sub_resource = p_path.find("::");
+	if (sub_resource == -1) {
+		return ResourceFormatLoader::recognize_path(p_path, p_for_type);
+	}
+	// "file.res::id" paths load a single sub-resource, which can be of any type.
+	return ResourceFormatLoader::recognize_path(p_path.substr(0, sub_resource));
+}
+
 RES ResourceFormatLoaderBinary::load(const String &p_path, const String &p_original_path, Error *r_error, bool p_use_sub_threads, float *r_progress, CacheMode p_cache_mode) {
 	if (r_error) {
 		*r_error = ERR_FILE_CANT_OPEN;
 	}
 
+	String file_path = p_path;
+	String path = p_original_path != "" ? p_original_path : p_path;
+	String sub_resource_id;
+	int sub_resource = path.find("::");
+	if (sub_resource != -1) {
+		sub_resource_id = path.substr(sub_resource + 2);
+		path = path.substr(0, sub_resource);
+		file_path = file_path.get_slice("::", 0);
+	}
+
 	Error err;
-	FileAccess *f = FileAccess::open(p_path, FileAccess::READ, &err);
+	FileAccess *f = FileAccess::open(file_path, FileAccess::READ, &err);
 
-	ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot open file '" + p_path + "'.");
+	ERR_FAIL_COND_V_MSG(err != OK, RES(), "Cannot open file '" + file_path + "'.");
 
 	ResourceLoaderBinary loader;
 	loader.cache_mode = p_cache_mode;
 	loader.use_sub_threads = p_use_sub_threads;
 	loader.progress = r_progress;
-	String path = p_original_path != "" ? p_original_path : p_path;
 	loader.local_path = ProjectSettings::get_singleton()->localize_path(path);
 	loader.res_path = loader.local_path;
 	//loader.set_local_path( Globals::get_singleton()->localize_path(p_path) );
 	loader.open(f);
 
-	err = loader.load();
+	if (sub_resource_id.is_empty()) {
+		err = loader.load();
+	} else {
+		err = loader.load_sub_resource(sub_resource_id);
+	}
 
 	if (r_error) {
 		*r_error = err;
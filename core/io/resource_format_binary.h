@@ -61,6 +61,7 @@ class ResourceLoaderBinary {
 		String type;
 		ResourceUID::ID uid = ResourceUID::INVALID_ID;
 		RES cache;
+		bool requested = false;
 	};
 
 	bool using_named_scene_ids = false;
@@ -71,11 +72,20 @@ class ResourceLoaderBinary {
 
 	struct IntResource {
 		String path;
+		String id;
 		uint64_t offset;
 	};
 
 	Vector<IntResource> internal_resources;
 	Map<String, RES> internal_index_cache;
+	// Internal resources are materialized when first referenced, from their offset.
+	Map<String, int> internal_index;
+	int internal_loaded = 0;
+
+	void _remap_external_resources();
+	Error _request_external_resource(int p_index);
+	void _index_internal_resources();
+	Error _load_internal_resource(int p_index);
 
 	String get_unicode_string();
 	void _advance_padding(uint32_t p_len);
@@ -95,6 +105,7 @@ public:
 	void set_local_path(const String &p_local_path);
 	Ref<Resource> get_resource();
 	Error load();
+	Error load_sub_resource(const String &p_id);
 	void set_translation_remapped(bool p_remapped);
 
 	void set_remaps(const Map<String, String> &p_remaps) { remaps = p_remaps; }
@@ -108,6 +119,7 @@ public:
 
 class ResourceFormatLoaderBinary : public ResourceFormatLoader {
 public:
+	virtual bool recognize_path(const String &p_path, const String &p_for_type = String()) const;
 	virtual RES load(const String &p_path, const String &p_original_path = "", Error *r_error = nullptr, bool p_use_sub_threads = false, float *r_progress = nullptr, CacheMode p_cache_mode = CACHE_MODE_REUSE);
 	virtual void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions) const;
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
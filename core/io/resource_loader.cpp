@@ -31,6 +31,7 @@
 #include "resource_loader.h"
 
 #include "core/config/project_settings.h"
+#include "core/debugger/trace.h"
 #include "core/io/file_access.h"
 #include "core/io/resource_importer.h"
 #include "core/os/os.h"
@@ -190,6 +191,8 @@ void ResourceFormatLoader::_bind_methods() {
 ///////////////////////////////////
 
 RES ResourceLoader::_load(const String &p_path, const String &p_original_path, const String &p_type_hint, ResourceFormatLoader::CacheMode p_cache_mode, Error *r_error, bool p_use_sub_threads, float *r_progress) {
+	TRACE_ZONE("ResourceLoader::load");
+	MemoryTagScope tag_scope(Memory::TAG_RESOURCE);
 	bool found = false;
 
 	// Try all loaders and pick the first match for the type hint
@@ -221,10 +224,6 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 	ThreadLoadTask &load_task = *(ThreadLoadTask *)p_userdata;
 	load_task.loader_id = Thread::get_caller_id();
 
-	if (load_task.semaphore) {
-		//this is an actual thread, so wait for Ok from semaphore
-		thread_load_semaphore->wait(); //wait until its ok to start loading
-	}
 	load_task.resource = _load(load_task.remapped_path, load_task.remapped_path != load_task.local_path ? load_task.local_path : String(), load_task.type_hint, load_task.cache_mode, &load_task.error, load_task.use_sub_threads, &load_task.progress);
 
 	load_task.progress = 1.0; //it was fully loaded at this point, so force progress to 1.0
@@ -236,16 +235,6 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 		load_task.status = THREAD_LOAD_LOADED;
 	}
 	if (load_task.semaphore) {
-		if (load_task.start_next && thread_waiting_count > 0) {
-			thread_waiting_count--;
-			//thread loading count remains constant, this ends but another one begins
-			thread_load_semaphore->post();
-		} else {
-			thread_loading_count--; //no threads waiting, just reduce loading count
-		}
-
-		print_lt("END: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
-
 		for (int i = 0; i < load_task.poll_requests; i++) {
 			load_task.semaphore->post();
 		}
@@ -275,7 +264,88 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 		}
 	}
 
+	if (load_task.cancelled) {
+		// Nobody wants it anymore, the resource stays in the cache if it was loaded.
+		thread_load_tasks.erase(load_task.local_path);
+	}
+
+	thread_load_mutex->unlock();
+}
+
+void ResourceLoader::_thread_load_worker(void *p_userdata) {
+	thread_load_mutex->lock();
+	thread_load_scheduled--;
+	// Not necessarily the load this task was scheduled for, the most urgent one is taken.
+	ThreadLoadTask *load_task = _thread_load_queue_pop();
 	thread_load_mutex->unlock();
+
+	if (load_task) {
+		_thread_load_function(load_task);
+	}
+
+	thread_load_mutex->lock();
+	thread_load_active--;
+	_thread_load_dispatch();
+	thread_load_mutex->unlock();
+}
+
+// Must be called with thread_load_mutex locked.
+void ResourceLoader::_thread_load_dispatch() {
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	// Every pool task must be waited on, collect the ones that are done.
+	for (uint32_t i = 0; i < thread_load_pool_tasks.size(); i++) {
+		if (pool->is_task_completed(thread_load_pool_tasks[i])) {
+			pool->wait_for_task_completion(thread_load_pool_tasks[i]);
+			thread_load_pool_tasks.remove_unordered(i);
+			i--;
+		}
+	}
+
+	while (thread_load_active < pool->get_thread_count() && thread_load_scheduled < (int)thread_load_queue.size()) {
+		thread_load_active++;
+		thread_load_scheduled++;
+		thread_load_pool_tasks.push_back(pool->add_native_task(&ResourceLoader::_thread_load_worker, nullptr, false, "Resource Loading"));
+	}
+
+	print_lt("DISPATCH: queued: " + itos(thread_load_queue.size()) + " / active: " + itos(thread_load_active) + " / scheduled: " + itos(thread_load_scheduled));
+}
+
+// Must be called with thread_load_mutex locked.
+ResourceLoader::ThreadLoadTask *ResourceLoader::_thread_load_queue_pop() {
+	if (thread_load_queue.is_empty()) {
+		return nullptr;
+	}
+
+	// Linear search, the queue is small and priorities change while queued.
+	// On ties the oldest request wins.
+	uint32_t best = 0;
+	for (uint32_t i = 1; i < thread_load_queue.size(); i++) {
+		if (thread_load_queue[i]->priority > thread_load_queue[best]->priority) {
+			best = i;
+		}
+	}
+
+	ThreadLoadTask *load_task = thread_load_queue[best];
+	thread_load_queue.remove(best);
+	load_task->queued = false;
+	return load_task;
+}
+
+// Must be called with thread_load_mutex locked.
+void ResourceLoader::_thread_load_set_priority(ThreadLoadTask &p_load_task, float p_priority, bool p_raise_only) {
+	if (p_raise_only ? p_load_task.priority >= p_priority : p_load_task.priority == p_priority) {
+		return; // Also stops cyclic sub-resource references.
+	}
+	p_load_task.priority = p_priority;
+
+	// Sub-resources block their owner, so they inherit its priority.
+	for (Set<String>::Element *E = p_load_task.sub_tasks.front(); E; E = E->next()) {
+		ThreadLoadTask *sub_task = thread_load_tasks.getptr(E->get());
+		if (sub_task && sub_task != &p_load_task) {
+			_thread_load_set_priority(*sub_task, p_priority, p_raise_only);
+		}
+	}
 }
 
 static String _validate_local_path(const String &p_path) {
@@ -288,7 +358,7 @@ static String _validate_local_path(const String &p_path) {
 		return ProjectSettings::get_singleton()->localize_path(p_path);
 	}
 }
-Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource) {
+Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource, float p_priority) {
 	String local_path = _validate_local_path(p_path);
 
 	thread_load_mutex->lock();
@@ -312,11 +382,18 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 		}
 	}
 
+	if (p_source_resource != String()) {
+		p_priority = MAX(p_priority, thread_load_tasks[p_source_resource].priority);
+	}
+
 	if (thread_load_tasks.has(local_path)) {
-		thread_load_tasks[local_path].requests++;
+		ThreadLoadTask &load_task = thread_load_tasks[local_path];
+		load_task.requests++;
+		load_task.cancelled = false;
 		if (p_source_resource != String()) {
 			thread_load_tasks[p_source_resource].sub_tasks.insert(local_path);
 		}
+		_thread_load_set_priority(load_task, p_priority, true);
 		thread_load_mutex->unlock();
 		return OK;
 	}
@@ -332,6 +409,7 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 		load_task.type_hint = p_type_hint;
 		load_task.cache_mode = p_cache_mode;
 		load_task.use_sub_threads = p_use_sub_threads;
+		load_task.priority = p_priority;
 
 		{ //must check if resource is already loaded before attempting to load it in a thread
 
@@ -370,21 +448,51 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 	if (load_task.resource.is_null()) { //needs to be loaded in thread
 
 		load_task.semaphore = memnew(Semaphore);
-		if (thread_loading_count < thread_load_max) {
-			thread_loading_count++;
-			thread_load_semaphore->post(); //we have free threads, so allow one
-		} else {
-			thread_waiting_count++;
-		}
+		load_task.queued = true;
+		thread_load_queue.push_back(&load_task);
+		_thread_load_dispatch();
+	}
+
+	thread_load_mutex->unlock();
 
-		print_lt("REQUEST: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+	return OK;
+}
+
+Error ResourceLoader::load_threaded_set_priority(const String &p_path, float p_priority) {
+	String local_path = _validate_local_path(p_path);
+
+	MutexLock lock(*thread_load_mutex);
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	ERR_FAIL_COND_V_MSG(!load_task, ERR_INVALID_PARAMETER, "There is no thread loading resource '" + local_path + "'.");
+
+	// Only affects loads that did not start yet, including sub-resources requested by it.
+	_thread_load_set_priority(*load_task, p_priority, false);
+	return OK;
+}
+
+Error ResourceLoader::load_threaded_cancel(const String &p_path) {
+	String local_path = _validate_local_path(p_path);
+
+	MutexLock lock(*thread_load_mutex);
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	ERR_FAIL_COND_V_MSG(!load_task, ERR_INVALID_PARAMETER, "There is no thread loading resource '" + local_path + "'.");
 
-		load_task.thread = memnew(Thread);
-		load_task.thread->start(_thread_load_function, &thread_load_tasks[local_path]);
-		load_task.loader_id = load_task.thread->get_id();
+	// Drops one request, the load is only cancelled once nobody else requested it.
+	load_task->requests--;
+	if (load_task->requests > 0) {
+		return OK;
 	}
 
-	thread_load_mutex->unlock();
+	if (load_task->queued) {
+		thread_load_queue.erase(load_task);
+		memdelete(load_task->semaphore);
+		thread_load_tasks.erase(local_path);
+	} else if (load_task->status == THREAD_LOAD_IN_PROGRESS) {
+		// Already loading, can't be interrupted. The task is erased when done.
+		load_task->cancelled = true;
+	} else {
+		thread_load_tasks.erase(local_path);
+	}
 
 	return OK;
 }
@@ -445,47 +553,45 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 
 	ThreadLoadTask &load_task = thread_load_tasks[local_path];
 
+	if (load_task.queued) {
+		// No worker picked it yet, so load it right here instead of waiting.
+		// This also makes loads blocked on a sub-resource load it first.
+		thread_load_queue.erase(&load_task);
+		load_task.queued = false;
+
+		thread_load_mutex->unlock();
+		_thread_load_function(&load_task);
+		thread_load_mutex->lock();
+	}
+
 	//semaphore still exists, meaning it's still loading, request poll
 	Semaphore *semaphore = load_task.semaphore;
 	if (semaphore) {
 		load_task.poll_requests++;
 
-		{
-			// As we got a semaphore, this means we are going to have to wait
-			// until the sub-resource is done loading
-			//
-			// As this thread will become 'blocked' we should "exchange" its
-			// active status with a waiting one, to ensure load continues.
-			//
-			// This ensures loading is never blocked and that is also within
-			// the maximum number of active threads.
-
-			if (thread_waiting_count > 0) {
-				thread_waiting_count--;
-				thread_loading_count++;
-				thread_load_semaphore->post();
-
-				load_task.start_next = false; //do not start next since we are doing it here
-			}
-
-			thread_suspended_count++;
-
-			print_lt("GET: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+		// A blocked worker does not count as active, so the queue keeps
+		// being processed while it waits.
+		bool is_worker = WorkerThreadPool::get_thread_index() != -1;
+		if (is_worker) {
+			thread_load_active--;
+			_thread_load_dispatch();
 		}
 
 		thread_load_mutex->unlock();
 		semaphore->wait();
 		thread_load_mutex->lock();
 
-		thread_suspended_count--;
+		if (is_worker) {
+			thread_load_active++;
+		}
+	}
 
-		if (!thread_load_tasks.has(local_path)) { //may have been erased during unlock and this was always an invalid call
-			thread_load_mutex->unlock();
-			if (r_error) {
-				*r_error = ERR_INVALID_PARAMETER;
-			}
-			return RES();
+	if (!thread_load_tasks.has(local_path)) { //may have been erased during unlock and this was always an invalid call
+		thread_load_mutex->unlock();
+		if (r_error) {
+			*r_error = ERR_INVALID_PARAMETER;
 		}
+		return RES();
 	}
 
 	RES resource = load_task.resource;
@@ -496,10 +602,6 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 	load_task.requests--;
 
 	if (load_task.requests == 0) {
-		if (load_task.thread) { //thread may not have been used
-			load_task.thread->wait_to_finish();
-			memdelete(load_task.thread);
-		}
 		thread_load_tasks.erase(local_path);
 	}
 
@@ -1055,16 +1157,27 @@ void ResourceLoader::remove_custom_loaders() {
 
 void ResourceLoader::initialize() {
 	thread_load_mutex = memnew(Mutex);
-	thread_load_max = OS::get_singleton()->get_processor_count();
-	thread_loading_count = 0;
-	thread_waiting_count = 0;
-	thread_suspended_count = 0;
-	thread_load_semaphore = memnew(Semaphore);
+	thread_load_scheduled = 0;
+	thread_load_active = 0;
 }
 
 void ResourceLoader::finalize() {
+	// Let the workers finish the loads still queued, they may schedule more while doing so.
+	while (true) {
+		thread_load_mutex->lock();
+		LocalVector<WorkerThreadPool::TaskID> pool_tasks = thread_load_pool_tasks;
+		thread_load_pool_tasks.clear();
+		thread_load_mutex->unlock();
+
+		if (pool_tasks.is_empty()) {
+			break;
+		}
+		for (uint32_t i = 0; i < pool_tasks.size(); i++) {
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(pool_tasks[i]);
+		}
+	}
+
 	memdelete(thread_load_mutex);
-	memdelete(thread_load_semaphore);
 }
 
 ResourceLoadErrorNotify ResourceLoader::err_notify = nullptr;
@@ -1078,12 +1191,10 @@ bool ResourceLoader::timestamp_on_load = false;
 
 Mutex *ResourceLoader::thread_load_mutex = nullptr;
 HashMap<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
-Semaphore *ResourceLoader::thread_load_semaphore = nullptr;
-
-int ResourceLoader::thread_loading_count = 0;
-int ResourceLoader::thread_waiting_count = 0;
-int ResourceLoader::thread_suspended_count = 0;
-int ResourceLoader::thread_load_max = 0;
+LocalVector<ResourceLoader::ThreadLoadTask *> ResourceLoader::thread_load_queue;
+LocalVector<WorkerThreadPool::TaskID> ResourceLoader::thread_load_pool_tasks;
+int ResourceLoader::thread_load_scheduled = 0;
+int ResourceLoader::thread_load_active = 0;
 
 SelfList<Resource>::List ResourceLoader::remapped_list;
 HashMap<String, Vector<String>> ResourceLoader::translation_remaps;
@@ -34,6 +34,8 @@
 #include "core/io/resource.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/templates/local_vector.h"
 
 class ResourceFormatLoader : public RefCounted {
 	GDCLASS(ResourceFormatLoader, RefCounted);
@@ -116,38 +118,46 @@ private:
 	static Ref<ResourceFormatLoader> _find_custom_resource_format_loader(String path);
 
 	struct ThreadLoadTask {
-		Thread *thread = nullptr;
 		Thread::ID loader_id = 0;
 		Semaphore *semaphore = nullptr;
 		String local_path;
 		String remapped_path;
 		String type_hint;
 		float progress = 0.0;
+		float priority = 0.0;
 		ThreadLoadStatus status = THREAD_LOAD_IN_PROGRESS;
 		ResourceFormatLoader::CacheMode cache_mode = ResourceFormatLoader::CACHE_MODE_REUSE;
 		Error error = OK;
 		RES resource;
 		bool xl_remapped = false;
 		bool use_sub_threads = false;
-		bool start_next = true;
+		bool queued = false; // Waiting in thread_load_queue for a worker.
+		bool cancelled = false; // No requests left, erase once the load ends.
 		int requests = 0;
 		int poll_requests = 0;
 		Set<String> sub_tasks;
 	};
 
 	static void _thread_load_function(void *p_userdata);
+	static void _thread_load_worker(void *p_userdata);
+	static void _thread_load_dispatch();
+	static ThreadLoadTask *_thread_load_queue_pop();
+	static void _thread_load_set_priority(ThreadLoadTask &p_load_task, float p_priority, bool p_raise_only);
+
 	static Mutex *thread_load_mutex;
 	static HashMap<String, ThreadLoadTask> thread_load_tasks;
-	static Semaphore *thread_load_semaphore;
-	static int thread_waiting_count;
-	static int thread_loading_count;
-	static int thread_suspended_count;
-	static int thread_load_max;
+	// Loads not yet picked by a worker. Workers always take the highest priority one.
+	static LocalVector<ThreadLoadTask *> thread_load_queue;
+	static LocalVector<WorkerThreadPool::TaskID> thread_load_pool_tasks;
+	static int thread_load_scheduled; // Pool tasks that did not pick a load yet.
+	static int thread_load_active; // Pool tasks scheduled or loading, blocked ones excluded.
 
 	static float _dependency_get_progress(const String &p_path);
 
 public:
-	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false, ResourceFormatLoader::CacheMode p_cache_mode = ResourceFormatLoader::CACHE_MODE_REUSE, const String &p_source_resource = String());
+	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false, ResourceFormatLoader::CacheMode p_cache_mode = ResourceFormatLoader::CACHE_MODE_REUSE, const String &p_source_resource = String(), float p_priority = 0.0);
+	static Error load_threaded_set_priority(const String &p_path, float p_priority);
+	static Error load_threaded_cancel(const String &p_path);
 	static ThreadLoadStatus load_threaded_get_status(const String &p_path, float *r_progress = nullptr);
 	static RES load_threaded_get(const String &p_path, Error *r_error = nullptr);
 
@@ -35,6 +35,7 @@
 #include "core/object/class_db.h"
 #include "core/object/ref_counted.h"
 #include "core/os/os.h"
+#include "core/variant/variant_internal.h"
 #include "core/variant/variant_parser.h"
 
 static bool _is_number(char32_t c) {
@@ -1381,6 +1382,547 @@ bool Expression::_execute(const Array &p_inputs, Object *p_instance, Expression:
 	return false;
 }
 
+// Values of these types are shared between copies, so a folded constant could
+// be modified through a previous result.
+static bool _is_foldable_type(Variant::Type p_type) {
+	return p_type != Variant::OBJECT && p_type != Variant::ARRAY && p_type != Variant::DICTIONARY && p_type < Variant::PACKED_BYTE_ARRAY;
+}
+
+// The validated evaluators don't check for division by zero or invalid shifts.
+static bool _is_cacheable_operator(Variant::Operator p_op) {
+	switch (p_op) {
+		case Variant::OP_EQUAL:
+		case Variant::OP_NOT_EQUAL:
+		case Variant::OP_LESS:
+		case Variant::OP_LESS_EQUAL:
+		case Variant::OP_GREATER:
+		case Variant::OP_GREATER_EQUAL:
+		case Variant::OP_ADD:
+		case Variant::OP_SUBTRACT:
+		case Variant::OP_MULTIPLY:
+		case Variant::OP_NEGATE:
+		case Variant::OP_POSITIVE:
+		case Variant::OP_BIT_AND:
+		case Variant::OP_BIT_OR:
+		case Variant::OP_BIT_XOR:
+		case Variant::OP_BIT_NEGATE:
+		case Variant::OP_AND:
+		case Variant::OP_OR:
+		case Variant::OP_XOR:
+		case Variant::OP_NOT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+int Expression::_add_constant(const Variant &p_value) {
+	constants.push_back(p_value);
+	return (ADDR_CONSTANT << ADDR_BITS) | (constants.size() - 1);
+}
+
+int Expression::_add_name(const StringName &p_name) {
+	for (uint32_t i = 0; i < names.size(); i++) {
+		if (names[i] == p_name) {
+			return i;
+		}
+	}
+	names.push_back(p_name);
+	return names.size() - 1;
+}
+
+int Expression::_alloc_temporary() {
+	if (temporary_count >= MAX_TEMPORARIES) {
+		return -1;
+	}
+	return (ADDR_TEMPORARY << ADDR_BITS) | temporary_count++;
+}
+
+bool Expression::_compile_arguments(const Vector<ENode *> &p_arguments, Vector<int> &r_addresses, bool &r_constant) {
+	r_constant = true;
+	r_addresses.resize(p_arguments.size());
+	for (int i = 0; i < p_arguments.size(); i++) {
+		bool constant;
+		r_addresses.write[i] = _compile_node(p_arguments[i], constant);
+		if (r_addresses[i] < 0) {
+			return false;
+		}
+		r_constant = r_constant && constant;
+	}
+	max_argument_count = MAX(max_argument_count, p_arguments.size());
+	return true;
+}
+
+int Expression::_compile_node(const ENode *p_node, bool &r_constant) {
+	r_constant = false;
+
+	switch (p_node->type) {
+		case ENode::TYPE_INPUT: {
+			const InputNode *in = static_cast<const InputNode *>(p_node);
+			if (in->index < 0 || in->index > ADDR_MASK) {
+				return -1;
+			}
+			max_input_index = MAX(max_input_index, in->index);
+			return (ADDR_INPUT << ADDR_BITS) | in->index;
+		}
+		case ENode::TYPE_CONSTANT: {
+			r_constant = true;
+			return _add_constant(static_cast<const ConstantNode *>(p_node)->value);
+		}
+		case ENode::TYPE_SELF: {
+			uses_self = true;
+			return ADDR_SELF << ADDR_BITS;
+		}
+		case ENode::TYPE_OPERATOR: {
+			const OperatorNode *op = static_cast<const OperatorNode *>(p_node);
+
+			bool a_constant = true;
+			bool b_constant = true;
+			int a = _compile_node(op->nodes[0], a_constant);
+			int b = op->nodes[1] ? _compile_node(op->nodes[1], b_constant) : _add_constant(Variant());
+			if (a < 0 || b < 0) {
+				return -1;
+			}
+
+			if (a_constant && b_constant) {
+				Variant result;
+				bool valid = true;
+				Variant::evaluate(op->op, constants[a & ADDR_MASK], constants[b & ADDR_MASK], result, valid);
+				if (valid && _is_foldable_type(result.get_type())) {
+					r_constant = true;
+					return _add_constant(result);
+				}
+				// Leave the error to execution.
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(OPCODE_OPERATOR);
+			code.push_back(op->op);
+			code.push_back(a);
+			code.push_back(b);
+			code.push_back(dst);
+			code.push_back(operator_cache_count++);
+			return dst;
+		}
+		case ENode::TYPE_INDEX: {
+			const IndexNode *index = static_cast<const IndexNode *>(p_node);
+
+			bool base_constant;
+			bool index_constant;
+			int base = _compile_node(index->base, base_constant);
+			int idx = base < 0 ? -1 : _compile_node(index->index, index_constant);
+			if (idx < 0) {
+				return -1;
+			}
+
+			if (base_constant && index_constant) {
+				bool valid;
+				Variant result = constants[base & ADDR_MASK].get(constants[idx & ADDR_MASK], &valid);
+				if (valid && _is_foldable_type(result.get_type())) {
+					r_constant = true;
+					return _add_constant(result);
+				}
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(OPCODE_INDEX);
+			code.push_back(base);
+			code.push_back(idx);
+			code.push_back(dst);
+			return dst;
+		}
+		case ENode::TYPE_NAMED_INDEX: {
+			const NamedIndexNode *index = static_cast<const NamedIndexNode *>(p_node);
+
+			bool base_constant;
+			int base = _compile_node(index->base, base_constant);
+			if (base < 0) {
+				return -1;
+			}
+
+			if (base_constant) {
+				bool valid;
+				Variant result = constants[base & ADDR_MASK].get_named(index->name, valid);
+				if (valid && _is_foldable_type(result.get_type())) {
+					r_constant = true;
+					return _add_constant(result);
+				}
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(OPCODE_NAMED_INDEX);
+			code.push_back(base);
+			code.push_back(_add_name(index->name));
+			code.push_back(dst);
+			return dst;
+		}
+		case ENode::TYPE_ARRAY:
+		case ENode::TYPE_DICTIONARY: {
+			const Vector<ENode *> &elements = p_node->type == ENode::TYPE_ARRAY ? static_cast<const ArrayNode *>(p_node)->array : static_cast<const DictionaryNode *>(p_node)->dict;
+
+			Vector<int> addresses;
+			bool constant;
+			if (!_compile_arguments(elements, addresses, constant)) {
+				return -1;
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(p_node->type == ENode::TYPE_ARRAY ? OPCODE_ARRAY : OPCODE_DICTIONARY);
+			code.push_back(addresses.size());
+			for (int i = 0; i < addresses.size(); i++) {
+				code.push_back(addresses[i]);
+			}
+			code.push_back(dst);
+			return dst;
+		}
+		case ENode::TYPE_CONSTRUCTOR: {
+			const ConstructorNode *constructor = static_cast<const ConstructorNode *>(p_node);
+
+			Vector<int> addresses;
+			bool constant;
+			if (!_compile_arguments(constructor->arguments, addresses, constant)) {
+				return -1;
+			}
+
+			if (constant && _is_foldable_type(constructor->data_type)) {
+				Vector<const Variant *> argp;
+				argp.resize(addresses.size());
+				for (int i = 0; i < addresses.size(); i++) {
+					argp.write[i] = &constants[addresses[i] & ADDR_MASK];
+				}
+				Variant result;
+				Callable::CallError ce;
+				Variant::construct(constructor->data_type, result, (const Variant **)argp.ptr(), argp.size(), ce);
+				if (ce.error == Callable::CallError::CALL_OK) {
+					r_constant = true;
+					return _add_constant(result);
+				}
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(OPCODE_CONSTRUCT);
+			code.push_back(constructor->data_type);
+			code.push_back(addresses.size());
+			for (int i = 0; i < addresses.size(); i++) {
+				code.push_back(addresses[i]);
+			}
+			code.push_back(dst);
+			return dst;
+		}
+		case ENode::TYPE_BUILTIN_FUNC: {
+			const BuiltinFuncNode *bifunc = static_cast<const BuiltinFuncNode *>(p_node);
+
+			Vector<int> addresses;
+			bool constant;
+			if (!_compile_arguments(bifunc->arguments, addresses, constant)) {
+				return -1;
+			}
+
+			// Only math functions are pure, the others may have side effects or depend on state.
+			if (constant && Variant::get_utility_function_type(bifunc->func) == Variant::UTILITY_FUNC_TYPE_MATH) {
+				Vector<const Variant *> argp;
+				argp.resize(addresses.size());
+				for (int i = 0; i < addresses.size(); i++) {
+					argp.write[i] = &constants[addresses[i] & ADDR_MASK];
+				}
+				Variant result;
+				Callable::CallError ce;
+				Variant::call_utility_function(bifunc->func, &result, (const Variant **)argp.ptr(), argp.size(), ce);
+				if (ce.error == Callable::CallError::CALL_OK && _is_foldable_type(result.get_type())) {
+					r_constant = true;
+					return _add_constant(result);
+				}
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(OPCODE_CALL_BUILTIN);
+			code.push_back(_add_name(bifunc->func));
+			code.push_back(addresses.size());
+			for (int i = 0; i < addresses.size(); i++) {
+				code.push_back(addresses[i]);
+			}
+			code.push_back(dst);
+			return dst;
+		}
+		case ENode::TYPE_CALL: {
+			const CallNode *call = static_cast<const CallNode *>(p_node);
+
+			bool base_constant;
+			int base = _compile_node(call->base, base_constant);
+			if (base < 0) {
+				return -1;
+			}
+
+			Vector<int> addresses;
+			bool constant;
+			if (!_compile_arguments(call->arguments, addresses, constant)) {
+				return -1;
+			}
+
+			int dst = _alloc_temporary();
+			if (dst < 0) {
+				return -1;
+			}
+			code.push_back(OPCODE_CALL);
+			code.push_back(base);
+			code.push_back(_add_name(call->method));
+			code.push_back(addresses.size());
+			for (int i = 0; i < addresses.size(); i++) {
+				code.push_back(addresses[i]);
+			}
+			code.push_back(dst);
+			return dst;
+		}
+	}
+	return -1;
+}
+
+void Expression::_compile_bytecode() {
+	code.clear();
+	constants.clear();
+	names.clear();
+	_clear_operator_caches();
+	temporary_count = 0;
+	max_argument_count = 0;
+	max_input_index = -1;
+	uses_self = false;
+
+	bool constant;
+	result_address = root ? _compile_node(root, constant) : -1;
+	// Deep expressions with too many temporaries for the stack keep using the node tree.
+	bytecode_valid = result_address >= 0;
+
+	operator_caches.resize(operator_cache_count);
+	for (int i = 0; i < operator_cache_count; i++) {
+		operator_caches[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+void Expression::_clear_operator_caches() {
+	operator_caches.clear();
+	for (uint32_t i = 0; i < operator_cache_entries.size(); i++) {
+		memdelete(operator_cache_entries[i]);
+	}
+	operator_cache_entries.clear();
+	operator_cache_count = 0;
+}
+
+void Expression::_update_operator_cache(int p_cache, Variant::Operator p_op, Variant::Type p_left, Variant::Type p_right) {
+	Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(p_op, p_left, p_right);
+	if (!evaluator) {
+		return;
+	}
+
+	MutexLock lock(operator_cache_mutex);
+	// Reuse entries, so operands alternating between types don't allocate on every execution.
+	OperatorCache *cache = nullptr;
+	for (uint32_t i = 0; i < operator_cache_entries.size(); i++) {
+		OperatorCache *entry = operator_cache_entries[i];
+		if (entry->op == p_op && entry->left == p_left && entry->right == p_right) {
+			cache = entry;
+			break;
+		}
+	}
+	if (!cache) {
+		cache = memnew(OperatorCache);
+		cache->op = p_op;
+		cache->left = p_left;
+		cache->right = p_right;
+		cache->result = Variant::get_operator_return_type(p_op, p_left, p_right);
+		cache->evaluator = evaluator;
+		operator_cache_entries.push_back(cache);
+	}
+	operator_caches[p_cache].store(cache, std::memory_order_release);
+}
+
+bool Expression::_execute_bytecode(const Array &p_inputs, Object *p_instance, Variant &r_ret, String &r_error_str) {
+	Variant *temporaries = (Variant *)alloca(sizeof(Variant) * temporary_count);
+	for (int i = 0; i < temporary_count; i++) {
+		memnew_placement(&temporaries[i], Variant);
+	}
+	const Variant **argp = (const Variant **)alloca(sizeof(const Variant *) * max_argument_count);
+	Variant self;
+	if (uses_self) {
+		self = p_instance;
+	}
+
+	// Inputs were checked to be all passed, and Array stores them contiguously.
+	const Variant *bases[4] = { temporaries, constants.ptr(), p_inputs.is_empty() ? nullptr : &p_inputs[0], &self };
+	const int *ip = code.ptr();
+	const int *end = ip + code.size();
+
+#define OPERAND(m_address) (bases[(m_address) >> ADDR_BITS] + ((m_address)&ADDR_MASK))
+#define TEMPORARY(m_address) (&temporaries[(m_address)&ADDR_MASK])
+
+	bool failed = false;
+	while (ip < end && !failed) {
+		switch (ip[0]) {
+			case OPCODE_OPERATOR: {
+				const Variant::Operator op = Variant::Operator(ip[1]);
+				const Variant *a = OPERAND(ip[2]);
+				const Variant *b = OPERAND(ip[3]);
+				Variant *dst = TEMPORARY(ip[4]);
+				const int cache_index = ip[5];
+				const OperatorCache *cache = operator_caches[cache_index].load(std::memory_order_acquire);
+				ip += 6;
+
+				if (likely(cache && a->get_type() == cache->left && b->get_type() == cache->right)) {
+					if (dst->get_type() != cache->result) {
+						VariantInternal::initialize(dst, cache->result);
+					}
+					cache->evaluator(a, b, dst);
+					break;
+				}
+
+				bool valid = true;
+				Variant::evaluate(op, *a, *b, *dst, valid);
+				if (!valid) {
+					r_error_str = vformat(RTR("Invalid operands to operator %s, %s and %s."), Variant::get_operator_name(op), Variant::get_type_name(a->get_type()), Variant::get_type_name(b->get_type()));
+					failed = true;
+				} else if (_is_cacheable_operator(op) && a->get_type() != Variant::OBJECT && b->get_type() != Variant::OBJECT) {
+					_update_operator_cache(cache_index, op, a->get_type(), b->get_type());
+				}
+			} break;
+			case OPCODE_INDEX: {
+				const Variant *base = OPERAND(ip[1]);
+				const Variant *idx = OPERAND(ip[2]);
+				Variant *dst = TEMPORARY(ip[3]);
+				ip += 4;
+
+				bool valid;
+				*dst = base->get(*idx, &valid);
+				if (!valid) {
+					r_error_str = vformat(RTR("Invalid index of type %s for base type %s"), Variant::get_type_name(idx->get_type()), Variant::get_type_name(base->get_type()));
+					failed = true;
+				}
+			} break;
+			case OPCODE_NAMED_INDEX: {
+				const Variant *base = OPERAND(ip[1]);
+				const StringName &name = names[ip[2]];
+				Variant *dst = TEMPORARY(ip[3]);
+				ip += 4;
+
+				bool valid;
+				*dst = base->get_named(name, valid);
+				if (!valid) {
+					r_error_str = vformat(RTR("Invalid named index '%s' for base type %s"), String(name), Variant::get_type_name(base->get_type()));
+					failed = true;
+				}
+			} break;
+			case OPCODE_ARRAY: {
+				const int count = ip[1];
+				Array arr;
+				arr.resize(count);
+				for (int i = 0; i < count; i++) {
+					arr[i] = *OPERAND(ip[2 + i]);
+				}
+				*TEMPORARY(ip[2 + count]) = arr;
+				ip += 3 + count;
+			} break;
+			case OPCODE_DICTIONARY: {
+				const int count = ip[1];
+				Dictionary d;
+				for (int i = 0; i < count; i += 2) {
+					d[*OPERAND(ip[2 + i])] = *OPERAND(ip[3 + i]);
+				}
+				*TEMPORARY(ip[2 + count]) = d;
+				ip += 3 + count;
+			} break;
+			case OPCODE_CONSTRUCT: {
+				const Variant::Type type = Variant::Type(ip[1]);
+				const int argc = ip[2];
+				for (int i = 0; i < argc; i++) {
+					argp[i] = OPERAND(ip[3 + i]);
+				}
+				Variant *dst = TEMPORARY(ip[3 + argc]);
+				ip += 4 + argc;
+
+				Callable::CallError ce;
+				Variant::construct(type, *dst, argp, argc, ce);
+				if (ce.error != Callable::CallError::CALL_OK) {
+					r_error_str = vformat(RTR("Invalid arguments to construct '%s'"), Variant::get_type_name(type));
+					failed = true;
+				}
+			} break;
+			case OPCODE_CALL_BUILTIN: {
+				const StringName &func = names[ip[1]];
+				const int argc = ip[2];
+				for (int i = 0; i < argc; i++) {
+					argp[i] = OPERAND(ip[3 + i]);
+				}
+				Variant *dst = TEMPORARY(ip[3 + argc]);
+				ip += 4 + argc;
+
+				*dst = Variant(); // May not return anything.
+				Callable::CallError ce;
+				Variant::call_utility_function(func, dst, argp, argc, ce);
+				if (ce.error != Callable::CallError::CALL_OK) {
+					r_error_str = "Builtin Call Failed. " + Variant::get_call_error_text(func, argp, argc, ce);
+					failed = true;
+				}
+			} break;
+			case OPCODE_CALL: {
+				const int base_address = ip[1];
+				const StringName &method = names[ip[2]];
+				const int argc = ip[3];
+				for (int i = 0; i < argc; i++) {
+					argp[i] = OPERAND(ip[4 + i]);
+				}
+				Variant *dst = TEMPORARY(ip[4 + argc]);
+				ip += 5 + argc;
+
+				// Calls may modify their base, which must not change constants or inputs.
+				Variant base_copy;
+				Variant *base = TEMPORARY(base_address);
+				if ((base_address >> ADDR_BITS) != ADDR_TEMPORARY) {
+					base_copy = *OPERAND(base_address);
+					base = &base_copy;
+				}
+
+				Callable::CallError ce;
+				base->call(method, argp, argc, *dst, ce);
+				if (ce.error != Callable::CallError::CALL_OK) {
+					r_error_str = vformat(RTR("On call to '%s':"), String(method));
+					failed = true;
+				}
+			} break;
+			default: {
+				r_error_str = "Invalid expression byte code.";
+				failed = true;
+			} break;
+		}
+	}
+
+	// On errors this is what the failing root node left, like the node tree returns.
+	r_ret = *OPERAND(result_address);
+
+#undef OPERAND
+#undef TEMPORARY
+
+	for (int i = 0; i < temporary_count; i++) {
+		temporaries[i].~Variant();
+	}
+	return failed;
+}
+
 Error Expression::parse(const String &p_expression, const Vector<String> &p_input_names) {
 	if (nodes) {
 		memdelete(nodes);
@@ -1402,21 +1944,30 @@ Error Expression::parse(const String &p_expression, const Vector<String> &p_inpu
 			memdelete(nodes);
 		}
 		nodes = nullptr;
+		bytecode_valid = false;
 		return ERR_INVALID_PARAMETER;
 	}
 
+	_compile_bytecode();
+
 	return OK;
 }
 
-Variant Expression::execute(Array p_inputs, Object *p_base, bool p_show_error) {
+bool Expression::_execute_expression(const Array &p_inputs, Object *p_base, bool p_use_bytecode, Variant &r_ret, String &r_error_str) {
+	if (p_use_bytecode && bytecode_valid && max_input_index < p_inputs.size() && (p_base || !uses_self)) {
+		return _execute_bytecode(p_inputs, p_base, r_ret, r_error_str);
+	}
+	// Also reports missing inputs or instance, the node tree finds the same errors in order.
+	return _execute(p_inputs, p_base, root, r_ret, r_error_str);
+}
+
+Variant Expression::_execute_and_record(const Array &p_inputs, Object *p_base, bool p_show_error, bool p_use_bytecode) {
 	ERR_FAIL_COND_V_MSG(error_set, Variant(), "There was previously a parse error: " + error_str + ".");
 
-	execution_error = false;
 	Variant output;
 	String error_txt;
-	bool err = _execute(p_inputs, p_base, root, output, error_txt);
-	if (err) {
-		execution_error = true;
+	execution_error = _execute_expression(p_inputs, p_base, p_use_bytecode, output, error_txt);
+	if (execution_error) {
 		error_str = error_txt;
 		ERR_FAIL_COND_V_MSG(p_show_error, Variant(), error_str);
 	}
@@ -1424,6 +1975,19 @@ Variant Expression::execute(Array p_inputs, Object *p_base, bool p_show_error) {
 	return output;
 }
 
+Variant Expression::execute(Array p_inputs, Object *p_base, bool p_show_error) {
+	return _execute_and_record(p_inputs, p_base, p_show_error, true);
+}
+
+Variant Expression::execute_node_tree(Array p_inputs, Object *p_base, bool p_show_error) {
+	return _execute_and_record(p_inputs, p_base, p_show_error, false);
+}
+
+bool Expression::try_execute(const Array &p_inputs, Object *p_base, Variant &r_ret, String &r_error_str) {
+	ERR_FAIL_COND_V_MSG(error_set, false, "There was previously a parse error: " + error_str + ".");
+	return !_execute_expression(p_inputs, p_base, true, r_ret, r_error_str);
+}
+
 bool Expression::has_execute_failed() const {
 	return execution_error;
 }
@@ -1443,4 +2007,5 @@ Expression::~Expression() {
 	if (nodes) {
 		memdelete(nodes);
 	}
+	_clear_operator_caches();
 }
@@ -32,6 +32,10 @@
 #define EXPRESSION_H
 
 #include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+
+#include <atomic>
 
 class Expression : public RefCounted {
 	GDCLASS(Expression, RefCounted);
@@ -258,12 +262,84 @@ private:
 	bool execution_error = false;
 	bool _execute(const Array &p_inputs, Object *p_instance, Expression::ENode *p_node, Variant &r_ret, String &r_error_str);
 
+	// The node tree is compiled to a linear byte code after parsing, which is what
+	// execute() runs. Each node writes its own temporary, nodes with constant
+	// operands are folded into constants. Operands are addresses made of a kind
+	// and an index. The tree walker above is kept to report input and self errors
+	// exactly as before, since those are checked before running the byte code.
+	enum Opcode {
+		OPCODE_OPERATOR, // op, a, b, dst, cache.
+		OPCODE_INDEX, // base, index, dst.
+		OPCODE_NAMED_INDEX, // base, name, dst.
+		OPCODE_ARRAY, // count, elements..., dst.
+		OPCODE_DICTIONARY, // count, keys and values..., dst.
+		OPCODE_CONSTRUCT, // type, argc, args..., dst.
+		OPCODE_CALL_BUILTIN, // name, argc, args..., dst.
+		OPCODE_CALL, // base, name, argc, args..., dst.
+	};
+
+	enum {
+		ADDR_BITS = 24,
+		ADDR_MASK = (1 << ADDR_BITS) - 1,
+		ADDR_TEMPORARY = 0,
+		ADDR_CONSTANT = 1,
+		ADDR_INPUT = 2,
+		ADDR_SELF = 3,
+		MAX_TEMPORARIES = 1024,
+	};
+
+	// Operators are evaluated with the validated evaluator of the last operand types.
+	// Entries are immutable and published with a single pointer store, so threads
+	// executing the same expression never see a partially updated one. They are
+	// kept until the expression is parsed again or freed, and shared by all the
+	// operators with the same types.
+	struct OperatorCache {
+		Variant::Operator op = Variant::OP_MAX;
+		Variant::Type left = Variant::VARIANT_MAX;
+		Variant::Type right = Variant::VARIANT_MAX;
+		Variant::Type result = Variant::NIL;
+		Variant::ValidatedOperatorEvaluator evaluator = nullptr;
+	};
+
+	LocalVector<int> code;
+	LocalVector<Variant> constants;
+	LocalVector<StringName> names;
+	LocalVector<std::atomic<const OperatorCache *>> operator_caches;
+	LocalVector<OperatorCache *> operator_cache_entries;
+	BinaryMutex operator_cache_mutex;
+	int operator_cache_count = 0;
+	int temporary_count = 0;
+	int max_argument_count = 0;
+	int max_input_index = -1;
+	bool uses_self = false;
+	bool bytecode_valid = false;
+	int result_address = 0;
+
+	int _add_constant(const Variant &p_value);
+	int _add_name(const StringName &p_name);
+	int _alloc_temporary();
+	bool _compile_arguments(const Vector<ENode *> &p_arguments, Vector<int> &r_addresses, bool &r_constant);
+	int _compile_node(const ENode *p_node, bool &r_constant);
+	void _compile_bytecode();
+	void _clear_operator_caches();
+	void _update_operator_cache(int p_cache, Variant::Operator p_op, Variant::Type p_left, Variant::Type p_right);
+	bool _execute_bytecode(const Array &p_inputs, Object *p_instance, Variant &r_ret, String &r_error_str);
+	bool _execute_expression(const Array &p_inputs, Object *p_base, bool p_use_bytecode, Variant &r_ret, String &r_error_str);
+	Variant _execute_and_record(const Array &p_inputs, Object *p_base, bool p_show_error, bool p_use_bytecode);
+
 protected:
 	static void _bind_methods();
 
 public:
 	Error parse(const String &p_expression, const Vector<String> &p_input_names = Vector<String>());
 	Variant execute(Array p_inputs = Array(), Object *p_base = nullptr, bool p_show_error = true);
+	// Walks the parsed node tree instead of running the byte code. It is slower, and
+	// serves as the reference the byte code is checked against.
+	Variant execute_node_tree(Array p_inputs = Array(), Object *p_base = nullptr, bool p_show_error = true);
+	// execute() records its error for has_execute_failed() and get_error_text(), so
+	// it must only run on one thread at a time. This returns the error instead,
+	// several threads can run the same expression with it.
+	bool try_execute(const Array &p_inputs, Object *p_base, Variant &r_ret, String &r_error_str);
 	bool has_execute_failed() const;
 	String get_error_text() const;
 
@@ -544,6 +544,21 @@ Object *ClassDB::instantiate(const StringName &p_class) {
 	return ti->creation_func();
 }
 
+ClassDB::CreationFunc ClassDB::get_creation_func(const StringName &p_class) {
+	OBJTYPE_RLOCK;
+
+	ClassInfo *ti = classes.getptr(p_class);
+	if (!ti || ti->disabled || ti->native_extension) {
+		return nullptr; // Left to instantiate().
+	}
+#ifdef TOOLS_ENABLED
+	if (ti->api == API_EDITOR && !Engine::get_singleton()->is_editor_hint()) {
+		return nullptr;
+	}
+#endif
+	return ti->creation_func;
+}
+
 bool ClassDB::can_instantiate(const StringName &p_class) {
 	OBJTYPE_RLOCK;
 
@@ -1123,45 +1138,64 @@ bool ClassDB::set_property(Object *p_object, const StringName &p_property, const
 	while (check) {
 		const PropertySetGet *psg = check->property_setget.getptr(p_property);
 		if (psg) {
-			if (!psg->setter) {
-				if (r_valid) {
-					*r_valid = false;
-				}
-				return true; //return true but do nothing
-			}
-
-			Callable::CallError ce;
+			set_property_setget(p_object, psg, p_value, r_valid);
+			return true;
+		}
 
-			if (psg->index >= 0) {
-				Variant index = psg->index;
-				const Variant *arg[2] = { &index, &p_value };
-				//p_object->call(psg->setter,arg,2,ce);
-				if (psg->_setptr) {
-					psg->_setptr->call(p_object, arg, 2, ce);
-				} else {
-					p_object->call(psg->setter, arg, 2, ce);
-				}
+		check = check->inherits_ptr;
+	}
 
-			} else {
-				const Variant *arg[1] = { &p_value };
-				if (psg->_setptr) {
-					psg->_setptr->call(p_object, arg, 1, ce);
-				} else {
-					p_object->call(psg->setter, arg, 1, ce);
-				}
-			}
+	return false;
+}
 
-			if (r_valid) {
-				*r_valid = ce.error == Callable::CallError::CALL_OK;
-			}
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
+	OBJTYPE_RLOCK;
 
-			return true;
+	ClassInfo *check = classes.getptr(p_class);
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+			return psg;
 		}
 
 		check = check->inherits_ptr;
 	}
 
-	return false;
+	return nullptr;
+}
+
+void ClassDB::set_property_setget(Object *p_object, const PropertySetGet *p_setget, const Variant &p_value, bool *r_valid) {
+	if (!p_setget->setter) {
+		if (r_valid) {
+			*r_valid = false;
+		}
+		return; //do nothing
+	}
+
+	Callable::CallError ce;
+
+	if (p_setget->index >= 0) {
+		Variant index = p_setget->index;
+		const Variant *arg[2] = { &index, &p_value };
+		//p_object->call(psg->setter,arg,2,ce);
+		if (p_setget->_setptr) {
+			p_setget->_setptr->call(p_object, arg, 2, ce);
+		} else {
+			p_object->call(p_setget->setter, arg, 2, ce);
+		}
+
+	} else {
+		const Variant *arg[1] = { &p_value };
+		if (p_setget->_setptr) {
+			p_setget->_setptr->call(p_object, arg, 1, ce);
+		} else {
+			p_object->call(p_setget->setter, arg, 1, ce);
+		}
+	}
+
+	if (r_valid) {
+		*r_valid = ce.error == Callable::CallError::CALL_OK;
+	}
 }
 
 bool ClassDB::get_property(Object *p_object, const StringName &p_property, Variant &r_value) {
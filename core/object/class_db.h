@@ -233,6 +233,11 @@ public:
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
 	static bool can_instantiate(const StringName &p_class);
 	static Object *instantiate(const StringName &p_class);
+
+	// For callers creating many objects of the same class, like SceneState. Only
+	// core classes resolve, extension classes may be unloaded while in use.
+	typedef Object *(*CreationFunc)();
+	static CreationFunc get_creation_func(const StringName &p_class);
 	static void instance_get_native_extension_data(ObjectNativeExtension **r_extension, GDExtensionClassInstancePtr *r_extension_instance);
 
 	static APIType get_api_type(const StringName &p_class);
@@ -357,6 +362,8 @@ public:
 	static void get_property_list(const StringName &p_class, List<PropertyInfo> *p_list, bool p_no_inheritance = false, const Object *p_validator = nullptr);
 	static bool get_property_info(const StringName &p_class, const StringName &p_property, PropertyInfo *r_info, bool p_no_inheritance = false, const Object *p_validator = nullptr);
 	static bool set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid = nullptr);
+	static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
+	static void set_property_setget(Object *p_object, const PropertySetGet *p_setget, const Variant &p_value, bool *r_valid = nullptr);
 	static bool get_property(Object *p_object, const StringName &p_property, Variant &r_value);
 	static bool has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance = false);
 	static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
@@ -35,11 +35,106 @@
 #include "core/object/script_language.h"
 
 MessageQueue *MessageQueue::singleton = nullptr;
+thread_local MessageQueue::ThreadBufferRef MessageQueue::thread_buffer;
 
 MessageQueue *MessageQueue::get_singleton() {
 	return singleton;
 }
 
+MessageQueue::ThreadBufferRef::~ThreadBufferRef() {
+	if (buffer && buffer->refcount.unref()) {
+		_free_pages(buffer);
+		memdelete(buffer);
+	}
+}
+
+MessageQueue::Page *MessageQueue::_alloc_page(uint32_t p_size) {
+	Page *page = memnew_placement(memalloc(sizeof(Page) + p_size), Page);
+	page->next.store(nullptr, std::memory_order_relaxed);
+	page->committed.store(0, std::memory_order_relaxed);
+	page->size = p_size;
+	return page;
+}
+
+uint32_t MessageQueue::_get_message_size(const Message *p_message) {
+	uint32_t size = sizeof(Message);
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		size += sizeof(Variant) * p_message->args;
+	}
+	return size;
+}
+
+void MessageQueue::_destroy_message(Message *p_message) {
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
+	p_message->~Message();
+}
+
+// Must only be called once the owner thread can't push to the buffer anymore, pending messages are discarded.
+void MessageQueue::_free_pages(ThreadBuffer *p_buffer) {
+	Page *page = p_buffer->read_page;
+	while (page) {
+		uint32_t committed = page->committed.load(std::memory_order_acquire);
+		while (page->read < committed) {
+			Message *message = (Message *)(page->data() + page->read);
+			page->read += _get_message_size(message);
+			_destroy_message(message);
+		}
+		Page *next = page->next.load(std::memory_order_acquire);
+		page->~Page();
+		memfree(page);
+		page = next;
+	}
+	p_buffer->read_page = nullptr;
+	p_buffer->write_page = nullptr;
+}
+
+MessageQueue::ThreadBuffer *MessageQueue::_get_thread_buffer() {
+	ThreadBuffer *tb = thread_buffer.buffer;
+	if (likely(tb && !tb->queue_released.load(std::memory_order_acquire))) {
+		return tb;
+	}
+
+	if (tb && tb->refcount.unref()) {
+		// Left over by a previous queue, which already released the pages.
+		memdelete(tb);
+	}
+
+	tb = memnew(ThreadBuffer);
+	tb->refcount.init(2);
+	tb->queue_released.store(false);
+	tb->write_page = _alloc_page(page_size);
+	tb->read_page = tb->write_page;
+
+	buffers_mutex.lock();
+	buffers.push_back(tb);
+	buffers_mutex.unlock();
+
+	thread_buffer.buffer = tb;
+	return tb;
+}
+
+MessageQueue::Message *MessageQueue::_alloc_message(int p_argcount) {
+	ThreadBuffer *tb = _get_thread_buffer();
+
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	if (tb->write_pos + room_needed > tb->write_page->size) {
+		// The flushing thread only moves to the next page once this one is sealed by linking it.
+		Page *page = _alloc_page(MAX(page_size, room_needed));
+		tb->write_page->next.store(page, std::memory_order_release);
+		tb->write_page = page;
+		tb->write_pos = 0;
+	}
+
+	Message *msg = memnew_placement(tb->write_page->data() + tb->write_pos, Message);
+	tb->write_pos += room_needed;
+	return msg;
+}
+
 Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
 	return push_callable(Callable(p_id, p_method), p_args, p_argcount, p_show_error);
 }
@@ -60,56 +155,29 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 }
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
-	_THREAD_SAFE_METHOD_
-
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id)) {
-			type = ObjectDB::get_instance(p_id)->get_class();
-		}
-		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
-
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = _alloc_message(1);
 	msg->args = 1;
 	msg->callable = Callable(p_id, p_prop);
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
-
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
+	Variant *v = memnew_placement(msg + 1, Variant);
 	*v = p_value;
 
+	_commit_message();
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
-
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = _alloc_message(0);
 
 	msg->type = TYPE_NOTIFICATION;
 	msg->callable = Callable(p_id, CoreStringNames::get_singleton()->notification); //name is meaningless but callable needs it
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
-
+	_commit_message();
 	return OK;
 }
 
@@ -126,17 +194,7 @@ Error MessageQueue::push_set(Object *p_object, const StringName &p_prop, const V
 }
 
 Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error) {
-	_THREAD_SAFE_METHOD_
-
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed method: " + p_callable);
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
-
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = _alloc_message(p_argcount);
 	msg->args = p_argcount;
 	msg->callable = p_callable;
 	msg->type = TYPE_CALL;
@@ -144,14 +202,13 @@ Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_
 		msg->type |= FLAG_SHOW_ERROR;
 	}
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
+		Variant *v = memnew_placement(&args[i], Variant);
 		*v = *p_args[i];
 	}
 
+	_commit_message();
 	return OK;
 }
 
@@ -175,56 +232,66 @@ void MessageQueue::statistics() {
 	Map<int, int> notify_count;
 	Map<Callable, int> call_count;
 	int null_count = 0;
+	uint32_t total_bytes = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	bool expected = false;
+	ERR_FAIL_COND_MSG(!flushing.compare_exchange_strong(expected, true), "Can't gather statistics while flushing.");
 
-		Object *target = message->callable.get_object();
+	buffers_mutex.lock();
+	for (uint32_t i = 0; i < buffers.size(); i++) {
+		for (Page *page = buffers[i]->read_page; page; page = page->next.load(std::memory_order_acquire)) {
+			uint32_t read_pos = page->read;
+			uint32_t committed = page->committed.load(std::memory_order_acquire);
+			while (read_pos < committed) {
+				Message *message = (Message *)(page->data() + read_pos);
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					if (!call_count.has(message->callable)) {
-						call_count[message->callable] = 0;
-					}
+				Object *target = message->callable.get_object();
 
-					call_count[message->callable]++;
+				if (target != nullptr) {
+					switch (message->type & FLAG_MASK) {
+						case TYPE_CALL: {
+							if (!call_count.has(message->callable)) {
+								call_count[message->callable] = 0;
+							}
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					if (!notify_count.has(message->notification)) {
-						notify_count[message->notification] = 0;
-					}
+							call_count[message->callable]++;
 
-					notify_count[message->notification]++;
+						} break;
+						case TYPE_NOTIFICATION: {
+							if (!notify_count.has(message->notification)) {
+								notify_count[message->notification] = 0;
+							}
 
-				} break;
-				case TYPE_SET: {
-					StringName t = message->callable.get_method();
-					if (!set_count.has(t)) {
-						set_count[t] = 0;
-					}
+							notify_count[message->notification]++;
 
-					set_count[t]++;
+						} break;
+						case TYPE_SET: {
+							StringName t = message->callable.get_method();
+							if (!set_count.has(t)) {
+								set_count[t] = 0;
+							}
 
-				} break;
-			}
+							set_count[t]++;
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+						} break;
+					}
 
-			null_count++;
-		}
+				} else {
+					//object was deleted
+					print_line("Object was deleted while awaiting a callback");
+
+					null_count++;
+				}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
+				read_pos += _get_message_size(message);
+				total_bytes += _get_message_size(message);
+			}
 		}
 	}
+	buffers_mutex.unlock();
+	flushing.store(false);
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	print_line("TOTAL BYTES: " + itos(total_bytes));
 	print_line("NULL count: " + itos(null_count));
 
 	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
@@ -261,114 +328,149 @@ void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_a
 	}
 }
 
-void MessageQueue::flush() {
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
-	}
-
-	uint32_t read_pos = 0;
+uint32_t MessageQueue::_flush_buffer(ThreadBuffer *p_buffer) {
+	uint32_t flushed = 0;
+	Page *page = p_buffer->read_page;
 
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
+	while (true) {
+		if (page->read < page->committed.load(std::memory_order_acquire)) {
+			Message *message = (Message *)(page->data() + page->read);
 
-	if (flushing) {
-		_THREAD_SAFE_UNLOCK_
-		ERR_FAIL_COND(flushing); //already flushing, you did something odd
-	}
-	flushing = true;
+			//pre-advance so this function is reentrant, a call can re-add itself to the message queue
+			uint32_t advance = _get_message_size(message);
+			page->read += advance;
+			flushed += advance;
 
-	while (read_pos < buffer_end) {
-		//lock on each iteration, so a call can re-add itself to the message queue
+			Object *target = message->callable.get_object();
 
-		Message *message = (Message *)&buffer[read_pos];
+			if (target != nullptr) {
+				switch (message->type & FLAG_MASK) {
+					case TYPE_CALL: {
+						Variant *args = (Variant *)(message + 1);
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			advance += sizeof(Variant) * message->args;
-		}
+						// messages don't expect a return value
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+						_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
 
-		_THREAD_SAFE_UNLOCK_
+					} break;
+					case TYPE_NOTIFICATION: {
+						// messages don't expect a return value
+						target->notification(message->notification);
 
-		Object *target = message->callable.get_object();
+					} break;
+					case TYPE_SET: {
+						Variant *arg = (Variant *)(message + 1);
+						// messages don't expect a return value
+						target->set(message->callable.get_method(), *arg);
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					Variant *args = (Variant *)(message + 1);
+					} break;
+				}
+			}
 
-					// messages don't expect a return value
+			_destroy_message(message);
+			continue;
+		}
 
-					_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
+		Page *next = page->next.load(std::memory_order_acquire);
+		if (!next) {
+			break;
+		}
+		// The page is sealed, but messages may have been committed right before that.
+		if (page->read < page->committed.load(std::memory_order_acquire)) {
+			continue;
+		}
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					// messages don't expect a return value
-					target->notification(message->notification);
+		p_buffer->read_page = next;
+		page->~Page();
+		memfree(page);
+		page = next;
+	}
 
-				} break;
-				case TYPE_SET: {
-					Variant *arg = (Variant *)(message + 1);
-					// messages don't expect a return value
-					target->set(message->callable.get_method(), *arg);
+	return flushed;
+}
 
-				} break;
-			}
+void MessageQueue::flush() {
+	bool expected = false;
+	ERR_FAIL_COND_MSG(!flushing.compare_exchange_strong(expected, true), "Already flushing, you did something odd.");
+
+	uint32_t flushed = 0;
+	while (true) {
+		// Buffers may be added while flushing, but only this function removes them.
+		buffers_mutex.lock();
+		flush_buffers.resize(buffers.size());
+		for (uint32_t i = 0; i < buffers.size(); i++) {
+			flush_buffers[i] = buffers[i];
 		}
+		buffers_mutex.unlock();
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
-			}
+		// Keep going until calls stop adding new messages.
+		uint32_t pass_flushed = 0;
+		for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+			pass_flushed += _flush_buffer(flush_buffers[i]);
 		}
+		if (pass_flushed == 0) {
+			break;
+		}
+		flushed += pass_flushed;
+	}
 
-		message->~Message();
+	// Release the buffers of threads that exited.
+	flush_buffers.clear();
+	buffers_mutex.lock();
+	for (uint32_t i = 0; i < buffers.size(); i++) {
+		if (buffers[i]->refcount.get() == 1) {
+			flush_buffers.push_back(buffers[i]);
+			buffers.remove(i);
+			i--;
+		}
+	}
+	buffers_mutex.unlock();
+
+	for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+		ThreadBuffer *tb = flush_buffers[i];
+		// The thread may have pushed more messages after the last pass before
+		// exiting. Nothing can write to the buffer anymore, so this drains it.
+		flushed += _flush_buffer(tb);
+		tb->refcount.unref();
+		_free_pages(tb);
+		memdelete(tb);
+	}
 
-		_THREAD_SAFE_LOCK_
+	if (flushed > buffer_max_used) {
+		buffer_max_used = flushed;
 	}
 
-	buffer_end = 0; // reset buffer
-	flushing = false;
-	_THREAD_SAFE_UNLOCK_
+	flushing.store(false);
 }
 
 bool MessageQueue::is_flushing() const {
-	return flushing;
+	return flushing.load();
 }
 
 MessageQueue::MessageQueue() {
 	ERR_FAIL_COND_MSG(singleton != nullptr, "A MessageQueue singleton already exists.");
 	singleton = this;
 
-	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
-	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater"));
-	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+	flushing.store(false);
+
+	page_size = GLOBAL_DEF_RST("memory/limits/message_queue/page_size_kb", DEFAULT_PAGE_SIZE_KB);
+	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/page_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/page_size_kb", PROPERTY_HINT_RANGE, "4,1024,1,or_greater"));
+	page_size *= 1024;
 }
 
 MessageQueue::~MessageQueue() {
-	uint32_t read_pos = 0;
-
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++) {
-				args[i].~Variant();
-			}
-		}
-		message->~Message();
-
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
+	buffers_mutex.lock();
+	for (uint32_t i = 0; i < buffers.size(); i++) {
+		ThreadBuffer *tb = buffers[i];
+		// Threads still holding the buffer only free it, and allocate a new one if they push again.
+		tb->queue_released.store(true, std::memory_order_release);
+		_free_pages(tb);
+		if (tb->refcount.unref()) {
+			memdelete(tb);
 		}
 	}
+	buffers.clear();
+	buffers_mutex.unlock();
 
 	singleton = nullptr;
-	memdelete_arr(buffer);
 }
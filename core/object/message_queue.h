@@ -27,18 +27,23 @@
 /* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
-
 #ifndef MESSAGE_QUEUE_H
 #define MESSAGE_QUEUE_H
 
 #include "core/object/class_db.h"
-#include "core/os/thread_safe.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
 
-class MessageQueue {
-	_THREAD_SAFE_CLASS_
+#include <atomic>
 
+// Deferred calls are appended to a buffer owned by the pushing thread, so
+// threads never contend with each other when pushing. Buffers are made of
+// pages allocated on demand, and flush() drains every thread buffer (messages
+// from a given thread keep their order).
+class MessageQueue {
 	enum {
-		DEFAULT_QUEUE_SIZE_KB = 4096
+		DEFAULT_PAGE_SIZE_KB = 64
 	};
 
 	enum {
@@ -59,16 +64,54 @@ class MessageQueue {
 		};
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end = 0;
+	struct alignas(16) Page {
+		std::atomic<Page *> next;
+		// Bytes written by the owner thread, published with release semantics.
+		std::atomic<uint32_t> committed;
+		uint32_t read = 0; // Only accessed by the flushing thread.
+		uint32_t size = 0;
+
+		_FORCE_INLINE_ uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+	};
+
+	// Single producer (the owner thread), single consumer (the flushing thread).
+	struct ThreadBuffer {
+		// Held by the queue and by the owner thread, whoever releases last frees it.
+		SafeRefCount refcount;
+		std::atomic<bool> queue_released;
+		Page *write_page = nullptr;
+		uint32_t write_pos = 0;
+		Page *read_page = nullptr;
+	};
+
+	struct ThreadBufferRef {
+		ThreadBuffer *buffer = nullptr;
+		~ThreadBufferRef();
+	};
+
+	static thread_local ThreadBufferRef thread_buffer;
+
+	BinaryMutex buffers_mutex;
+	LocalVector<ThreadBuffer *> buffers;
+	LocalVector<ThreadBuffer *> flush_buffers;
+	uint32_t page_size = 0;
 	uint32_t buffer_max_used = 0;
-	uint32_t buffer_size;
+
+	static Page *_alloc_page(uint32_t p_size);
+	static void _free_pages(ThreadBuffer *p_buffer);
+	static uint32_t _get_message_size(const Message *p_message);
+	static void _destroy_message(Message *p_message);
+
+	ThreadBuffer *_get_thread_buffer();
+	Message *_alloc_message(int p_argcount);
+	_FORCE_INLINE_ void _commit_message() { thread_buffer.buffer->write_page->committed.store(thread_buffer.buffer->write_pos, std::memory_order_release); }
+	uint32_t _flush_buffer(ThreadBuffer *p_buffer);
 
 	void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
 
-	bool flushing = false;
+	std::atomic<bool> flushing;
 
 public:
 	static MessageQueue *get_singleton();
@@ -820,6 +820,21 @@ public:
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
+#ifdef DEBUG_ENABLED
+// Held while calling a method of the object, so it can't be freed meanwhile.
+struct _ObjectDebugLock {
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+#endif
+
 class ObjectDB {
 //this needs to add up to 63, 1 bit is for reference
 #define OBJECTDB_VALIDATOR_BITS 39
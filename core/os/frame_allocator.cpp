@@ -0,0 +1,126 @@
+/*************************************************************************/
+/*  frame_allocator.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "frame_allocator.h"
+
+#include "core/error/error_macros.h"
+
+#include <string.h>
+
+thread_local ArenaAllocator FrameAllocator::arena;
+
+void ArenaAllocator::_add_chunk(size_t p_min_size) {
+	// Reuse the spare chunk if it's large enough, spares are big chunk_size ones in practice.
+	Chunk *chunk = nullptr;
+	if (spare && spare->size >= p_min_size) {
+		chunk = spare;
+		spare = spare->prev;
+	} else {
+		size_t size = MAX(chunk_size, p_min_size);
+		chunk = (Chunk *)memalloc(_align(sizeof(Chunk)) + size);
+		CRASH_COND_MSG(!chunk, "Out of memory.");
+		chunk->size = size;
+	}
+
+	chunk->used = 0;
+	chunk->prev = current;
+	current = chunk;
+}
+
+void *ArenaAllocator::realloc(void *p_memory, size_t p_bytes) {
+	if (!p_memory) {
+		return alloc(p_bytes);
+	}
+
+	uint8_t *mem = (uint8_t *)p_memory - _header_size();
+	size_t old_size = ((Header *)mem)->size;
+
+	// Last allocation of the current chunk, can grow or shrink in place.
+	uint8_t *end = _get_chunk_data(current) + current->used;
+	if (mem + _header_size() + _align(old_size) == end) {
+		size_t start = mem - _get_chunk_data(current);
+		size_t needed = _header_size() + _align(p_bytes);
+		if (start + needed <= current->size) {
+			current->used = start + needed;
+			((Header *)mem)->size = p_bytes;
+			return p_memory;
+		}
+	}
+
+	if (p_bytes <= old_size) {
+		((Header *)mem)->size = p_bytes;
+		return p_memory;
+	}
+
+	void *new_memory = alloc(p_bytes);
+	memcpy(new_memory, p_memory, old_size);
+	return new_memory;
+}
+
+ArenaAllocator::Marker ArenaAllocator::get_marker() const {
+	Marker marker;
+	marker.chunk = current;
+	marker.used = current ? current->used : 0;
+	return marker;
+}
+
+void ArenaAllocator::rewind(const Marker &p_marker) {
+	while (current != p_marker.chunk) {
+		ERR_FAIL_COND_MSG(!current, "Rewinding to a marker that is not part of this arena.");
+		Chunk *chunk = current;
+		current = chunk->prev;
+		chunk->prev = spare;
+		spare = chunk;
+	}
+	if (current) {
+		current->used = p_marker.used;
+	}
+}
+
+void ArenaAllocator::reset() {
+	rewind(Marker());
+}
+
+size_t ArenaAllocator::get_used() const {
+	size_t used = 0;
+	for (Chunk *chunk = current; chunk; chunk = chunk->prev) {
+		used += chunk->used;
+	}
+	return used;
+}
+
+ArenaAllocator::~ArenaAllocator() {
+	reset();
+	while (spare) {
+		Chunk *chunk = spare;
+		spare = chunk->prev;
+		memfree(chunk);
+	}
+}
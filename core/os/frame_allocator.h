@@ -0,0 +1,126 @@
+/*************************************************************************/
+/*  frame_allocator.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FRAME_ALLOCATOR_H
+#define FRAME_ALLOCATOR_H
+
+#include "core/os/memory.h"
+
+// Bump allocator for transient data. Individual allocations are never freed,
+// the arena is rewound to a marker (or reset) instead, which releases all the
+// allocations made since then at once. Chunks are kept for reuse.
+class ArenaAllocator {
+	struct Chunk {
+		Chunk *prev = nullptr;
+		size_t size = 0;
+		size_t used = 0;
+	};
+
+	// Stored before each allocation, so it can be reallocated.
+	struct Header {
+		size_t size;
+	};
+
+	enum {
+		ALIGN = 16,
+		DEFAULT_CHUNK_SIZE = 64 * 1024,
+	};
+
+	Chunk *current = nullptr;
+	Chunk *spare = nullptr;
+	size_t chunk_size = DEFAULT_CHUNK_SIZE;
+
+	static _FORCE_INLINE_ size_t _align(size_t p_size) { return (p_size + ALIGN - 1) & ~size_t(ALIGN - 1); }
+	static _FORCE_INLINE_ size_t _header_size() { return _align(sizeof(Header)); }
+	static _FORCE_INLINE_ uint8_t *_get_chunk_data(Chunk *p_chunk) { return (uint8_t *)p_chunk + _align(sizeof(Chunk)); }
+
+	void _add_chunk(size_t p_min_size);
+
+public:
+	struct Marker {
+		Chunk *chunk = nullptr;
+		size_t used = 0;
+	};
+
+	_FORCE_INLINE_ void *alloc(size_t p_bytes) {
+		size_t needed = _header_size() + _align(p_bytes);
+		if (unlikely(!current || current->used + needed > current->size)) {
+			_add_chunk(needed);
+		}
+		uint8_t *mem = _get_chunk_data(current) + current->used;
+		current->used += needed;
+		((Header *)mem)->size = p_bytes;
+		return mem + _header_size();
+	}
+
+	// Grows in place when p_memory is the last allocation and it fits.
+	void *realloc(void *p_memory, size_t p_bytes);
+
+	Marker get_marker() const;
+	void rewind(const Marker &p_marker);
+	void reset();
+
+	size_t get_used() const;
+	void set_chunk_size(size_t p_size) { chunk_size = p_size; }
+
+	ArenaAllocator() {}
+	~ArenaAllocator();
+};
+
+// Per-thread arena, meant to be used inside a FrameAllocatorScope (typically
+// wrapping a frame of some subsystem). Memory is valid until the scope that
+// contains the allocation ends, on the thread that made the allocation.
+//
+// Can be used as the allocator of LocalVector and HashMap for temporaries that
+// would otherwise go through malloc every frame.
+class FrameAllocator {
+	static thread_local ArenaAllocator arena;
+
+public:
+	_FORCE_INLINE_ static void *alloc(size_t p_bytes) { return arena.alloc(p_bytes); }
+	_FORCE_INLINE_ static void *realloc(void *p_memory, size_t p_bytes) { return arena.realloc(p_memory, p_bytes); }
+	_FORCE_INLINE_ static void free(void *p_memory) {} // Released when the scope ends.
+
+	static ArenaAllocator &get_thread_arena() { return arena; }
+};
+
+class FrameAllocatorScope {
+	ArenaAllocator::Marker marker;
+
+public:
+	_FORCE_INLINE_ FrameAllocatorScope() {
+		marker = FrameAllocator::get_thread_arena().get_marker();
+	}
+	_FORCE_INLINE_ ~FrameAllocatorScope() {
+		FrameAllocator::get_thread_arena().rewind(marker);
+	}
+};
+
+#endif // FRAME_ALLOCATOR_H
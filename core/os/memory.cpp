@@ -33,6 +33,7 @@
 #include "core/error/error_macros.h"
 #include "core/templates/safe_refcount.h"
 
+#include <atomic>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -65,6 +66,36 @@ SafeNumeric<uint64_t> Memory::max_usage;
 
 SafeNumeric<uint64_t> Memory::alloc_count;
 
+#ifdef DEBUG_ENABLED
+// The tag is kept in the upper bits of the size word in the allocation header.
+#define TAG_SHIFT 56
+#define TAG_SIZE_MASK ((uint64_t(1) << TAG_SHIFT) - 1)
+
+static SafeNumeric<uint64_t> tag_usage[Memory::TAG_MAX];
+static SafeNumeric<uint64_t> tag_alloc_count[Memory::TAG_MAX];
+static thread_local Memory::Tag current_tag = Memory::TAG_DEFAULT;
+
+static std::atomic<Memory::AllocationSampleFunc> sample_func;
+static std::atomic<uint32_t> sample_interval;
+static thread_local uint32_t sample_countdown = 0;
+static thread_local bool sampling = false;
+
+static _FORCE_INLINE_ void _sample_allocation(size_t p_bytes, Memory::Tag p_tag) {
+	Memory::AllocationSampleFunc func = sample_func.load(std::memory_order_relaxed);
+	if (likely(!func) || sampling) {
+		return;
+	}
+	if (sample_countdown > 0) {
+		sample_countdown--;
+		return;
+	}
+	sample_countdown = sample_interval.load(std::memory_order_relaxed);
+	sampling = true;
+	func(p_bytes, p_tag);
+	sampling = false;
+}
+#endif
+
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 #ifdef DEBUG_ENABLED
 	bool prepad = true;
@@ -85,8 +116,15 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 		uint8_t *s8 = (uint8_t *)mem;
 
 #ifdef DEBUG_ENABLED
+		Tag tag = current_tag;
+		*s |= uint64_t(tag) << TAG_SHIFT;
+		tag_usage[tag].add(p_bytes);
+		tag_alloc_count[tag].increment();
+
 		uint64_t new_mem_usage = mem_usage.add(p_bytes);
 		max_usage.exchange_if_greater(new_mem_usage);
+
+		_sample_allocation(p_bytes, tag);
 #endif
 		return s8 + PAD_ALIGN;
 	} else {
@@ -111,12 +149,21 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 		mem -= PAD_ALIGN;
 		uint64_t *s = (uint64_t *)mem;
 
+		uint64_t header = p_bytes;
+
 #ifdef DEBUG_ENABLED
-		if (p_bytes > *s) {
-			uint64_t new_mem_usage = mem_usage.add(p_bytes - *s);
+		// Reallocations stay accounted to the tag of the original allocation.
+		Tag tag = Tag(*s >> TAG_SHIFT);
+		uint64_t old_bytes = *s & TAG_SIZE_MASK;
+		header |= uint64_t(tag) << TAG_SHIFT;
+		if (p_bytes > old_bytes) {
+			tag_usage[tag].add(p_bytes - old_bytes);
+			uint64_t new_mem_usage = mem_usage.add(p_bytes - old_bytes);
 			max_usage.exchange_if_greater(new_mem_usage);
+			_sample_allocation(p_bytes - old_bytes, tag);
 		} else {
-			mem_usage.sub(*s - p_bytes);
+			tag_usage[tag].sub(old_bytes - p_bytes);
+			mem_usage.sub(old_bytes - p_bytes);
 		}
 #endif
 
@@ -124,14 +171,14 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 			free(mem);
 			return nullptr;
 		} else {
-			*s = p_bytes;
+			*s = header;
 
 			mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
 			ERR_FAIL_COND_V(!mem, nullptr);
 
 			s = (uint64_t *)mem;
 
-			*s = p_bytes;
+			*s = header;
 
 			return mem + PAD_ALIGN;
 		}
@@ -162,7 +209,9 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
 #ifdef DEBUG_ENABLED
 		uint64_t *s = (uint64_t *)mem;
-		mem_usage.sub(*s);
+		uint64_t bytes = *s & TAG_SIZE_MASK;
+		tag_usage[*s >> TAG_SHIFT].sub(bytes);
+		mem_usage.sub(bytes);
 #endif
 
 		free(mem);
@@ -191,6 +240,63 @@ uint64_t Memory::get_mem_max_usage() {
 #endif
 }
 
+Memory::Tag Memory::set_current_tag(Tag p_tag) {
+#ifdef DEBUG_ENABLED
+	Tag previous = current_tag;
+	current_tag = p_tag;
+	return previous;
+#else
+	return TAG_DEFAULT;
+#endif
+}
+
+Memory::Tag Memory::get_current_tag() {
+#ifdef DEBUG_ENABLED
+	return current_tag;
+#else
+	return TAG_DEFAULT;
+#endif
+}
+
+uint64_t Memory::get_tag_usage(Tag p_tag) {
+	ERR_FAIL_INDEX_V(p_tag, TAG_MAX, 0);
+#ifdef DEBUG_ENABLED
+	return tag_usage[p_tag].get();
+#else
+	return 0;
+#endif
+}
+
+uint64_t Memory::get_tag_allocation_count(Tag p_tag) {
+	ERR_FAIL_INDEX_V(p_tag, TAG_MAX, 0);
+#ifdef DEBUG_ENABLED
+	return tag_alloc_count[p_tag].get();
+#else
+	return 0;
+#endif
+}
+
+const char *Memory::get_tag_name(Tag p_tag) {
+	static const char *names[TAG_MAX] = {
+		"default",
+		"variant",
+		"script",
+		"resource",
+		"image",
+		"rendering",
+		"physics",
+	};
+	ERR_FAIL_INDEX_V(p_tag, TAG_MAX, "");
+	return names[p_tag];
+}
+
+void Memory::set_allocation_sampling(AllocationSampleFunc p_func, uint32_t p_interval) {
+#ifdef DEBUG_ENABLED
+	sample_interval.store(p_interval > 0 ? p_interval - 1 : 0);
+	sample_func.store(p_func);
+#endif
+}
+
 _GlobalNil::_GlobalNil() {
 	left = this;
 	right = this;
@@ -50,6 +50,23 @@ class Memory {
 	static SafeNumeric<uint64_t> alloc_count;
 
 public:
+	// Allocations are accounted to the tag active on the allocating thread
+	// (see MemoryTagScope). Only tracked in debug builds, where allocations
+	// have a header to remember their size and tag.
+	enum Tag {
+		TAG_DEFAULT,
+		TAG_VARIANT, // Array and Dictionary storage.
+		TAG_SCRIPT,
+		TAG_RESOURCE, // Resource loading.
+		TAG_IMAGE,
+		TAG_RENDERING,
+		TAG_PHYSICS,
+		TAG_MAX
+	};
+
+	// Called on the allocating thread, allocations made from it are not sampled.
+	typedef void (*AllocationSampleFunc)(size_t p_bytes, Tag p_tag);
+
 	static void *alloc_static(size_t p_bytes, bool p_pad_align = false);
 	static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false);
 	static void free_static(void *p_ptr, bool p_pad_align = false);
@@ -57,11 +74,34 @@ public:
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+
+	static Tag set_current_tag(Tag p_tag); // Returns the previous one.
+	static Tag get_current_tag();
+	static uint64_t get_tag_usage(Tag p_tag);
+	static uint64_t get_tag_allocation_count(Tag p_tag); // Total since startup, to derive rates.
+	static const char *get_tag_name(Tag p_tag);
+
+	// Reports one out of every p_interval allocations (per thread) to p_func, pass nullptr to disable.
+	static void set_allocation_sampling(AllocationSampleFunc p_func, uint32_t p_interval);
+};
+
+class MemoryTagScope {
+#ifdef DEBUG_ENABLED
+	Memory::Tag previous;
+
+public:
+	_FORCE_INLINE_ MemoryTagScope(Memory::Tag p_tag) { previous = Memory::set_current_tag(p_tag); }
+	_FORCE_INLINE_ ~MemoryTagScope() { Memory::set_current_tag(previous); }
+#else
+public:
+	_FORCE_INLINE_ MemoryTagScope(Memory::Tag p_tag) {}
+#endif
 };
 
 class DefaultAllocator {
 public:
 	_FORCE_INLINE_ static void *alloc(size_t p_memory) { return Memory::alloc_static(p_memory, false); }
+	_FORCE_INLINE_ static void *realloc(void *p_ptr, size_t p_memory) { return Memory::realloc_static(p_ptr, p_memory, false); }
 	_FORCE_INLINE_ static void free(void *p_ptr) { Memory::free_static(p_ptr, false); }
 };
 
@@ -81,6 +121,7 @@ void operator delete(void *p_mem, void *p_pointer, size_t check, const char *p_d
 #define memalloc(m_size) Memory::alloc_static(m_size)
 #define memrealloc(m_mem, m_size) Memory::realloc_static(m_mem, m_size)
 #define memfree(m_mem) Memory::free_static(m_mem)
+#define memalloc_tagged(m_tag, m_size) (MemoryTagScope(m_tag), Memory::alloc_static(m_size))
 
 _ALWAYS_INLINE_ void postinitialize_handler(void *) {}
 
@@ -102,6 +143,9 @@ _ALWAYS_INLINE_ void *operator new(size_t p_size, void *p_pointer, size_t check,
 #define memnew_allocator(m_class, m_allocator) _post_initialize(new (m_allocator::alloc) m_class)
 #define memnew_placement(m_placement, m_class) _post_initialize(new (m_placement, sizeof(m_class), "") m_class)
 
+// Accounts the allocation (and those made by the constructor) to m_tag.
+#define memnew_tagged(m_tag, m_class) (MemoryTagScope(m_tag), memnew(m_class))
+
 _ALWAYS_INLINE_ bool predelete_handler(void *) {
 	return true;
 }
@@ -228,6 +228,10 @@ public:
 	virtual bool is_disable_crash_handler() const { return false; }
 	virtual void initialize_debugging() {}
 
+	// Return addresses of the calling thread's stack, innermost first. Must not allocate through Memory.
+	virtual int get_backtrace(void **r_frames, int p_max_frames) const { return 0; }
+	virtual String get_backtrace_symbol(void *p_address) const { return String(); }
+
 	virtual void dump_memory_to_file(const char *p_file);
 	virtual void dump_resources_to_file(const char *p_file);
 	virtual void print_resources_in_use(bool p_short = false);
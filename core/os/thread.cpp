@@ -30,6 +30,7 @@
 
 #include "thread.h"
 
+#include "core/debugger/thread_buffer_registry.h"
 #include "core/object/script_language.h"
 
 #if !defined(NO_THREADS)
@@ -105,6 +106,8 @@ void Thread::wait_to_finish() {
 }
 
 Error Thread::set_name(const String &p_name) {
+	DebugThreadNames::set_thread_name(p_name);
+
 	if (set_name_func) {
 		return set_name_func(p_name);
 	}
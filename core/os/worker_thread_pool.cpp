@@ -0,0 +1,639 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/debugger/trace.h"
+#include "core/os/os.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = nullptr;
+thread_local WorkerThreadPool::ThreadData *WorkerThreadPool::current_thread = nullptr;
+
+/* TASK DEQUE */
+
+void WorkerThreadPool::TaskDeque::push_back(Task *p_task) {
+	MutexLock lock(mutex);
+	if (count == ring.size()) {
+		// Grow, unwrapping the ring so head is at zero again.
+		uint32_t old_size = ring.size();
+		LocalVector<Task *> new_ring;
+		new_ring.resize(MAX(old_size * 2, 16u));
+		for (uint32_t i = 0; i < count; i++) {
+			new_ring[i] = ring[(head + i) % old_size];
+		}
+		ring = new_ring;
+		head = 0;
+	}
+	ring[(head + count) % ring.size()] = p_task;
+	count++;
+}
+
+void WorkerThreadPool::TaskDeque::push_front(Task *p_task) {
+	MutexLock lock(mutex);
+	if (count == ring.size()) {
+		uint32_t old_size = ring.size();
+		LocalVector<Task *> new_ring;
+		new_ring.resize(MAX(old_size * 2, 16u));
+		for (uint32_t i = 0; i < count; i++) {
+			new_ring[i] = ring[(head + i) % old_size];
+		}
+		ring = new_ring;
+		head = 0;
+	}
+	head = (head + ring.size() - 1) % ring.size();
+	ring[head] = p_task;
+	count++;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop_back() {
+	MutexLock lock(mutex);
+	if (count == 0) {
+		return nullptr;
+	}
+	count--;
+	return ring[(head + count) % ring.size()];
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop_front() {
+	MutexLock lock(mutex);
+	if (count == 0) {
+		return nullptr;
+	}
+	Task *task = ring[head];
+	head = (head + 1) % ring.size();
+	count--;
+	return task;
+}
+
+/* WORKERS */
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+	ThreadData *thread = static_cast<ThreadData *>(p_user);
+	current_thread = thread;
+	Thread::set_name("WorkerThread " + itos(thread->index));
+
+	while (!singleton->exit_threads.load()) {
+		uint64_t epoch = singleton->enqueue_epoch.load();
+		Task *task = singleton->_claim_task(thread);
+		if (task) {
+			singleton->_run_task(task);
+			continue;
+		}
+		singleton->_sleep_worker(thread, epoch);
+	}
+
+	current_thread = nullptr;
+}
+
+void WorkerThreadPool::_wake_one() {
+	idle_mutex.lock();
+	if (idle_threads.size() == 0) {
+		idle_mutex.unlock();
+		return;
+	}
+	ThreadData *thread = idle_threads[idle_threads.size() - 1];
+	idle_threads.resize(idle_threads.size() - 1);
+	thread->idle = false;
+	idle_mutex.unlock();
+
+	thread->wake.post();
+}
+
+void WorkerThreadPool::_sleep_worker(ThreadData *p_thread, uint64_t p_epoch) {
+	idle_mutex.lock();
+	if (enqueue_epoch.load() != p_epoch || exit_threads.load()) {
+		// Something was queued since the caller last looked, don't sleep.
+		idle_mutex.unlock();
+		return;
+	}
+	p_thread->idle = true;
+	idle_threads.push_back(p_thread);
+	idle_mutex.unlock();
+
+	p_thread->wake.wait();
+
+	idle_mutex.lock();
+	if (p_thread->idle) {
+		// Woken by something other than an enqueue (a completion or exit).
+		idle_threads.erase(p_thread);
+		p_thread->idle = false;
+	}
+	idle_mutex.unlock();
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_find_task(ThreadData *p_thread) {
+	Task *task = nullptr;
+	if (p_thread) {
+		task = p_thread->deque.pop_back();
+	}
+	if (!task) {
+		task = injection_queue.pop_front();
+	}
+	if (!task && thread_count > 1) {
+		uint32_t start = p_thread ? p_thread->steal_seed++ : 0;
+		for (uint32_t i = 0; i < thread_count; i++) {
+			ThreadData *victim = &threads[(start + i) % thread_count];
+			if (victim == p_thread) {
+				continue;
+			}
+			task = victim->deque.pop_front();
+			if (task) {
+				break;
+			}
+		}
+	}
+	return task;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_claim_task(ThreadData *p_thread) {
+	while (true) {
+		Task *task = _find_task(p_thread);
+		if (!task) {
+			return nullptr;
+		}
+		uint32_t expected = TASK_STATE_QUEUED;
+		bool claimed = task->state.compare_exchange_strong(expected, TASK_STATE_RUNNING);
+		// The queue entry is gone. If a waiter already claimed and released the
+		// task, this was the last reference and the task is freed here.
+		_unreference_task(task);
+		if (claimed) {
+			return task;
+		}
+	}
+}
+
+/* TASKS */
+
+WorkerThreadPool::Task *WorkerThreadPool::_alloc_task() {
+	MutexLock lock(task_mutex);
+	return task_allocator.alloc();
+}
+
+WorkerThreadPool::Group *WorkerThreadPool::_alloc_group() {
+	MutexLock lock(task_mutex);
+	return group_allocator.alloc();
+}
+
+void WorkerThreadPool::_enqueue(Task *p_task) {
+	p_task->state.store(TASK_STATE_QUEUED);
+
+	if (thread_count == 0) {
+		// No workers (single threaded platform), run synchronously.
+		uint32_t expected = TASK_STATE_QUEUED;
+		if (p_task->state.compare_exchange_strong(expected, TASK_STATE_RUNNING)) {
+			_run_task(p_task);
+		}
+		return;
+	}
+
+	p_task->references.fetch_add(1, std::memory_order_relaxed);
+	if (p_task->high_priority) {
+		injection_queue.push_front(p_task);
+	} else if (current_thread) {
+		current_thread->deque.push_back(p_task);
+	} else {
+		injection_queue.push_back(p_task);
+	}
+
+	enqueue_epoch.fetch_add(1);
+	_wake_one();
+}
+
+void WorkerThreadPool::_run_task(Task *p_task) {
+	TRACE_ZONE("WorkerThreadPool::task");
+	if (p_task->group) {
+		Group *group = p_task->group;
+		_process_group_elements(group);
+		_unreference_task(p_task);
+		_unreference_group(group);
+		return;
+	}
+
+	if (p_task->native_func) {
+		p_task->native_func(p_task->native_func_userdata);
+	} else if (p_task->template_userdata) {
+		p_task->template_userdata->callback();
+	} else {
+		Variant ret;
+		Callable::CallError ce;
+		p_task->callable.call(nullptr, 0, ret, ce);
+		if (ce.error != Callable::CallError::CALL_OK) {
+			ERR_PRINT("Error calling task: " + Variant::get_callable_error_text(p_task->callable, nullptr, 0, ce) + ".");
+		}
+	}
+
+	_finish_task(p_task);
+}
+
+void WorkerThreadPool::_finish_task(Task *p_task) {
+	LocalVector<Task *> ready;
+	ThreadData *waiting_worker = nullptr;
+
+	{
+		// Nothing may touch the task once the lock is released, as the waiter frees it.
+		MutexLock lock(task_mutex);
+		for (uint32_t i = 0; i < p_task->dependents.size(); i++) {
+			Task *dependent = p_task->dependents[i];
+			dependent->pending_dependencies--;
+			if (dependent->pending_dependencies == 0) {
+				ready.push_back(dependent);
+			}
+		}
+		p_task->dependents.clear();
+		waiting_worker = p_task->waiting_worker;
+		p_task->state.store(TASK_STATE_COMPLETED);
+		p_task->done_semaphore.post();
+	}
+
+	if (waiting_worker) {
+		waiting_worker->wake.post();
+	}
+
+	for (uint32_t i = 0; i < ready.size(); i++) {
+		_enqueue(ready[i]);
+	}
+}
+
+void WorkerThreadPool::_process_group_elements(Group *p_group) {
+	while (true) {
+		uint32_t work_index = p_group->index.fetch_add(1, std::memory_order_relaxed);
+		if (work_index >= p_group->max) {
+			break;
+		}
+
+		if (p_group->native_func) {
+			p_group->native_func(p_group->native_func_userdata, work_index);
+		} else if (p_group->template_userdata) {
+			p_group->template_userdata->callback_indexed(work_index);
+		} else {
+			Variant index = work_index;
+			const Variant *args[1] = { &index };
+			Variant ret;
+			Callable::CallError ce;
+			p_group->callable.call(args, 1, ret, ce);
+			if (ce.error != Callable::CallError::CALL_OK) {
+				ERR_PRINT("Error calling group task: " + Variant::get_callable_error_text(p_group->callable, args, 1, ce) + ".");
+			}
+		}
+
+		uint32_t completed = p_group->completed_index.fetch_add(1, std::memory_order_acq_rel) + 1;
+		if (completed == p_group->max) {
+			ThreadData *waiting_worker = nullptr;
+			{
+				MutexLock lock(task_mutex);
+				p_group->completed = true;
+				waiting_worker = p_group->waiting_worker;
+				p_group->done_semaphore.post();
+			}
+			if (waiting_worker) {
+				waiting_worker->wake.post();
+			}
+		}
+	}
+}
+
+void WorkerThreadPool::_unreference_task(Task *p_task) {
+	if (p_task->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+		return;
+	}
+	MutexLock lock(task_mutex);
+	task_allocator.free(p_task);
+}
+
+void WorkerThreadPool::_unreference_group(Group *p_group) {
+	if (p_group->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+		return;
+	}
+	if (p_group->template_userdata) {
+		memdelete(p_group->template_userdata);
+	}
+	p_group->callable = Callable();
+
+	MutexLock lock(task_mutex);
+	group_allocator.free(p_group);
+}
+
+void WorkerThreadPool::_help_while_waiting(Task *p_task, Group *p_group) {
+	// Worker threads never block while there is work they could do, otherwise
+	// tasks waiting on other tasks could deadlock the pool.
+	while (true) {
+		uint64_t epoch = enqueue_epoch.load();
+		{
+			MutexLock lock(task_mutex);
+			bool completed = p_task ? p_task->state.load() == TASK_STATE_COMPLETED : p_group->completed;
+			if (completed) {
+				return;
+			}
+			if (p_task) {
+				p_task->waiting_worker = current_thread;
+			} else {
+				p_group->waiting_worker = current_thread;
+			}
+		}
+
+		if (p_task) {
+			// It may have been queued since (if it had dependencies).
+			uint32_t expected = TASK_STATE_QUEUED;
+			if (p_task->state.compare_exchange_strong(expected, TASK_STATE_RUNNING)) {
+				_run_task(p_task);
+				continue;
+			}
+		}
+
+		Task *task = _claim_task(current_thread);
+		if (task) {
+			_run_task(task);
+			continue;
+		}
+
+		_sleep_worker(current_thread, epoch);
+	}
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::_add_task(Task *p_task, bool p_high_priority, const TaskID *p_dependencies, int p_dependency_count) {
+	p_task->high_priority = p_high_priority;
+
+	task_mutex.lock();
+	TaskID id = last_task++;
+	p_task->self = id;
+	tasks[id] = p_task;
+	for (int i = 0; i < p_dependency_count; i++) {
+		Task **dependency = tasks.getptr(p_dependencies[i]);
+		// Unknown IDs belong to tasks that were already completed and waited on.
+		if (dependency && (*dependency)->state.load() != TASK_STATE_COMPLETED) {
+			(*dependency)->dependents.push_back(p_task);
+			p_task->pending_dependencies++;
+		}
+	}
+	bool ready = p_task->pending_dependencies == 0;
+	task_mutex.unlock();
+
+	if (ready) {
+		_enqueue(p_task);
+	}
+	return id;
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(void (*p_func)(void *), void *p_userdata, bool p_high_priority, const String &p_description, const Vector<TaskID> &p_dependencies) {
+	Task *task = _alloc_task();
+	task->native_func = p_func;
+	task->native_func_userdata = p_userdata;
+	task->description = p_description;
+	return _add_task(task, p_high_priority, p_dependencies.ptr(), p_dependencies.size());
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_task(const Callable &p_action, bool p_high_priority, const String &p_description, const Vector<TaskID> &p_dependencies) {
+	Task *task = _alloc_task();
+	task->callable = p_action;
+	task->description = p_description;
+	return _add_task(task, p_high_priority, p_dependencies.ptr(), p_dependencies.size());
+}
+
+bool WorkerThreadPool::is_task_completed(TaskID p_task_id) const {
+	MutexLock lock(task_mutex);
+	Task *const *task = tasks.getptr(p_task_id);
+	ERR_FAIL_COND_V_MSG(!task, false, "Invalid Task ID.");
+	return (*task)->state.load() == TASK_STATE_COMPLETED;
+}
+
+void WorkerThreadPool::wait_for_task_completion(TaskID p_task_id) {
+	Task *task = nullptr;
+	{
+		MutexLock lock(task_mutex);
+		Task **taskp = tasks.getptr(p_task_id);
+		ERR_FAIL_COND_MSG(!taskp, "Invalid Task ID.");
+		task = *taskp;
+		ERR_FAIL_COND_MSG(task->waiting, "Another thread is waiting on this task.");
+		task->waiting = true;
+	}
+
+	// If nobody started it yet, just run it here.
+	uint32_t expected = TASK_STATE_QUEUED;
+	if (task->state.compare_exchange_strong(expected, TASK_STATE_RUNNING)) {
+		_run_task(task);
+	}
+
+	if (current_thread) {
+		_help_while_waiting(task, nullptr);
+	} else {
+		task->done_semaphore.wait();
+	}
+
+	if (task->template_userdata) {
+		memdelete(task->template_userdata);
+	}
+	// Release references outside of the lock, as that may run arbitrary code.
+	task->callable = Callable();
+
+	{
+		MutexLock lock(task_mutex);
+		tasks.erase(p_task_id);
+	}
+	// A queue may still hold the task if it was claimed here, then the thread popping it frees it.
+	_unreference_task(task);
+}
+
+/* GROUP TASKS */
+
+WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(Group *p_group, int p_elements, int p_tasks, bool p_high_priority, const String &p_description) {
+	if (p_elements < 0) {
+		p_elements = 0;
+	}
+	if (p_tasks < 0) {
+		p_tasks = get_thread_count();
+	}
+	p_tasks = MIN(p_tasks, p_elements);
+
+	p_group->max = p_elements;
+	p_group->references.store(p_tasks + 1);
+	if (p_elements == 0) {
+		p_group->completed = true;
+		p_group->done_semaphore.post();
+	}
+
+	LocalVector<Task *> group_tasks;
+	group_tasks.resize(p_tasks);
+
+	task_mutex.lock();
+	GroupID id = last_group++;
+	p_group->self = id;
+	groups[id] = p_group;
+	for (int i = 0; i < p_tasks; i++) {
+		Task *task = task_allocator.alloc();
+		task->group = p_group;
+		task->description = p_description;
+		task->high_priority = p_high_priority;
+		group_tasks[i] = task;
+	}
+	task_mutex.unlock();
+
+	for (int i = 0; i < p_tasks; i++) {
+		_enqueue(group_tasks[i]);
+	}
+
+	return id;
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::add_native_group_task(void (*p_func)(void *, uint32_t), void *p_userdata, int p_elements, int p_tasks, bool p_high_priority, const String &p_description) {
+	Group *group = _alloc_group();
+	group->native_func = p_func;
+	group->native_func_userdata = p_userdata;
+	return _add_group_task(group, p_elements, p_tasks, p_high_priority, p_description);
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::add_group_task(const Callable &p_action, int p_elements, int p_tasks, bool p_high_priority, const String &p_description) {
+	Group *group = _alloc_group();
+	group->callable = p_action;
+	return _add_group_task(group, p_elements, p_tasks, p_high_priority, p_description);
+}
+
+uint32_t WorkerThreadPool::get_group_processed_element_count(GroupID p_group) const {
+	MutexLock lock(task_mutex);
+	Group *const *group = groups.getptr(p_group);
+	ERR_FAIL_COND_V_MSG(!group, 0, "Invalid Group ID.");
+	return (*group)->completed_index.load();
+}
+
+bool WorkerThreadPool::is_group_task_completed(GroupID p_group) const {
+	MutexLock lock(task_mutex);
+	Group *const *group = groups.getptr(p_group);
+	ERR_FAIL_COND_V_MSG(!group, false, "Invalid Group ID.");
+	return (*group)->completed;
+}
+
+void WorkerThreadPool::wait_for_group_task_completion(GroupID p_group) {
+	Group *group = nullptr;
+	{
+		MutexLock lock(task_mutex);
+		Group **groupp = groups.getptr(p_group);
+		ERR_FAIL_COND_MSG(!groupp, "Invalid Group ID.");
+		group = *groupp;
+		ERR_FAIL_COND_MSG(group->waiting, "Another thread is waiting on this group task.");
+		group->waiting = true;
+	}
+
+	// The waiting thread takes part in the work instead of idling.
+	_process_group_elements(group);
+
+	if (current_thread) {
+		_help_while_waiting(nullptr, group);
+	} else {
+		group->done_semaphore.wait();
+	}
+
+	{
+		MutexLock lock(task_mutex);
+		groups.erase(p_group);
+	}
+	_unreference_group(group);
+}
+
+int WorkerThreadPool::get_thread_index() {
+	return current_thread ? (int)current_thread->index : -1;
+}
+
+/* SETUP */
+
+void WorkerThreadPool::init(int p_thread_count) {
+	ERR_FAIL_COND(threads != nullptr);
+
+#ifdef NO_THREADS
+	p_thread_count = 0;
+#else
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_processor_count();
+	}
+#endif
+
+	thread_count = p_thread_count;
+	if (thread_count == 0) {
+		return;
+	}
+
+	exit_threads.store(false);
+	threads = memnew_arr(ThreadData, thread_count);
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].index = i;
+		threads[i].steal_seed = i + 1;
+		threads[i].thread.start(&WorkerThreadPool::_thread_function, &threads[i]);
+	}
+}
+
+void WorkerThreadPool::finish() {
+	if (threads == nullptr) {
+		return;
+	}
+
+	exit_threads.store(true);
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].wake.post();
+	}
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].thread.wait_to_finish();
+	}
+
+	memdelete_arr(threads);
+	threads = nullptr;
+	thread_count = 0;
+
+	if (tasks.size()) {
+		ERR_PRINT(itos(tasks.size()) + " tasks were never waited on, their resources are leaked.");
+	}
+	if (groups.size()) {
+		ERR_PRINT(itos(groups.size()) + " group tasks were never waited on, their resources are leaked.");
+	}
+}
+
+void WorkerThreadPool::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("add_task", "action", "high_priority", "description", "dependencies"), &WorkerThreadPool::add_task, DEFVAL(false), DEFVAL(String()), DEFVAL(Vector<TaskID>()));
+	ClassDB::bind_method(D_METHOD("is_task_completed", "task_id"), &WorkerThreadPool::is_task_completed);
+	ClassDB::bind_method(D_METHOD("wait_for_task_completion", "task_id"), &WorkerThreadPool::wait_for_task_completion);
+
+	ClassDB::bind_method(D_METHOD("add_group_task", "action", "elements", "tasks_needed", "high_priority", "description"), &WorkerThreadPool::add_group_task, DEFVAL(-1), DEFVAL(false), DEFVAL(String()));
+	ClassDB::bind_method(D_METHOD("is_group_task_completed", "group_id"), &WorkerThreadPool::is_group_task_completed);
+	ClassDB::bind_method(D_METHOD("get_group_processed_element_count", "group_id"), &WorkerThreadPool::get_group_processed_element_count);
+	ClassDB::bind_method(D_METHOD("wait_for_group_task_completion", "group_id"), &WorkerThreadPool::wait_for_group_task_completion);
+
+	ClassDB::bind_method(D_METHOD("get_thread_count"), &WorkerThreadPool::get_thread_count);
+}
+
+WorkerThreadPool::WorkerThreadPool() :
+		task_allocator(1024),
+		group_allocator(256) {
+	singleton = this;
+	exit_threads.store(false);
+	enqueue_epoch.store(0);
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+	finish();
+	singleton = nullptr;
+}
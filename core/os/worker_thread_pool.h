@@ -0,0 +1,293 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/object/class_db.h"
+#include "core/os/memory.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/paged_allocator.h"
+
+#include <atomic>
+
+// Engine-wide job system. A fixed set of worker threads is shared by every
+// subsystem (rendering, physics, resource loading, the editor and scripts),
+// so parallel work composes instead of oversubscribing the CPU.
+//
+// Each worker owns a deque: tasks submitted from a worker go to its own deque
+// (popped LIFO for locality), tasks submitted from other threads go to a
+// shared injection queue, and idle workers steal from the front of other
+// workers' deques. Tasks may depend on other tasks, and group tasks split an
+// index range across several tasks.
+//
+// Every task and group task must be waited on exactly once, this is what
+// releases its resources.
+
+class WorkerThreadPool : public Object {
+	GDCLASS(WorkerThreadPool, Object)
+
+public:
+	typedef int64_t TaskID;
+	typedef int64_t GroupID;
+
+	enum {
+		INVALID_TASK_ID = -1
+	};
+
+private:
+	struct ThreadData;
+
+	struct BaseTemplateUserdata {
+		virtual void callback() {}
+		virtual void callback_indexed(uint32_t p_index) {}
+		virtual ~BaseTemplateUserdata() {}
+	};
+
+	template <class C, class M, class U>
+	struct TaskUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback() override {
+			(instance->*method)(userdata);
+		}
+	};
+
+	template <class C, class M, class U>
+	struct GroupUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback_indexed(uint32_t p_index) override {
+			(instance->*method)(p_index, userdata);
+		}
+	};
+
+	struct Group {
+		GroupID self = INVALID_TASK_ID;
+		std::atomic<uint32_t> index;
+		std::atomic<uint32_t> completed_index;
+		uint32_t max = 0;
+		// Tasks still referencing this group, plus one reference held until it is waited on.
+		std::atomic<uint32_t> references;
+		Semaphore done_semaphore;
+		ThreadData *waiting_worker = nullptr;
+		bool completed = false;
+		bool waiting = false;
+
+		Callable callable;
+		void (*native_func)(void *, uint32_t) = nullptr;
+		void *native_func_userdata = nullptr;
+		BaseTemplateUserdata *template_userdata = nullptr;
+
+		Group() {
+			index.store(0);
+			completed_index.store(0);
+			references.store(0);
+		}
+	};
+
+	enum TaskState {
+		TASK_STATE_PENDING, // Waiting for dependencies.
+		TASK_STATE_QUEUED,
+		TASK_STATE_RUNNING,
+		TASK_STATE_COMPLETED,
+	};
+
+	struct Task {
+		TaskID self = INVALID_TASK_ID;
+		Callable callable;
+		void (*native_func)(void *) = nullptr;
+		void *native_func_userdata = nullptr;
+		BaseTemplateUserdata *template_userdata = nullptr;
+		Group *group = nullptr; // Group tasks have no ID and are never waited on directly.
+		String description;
+		bool high_priority = false;
+		bool waiting = false;
+
+		// State transitions from queued to running are done with a CAS, so a
+		// task can be claimed by a waiter while it still sits in some queue.
+		std::atomic<uint32_t> state;
+		// One reference for the queue entry while the task is queued, plus one
+		// for its owner (the waiter, or the runner for group tasks). The task
+		// is only freed once both are gone, so a stale queue entry never
+		// points to freed or reused memory.
+		std::atomic<uint32_t> references;
+
+		// Protected by task_mutex.
+		uint32_t pending_dependencies = 0;
+		LocalVector<Task *> dependents;
+		ThreadData *waiting_worker = nullptr;
+		Semaphore done_semaphore;
+
+		Task() {
+			state.store(TASK_STATE_PENDING);
+			references.store(1);
+		}
+	};
+
+	// Ring buffer of tasks, both ends are accessible.
+	struct TaskDeque {
+		BinaryMutex mutex;
+		LocalVector<Task *> ring;
+		uint32_t head = 0;
+		uint32_t count = 0;
+
+		void push_back(Task *p_task);
+		void push_front(Task *p_task);
+		Task *pop_back();
+		Task *pop_front();
+	};
+
+	struct ThreadData {
+		uint32_t index = 0;
+		Thread thread;
+		TaskDeque deque;
+		Semaphore wake;
+		bool idle = false; // Protected by idle_mutex.
+		uint32_t steal_seed = 0;
+	};
+
+	static WorkerThreadPool *singleton;
+	static thread_local ThreadData *current_thread;
+
+	ThreadData *threads = nullptr;
+	uint32_t thread_count = 0;
+	std::atomic<bool> exit_threads;
+
+	TaskDeque injection_queue;
+
+	// Bumped on every enqueue, used to avoid lost wake-ups when going idle.
+	std::atomic<uint64_t> enqueue_epoch;
+	BinaryMutex idle_mutex;
+	LocalVector<ThreadData *> idle_threads;
+
+	BinaryMutex task_mutex;
+	PagedAllocator<Task> task_allocator;
+	PagedAllocator<Group> group_allocator;
+	HashMap<TaskID, Task *> tasks;
+	HashMap<GroupID, Group *> groups;
+	TaskID last_task = 1;
+	GroupID last_group = 1;
+
+	static void _thread_function(void *p_user);
+
+	Task *_alloc_task();
+	Group *_alloc_group();
+
+	TaskID _add_task(Task *p_task, bool p_high_priority, const TaskID *p_dependencies, int p_dependency_count);
+	GroupID _add_group_task(Group *p_group, int p_elements, int p_tasks, bool p_high_priority, const String &p_description);
+
+	void _enqueue(Task *p_task);
+	void _wake_one();
+	Task *_find_task(ThreadData *p_thread);
+	Task *_claim_task(ThreadData *p_thread);
+	void _run_task(Task *p_task);
+	void _process_group_elements(Group *p_group);
+	void _finish_task(Task *p_task);
+	void _unreference_task(Task *p_task);
+	void _unreference_group(Group *p_group);
+	void _sleep_worker(ThreadData *p_thread, uint64_t p_epoch);
+	void _help_while_waiting(Task *p_task, Group *p_group);
+
+protected:
+	static void _bind_methods();
+
+public:
+	TaskID add_native_task(void (*p_func)(void *), void *p_userdata, bool p_high_priority = false, const String &p_description = String(), const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+	TaskID add_task(const Callable &p_action, bool p_high_priority = false, const String &p_description = String(), const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+
+	template <class C, class M, class U>
+	TaskID add_template_task(C *p_instance, M p_method, U p_userdata, bool p_high_priority = false, const String &p_description = String(), const Vector<TaskID> &p_dependencies = Vector<TaskID>()) {
+		TaskUserData<C, M, U> *ud = memnew((TaskUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+
+		Task *task = _alloc_task();
+		task->template_userdata = ud;
+		task->description = p_description;
+		return _add_task(task, p_high_priority, p_dependencies.ptr(), p_dependencies.size());
+	}
+
+	bool is_task_completed(TaskID p_task_id) const;
+	void wait_for_task_completion(TaskID p_task_id);
+
+	// Process p_elements indices in parallel, split across p_tasks tasks (one per thread if -1).
+	// The thread waiting for the group helps processing it.
+	GroupID add_native_group_task(void (*p_func)(void *, uint32_t), void *p_userdata, int p_elements, int p_tasks = -1, bool p_high_priority = false, const String &p_description = String());
+	GroupID add_group_task(const Callable &p_action, int p_elements, int p_tasks = -1, bool p_high_priority = false, const String &p_description = String());
+
+	template <class C, class M, class U>
+	GroupID add_template_group_task(C *p_instance, M p_method, U p_userdata, int p_elements, int p_tasks = -1, bool p_high_priority = false, const String &p_description = String()) {
+		GroupUserData<C, M, U> *ud = memnew((GroupUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+
+		Group *group = _alloc_group();
+		group->template_userdata = ud;
+		return _add_group_task(group, p_elements, p_tasks, p_high_priority, p_description);
+	}
+
+	// Blocking helper, processes p_elements indices in parallel and returns once done.
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		if (p_elements == 0) {
+			return;
+		}
+		GroupID group = add_template_group_task(p_instance, p_method, p_userdata, p_elements);
+		wait_for_group_task_completion(group);
+	}
+
+	uint32_t get_group_processed_element_count(GroupID p_group) const;
+	bool is_group_task_completed(GroupID p_group) const;
+	void wait_for_group_task_completion(GroupID p_group);
+
+	// Number of worker threads. At least one, even if it is zero the tasks still run (synchronously).
+	_FORCE_INLINE_ int get_thread_count() const { return MAX(thread_count, 1u); }
+	// Index of the calling worker thread, or -1 if not called from a worker.
+	static int get_thread_index();
+
+	static WorkerThreadPool *get_singleton() { return singleton; }
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
@@ -72,6 +72,7 @@
 #include "core/object/undo_redo.h"
 #include "core/os/main_loop.h"
 #include "core/os/time.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/string/optimized_translation.h"
 #include "core/string/translation.h"
 
@@ -105,6 +106,8 @@ extern void unregister_global_constants();
 
 static ResourceUID *resource_uid = nullptr;
 
+static WorkerThreadPool *worker_thread_pool = nullptr;
+
 void register_core_types() {
 	//consistency check
 	static_assert(sizeof(Callable) <= 16);
@@ -232,6 +235,8 @@ void register_core_types() {
 
 	resource_uid = memnew(ResourceUID);
 
+	worker_thread_pool = memnew(WorkerThreadPool);
+
 	native_extension_manager = memnew(NativeExtensionManager);
 
 	ip = IP::create();
@@ -257,6 +262,9 @@ void register_core_settings() {
 
 	GLOBAL_DEF("network/ssl/certificate_bundle_override", "");
 	ProjectSettings::get_singleton()->set_custom_property_info("network/ssl/certificate_bundle_override", PropertyInfo(Variant::STRING, "network/ssl/certificate_bundle_override", PROPERTY_HINT_FILE, "*.crt"));
+
+	GLOBAL_DEF_RST("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads", PropertyInfo(Variant::INT, "threading/worker_pool/max_threads", PROPERTY_HINT_RANGE, "-1,256,1,or_greater"));
 }
 
 void register_core_singletons() {
@@ -276,6 +284,7 @@ void register_core_singletons() {
 	GDREGISTER_CLASS(Expression);
 	GDREGISTER_CLASS(_EngineDebugger);
 	GDREGISTER_CLASS(Time);
+	GDREGISTER_VIRTUAL_CLASS(WorkerThreadPool);
 
 	Engine::get_singleton()->add_singleton(Engine::Singleton("ProjectSettings", ProjectSettings::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("IP", IP::get_singleton(), "IP"));
@@ -292,6 +301,7 @@ void register_core_singletons() {
 	Engine::get_singleton()->add_singleton(Engine::Singleton("InputMap", InputMap::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("EngineDebugger", _EngineDebugger::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("Time", Time::get_singleton()));
+	Engine::get_singleton()->add_singleton(Engine::Singleton("WorkerThreadPool", WorkerThreadPool::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("NativeExtensionManager", NativeExtensionManager::get_singleton()));
 	Engine::get_singleton()->add_singleton(Engine::Singleton("ResourceUID", ResourceUID::get_singleton()));
 }
@@ -351,6 +361,9 @@ void unregister_core_types() {
 
 	ResourceLoader::finalize();
 
+	// Joins the worker threads, every user of the pool must be gone by now.
+	memdelete(worker_thread_pool);
+
 	ClassDB::cleanup_defaults();
 	ObjectDB::cleanup();
 
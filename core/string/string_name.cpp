@@ -40,13 +40,13 @@ StaticCString StaticCString::create(const char *p_ptr) {
 }
 
 StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+StringName::_TableLock StringName::_table_locks[STRING_TABLE_SHARDS];
 
 StringName _scs_create(const char *p_chr, bool p_static) {
 	return (p_chr[0] ? StringName(StaticCString::create(p_chr), p_static) : StringName());
 }
 
 bool StringName::configured = false;
-Mutex StringName::mutex;
 
 #ifdef DEBUG_ENABLED
 bool StringName::debug_stringname = false;
@@ -61,12 +61,11 @@ void StringName::setup() {
 }
 
 void StringName::cleanup() {
-	MutexLock lock(mutex);
-
 #ifdef DEBUG_ENABLED
 	if (unlikely(debug_stringname)) {
 		Vector<_Data *> data;
 		for (int i = 0; i < STRING_TABLE_LEN; i++) {
+			RWLockRead lock(_get_table_lock(i));
 			_Data *d = _table[i];
 			while (d) {
 				data.push_back(d);
@@ -76,12 +75,13 @@ void StringName::cleanup() {
 		print_line("\nStringName Reference Ranking:\n");
 		data.sort_custom<DebugSortReferences>();
 		for (int i = 0; i < MIN(100, data.size()); i++) {
-			print_line(itos(i + 1) + ": " + data[i]->get_name() + " - " + itos(data[i]->debug_references));
+			print_line(itos(i + 1) + ": " + data[i]->get_name() + " - " + itos(data[i]->debug_references.get()));
 		}
 	}
 #endif
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+		RWLockWrite lock(_get_table_lock(i));
 		while (_table[i]) {
 			_Data *d = _table[i];
 			lost_strings++;
@@ -103,11 +103,70 @@ void StringName::cleanup() {
 	configured = false;
 }
 
+// Must be called with the table lock of p_idx held, for reading or writing.
+template <class T>
+StringName::_Data *StringName::_find(uint32_t p_hash, uint32_t p_idx, const T &p_name) {
+	_Data *data = _table[p_idx];
+
+	while (data) {
+		// compare hash first
+		if (data->hash == p_hash && data->get_name() == p_name) {
+			break;
+		}
+		data = data->next;
+	}
+
+	return data;
+}
+
+// Fails if the last reference was just dropped on another thread, which is
+// about to remove it from the table. A new entry must be created instead.
+bool StringName::_ref_existing(_Data *p_data, bool p_static) {
+	if (!p_data->refcount.ref()) {
+		return false;
+	}
+
+	if (p_static) {
+		p_data->static_count.increment();
+	}
+#ifdef DEBUG_ENABLED
+	if (unlikely(debug_stringname)) {
+		p_data->debug_references.increment();
+	}
+#endif
+	return true;
+}
+
+// Must be called with the table lock of p_idx held for writing.
+StringName::_Data *StringName::_insert(uint32_t p_hash, uint32_t p_idx, bool p_static) {
+	_Data *data = memnew(_Data);
+	data->refcount.init();
+	data->static_count.set(p_static ? 1 : 0);
+	data->hash = p_hash;
+	data->idx = p_idx;
+	data->cname = nullptr;
+	data->next = _table[p_idx];
+	data->prev = nullptr;
+#ifdef DEBUG_ENABLED
+	if (unlikely(debug_stringname)) {
+		// Keep in memory, force static.
+		data->refcount.ref();
+		data->static_count.increment();
+	}
+#endif
+
+	if (_table[p_idx]) {
+		_table[p_idx]->prev = data;
+	}
+	_table[p_idx] = data;
+	return data;
+}
+
 void StringName::unref() {
 	ERR_FAIL_COND(!configured);
 
 	if (_data && _data->refcount.unref()) {
-		MutexLock lock(mutex);
+		RWLockWrite lock(_get_table_lock(_data->idx));
 
 		if (_data->static_count.get() > 0) {
 			if (_data->cname) {
@@ -191,58 +250,31 @@ StringName::StringName(const char *p_name, bool p_static) {
 		return; //empty, ignore
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
-
 	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
+	RWLock &lock = _get_table_lock(idx);
+
+	{
+		// Fast path, the name usually exists already.
+		RWLockRead read_lock(lock);
+		_Data *found = _find(hash, idx, p_name);
+		if (found && _ref_existing(found, p_static)) {
+			_data = found;
+			return;
 		}
-		_data = _data->next;
 	}
 
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-		}
+	RWLockWrite write_lock(lock);
 
+	// Search again, another thread may have added it while unlocked.
+	_Data *found = _find(hash, idx, p_name);
+	if (found && _ref_existing(found, p_static)) {
+		_data = found;
 		return;
 	}
 
-	_data = memnew(_Data);
+	_data = _insert(hash, idx, p_static);
 	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
 }
 
 StringName::StringName(const StaticCString &p_static_string, bool p_static) {
@@ -252,57 +284,29 @@ StringName::StringName(const StaticCString &p_static_string, bool p_static) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_static_string.ptr);
-
 	uint32_t idx = hash & STRING_TABLE_MASK;
+	RWLock &lock = _get_table_lock(idx);
 
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
+	{
+		RWLockRead read_lock(lock);
+		_Data *found = _find(hash, idx, p_static_string.ptr);
+		if (found && _ref_existing(found, p_static)) {
+			_data = found;
 			return;
 		}
 	}
 
-	_data = memnew(_Data);
+	RWLockWrite write_lock(lock);
 
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
+	_Data *found = _find(hash, idx, p_static_string.ptr);
+	if (found && _ref_existing(found, p_static)) {
+		_data = found;
+		return;
 	}
-	_table[idx] = _data;
+
+	_data = _insert(hash, idx, p_static);
+	_data->cname = p_static_string.ptr;
 }
 
 StringName::StringName(const String &p_name, bool p_static) {
@@ -314,56 +318,29 @@ StringName::StringName(const String &p_name, bool p_static) {
 		return;
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = p_name.hash();
 	uint32_t idx = hash & STRING_TABLE_MASK;
+	RWLock &lock = _get_table_lock(idx);
 
-	_data = _table[idx];
-
-	while (_data) {
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
+	{
+		RWLockRead read_lock(lock);
+		_Data *found = _find(hash, idx, p_name);
+		if (found && _ref_existing(found, p_static)) {
+			_data = found;
 			return;
 		}
 	}
 
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
+	RWLockWrite write_lock(lock);
 
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
+	_Data *found = _find(hash, idx, p_name);
+	if (found && _ref_existing(found, p_static)) {
+		_data = found;
+		return;
 	}
-	_table[idx] = _data;
+
+	_data = _insert(hash, idx, p_static);
+	_data->name = p_name;
 }
 
 StringName StringName::search(const char *p_name) {
@@ -374,28 +351,12 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
-
+	RWLockRead lock(_get_table_lock(idx));
+	_Data *_data = _find(hash, idx, p_name);
+	if (_data && _ref_existing(_data, false)) {
 		return StringName(_data);
 	}
 
@@ -410,23 +371,12 @@ StringName StringName::search(const char32_t *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
-
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
+	RWLockRead lock(_get_table_lock(idx));
+	_Data *_data = _find(hash, idx, p_name);
+	if (_data && _ref_existing(_data, false)) {
 		return StringName(_data);
 	}
 
@@ -436,28 +386,12 @@ StringName StringName::search(const char32_t *p_name) {
 StringName StringName::search(const String &p_name) {
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = p_name.hash();
-
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name()) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
+	RWLockRead lock(_get_table_lock(idx));
+	_Data *_data = _find(hash, idx, p_name);
+	if (_data && _ref_existing(_data, false)) {
 		return StringName(_data);
 	}
 
@@ -32,6 +32,7 @@
 #define STRING_NAME_H
 
 #include "core/os/mutex.h"
+#include "core/os/rw_lock.h"
 #include "core/string/ustring.h"
 #include "core/templates/safe_refcount.h"
 
@@ -46,7 +47,12 @@ class StringName {
 	enum {
 		STRING_TABLE_BITS = 16,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+		// The table is split in shards with their own lock, so threads
+		// interning unrelated names don't contend with each other.
+		STRING_TABLE_SHARD_BITS = 6,
+		STRING_TABLE_SHARDS = 1 << STRING_TABLE_SHARD_BITS,
+		STRING_TABLE_SHARD_MASK = STRING_TABLE_SHARDS - 1
 	};
 
 	struct _Data {
@@ -55,7 +61,7 @@ class StringName {
 		const char *cname = nullptr;
 		String name;
 #ifdef DEBUG_ENABLED
-		uint32_t debug_references = 0;
+		SafeNumeric<uint32_t> debug_references;
 #endif
 		String get_name() const { return cname ? String(cname) : name; }
 		int idx = 0;
@@ -67,6 +73,22 @@ class StringName {
 
 	static _Data *_table[STRING_TABLE_LEN];
 
+	// Lookups of existing names only take the read lock, inserting and
+	// removing take the write lock. Padded to avoid false sharing.
+	struct alignas(64) _TableLock {
+		RWLock lock;
+	};
+	static _TableLock _table_locks[STRING_TABLE_SHARDS];
+
+	_FORCE_INLINE_ static RWLock &_get_table_lock(uint32_t p_idx) {
+		return _table_locks[p_idx & STRING_TABLE_SHARD_MASK].lock;
+	}
+
+	template <class T>
+	static _Data *_find(uint32_t p_hash, uint32_t p_idx, const T &p_name);
+	static bool _ref_existing(_Data *p_data, bool p_static);
+	static _Data *_insert(uint32_t p_hash, uint32_t p_idx, bool p_static);
+
 	_Data *_data = nullptr;
 
 	union _HashUnion {
@@ -78,14 +100,13 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 	friend class Main;
-	static Mutex mutex;
 	static void setup();
 	static void cleanup();
 	static bool configured;
 #ifdef DEBUG_ENABLED
 	struct DebugSortReferences {
 		bool operator()(const _Data *p_left, const _Data *p_right) const {
-			return p_left->debug_references > p_right->debug_references;
+			return p_left->debug_references.get() > p_right->debug_references.get();
 		}
 	};
 
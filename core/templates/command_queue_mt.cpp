@@ -33,12 +33,118 @@
 #include "core/config/project_settings.h"
 #include "core/os/os.h"
 
-void CommandQueueMT::lock() {
-	mutex.lock();
+#include <string.h>
+#include <thread>
+
+CommandQueueMT::Page *CommandQueueMT::_alloc_page(uint32_t p_min_capacity) {
+	Page *page = nullptr;
+	{
+		MutexLock lock(page_mutex);
+		Page **E = &spare_pages;
+		while (*E) {
+			if ((*E)->capacity >= p_min_capacity) {
+				page = *E;
+				*E = page->next_free;
+				spare_count--;
+				break;
+			}
+			E = &(*E)->next_free;
+		}
+	}
+
+	if (!page) {
+		uint32_t capacity = MAX(page_size, _align(p_min_capacity));
+		uint8_t *mem = (uint8_t *)memalloc(PAGE_HEADER_SIZE + capacity);
+		CRASH_COND_MSG(!mem, "Out of memory.");
+		// Headers must read as uncommitted until written.
+		memset(mem + PAGE_HEADER_SIZE, 0, capacity);
+		page = memnew_placement(mem, Page);
+		page->capacity = capacity;
+	}
+
+	page->reserved.store(0, std::memory_order_relaxed);
+	page->end.store(PAGE_OPEN, std::memory_order_relaxed);
+	page->next.store(nullptr, std::memory_order_relaxed);
+	page->next_free = nullptr;
+	return page;
 }
 
-void CommandQueueMT::unlock() {
-	mutex.unlock();
+void CommandQueueMT::_open_next_page(Page *p_page, uint32_t p_offset, uint32_t p_size) {
+	if (p_offset <= p_page->capacity) {
+		// This reservation crossed the end of the page, so this producer links
+		// the next one. The next page must be visible before the end is.
+		Page *next = _alloc_page(sizeof(CommandHeader) + p_size);
+		p_page->next.store(next, std::memory_order_release);
+		p_page->end.store(p_offset, std::memory_order_release);
+		write_page.store(next, std::memory_order_release);
+	} else {
+		// Another producer is linking the next page.
+		while (write_page.load(std::memory_order_acquire) == p_page) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void CommandQueueMT::_recycle_retired_pages() {
+	// Producers only touch the page they loaded while counted as active, so
+	// once none is active no one can reference a retired page.
+	if (!retired_pages || active_producers.load() != 0) {
+		return;
+	}
+
+	MutexLock lock(page_mutex);
+	while (retired_pages) {
+		Page *page = retired_pages;
+		retired_pages = page->next_free;
+		if (spare_count < MAX_SPARE_PAGES && page->capacity == page_size) {
+			uint32_t used = page->end.load(std::memory_order_relaxed);
+			memset(page->get_data(), 0, MIN(used + (uint32_t)sizeof(CommandHeader), page->capacity));
+			page->next_free = spare_pages;
+			spare_pages = page;
+			spare_count++;
+		} else {
+			page->~Page();
+			memfree(page);
+		}
+	}
+}
+
+void CommandQueueMT::_flush() {
+	MutexLock lock(flush_mutex);
+	flush_depth++;
+
+	while (true) {
+		Page *page = read_page;
+		if (read_pos >= page->end.load(std::memory_order_acquire)) {
+			// Closed and fully read, the next page was linked before the end was set.
+			read_page = page->next.load(std::memory_order_acquire);
+			read_pos = 0;
+			page->next_free = retired_pages;
+			retired_pages = page;
+			continue;
+		}
+
+		if (read_pos + sizeof(CommandHeader) > page->capacity) {
+			break; // The page is being closed.
+		}
+		CommandHeader *header = reinterpret_cast<CommandHeader *>(page->get_data() + read_pos);
+		uint32_t size = header->size.load(std::memory_order_acquire);
+		if (size == 0) {
+			// Not committed yet (or not reserved at all), the producer will wake us again.
+			break;
+		}
+
+		// Advance first, the command may flush recursively.
+		read_pos += size;
+		flushed_commands++;
+		header->execute(reinterpret_cast<CommandBase *>(reinterpret_cast<uint8_t *>(header) + sizeof(CommandHeader)));
+	}
+
+	flush_depth--;
+	if (flush_depth == 0) {
+		// Pages are only recycled by the outermost flush, as an outer command may still live in them.
+		_recycle_retired_pages();
+	}
 }
 
 void CommandQueueMT::wait_for_flush() {
@@ -50,7 +156,7 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 	int idx = -1;
 
 	while (true) {
-		lock();
+		sync_sem_mutex.lock();
 		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
 			if (!sync_sems[i].in_use) {
 				sync_sems[i].in_use = true;
@@ -58,7 +164,7 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 				break;
 			}
 		}
-		unlock();
+		sync_sem_mutex.unlock();
 
 		if (idx == -1) {
 			wait_for_flush();
@@ -71,6 +177,19 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 }
 
 CommandQueueMT::CommandQueueMT(bool p_sync) {
+	if (ProjectSettings::get_singleton()) {
+		page_size = GLOBAL_DEF_RST("memory/limits/command_queue/multithreading_queue_size_kb", DEFAULT_COMMAND_MEM_SIZE_KB);
+		ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/command_queue/multithreading_queue_size_kb", PropertyInfo(Variant::INT, "memory/limits/command_queue/multithreading_queue_size_kb", PROPERTY_HINT_RANGE, "1,4096,1,or_greater"));
+		page_size = MAX(page_size, 1u) * 1024;
+	} else {
+		page_size = DEFAULT_COMMAND_MEM_SIZE_KB * 1024;
+	}
+
+	active_producers.store(0);
+	wake_count.store(0);
+	read_page = _alloc_page(page_size);
+	write_page.store(read_page);
+
 	if (p_sync) {
 		sync = memnew(Semaphore);
 	}
@@ -80,4 +199,25 @@ CommandQueueMT::~CommandQueueMT() {
 	if (sync) {
 		memdelete(sync);
 	}
+
+	// Pending commands are dropped, as before.
+	Page *page = read_page;
+	while (page) {
+		Page *next = page->next.load();
+		page->next_free = retired_pages;
+		retired_pages = page;
+		page = next;
+	}
+	while (retired_pages) {
+		Page *next = retired_pages->next_free;
+		retired_pages->~Page();
+		memfree(retired_pages);
+		retired_pages = next;
+	}
+	while (spare_pages) {
+		Page *next = spare_pages->next_free;
+		spare_pages->~Page();
+		memfree(spare_pages);
+		spare_pages = next;
+	}
 }
@@ -39,6 +39,8 @@
 #include "core/templates/simple_type.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+
 #define COMMA(N) _COMMA_##N
 #define _COMMA_0
 #define _COMMA_1 ,
@@ -205,6 +207,7 @@
 #define _SPACE_SEP_LIST_0(ITEM)
 
 #define ARG(N) p##N
+#define CMD_ARG(N) cmd->p##N
 #define PARAM(N) P##N p##N
 #define TYPE_PARAM(N) class P##N
 #define PARAM_DECL(N) typename GetSimpleTypeT<P##N>::type_t p##N
@@ -215,32 +218,44 @@
 		T *instance;                                                   \
 		M method;                                                      \
 		SEMIC_SEP_LIST(PARAM_DECL, N);                                 \
-		virtual void call() {                                          \
-			(instance->*method)(COMMA_SEP_LIST(ARG, N));               \
+		static void execute(CommandBase *p_cmd) {                      \
+			Command##N *cmd = static_cast<Command##N *>(p_cmd);        \
+			(cmd->instance->*cmd->method)(COMMA_SEP_LIST(CMD_ARG, N)); \
+			cmd->~Command##N();                                        \
 		}                                                              \
 	};
 
-#define DECL_CMD_RET(N)                                                         \
-	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R> \
-	struct CommandRet##N : public SyncCommand {                                 \
-		R *ret;                                                                 \
-		T *instance;                                                            \
-		M method;                                                               \
-		SEMIC_SEP_LIST(PARAM_DECL, N);                                          \
-		virtual void call() {                                                   \
-			*ret = (instance->*method)(COMMA_SEP_LIST(ARG, N));                 \
-		}                                                                       \
+#define DECL_CMD_RET(N)                                                          \
+	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R>  \
+	struct CommandRet##N : public CommandBase {                                  \
+		SyncSemaphore *sync_sem;                                                 \
+		R *ret;                                                                  \
+		T *instance;                                                             \
+		M method;                                                                \
+		SEMIC_SEP_LIST(PARAM_DECL, N);                                           \
+		static void execute(CommandBase *p_cmd) {                                \
+			CommandRet##N *cmd = static_cast<CommandRet##N *>(p_cmd);            \
+			*cmd->ret = (cmd->instance->*cmd->method)(COMMA_SEP_LIST(CMD_ARG, N)); \
+			SyncSemaphore *ss = cmd->sync_sem;                                   \
+			cmd->~CommandRet##N();                                               \
+			ss->sem.post();                                                      \
+		}                                                                        \
 	};
 
-#define DECL_CMD_SYNC(N)                                               \
-	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)> \
-	struct CommandSync##N : public SyncCommand {                       \
-		T *instance;                                                   \
-		M method;                                                      \
-		SEMIC_SEP_LIST(PARAM_DECL, N);                                 \
-		virtual void call() {                                          \
-			(instance->*method)(COMMA_SEP_LIST(ARG, N));               \
-		}                                                              \
+#define DECL_CMD_SYNC(N)                                                 \
+	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>   \
+	struct CommandSync##N : public CommandBase {                         \
+		SyncSemaphore *sync_sem;                                         \
+		T *instance;                                                     \
+		M method;                                                        \
+		SEMIC_SEP_LIST(PARAM_DECL, N);                                   \
+		static void execute(CommandBase *p_cmd) {                        \
+			CommandSync##N *cmd = static_cast<CommandSync##N *>(p_cmd);  \
+			(cmd->instance->*cmd->method)(COMMA_SEP_LIST(CMD_ARG, N));   \
+			SyncSemaphore *ss = cmd->sync_sem;                           \
+			cmd->~CommandSync##N();                                      \
+			ss->sem.post();                                              \
+		}                                                                \
 	};
 
 #define TYPE_ARG(N) P##N
@@ -250,13 +265,11 @@
 #define DECL_PUSH(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>       \
 	void push(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
-		CMD_TYPE(N) *cmd = allocate_and_lock<CMD_TYPE(N)>();                 \
+		CMD_TYPE(N) *cmd = allocate<CMD_TYPE(N)>();                          \
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
-		if (sync)                                                            \
-			sync->post();                                                    \
+		commit(cmd);                                                         \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -265,15 +278,13 @@
 	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R>                \
 	void push_and_ret(T *p_instance, M p_method, COMMA_SEP_LIST(PARAM, N) COMMA(N) R *r_ret) { \
 		SyncSemaphore *ss = _alloc_sync_sem();                                                 \
-		CMD_RET_TYPE(N) *cmd = allocate_and_lock<CMD_RET_TYPE(N)>();                           \
+		CMD_RET_TYPE(N) *cmd = allocate<CMD_RET_TYPE(N)>();                                    \
 		cmd->instance = p_instance;                                                            \
 		cmd->method = p_method;                                                                \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
-		if (sync)                                                                              \
-			sync->post();                                                                      \
+		commit(cmd);                                                                           \
 		ss->sem.wait();                                                                        \
 		ss->in_use = false;                                                                    \
 	}
@@ -284,38 +295,50 @@
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>                \
 	void push_and_sync(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
 		SyncSemaphore *ss = _alloc_sync_sem();                                        \
-		CMD_SYNC_TYPE(N) *cmd = allocate_and_lock<CMD_SYNC_TYPE(N)>();                \
+		CMD_SYNC_TYPE(N) *cmd = allocate<CMD_SYNC_TYPE(N)>();                         \
 		cmd->instance = p_instance;                                                   \
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
-		if (sync)                                                                     \
-			sync->post();                                                             \
+		commit(cmd);                                                                  \
 		ss->sem.wait();                                                               \
 		ss->in_use = false;                                                           \
 	}
 
 #define MAX_CMD_PARAMS 15
 
+// Multiple producer, single consumer queue of method calls, used by the
+// servers to run their API on their own thread.
+//
+// Commands are written to a list of pages without locking: producers reserve
+// space in the current page with an atomic add, construct the command in
+// place and then commit it by publishing its size. The producer that
+// overflows a page links a new one. Consumed pages are recycled once no
+// producer can still be reserving from them.
 class CommandQueueMT {
 	struct SyncSemaphore {
 		Semaphore sem;
 		bool in_use = false;
 	};
 
-	struct CommandBase {
-		virtual void call() = 0;
-		virtual void post() {}
-		virtual ~CommandBase() {}
+	// Commands are plain structs, each one has a static function that calls and destroys it.
+	struct CommandBase {};
+	typedef void (*ExecuteFunc)(CommandBase *);
+
+	struct CommandHeader {
+		std::atomic<uint32_t> size; // Including the header, zero until committed.
+		uint32_t padding;
+		ExecuteFunc execute;
 	};
 
-	struct SyncCommand : public CommandBase {
-		SyncSemaphore *sync_sem;
+	struct Page {
+		std::atomic<uint32_t> reserved; // May go past the capacity when the page overflows.
+		std::atomic<uint32_t> end; // Set once the page is closed, commands stop there.
+		std::atomic<Page *> next;
+		uint32_t capacity = 0;
+		Page *next_free = nullptr;
 
-		virtual void post() {
-			sync_sem->sem.post();
-		}
+		_FORCE_INLINE_ uint8_t *get_data() { return reinterpret_cast<uint8_t *>(this) + PAGE_HEADER_SIZE; }
 	};
 
 	DECL_CMD(0)
@@ -333,56 +356,81 @@ class CommandQueueMT {
 
 	enum {
 		DEFAULT_COMMAND_MEM_SIZE_KB = 256,
-		SYNC_SEMAPHORES = 8
+		SYNC_SEMAPHORES = 8,
+		PAGE_HEADER_SIZE = (sizeof(Page) + 15) & ~15,
+		MAX_SPARE_PAGES = 2,
 	};
 
-	LocalVector<uint8_t> command_mem;
-	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex mutex;
-	Semaphore *sync = nullptr;
+	static constexpr uint32_t PAGE_OPEN = UINT32_MAX;
 
-	template <class T>
-	T *allocate() {
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1));
-		uint64_t size = command_mem.size();
-		command_mem.resize(size + alloc_size + 8);
-		*(uint64_t *)&command_mem[size] = alloc_size;
-		T *cmd = memnew_placement(&command_mem[size + 8], T);
-		return cmd;
-	}
+	uint32_t page_size = DEFAULT_COMMAND_MEM_SIZE_KB * 1024;
 
-	template <class T>
-	T *allocate_and_lock() {
-		lock();
-		T *ret = allocate<T>();
-		return ret;
-	}
+	// Producer side.
+	std::atomic<Page *> write_page;
+	std::atomic<uint32_t> active_producers;
+
+	// Consumer side, protected by flush_mutex (recursive, commands may flush).
+	Mutex flush_mutex;
+	Page *read_page = nullptr;
+	uint32_t read_pos = 0;
+	uint32_t flush_depth = 0;
+	Page *retired_pages = nullptr;
+	uint64_t flushed_commands = 0;
 
-	void _flush() {
-		lock();
+	// Page recycling, only taken when a page fills up.
+	BinaryMutex page_mutex;
+	Page *spare_pages = nullptr;
+	uint32_t spare_count = 0;
 
-		uint64_t read_ptr = 0;
-		uint64_t limit = command_mem.size();
+	// Wake-ups are counted like a semaphore, but the semaphore is only touched
+	// when the consumer is actually sleeping (the count is negative).
+	std::atomic<int32_t> wake_count;
+	Semaphore *sync = nullptr;
 
-		while (read_ptr < limit) {
-			uint64_t size = *(uint64_t *)&command_mem[read_ptr];
-			read_ptr += 8;
-			CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
+	BinaryMutex sync_sem_mutex;
+	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
+
+	_FORCE_INLINE_ static uint32_t _align(uint32_t p_size) { return (p_size + 7) & ~7; }
+
+	Page *_alloc_page(uint32_t p_min_capacity);
+	void _open_next_page(Page *p_page, uint32_t p_offset, uint32_t p_size);
+	void _recycle_retired_pages();
+
+	_FORCE_INLINE_ uint8_t *_reserve(uint32_t p_size) {
+		active_producers.fetch_add(1);
+		while (true) {
+			Page *page = write_page.load(std::memory_order_acquire);
+			uint32_t offset = page->reserved.fetch_add(p_size);
+			if (likely(offset + p_size <= page->capacity)) {
+				return page->get_data() + offset;
+			}
+			_open_next_page(page, offset, p_size);
+		}
+	}
 
-			cmd->call(); //execute the function
-			cmd->post(); //release in case it needs sync/ret
-			cmd->~CommandBase(); //should be done, so erase the command
+	template <class T>
+	T *allocate() {
+		uint32_t size = sizeof(CommandHeader) + _align(sizeof(T));
+		CommandHeader *header = reinterpret_cast<CommandHeader *>(_reserve(size));
+		header->execute = &T::execute;
+		return memnew_placement(reinterpret_cast<uint8_t *>(header) + sizeof(CommandHeader), T);
+	}
 
-			read_ptr += size;
+	template <class T>
+	void commit(T *p_cmd) {
+		CommandHeader *header = reinterpret_cast<CommandHeader *>(reinterpret_cast<uint8_t *>(p_cmd) - sizeof(CommandHeader));
+		header->size.store(sizeof(CommandHeader) + _align(sizeof(T)), std::memory_order_release);
+		active_producers.fetch_sub(1);
+		if (sync && wake_count.fetch_add(1) < 0) {
+			sync->post();
 		}
+	}
 
-		command_mem.clear();
-		unlock();
+	_FORCE_INLINE_ bool _has_pending() const {
+		return read_page->end.load(std::memory_order_relaxed) != PAGE_OPEN || read_page->reserved.load(std::memory_order_relaxed) > read_pos;
 	}
 
-	void lock();
-	void unlock();
+	void _flush();
 	void wait_for_flush();
 	SyncSemaphore *_alloc_sync_sem();
 
@@ -400,7 +448,7 @@ public:
 	SPACE_SEP_LIST(DECL_PUSH_AND_SYNC, 15)
 
 	_FORCE_INLINE_ void flush_if_pending() {
-		if (unlikely(command_mem.size() > 0)) {
+		if (unlikely(_has_pending())) {
 			_flush();
 		}
 	}
@@ -408,17 +456,24 @@ public:
 		_flush();
 	}
 
+	// Waits for one push (each push wakes one wait), then flushes everything.
 	void wait_and_flush() {
 		ERR_FAIL_COND(!sync);
-		sync->wait();
+		if (wake_count.fetch_sub(1) <= 0) {
+			sync->wait();
+		}
 		_flush();
 	}
 
+	// Total number of commands executed, to measure throughput.
+	uint64_t get_flushed_command_count() const { return flushed_commands; }
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
 
 #undef ARG
+#undef CMD_ARG
 #undef PARAM
 #undef TYPE_PARAM
 #undef PARAM_DECL
@@ -0,0 +1,485 @@
+/*************************************************************************/
+/*  dense_ordered_hash_map.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef DENSE_ORDERED_HASH_MAP_H
+#define DENSE_ORDERED_HASH_MAP_H
+
+#include "core/math/math_funcs.h"
+#include "core/os/memory.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/local_vector.h"
+
+/**
+ * An insertion ordered hash map with compact storage, in the spirit of
+ * CPython's dict.
+ *
+ * Entries are kept in a dense array in insertion order, and a separate open
+ * addressing (linear probing) table maps hashes to entry indices. Lookups
+ * mostly touch the small slot table and one entry, and iterating is a linear
+ * walk over the entries array.
+ *
+ * Key/value pairs live in pages owned by the map, so references to values stay
+ * valid until their key is erased, even while the map grows or compacts.
+ * Erased entries are left as holes in the entries array, which is compacted
+ * once holes outnumber live entries.
+ *
+ * Erasing invalidates Elements (but not other keys or values), iteration order
+ * is preserved.
+ */
+template <class K, class V, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<K>>
+class DenseOrderedHashMap {
+	struct KeyValue {
+		K key;
+		V value;
+
+		KeyValue(const K &p_key, const V &p_value) :
+				key(p_key),
+				value(p_value) {}
+	};
+
+	struct Entry {
+		KeyValue *pair; // nullptr once erased.
+		uint32_t hash;
+	};
+
+	// The hash is repeated here so probing rarely needs to look at the entries.
+	struct Slot {
+		uint32_t index;
+		uint32_t hash;
+	};
+
+	enum {
+		MIN_INDEX_CAPACITY_BITS = 3,
+		MIN_PAGE_SIZE = 4,
+		MAX_PAGE_SIZE = 4096,
+		EMPTY_INDEX = 0xFFFFFFFF,
+		DELETED_INDEX = 0xFFFFFFFE,
+	};
+
+	LocalVector<Entry> entries;
+	Slot *slots = nullptr;
+	uint32_t slot_capacity = 0; // Power of two.
+	uint32_t slot_capacity_bits = 0;
+	uint32_t num_elements = 0;
+	uint32_t used_slots = 0; // Live and deleted ones, probing stops at empty slots only.
+
+	// Pair storage, page sizes double up to MAX_PAGE_SIZE.
+	LocalVector<uint8_t *> pages;
+	uint32_t last_page_size = 0;
+	uint32_t last_page_used = 0;
+	LocalVector<KeyValue *> free_pairs;
+
+	KeyValue *_alloc_pair(const K &p_key, const V &p_value) {
+		KeyValue *pair;
+		if (free_pairs.size()) {
+			pair = free_pairs[free_pairs.size() - 1];
+			free_pairs.resize(free_pairs.size() - 1);
+		} else {
+			if (last_page_used == last_page_size) {
+				last_page_size = last_page_size ? MIN(last_page_size * 2, (uint32_t)MAX_PAGE_SIZE) : (uint32_t)MIN_PAGE_SIZE;
+				last_page_used = 0;
+				pages.push_back((uint8_t *)memalloc(sizeof(KeyValue) * last_page_size));
+			}
+			pair = ((KeyValue *)pages[pages.size() - 1]) + last_page_used;
+			last_page_used++;
+		}
+		memnew_placement(pair, KeyValue(p_key, p_value));
+		return pair;
+	}
+
+	void _free_pair(KeyValue *p_pair) {
+		p_pair->~KeyValue();
+		free_pairs.push_back(p_pair);
+	}
+
+	_FORCE_INLINE_ static uint32_t _hash(const K &p_key) {
+		return Hasher::hash(p_key);
+	}
+
+	// Fibonacci hashing, spreads hashes with poor low bits (like sequential keys) over the table.
+	_FORCE_INLINE_ uint32_t _get_slot_pos(uint32_t p_hash) const {
+		return (p_hash * 2654435769u) >> (32 - slot_capacity_bits);
+	}
+
+	// Returns the slot position, or EMPTY_INDEX.
+	uint32_t _find_slot(const K &p_key, uint32_t p_hash) const {
+		if (num_elements == 0) {
+			return EMPTY_INDEX;
+		}
+
+		uint32_t mask = slot_capacity - 1;
+		uint32_t pos = _get_slot_pos(p_hash);
+
+		while (true) {
+			const Slot &slot = slots[pos];
+			if (slot.index == EMPTY_INDEX) {
+				return EMPTY_INDEX;
+			}
+			if (slot.hash == p_hash && slot.index != DELETED_INDEX && Comparator::compare(entries[slot.index].pair->key, p_key)) {
+				return pos;
+			}
+			pos = (pos + 1) & mask;
+		}
+	}
+
+	_FORCE_INLINE_ uint32_t _find_entry(const K &p_key, uint32_t p_hash) const {
+		uint32_t pos = _find_slot(p_key, p_hash);
+		return pos == EMPTY_INDEX ? EMPTY_INDEX : slots[pos].index;
+	}
+
+	// Allocates the slot table for the current entries, dropping the erased ones.
+	void _rebuild(uint32_t p_min_elements) {
+		uint32_t bits = MIN_INDEX_CAPACITY_BITS;
+		while ((1u << bits) * 3 / 4 < p_min_elements) {
+			bits++;
+		}
+
+		if (entries.size() != num_elements) {
+			uint32_t to = 0;
+			for (uint32_t i = 0; i < entries.size(); i++) {
+				if (entries[i].pair) {
+					entries[to++] = entries[i];
+				}
+			}
+			entries.resize(to);
+		}
+
+		if (bits != slot_capacity_bits) {
+			if (slots) {
+				memfree(slots);
+			}
+			slot_capacity_bits = bits;
+			slot_capacity = 1 << bits;
+			slots = (Slot *)memalloc(sizeof(Slot) * slot_capacity);
+		}
+
+		uint32_t mask = slot_capacity - 1;
+		for (uint32_t i = 0; i < slot_capacity; i++) {
+			slots[i].index = EMPTY_INDEX;
+		}
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			uint32_t pos = _get_slot_pos(entries[i].hash);
+			while (slots[pos].index != EMPTY_INDEX) {
+				pos = (pos + 1) & mask;
+			}
+			slots[pos].index = i;
+			slots[pos].hash = entries[i].hash;
+		}
+		used_slots = entries.size();
+	}
+
+	uint32_t _insert(const K &p_key, const V &p_value, uint32_t p_hash) {
+		if (used_slots + 1 > slot_capacity * 3 / 4) {
+			_rebuild(num_elements + 1);
+		}
+
+		uint32_t idx = entries.size();
+		Entry e;
+		e.pair = _alloc_pair(p_key, p_value);
+		e.hash = p_hash;
+		entries.push_back(e);
+		num_elements++;
+
+		// Reuse the first empty or deleted slot, the key is known to be missing.
+		uint32_t mask = slot_capacity - 1;
+		uint32_t pos = _get_slot_pos(p_hash);
+		while (slots[pos].index < DELETED_INDEX) {
+			pos = (pos + 1) & mask;
+		}
+		if (slots[pos].index == EMPTY_INDEX) {
+			used_slots++;
+		}
+		slots[pos].index = idx;
+		slots[pos].hash = p_hash;
+
+		return idx;
+	}
+
+	uint32_t _next_live(uint32_t p_from) const {
+		for (uint32_t i = p_from; i < entries.size(); i++) {
+			if (entries[i].pair) {
+				return i;
+			}
+		}
+		return EMPTY_INDEX;
+	}
+
+	void _release() {
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			if (entries[i].pair) {
+				entries[i].pair->~KeyValue();
+			}
+		}
+		for (uint32_t i = 0; i < pages.size(); i++) {
+			memfree(pages[i]);
+		}
+		if (slots) {
+			memfree(slots);
+		}
+		slots = nullptr;
+		slot_capacity = 0;
+		slot_capacity_bits = 0;
+		num_elements = 0;
+		used_slots = 0;
+		entries.clear();
+		pages.clear();
+		free_pairs.clear();
+		last_page_size = 0;
+		last_page_used = 0;
+	}
+
+public:
+	class ConstElement;
+
+	class Element {
+		friend class DenseOrderedHashMap<K, V, Hasher, Comparator>;
+		friend class ConstElement;
+
+		DenseOrderedHashMap *map = nullptr;
+		uint32_t index = 0;
+
+		Element(DenseOrderedHashMap *p_map, uint32_t p_index) {
+			if (p_index != EMPTY_INDEX) {
+				map = p_map;
+				index = p_index;
+			}
+		}
+
+	public:
+		_FORCE_INLINE_ Element() {}
+
+		Element next() const {
+			return Element(map, map->_next_live(index + 1));
+		}
+
+		_FORCE_INLINE_ bool operator==(const Element &p_other) const {
+			return map == p_other.map && index == p_other.index;
+		}
+		_FORCE_INLINE_ bool operator!=(const Element &p_other) const {
+			return !(*this == p_other);
+		}
+
+		operator bool() const {
+			return map != nullptr;
+		}
+
+		const K &key() const {
+			CRASH_COND(!map);
+			return map->entries[index].pair->key;
+		}
+
+		V &value() const {
+			CRASH_COND(!map);
+			return map->entries[index].pair->value;
+		}
+
+		V &get() const {
+			CRASH_COND(!map);
+			return map->entries[index].pair->value;
+		}
+	};
+
+	class ConstElement {
+		friend class DenseOrderedHashMap<K, V, Hasher, Comparator>;
+
+		const DenseOrderedHashMap *map = nullptr;
+		uint32_t index = 0;
+
+		ConstElement(const DenseOrderedHashMap *p_map, uint32_t p_index) {
+			if (p_index != EMPTY_INDEX) {
+				map = p_map;
+				index = p_index;
+			}
+		}
+
+	public:
+		_FORCE_INLINE_ ConstElement() {}
+
+		ConstElement(const Element &p_element) :
+				map(p_element.map),
+				index(p_element.index) {}
+
+		ConstElement next() const {
+			return ConstElement(map, map->_next_live(index + 1));
+		}
+
+		_FORCE_INLINE_ bool operator==(const ConstElement &p_other) const {
+			return map == p_other.map && index == p_other.index;
+		}
+		_FORCE_INLINE_ bool operator!=(const ConstElement &p_other) const {
+			return !(*this == p_other);
+		}
+
+		operator bool() const {
+			return map != nullptr;
+		}
+
+		const K &key() const {
+			CRASH_COND(!map);
+			return map->entries[index].pair->key;
+		}
+
+		const V &value() const {
+			CRASH_COND(!map);
+			return map->entries[index].pair->value;
+		}
+
+		const V &get() const {
+			CRASH_COND(!map);
+			return map->entries[index].pair->value;
+		}
+	};
+
+	ConstElement find(const K &p_key) const {
+		return ConstElement(this, _find_entry(p_key, _hash(p_key)));
+	}
+
+	Element find(const K &p_key) {
+		return Element(this, _find_entry(p_key, _hash(p_key)));
+	}
+
+	Element insert(const K &p_key, const V &p_value) {
+		uint32_t hash = _hash(p_key);
+		uint32_t idx = _find_entry(p_key, hash);
+		if (idx != EMPTY_INDEX) {
+			entries[idx].pair->value = p_value;
+			return Element(this, idx);
+		}
+		return Element(this, _insert(p_key, p_value, hash));
+	}
+
+	bool erase(const K &p_key) {
+		uint32_t pos = _find_slot(p_key, _hash(p_key));
+		if (pos == EMPTY_INDEX) {
+			return false;
+		}
+
+		uint32_t idx = slots[pos].index;
+		slots[pos].index = DELETED_INDEX;
+		_free_pair(entries[idx].pair);
+		entries[idx].pair = nullptr;
+		num_elements--;
+
+		if (entries.size() - num_elements > num_elements && entries.size() > (1u << MIN_INDEX_CAPACITY_BITS)) {
+			_rebuild(num_elements);
+		}
+		return true;
+	}
+
+	inline bool has(const K &p_key) const {
+		return _find_entry(p_key, _hash(p_key)) != EMPTY_INDEX;
+	}
+
+	const V &operator[](const K &p_key) const {
+		uint32_t idx = _find_entry(p_key, _hash(p_key));
+		CRASH_COND(idx == EMPTY_INDEX);
+		return entries[idx].pair->value;
+	}
+
+	V &operator[](const K &p_key) {
+		uint32_t hash = _hash(p_key);
+		uint32_t idx = _find_entry(p_key, hash);
+		if (idx == EMPTY_INDEX) {
+			// consistent with Map behaviour
+			idx = _insert(p_key, V(), hash);
+		}
+		return entries[idx].pair->value;
+	}
+
+	// Element at the given position in insertion order, O(1) unless there are erased holes.
+	Element get_element_at(uint32_t p_position) {
+		if (p_position >= num_elements) {
+			return Element();
+		}
+		if (entries.size() == num_elements) {
+			return Element(this, p_position);
+		}
+		for (Element E = front(); E; E = E.next()) {
+			if (p_position == 0) {
+				return E;
+			}
+			p_position--;
+		}
+		return Element();
+	}
+
+	ConstElement get_element_at(uint32_t p_position) const {
+		return const_cast<DenseOrderedHashMap *>(this)->get_element_at(p_position);
+	}
+
+	inline Element front() {
+		return Element(this, _next_live(0));
+	}
+
+	inline ConstElement front() const {
+		return ConstElement(this, _next_live(0));
+	}
+
+	void reserve(uint32_t p_elements) {
+		if (p_elements > slot_capacity * 3 / 4) {
+			_rebuild(p_elements);
+		}
+		entries.reserve(p_elements);
+	}
+
+	inline bool is_empty() const { return num_elements == 0; }
+	inline int size() const { return num_elements; }
+
+	const void *id() const {
+		return this;
+	}
+
+	void clear() {
+		_release();
+	}
+
+	void operator=(const DenseOrderedHashMap &p_map) {
+		if (this == &p_map) {
+			return;
+		}
+		clear();
+		reserve(p_map.num_elements);
+		for (ConstElement E = p_map.front(); E; E = E.next()) {
+			_insert(E.key(), E.value(), p_map.entries[E.index].hash);
+		}
+	}
+
+	DenseOrderedHashMap(const DenseOrderedHashMap &p_map) {
+		*this = p_map;
+	}
+
+	_FORCE_INLINE_ DenseOrderedHashMap() {}
+
+	~DenseOrderedHashMap() {
+		_release();
+	}
+};
+
+#endif // DENSE_ORDERED_HASH_MAP_H
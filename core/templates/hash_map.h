@@ -55,7 +55,7 @@
  *
 */
 
-template <class TKey, class TData, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<TKey>, uint8_t MIN_HASH_TABLE_POWER = 3, uint8_t RELATIONSHIP = 8>
+template <class TKey, class TData, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<TKey>, uint8_t MIN_HASH_TABLE_POWER = 3, uint8_t RELATIONSHIP = 8, class Allocator = DefaultAllocator>
 class HashMap {
 public:
 	struct Pair {
@@ -100,7 +100,7 @@ private:
 	void make_hash_table() {
 		ERR_FAIL_COND(hash_table);
 
-		hash_table = memnew_arr(Element *, (1 << MIN_HASH_TABLE_POWER));
+		hash_table = (Element **)Allocator::alloc(sizeof(Element *) * (1 << MIN_HASH_TABLE_POWER));
 
 		hash_table_power = MIN_HASH_TABLE_POWER;
 		elements = 0;
@@ -112,7 +112,7 @@ private:
 	void erase_hash_table() {
 		ERR_FAIL_COND_MSG(elements, "Cannot erase hash table if there are still elements inside.");
 
-		memdelete_arr(hash_table);
+		Allocator::free(hash_table);
 		hash_table = nullptr;
 		hash_table_power = 0;
 		elements = 0;
@@ -146,7 +146,7 @@ private:
 			return;
 		}
 
-		Element **new_hash_table = memnew_arr(Element *, ((uint64_t)1 << new_hash_table_power));
+		Element **new_hash_table = (Element **)Allocator::alloc(sizeof(Element *) * ((uint64_t)1 << new_hash_table_power));
 		ERR_FAIL_COND_MSG(!new_hash_table, "Out of memory.");
 
 		for (int i = 0; i < (1 << new_hash_table_power); i++) {
@@ -164,7 +164,7 @@ private:
 				}
 			}
 
-			memdelete_arr(hash_table);
+			Allocator::free(hash_table);
 		}
 		hash_table = new_hash_table;
 		hash_table_power = new_hash_table_power;
@@ -192,7 +192,7 @@ private:
 
 	Element *create_element(const TKey &p_key) {
 		/* if element doesn't exist, create it */
-		Element *e = memnew(Element);
+		Element *e = memnew_allocator(Element, Allocator);
 		ERR_FAIL_COND_V_MSG(!e, nullptr, "Out of memory.");
 		uint32_t hash = Hasher::hash(p_key);
 		uint32_t index = hash & ((1 << hash_table_power) - 1);
@@ -218,7 +218,7 @@ private:
 			return; /* not copying from empty table */
 		}
 
-		hash_table = memnew_arr(Element *, (uint64_t)1 << p_t.hash_table_power);
+		hash_table = (Element **)Allocator::alloc(sizeof(Element *) * ((uint64_t)1 << p_t.hash_table_power));
 		hash_table_power = p_t.hash_table_power;
 		elements = p_t.elements;
 
@@ -228,7 +228,7 @@ private:
 			const Element *e = p_t.hash_table[i];
 
 			while (e) {
-				Element *le = memnew(Element); /* local element */
+				Element *le = memnew_allocator(Element, Allocator); /* local element */
 
 				*le = *e; /* copy data */
 
@@ -400,7 +400,7 @@ public:
 					hash_table[index] = e->next;
 				}
 
-				memdelete(e);
+				memdelete_allocator<Element, Allocator>(e);
 				elements--;
 
 				if (elements == 0) {
@@ -508,11 +508,11 @@ public:
 				while (hash_table[i]) {
 					Element *e = hash_table[i];
 					hash_table[i] = e->next;
-					memdelete(e);
+					memdelete_allocator<Element, Allocator>(e);
 				}
 			}
 
-			memdelete_arr(hash_table);
+			Allocator::free(hash_table);
 		}
 
 		hash_table = nullptr;
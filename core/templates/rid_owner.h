@@ -35,11 +35,13 @@
 #include "core/os/spin_lock.h"
 #include "core/string/print_string.h"
 #include "core/templates/list.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/oa_hash_map.h"
 #include "core/templates/rid.h"
 #include "core/templates/safe_refcount.h"
 #include "core/templates/set.h"
 
+#include <atomic>
 #include <stdio.h>
 #include <typeinfo>
 
@@ -65,70 +67,113 @@ public:
 	virtual ~RID_AllocBase() {}
 };
 
+// Lookups (getornull, owns) never lock, even when THREAD_SAFE: chunk tables
+// are only appended to and replaced tables are kept alive until destruction,
+// and validators are atomic, so a reader always sees either a valid slot or a
+// mismatching validator. Allocating and freeing are serialized on a spin lock
+// that only guards the free list bookkeeping.
 template <class T, bool THREAD_SAFE = false>
 class RID_Alloc : public RID_AllocBase {
-	T **chunks = nullptr;
+	static constexpr std::memory_order ACQUIRE = THREAD_SAFE ? std::memory_order_acquire : std::memory_order_relaxed;
+	static constexpr std::memory_order RELEASE = THREAD_SAFE ? std::memory_order_release : std::memory_order_relaxed;
+
+	typedef std::atomic<uint32_t> Validator;
+
+	std::atomic<T **> chunks;
+	std::atomic<Validator **> validator_chunks;
 	uint32_t **free_list_chunks = nullptr;
-	uint32_t **validator_chunks = nullptr;
+	uint32_t chunk_capacity = 0;
 
 	uint32_t elements_in_chunk;
-	uint32_t max_alloc = 0;
+	std::atomic<uint32_t> max_alloc;
 	uint32_t alloc_count = 0;
 
+	// Chunk tables replaced while growing, a concurrent lookup may still be reading them.
+	LocalVector<void *> retired_tables;
+
 	const char *description = nullptr;
 
 	SpinLock spin_lock;
 
-	_FORCE_INLINE_ RID _allocate_rid() {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
+	template <class V>
+	V **_grow_table(V **p_table, uint32_t p_chunk_count, uint32_t p_new_capacity) {
+		V **table = (V **)memalloc(sizeof(V *) * p_new_capacity);
+		if (p_table) {
+			memcpy(table, p_table, sizeof(V *) * p_chunk_count);
+			if (THREAD_SAFE) {
+				retired_tables.push_back(p_table);
+			} else {
+				memfree(p_table);
+			}
 		}
+		return table;
+	}
 
-		if (alloc_count == max_alloc) {
-			//allocate a new chunk
-			uint32_t chunk_count = alloc_count == 0 ? 0 : (max_alloc / elements_in_chunk);
-
-			//grow chunks
-			chunks = (T **)memrealloc(chunks, sizeof(T *) * (chunk_count + 1));
-			chunks[chunk_count] = (T *)memalloc(sizeof(T) * elements_in_chunk); //but don't initialize
-
-			//grow validators
-			validator_chunks = (uint32_t **)memrealloc(validator_chunks, sizeof(uint32_t *) * (chunk_count + 1));
-			validator_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
-			//grow free lists
-			free_list_chunks = (uint32_t **)memrealloc(free_list_chunks, sizeof(uint32_t *) * (chunk_count + 1));
-			free_list_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
-
-			//initialize
-			for (uint32_t i = 0; i < elements_in_chunk; i++) {
-				// Don't initialize chunk.
-				validator_chunks[chunk_count][i] = 0xFFFFFFFF;
-				free_list_chunks[chunk_count][i] = alloc_count + i;
-			}
+	void _add_chunk() {
+		uint32_t max = max_alloc.load(std::memory_order_relaxed);
+		uint32_t chunk_count = max / elements_in_chunk;
+
+		T **chunk_table = chunks.load(std::memory_order_relaxed);
+		Validator **validator_table = validator_chunks.load(std::memory_order_relaxed);
 
-			max_alloc += elements_in_chunk;
+		if (chunk_count == chunk_capacity) {
+			chunk_capacity = MAX(chunk_capacity * 2, 4u);
+			chunk_table = _grow_table(chunk_table, chunk_count, chunk_capacity);
+			validator_table = _grow_table(validator_table, chunk_count, chunk_capacity);
+			free_list_chunks = (uint32_t **)memrealloc(free_list_chunks, sizeof(uint32_t *) * chunk_capacity);
 		}
 
-		uint32_t free_index = free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk];
+		chunk_table[chunk_count] = (T *)memalloc(sizeof(T) * elements_in_chunk); //but don't initialize
+		validator_table[chunk_count] = (Validator *)memalloc(sizeof(Validator) * elements_in_chunk);
+		free_list_chunks[chunk_count] = (uint32_t *)memalloc(sizeof(uint32_t) * elements_in_chunk);
 
-		uint32_t free_chunk = free_index / elements_in_chunk;
-		uint32_t free_element = free_index % elements_in_chunk;
+		//initialize
+		for (uint32_t i = 0; i < elements_in_chunk; i++) {
+			// Don't initialize chunk.
+			memnew_placement(&validator_table[chunk_count][i], Validator);
+			validator_table[chunk_count][i].store(0xFFFFFFFF, std::memory_order_relaxed);
+			free_list_chunks[chunk_count][i] = alloc_count + i;
+		}
+
+		// Publish the tables before the new size, lookups check the size first.
+		chunks.store(chunk_table, RELEASE);
+		validator_chunks.store(validator_table, RELEASE);
+		max_alloc.store(max + elements_in_chunk, RELEASE);
+	}
 
+	_FORCE_INLINE_ Validator &_get_validator(uint32_t p_idx) {
+		return validator_chunks.load(ACQUIRE)[p_idx / elements_in_chunk][p_idx % elements_in_chunk];
+	}
+
+	_FORCE_INLINE_ T *_get_element(uint32_t p_idx) {
+		return &chunks.load(ACQUIRE)[p_idx / elements_in_chunk][p_idx % elements_in_chunk];
+	}
+
+	_FORCE_INLINE_ RID _allocate_rid() {
 		uint32_t validator = (uint32_t)(_gen_id() & 0x7FFFFFFF);
-		uint64_t id = validator;
-		id <<= 32;
-		id |= free_index;
 
-		validator_chunks[free_chunk][free_element] = validator;
+		if (THREAD_SAFE) {
+			spin_lock.lock();
+		}
 
-		validator_chunks[free_chunk][free_element] |= 0x80000000; //mark uninitialized bit
+		if (alloc_count == max_alloc.load(std::memory_order_relaxed)) {
+			//allocate a new chunk
+			_add_chunk();
+		}
 
+		uint32_t free_index = free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk];
 		alloc_count++;
 
+		_get_validator(free_index).store(validator | 0x80000000, RELEASE); //mark uninitialized bit
+
 		if (THREAD_SAFE) {
 			spin_lock.unlock();
 		}
 
+		uint64_t id = validator;
+		id <<= 32;
+		id |= free_index;
+
 		return _make_from_id(id);
 	}
 
@@ -153,59 +198,38 @@ public:
 		if (p_rid == RID()) {
 			return nullptr;
 		}
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
 
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+		if (unlikely(idx >= max_alloc.load(ACQUIRE))) {
 			return nullptr;
 		}
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
-
 		uint32_t validator = uint32_t(id >> 32);
+		Validator &slot = _get_validator(idx);
 
 		if (unlikely(p_initialize)) {
-			if (unlikely(!(validator_chunks[idx_chunk][idx_element] & 0x80000000))) {
-				if (THREAD_SAFE) {
-					spin_lock.unlock();
+			// Only the uninitialized value for this validator may be cleared, so
+			// two threads can't both initialize the same RID.
+			uint32_t expected = validator | 0x80000000;
+			if (unlikely(!slot.compare_exchange_strong(expected, validator))) {
+				if (unlikely(!(expected & 0x80000000))) {
+					ERR_FAIL_V_MSG(nullptr, "Initializing already initialized RID");
 				}
-				ERR_FAIL_V_MSG(nullptr, "Initializing already initialized RID");
+				ERR_FAIL_V_MSG(nullptr, "Attempting to initialize the wrong RID");
 			}
 
-			if (unlikely((validator_chunks[idx_chunk][idx_element] & 0x7FFFFFFF) != validator)) {
-				if (THREAD_SAFE) {
-					spin_lock.unlock();
+		} else {
+			uint32_t current = slot.load(ACQUIRE);
+			if (unlikely(current != validator)) {
+				if ((current & 0x80000000) && current != 0xFFFFFFFF) {
+					ERR_FAIL_V_MSG(nullptr, "Attempting to use an uninitialized RID");
 				}
-				ERR_FAIL_V_MSG(nullptr, "Attempting to initialize the wrong RID");
 				return nullptr;
 			}
-
-			validator_chunks[idx_chunk][idx_element] &= 0x7FFFFFFF; //initialized
-
-		} else if (unlikely(validator_chunks[idx_chunk][idx_element] != validator)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			if ((validator_chunks[idx_chunk][idx_element] & 0x80000000) && validator_chunks[idx_chunk][idx_element] != 0xFFFFFFFF) {
-				ERR_FAIL_V_MSG(nullptr, "Attempting to use an uninitialized RID");
-			}
-			return nullptr;
-		}
-
-		T *ptr = &chunks[idx_chunk][idx_element];
-
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
 		}
 
-		return ptr;
+		return _get_element(idx);
 	}
 	void initialize_rid(RID p_rid) {
 		T *mem = getornull(p_rid, true);
@@ -219,65 +243,39 @@ public:
 	}
 
 	_FORCE_INLINE_ bool owns(const RID &p_rid) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
+		if (unlikely(idx >= max_alloc.load(ACQUIRE))) {
 			return false;
 		}
 
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
-
 		uint32_t validator = uint32_t(id >> 32);
-
-		bool owned = (validator_chunks[idx_chunk][idx_element] & 0x7FFFFFFF) == validator;
-
-		if (THREAD_SAFE) {
-			spin_lock.unlock();
-		}
-
-		return owned;
+		return (_get_validator(idx).load(ACQUIRE) & 0x7FFFFFFF) == validator;
 	}
 
 	_FORCE_INLINE_ void free(const RID &p_rid) {
-		if (THREAD_SAFE) {
-			spin_lock.lock();
-		}
-
 		uint64_t id = p_rid.get_id();
 		uint32_t idx = uint32_t(id & 0xFFFFFFFF);
-		if (unlikely(idx >= max_alloc)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			ERR_FAIL();
-		}
-
-		uint32_t idx_chunk = idx / elements_in_chunk;
-		uint32_t idx_element = idx % elements_in_chunk;
+		ERR_FAIL_COND(idx >= max_alloc.load(ACQUIRE));
 
 		uint32_t validator = uint32_t(id >> 32);
-		if (unlikely(validator_chunks[idx_chunk][idx_element] & 0x80000000)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
-			}
-			ERR_FAIL_MSG("Attempted to free an uninitialized or invalid RID");
-		} else if (unlikely(validator_chunks[idx_chunk][idx_element] != validator)) {
-			if (THREAD_SAFE) {
-				spin_lock.unlock();
+		Validator &slot = _get_validator(idx);
+
+		// Invalidate first, from here on lookups fail and a concurrent free of
+		// the same RID loses the exchange.
+		uint32_t expected = validator;
+		if (unlikely(!slot.compare_exchange_strong(expected, 0xFFFFFFFF))) {
+			if (expected & 0x80000000) {
+				ERR_FAIL_MSG("Attempted to free an uninitialized or invalid RID");
 			}
 			ERR_FAIL();
 		}
 
-		chunks[idx_chunk][idx_element].~T();
-		validator_chunks[idx_chunk][idx_element] = 0xFFFFFFFF; // go invalid
+		_get_element(idx)->~T();
+
+		if (THREAD_SAFE) {
+			spin_lock.lock();
+		}
 
 		alloc_count--;
 		free_list_chunks[alloc_count / elements_in_chunk][alloc_count % elements_in_chunk] = idx;
@@ -297,7 +295,7 @@ public:
 			spin_lock.lock();
 		}
 		uint64_t idx = free_list_chunks[p_index / elements_in_chunk][p_index % elements_in_chunk];
-		T *ptr = &chunks[idx / elements_in_chunk][idx % elements_in_chunk];
+		T *ptr = _get_element(idx);
 		if (THREAD_SAFE) {
 			spin_lock.unlock();
 		}
@@ -310,7 +308,7 @@ public:
 			spin_lock.lock();
 		}
 		uint64_t idx = free_list_chunks[p_index / elements_in_chunk][p_index % elements_in_chunk];
-		uint64_t validator = validator_chunks[idx / elements_in_chunk][idx % elements_in_chunk];
+		uint64_t validator = _get_validator(idx).load(std::memory_order_relaxed);
 
 		RID rid = _make_from_id((validator << 32) | idx);
 		if (THREAD_SAFE) {
@@ -323,8 +321,9 @@ public:
 		if (THREAD_SAFE) {
 			spin_lock.lock();
 		}
-		for (size_t i = 0; i < max_alloc; i++) {
-			uint64_t validator = validator_chunks[i / elements_in_chunk][i % elements_in_chunk];
+		uint32_t max = max_alloc.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < max; i++) {
+			uint64_t validator = _get_validator(i).load(std::memory_order_relaxed);
 			if (validator != 0xFFFFFFFF) {
 				p_owned->push_back(_make_from_id((validator << 32) | i));
 			}
@@ -340,9 +339,13 @@ public:
 
 	RID_Alloc(uint32_t p_target_chunk_byte_size = 65536) {
 		elements_in_chunk = sizeof(T) > p_target_chunk_byte_size ? 1 : (p_target_chunk_byte_size / sizeof(T));
+		chunks.store(nullptr);
+		validator_chunks.store(nullptr);
+		max_alloc.store(0);
 	}
 
 	~RID_Alloc() {
+		uint32_t max = max_alloc.load();
 		if (alloc_count) {
 			if (description) {
 				print_error("ERROR: " + itos(alloc_count) + " RID allocations of type '" + description + "' were leaked at exit.");
@@ -354,28 +357,34 @@ public:
 #endif
 			}
 
-			for (size_t i = 0; i < max_alloc; i++) {
-				uint64_t validator = validator_chunks[i / elements_in_chunk][i % elements_in_chunk];
+			for (size_t i = 0; i < max; i++) {
+				uint64_t validator = _get_validator(i).load();
 				if (validator & 0x80000000) {
 					continue; //uninitialized
 				}
 				if (validator != 0xFFFFFFFF) {
-					chunks[i / elements_in_chunk][i % elements_in_chunk].~T();
+					_get_element(i)->~T();
 				}
 			}
 		}
 
-		uint32_t chunk_count = max_alloc / elements_in_chunk;
+		T **chunk_table = chunks.load();
+		Validator **validator_table = validator_chunks.load();
+		uint32_t chunk_count = max / elements_in_chunk;
 		for (uint32_t i = 0; i < chunk_count; i++) {
-			memfree(chunks[i]);
-			memfree(validator_chunks[i]);
+			memfree(chunk_table[i]);
+			memfree(validator_table[i]);
 			memfree(free_list_chunks[i]);
 		}
 
-		if (chunks) {
-			memfree(chunks);
+		if (chunk_table) {
+			memfree(chunk_table);
 			memfree(free_list_chunks);
-			memfree(validator_chunks);
+			memfree(validator_table);
+		}
+
+		for (uint32_t i = 0; i < retired_tables.size(); i++) {
+			memfree(retired_tables[i]);
 		}
 	}
 };
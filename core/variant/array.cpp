@@ -190,20 +190,24 @@ void Array::operator=(const Array &p_array) {
 }
 
 void Array::push_back(const Variant &p_value) {
+	MemoryTagScope tag_scope(Memory::TAG_VARIANT);
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "push_back"));
 	_p->array.push_back(p_value);
 }
 
 void Array::append_array(const Array &p_array) {
+	MemoryTagScope tag_scope(Memory::TAG_VARIANT);
 	ERR_FAIL_COND(!_p->typed.validate(p_array, "append_array"));
 	_p->array.append_array(p_array._p->array);
 }
 
 Error Array::resize(int p_new_size) {
+	MemoryTagScope tag_scope(Memory::TAG_VARIANT);
 	return _p->array.resize(p_new_size);
 }
 
 void Array::insert(int p_pos, const Variant &p_value) {
+	MemoryTagScope tag_scope(Memory::TAG_VARIANT);
 	ERR_FAIL_COND(!_p->typed.validate(p_value, "insert"));
 	_p->array.insert(p_pos, p_value);
 }
@@ -601,7 +605,7 @@ const void *Array::id() const {
 }
 
 Array::Array(const Array &p_from, uint32_t p_type, const StringName &p_class_name, const Variant &p_script) {
-	_p = memnew(ArrayPrivate);
+	_p = memnew_tagged(Memory::TAG_VARIANT, ArrayPrivate);
 	_p->refcount.init();
 	set_typed(p_type, p_class_name, p_script);
 	_assign(p_from);
@@ -647,7 +651,7 @@ Array::Array(const Array &p_from) {
 }
 
 Array::Array() {
-	_p = memnew(ArrayPrivate);
+	_p = memnew_tagged(Memory::TAG_VARIANT, ArrayPrivate);
 	_p->refcount.init();
 }
 
@@ -0,0 +1,334 @@
+/*************************************************************************/
+/*  packed_array_math.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "packed_array_math.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PACKED_ARRAY_MATH_SSE2
+#endif
+
+// The kernels are written once against these lane types. ScalarLanes handles
+// the tails, and everything when SSE2 isn't available.
+template <class T>
+struct ScalarLanes {
+	typedef T Reg;
+	static const int COUNT = 1;
+	static _FORCE_INLINE_ Reg load(const T *p_ptr) { return *p_ptr; }
+	static _FORCE_INLINE_ Reg load_widened(const float *p_ptr) { return *p_ptr; }
+	static _FORCE_INLINE_ void store(T *p_ptr, Reg p_reg) { *p_ptr = p_reg; }
+	static _FORCE_INLINE_ Reg set(T p_value) { return p_value; }
+	static _FORCE_INLINE_ Reg add(Reg p_a, Reg p_b) { return p_a + p_b; }
+	static _FORCE_INLINE_ Reg sub(Reg p_a, Reg p_b) { return p_a - p_b; }
+	static _FORCE_INLINE_ Reg mul(Reg p_a, Reg p_b) { return p_a * p_b; }
+	static _FORCE_INLINE_ Reg min(Reg p_a, Reg p_b) { return p_a < p_b ? p_a : p_b; }
+	static _FORCE_INLINE_ Reg max(Reg p_a, Reg p_b) { return p_a > p_b ? p_a : p_b; }
+};
+
+template <class T>
+struct Lanes : public ScalarLanes<T> {};
+
+#ifdef PACKED_ARRAY_MATH_SSE2
+template <>
+struct Lanes<float> {
+	typedef __m128 Reg;
+	static const int COUNT = 4;
+	static _FORCE_INLINE_ Reg load(const float *p_ptr) { return _mm_loadu_ps(p_ptr); }
+	static _FORCE_INLINE_ void store(float *p_ptr, Reg p_reg) { _mm_storeu_ps(p_ptr, p_reg); }
+	static _FORCE_INLINE_ Reg set(float p_value) { return _mm_set1_ps(p_value); }
+	static _FORCE_INLINE_ Reg add(Reg p_a, Reg p_b) { return _mm_add_ps(p_a, p_b); }
+	static _FORCE_INLINE_ Reg sub(Reg p_a, Reg p_b) { return _mm_sub_ps(p_a, p_b); }
+	static _FORCE_INLINE_ Reg mul(Reg p_a, Reg p_b) { return _mm_mul_ps(p_a, p_b); }
+	static _FORCE_INLINE_ Reg min(Reg p_a, Reg p_b) { return _mm_min_ps(p_a, p_b); }
+	static _FORCE_INLINE_ Reg max(Reg p_a, Reg p_b) { return _mm_max_ps(p_a, p_b); }
+};
+
+template <>
+struct Lanes<double> {
+	typedef __m128d Reg;
+	static const int COUNT = 2;
+	static _FORCE_INLINE_ Reg load(const double *p_ptr) { return _mm_loadu_pd(p_ptr); }
+	static _FORCE_INLINE_ Reg load_widened(const float *p_ptr) { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)p_ptr))); }
+	static _FORCE_INLINE_ void store(double *p_ptr, Reg p_reg) { _mm_storeu_pd(p_ptr, p_reg); }
+	static _FORCE_INLINE_ Reg set(double p_value) { return _mm_set1_pd(p_value); }
+	static _FORCE_INLINE_ Reg add(Reg p_a, Reg p_b) { return _mm_add_pd(p_a, p_b); }
+	static _FORCE_INLINE_ Reg sub(Reg p_a, Reg p_b) { return _mm_sub_pd(p_a, p_b); }
+	static _FORCE_INLINE_ Reg mul(Reg p_a, Reg p_b) { return _mm_mul_pd(p_a, p_b); }
+	static _FORCE_INLINE_ Reg min(Reg p_a, Reg p_b) { return _mm_min_pd(p_a, p_b); }
+	static _FORCE_INLINE_ Reg max(Reg p_a, Reg p_b) { return _mm_max_pd(p_a, p_b); }
+};
+#endif
+
+// Stores p_op(r_values[i], p_other[i]) into r_values[i]. Operations that only
+// take a constant ignore p_other, which then points to r_values itself.
+template <class T, class Op>
+static _FORCE_INLINE_ void _map(T *r_values, const T *p_other, int64_t p_count, const Op &p_op) {
+	typedef Lanes<T> L;
+	int64_t i = 0;
+	for (; i + L::COUNT <= p_count; i += L::COUNT) {
+		L::store(r_values + i, p_op.template apply<L>(L::load(r_values + i), L::load(p_other + i)));
+	}
+	for (; i < p_count; i++) {
+		r_values[i] = p_op.template apply<ScalarLanes<T>>(r_values[i], p_other[i]);
+	}
+}
+
+// Folds p_op(accum, p_a[i], p_b[i]) into one accumulator per lane, which are
+// then combined with p_op.combine().
+template <class T, class Op>
+static _FORCE_INLINE_ T _reduce(const T *p_a, const T *p_b, int64_t p_count, T p_initial, const Op &p_op) {
+	typedef Lanes<T> L;
+	typename L::Reg accum = L::set(p_initial);
+	int64_t i = 0;
+	for (; i + L::COUNT <= p_count; i += L::COUNT) {
+		accum = p_op.template apply<L>(accum, L::load(p_a + i), L::load(p_b + i));
+	}
+	T lanes[L::COUNT];
+	L::store(lanes, accum);
+	T result = lanes[0];
+	for (int j = 1; j < L::COUNT; j++) {
+		result = p_op.template combine<ScalarLanes<T>>(result, lanes[j]);
+	}
+	for (; i < p_count; i++) {
+		result = p_op.template apply<ScalarLanes<T>>(result, p_a[i], p_b[i]);
+	}
+	return result;
+}
+
+// Same as _reduce(), but accumulates floats in double lanes.
+template <class Op>
+static _FORCE_INLINE_ double _reduce_widened(const float *p_a, const float *p_b, int64_t p_count, const Op &p_op) {
+	typedef Lanes<double> L;
+	typename L::Reg accum = L::set(0.0);
+	int64_t i = 0;
+	for (; i + L::COUNT <= p_count; i += L::COUNT) {
+		accum = p_op.template apply<L>(accum, L::load_widened(p_a + i), L::load_widened(p_b + i));
+	}
+	double lanes[L::COUNT];
+	L::store(lanes, accum);
+	double result = lanes[0];
+	for (int j = 1; j < L::COUNT; j++) {
+		result = p_op.template combine<ScalarLanes<double>>(result, lanes[j]);
+	}
+	for (; i < p_count; i++) {
+		result = p_op.template apply<ScalarLanes<double>>(result, p_a[i], p_b[i]);
+	}
+	return result;
+}
+
+template <class T>
+struct AddOp {
+	T value;
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_a, typename L::Reg p_b) const { return L::add(p_a, L::set(value)); }
+};
+
+template <class T>
+struct AddArrayOp {
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_a, typename L::Reg p_b) const { return L::add(p_a, p_b); }
+};
+
+template <class T>
+struct MultiplyOp {
+	T value;
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_a, typename L::Reg p_b) const { return L::mul(p_a, L::set(value)); }
+};
+
+template <class T>
+struct MultiplyArrayOp {
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_a, typename L::Reg p_b) const { return L::mul(p_a, p_b); }
+};
+
+template <class T>
+struct LerpOp {
+	T weight;
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_from, typename L::Reg p_to) const { return L::add(p_from, L::mul(L::sub(p_to, p_from), L::set(weight))); }
+};
+
+template <class T>
+struct ClampOp {
+	T min;
+	T max;
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_a, typename L::Reg p_b) const { return L::min(L::max(p_a, L::set(min)), L::set(max)); }
+};
+
+template <class T>
+struct DotOp {
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_accum, typename L::Reg p_a, typename L::Reg p_b) const { return L::add(p_accum, L::mul(p_a, p_b)); }
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg combine(typename L::Reg p_a, typename L::Reg p_b) const { return L::add(p_a, p_b); }
+};
+
+template <class T>
+struct SumOp {
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_accum, typename L::Reg p_a, typename L::Reg p_b) const { return L::add(p_accum, p_a); }
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg combine(typename L::Reg p_a, typename L::Reg p_b) const { return L::add(p_a, p_b); }
+};
+
+template <class T>
+struct MinOp {
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_accum, typename L::Reg p_a, typename L::Reg p_b) const { return L::min(p_accum, p_a); }
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg combine(typename L::Reg p_a, typename L::Reg p_b) const { return L::min(p_a, p_b); }
+};
+
+template <class T>
+struct MaxOp {
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg apply(typename L::Reg p_accum, typename L::Reg p_a, typename L::Reg p_b) const { return L::max(p_accum, p_a); }
+	template <class L>
+	_FORCE_INLINE_ typename L::Reg combine(typename L::Reg p_a, typename L::Reg p_b) const { return L::max(p_a, p_b); }
+};
+
+#define PACKED_ARRAY_MATH_KERNELS(m_type)                                                                         \
+	void PackedArrayMath::add(m_type *r_values, m_type p_value, int64_t p_count) {                                \
+		_map(r_values, r_values, p_count, AddOp<m_type>{ p_value });                                              \
+	}                                                                                                             \
+	void PackedArrayMath::add_array(m_type *r_values, const m_type *p_other, int64_t p_count) {                   \
+		_map(r_values, p_other, p_count, AddArrayOp<m_type>());                                                   \
+	}                                                                                                             \
+	void PackedArrayMath::multiply(m_type *r_values, m_type p_value, int64_t p_count) {                           \
+		_map(r_values, r_values, p_count, MultiplyOp<m_type>{ p_value });                                         \
+	}                                                                                                             \
+	void PackedArrayMath::multiply_array(m_type *r_values, const m_type *p_other, int64_t p_count) {              \
+		_map(r_values, p_other, p_count, MultiplyArrayOp<m_type>());                                              \
+	}                                                                                                             \
+	void PackedArrayMath::lerp_array(m_type *r_values, const m_type *p_to, m_type p_weight, int64_t p_count) {    \
+		_map(r_values, p_to, p_count, LerpOp<m_type>{ p_weight });                                                \
+	}                                                                                                             \
+	void PackedArrayMath::clamp(m_type *r_values, m_type p_min, m_type p_max, int64_t p_count) {                  \
+		_map(r_values, r_values, p_count, ClampOp<m_type>{ p_min, p_max });                                       \
+	}                                                                                                             \
+	m_type PackedArrayMath::min(const m_type *p_values, int64_t p_count) {                                        \
+		return _reduce(p_values, p_values, p_count, p_values[0], MinOp<m_type>());                                \
+	}                                                                                                             \
+	m_type PackedArrayMath::max(const m_type *p_values, int64_t p_count) {                                        \
+		return _reduce(p_values, p_values, p_count, p_values[0], MaxOp<m_type>());                                \
+	}
+
+PACKED_ARRAY_MATH_KERNELS(float)
+PACKED_ARRAY_MATH_KERNELS(double)
+
+#undef PACKED_ARRAY_MATH_KERNELS
+
+// Sums and dot products of floats are accumulated in double, float accumulators
+// would lose most of the precision of the result on large arrays.
+
+double PackedArrayMath::dot(const float *p_a, const float *p_b, int64_t p_count) {
+	return _reduce_widened(p_a, p_b, p_count, DotOp<double>());
+}
+
+double PackedArrayMath::dot(const double *p_a, const double *p_b, int64_t p_count) {
+	return _reduce(p_a, p_b, p_count, 0.0, DotOp<double>());
+}
+
+double PackedArrayMath::sum(const float *p_values, int64_t p_count) {
+	return _reduce_widened(p_values, p_values, p_count, SumOp<double>());
+}
+
+double PackedArrayMath::sum(const double *p_values, int64_t p_count) {
+	return _reduce(p_values, p_values, p_count, 0.0, SumOp<double>());
+}
+
+// The vector kernels are plain loops over the elements, which compilers
+// vectorize well enough on their own.
+
+void PackedArrayMath::add(Vector2 *r_values, const Vector2 &p_value, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_values[i] += p_value;
+	}
+}
+
+void PackedArrayMath::add(Vector3 *r_values, const Vector3 &p_value, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_values[i] += p_value;
+	}
+}
+
+void PackedArrayMath::clamp(Vector2 *r_values, const Vector2 &p_min, const Vector2 &p_max, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_values[i] = r_values[i].clamp(p_min, p_max);
+	}
+}
+
+void PackedArrayMath::clamp(Vector3 *r_values, const Vector3 &p_min, const Vector3 &p_max, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_values[i] = r_values[i].clamp(p_min, p_max);
+	}
+}
+
+void PackedArrayMath::dot(const Vector2 *p_values, const Vector2 &p_vector, float *r_dots, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_dots[i] = p_values[i].dot(p_vector);
+	}
+}
+
+void PackedArrayMath::dot(const Vector3 *p_values, const Vector3 &p_vector, float *r_dots, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_dots[i] = p_values[i].dot(p_vector);
+	}
+}
+
+Vector2 PackedArrayMath::sum(const Vector2 *p_values, int64_t p_count) {
+	Vector2 result;
+	for (int64_t i = 0; i < p_count; i++) {
+		result += p_values[i];
+	}
+	return result;
+}
+
+Vector3 PackedArrayMath::sum(const Vector3 *p_values, int64_t p_count) {
+	Vector3 result;
+	for (int64_t i = 0; i < p_count; i++) {
+		result += p_values[i];
+	}
+	return result;
+}
+
+void PackedArrayMath::transform(Vector2 *r_values, const Transform2D &p_transform, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_values[i] = p_transform.xform(r_values[i]);
+	}
+}
+
+void PackedArrayMath::transform(Vector3 *r_values, const Transform3D &p_transform, int64_t p_count) {
+	for (int64_t i = 0; i < p_count; i++) {
+		r_values[i] = p_transform.xform(r_values[i]);
+	}
+}
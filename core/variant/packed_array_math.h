@@ -0,0 +1,77 @@
+/*************************************************************************/
+/*  packed_array_math.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef PACKED_ARRAY_MATH_H
+#define PACKED_ARRAY_MATH_H
+
+#include "core/math/transform_2d.h"
+#include "core/math/transform_3d.h"
+
+// Elementwise kernels behind the bulk math methods of the packed arrays.
+// Operations work in place on the first array. Vector arrays reuse the
+// scalar kernels on their components where the operation allows it.
+class PackedArrayMath {
+public:
+	static void add(float *r_values, float p_value, int64_t p_count);
+	static void add(double *r_values, double p_value, int64_t p_count);
+	static void add_array(float *r_values, const float *p_other, int64_t p_count);
+	static void add_array(double *r_values, const double *p_other, int64_t p_count);
+	static void multiply(float *r_values, float p_value, int64_t p_count);
+	static void multiply(double *r_values, double p_value, int64_t p_count);
+	static void multiply_array(float *r_values, const float *p_other, int64_t p_count);
+	static void multiply_array(double *r_values, const double *p_other, int64_t p_count);
+	static void lerp_array(float *r_values, const float *p_to, float p_weight, int64_t p_count);
+	static void lerp_array(double *r_values, const double *p_to, double p_weight, int64_t p_count);
+	static void clamp(float *r_values, float p_min, float p_max, int64_t p_count);
+	static void clamp(double *r_values, double p_min, double p_max, int64_t p_count);
+
+	static double dot(const float *p_a, const float *p_b, int64_t p_count);
+	static double dot(const double *p_a, const double *p_b, int64_t p_count);
+	static double sum(const float *p_values, int64_t p_count);
+	static double sum(const double *p_values, int64_t p_count);
+	// Both require at least one value.
+	static float min(const float *p_values, int64_t p_count);
+	static double min(const double *p_values, int64_t p_count);
+	static float max(const float *p_values, int64_t p_count);
+	static double max(const double *p_values, int64_t p_count);
+
+	static void add(Vector2 *r_values, const Vector2 &p_value, int64_t p_count);
+	static void add(Vector3 *r_values, const Vector3 &p_value, int64_t p_count);
+	static void clamp(Vector2 *r_values, const Vector2 &p_min, const Vector2 &p_max, int64_t p_count);
+	static void clamp(Vector3 *r_values, const Vector3 &p_min, const Vector3 &p_max, int64_t p_count);
+	static void dot(const Vector2 *p_values, const Vector2 &p_vector, float *r_dots, int64_t p_count);
+	static void dot(const Vector3 *p_values, const Vector3 &p_vector, float *r_dots, int64_t p_count);
+	static Vector2 sum(const Vector2 *p_values, int64_t p_count);
+	static Vector3 sum(const Vector3 *p_values, int64_t p_count);
+	static void transform(Vector2 *r_values, const Transform2D &p_transform, int64_t p_count);
+	static void transform(Vector3 *r_values, const Transform3D &p_transform, int64_t p_count);
+};
+
+#endif // PACKED_ARRAY_MATH_H
@@ -39,6 +39,7 @@
 #include "core/os/os.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/oa_hash_map.h"
+#include "core/variant/packed_array_math.h"
 
 typedef void (*VariantFunc)(Variant &r_ret, Variant &p_self, const Variant **p_args);
 typedef void (*VariantConstructFunc)(Variant &r_ret, const Variant **p_args);
@@ -545,6 +546,28 @@ static _FORCE_INLINE_ void vc_ptrcall(void (*method)(T *, P...), void *p_base, c
 		}                                                                                                                                                         \
 	};
 
+// Packed array elements seen as COMPONENTS scalars of type S, so the same bulk
+// math kernels serve float and vector arrays.
+template <class E>
+struct PackedComponents {
+	typedef E S;
+	static const int COMPONENTS = 1;
+};
+
+template <>
+struct PackedComponents<Vector2> {
+	typedef real_t S;
+	static const int COMPONENTS = 2;
+};
+
+template <>
+struct PackedComponents<Vector3> {
+	typedef real_t S;
+	static const int COMPONENTS = 3;
+};
+
+static_assert(sizeof(Vector2) == 2 * sizeof(real_t) && sizeof(Vector3) == 3 * sizeof(real_t), "Vectors must be tightly packed for the bulk math kernels.");
+
 struct _VariantCall {
 	static String func_PackedByteArray_get_string_from_ascii(PackedByteArray *p_instance) {
 		String s;
@@ -873,6 +896,90 @@ struct _VariantCall {
 		return len;
 	}
 
+	// Bulk math, see PackedArrayMath. Vector arrays go through the scalar
+	// kernels on their components when the operation is componentwise.
+
+	template <class E>
+	static void func_PackedFloatArray_add(Vector<E> *p_instance, double p_value) {
+		PackedArrayMath::add(p_instance->ptrw(), E(p_value), p_instance->size());
+	}
+	template <class E>
+	static void func_PackedFloatArray_multiply(Vector<E> *p_instance, double p_value) {
+		PackedArrayMath::multiply(p_instance->ptrw(), E(p_value), p_instance->size());
+	}
+	template <class E>
+	static void func_PackedFloatArray_clamp(Vector<E> *p_instance, double p_min, double p_max) {
+		PackedArrayMath::clamp(p_instance->ptrw(), E(p_min), E(p_max), p_instance->size());
+	}
+	template <class E>
+	static double func_PackedFloatArray_dot(Vector<E> *p_instance, const Vector<E> &p_other) {
+		ERR_FAIL_COND_V_MSG(p_instance->size() != p_other.size(), 0, "Arrays must have the same size.");
+		return PackedArrayMath::dot(p_instance->ptr(), p_other.ptr(), p_instance->size());
+	}
+	template <class E>
+	static double func_PackedFloatArray_sum(Vector<E> *p_instance) {
+		return PackedArrayMath::sum(p_instance->ptr(), p_instance->size());
+	}
+	template <class E>
+	static double func_PackedFloatArray_min(Vector<E> *p_instance) {
+		ERR_FAIL_COND_V_MSG(p_instance->is_empty(), 0, "Can't get the minimum of an empty array.");
+		return PackedArrayMath::min(p_instance->ptr(), p_instance->size());
+	}
+	template <class E>
+	static double func_PackedFloatArray_max(Vector<E> *p_instance) {
+		ERR_FAIL_COND_V_MSG(p_instance->is_empty(), 0, "Can't get the maximum of an empty array.");
+		return PackedArrayMath::max(p_instance->ptr(), p_instance->size());
+	}
+
+	template <class E>
+	static void func_PackedArray_add_array(Vector<E> *p_instance, const Vector<E> &p_other) {
+		ERR_FAIL_COND_MSG(p_instance->size() != p_other.size(), "Arrays must have the same size.");
+		typedef typename PackedComponents<E>::S S;
+		PackedArrayMath::add_array((S *)p_instance->ptrw(), (const S *)p_other.ptr(), p_instance->size() * PackedComponents<E>::COMPONENTS);
+	}
+	template <class E>
+	static void func_PackedArray_multiply_array(Vector<E> *p_instance, const Vector<E> &p_other) {
+		ERR_FAIL_COND_MSG(p_instance->size() != p_other.size(), "Arrays must have the same size.");
+		typedef typename PackedComponents<E>::S S;
+		PackedArrayMath::multiply_array((S *)p_instance->ptrw(), (const S *)p_other.ptr(), p_instance->size() * PackedComponents<E>::COMPONENTS);
+	}
+	template <class E>
+	static void func_PackedArray_lerp_array(Vector<E> *p_instance, const Vector<E> &p_to, double p_weight) {
+		ERR_FAIL_COND_MSG(p_instance->size() != p_to.size(), "Arrays must have the same size.");
+		typedef typename PackedComponents<E>::S S;
+		PackedArrayMath::lerp_array((S *)p_instance->ptrw(), (const S *)p_to.ptr(), S(p_weight), p_instance->size() * PackedComponents<E>::COMPONENTS);
+	}
+
+	template <class E>
+	static void func_PackedVectorArray_add(Vector<E> *p_instance, const E &p_value) {
+		PackedArrayMath::add(p_instance->ptrw(), p_value, p_instance->size());
+	}
+	template <class E>
+	static void func_PackedVectorArray_multiply(Vector<E> *p_instance, double p_value) {
+		PackedArrayMath::multiply((real_t *)p_instance->ptrw(), real_t(p_value), p_instance->size() * PackedComponents<E>::COMPONENTS);
+	}
+	template <class E>
+	static void func_PackedVectorArray_clamp(Vector<E> *p_instance, const E &p_min, const E &p_max) {
+		PackedArrayMath::clamp(p_instance->ptrw(), p_min, p_max, p_instance->size());
+	}
+	template <class E>
+	static PackedFloat32Array func_PackedVectorArray_dot(Vector<E> *p_instance, const E &p_vector) {
+		PackedFloat32Array dots;
+		dots.resize(p_instance->size());
+		PackedArrayMath::dot(p_instance->ptr(), p_vector, dots.ptrw(), p_instance->size());
+		return dots;
+	}
+	template <class E>
+	static E func_PackedVectorArray_sum(Vector<E> *p_instance) {
+		return PackedArrayMath::sum(p_instance->ptr(), p_instance->size());
+	}
+	static void func_PackedVector2Array_transform(PackedVector2Array *p_instance, const Transform2D &p_transform) {
+		PackedArrayMath::transform(p_instance->ptrw(), p_transform, p_instance->size());
+	}
+	static void func_PackedVector3Array_transform(PackedVector3Array *p_instance, const Transform3D &p_transform) {
+		PackedArrayMath::transform(p_instance->ptrw(), p_transform, p_instance->size());
+	}
+
 	static void func_Callable_call(Variant *v, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) {
 		Callable *callable = VariantGetInternalPtr<Callable>::get_ptr(v);
 		callable->call(p_args, p_argcount, r_ret, r_error);
@@ -1934,6 +2041,16 @@ static void _register_variant_builtin_methods() {
 	bind_method(PackedFloat32Array, to_byte_array, sarray(), varray());
 	bind_method(PackedFloat32Array, sort, sarray(), varray());
 	bind_method(PackedFloat32Array, duplicate, sarray(), varray());
+	bind_functionnc(PackedFloat32Array, add, _VariantCall::func_PackedFloatArray_add<float>, sarray("value"), varray());
+	bind_functionnc(PackedFloat32Array, add_array, _VariantCall::func_PackedArray_add_array<float>, sarray("array"), varray());
+	bind_functionnc(PackedFloat32Array, multiply, _VariantCall::func_PackedFloatArray_multiply<float>, sarray("value"), varray());
+	bind_functionnc(PackedFloat32Array, multiply_array, _VariantCall::func_PackedArray_multiply_array<float>, sarray("array"), varray());
+	bind_functionnc(PackedFloat32Array, lerp_array, _VariantCall::func_PackedArray_lerp_array<float>, sarray("to", "weight"), varray());
+	bind_functionnc(PackedFloat32Array, clamp, _VariantCall::func_PackedFloatArray_clamp<float>, sarray("min", "max"), varray());
+	bind_function(PackedFloat32Array, dot, _VariantCall::func_PackedFloatArray_dot<float>, sarray("array"), varray());
+	bind_function(PackedFloat32Array, sum, _VariantCall::func_PackedFloatArray_sum<float>, sarray(), varray());
+	bind_function(PackedFloat32Array, min, _VariantCall::func_PackedFloatArray_min<float>, sarray(), varray());
+	bind_function(PackedFloat32Array, max, _VariantCall::func_PackedFloatArray_max<float>, sarray(), varray());
 
 	/* Float64 Array */
 
@@ -1953,6 +2070,16 @@ static void _register_variant_builtin_methods() {
 	bind_method(PackedFloat64Array, to_byte_array, sarray(), varray());
 	bind_method(PackedFloat64Array, sort, sarray(), varray());
 	bind_method(PackedFloat64Array, duplicate, sarray(), varray());
+	bind_functionnc(PackedFloat64Array, add, _VariantCall::func_PackedFloatArray_add<double>, sarray("value"), varray());
+	bind_functionnc(PackedFloat64Array, add_array, _VariantCall::func_PackedArray_add_array<double>, sarray("array"), varray());
+	bind_functionnc(PackedFloat64Array, multiply, _VariantCall::func_PackedFloatArray_multiply<double>, sarray("value"), varray());
+	bind_functionnc(PackedFloat64Array, multiply_array, _VariantCall::func_PackedArray_multiply_array<double>, sarray("array"), varray());
+	bind_functionnc(PackedFloat64Array, lerp_array, _VariantCall::func_PackedArray_lerp_array<double>, sarray("to", "weight"), varray());
+	bind_functionnc(PackedFloat64Array, clamp, _VariantCall::func_PackedFloatArray_clamp<double>, sarray("min", "max"), varray());
+	bind_function(PackedFloat64Array, dot, _VariantCall::func_PackedFloatArray_dot<double>, sarray("array"), varray());
+	bind_function(PackedFloat64Array, sum, _VariantCall::func_PackedFloatArray_sum<double>, sarray(), varray());
+	bind_function(PackedFloat64Array, min, _VariantCall::func_PackedFloatArray_min<double>, sarray(), varray());
+	bind_function(PackedFloat64Array, max, _VariantCall::func_PackedFloatArray_max<double>, sarray(), varray());
 
 	/* String Array */
 
@@ -1991,6 +2118,15 @@ static void _register_variant_builtin_methods() {
 	bind_method(PackedVector2Array, to_byte_array, sarray(), varray());
 	bind_method(PackedVector2Array, sort, sarray(), varray());
 	bind_method(PackedVector2Array, duplicate, sarray(), varray());
+	bind_functionnc(PackedVector2Array, add, _VariantCall::func_PackedVectorArray_add<Vector2>, sarray("value"), varray());
+	bind_functionnc(PackedVector2Array, add_array, _VariantCall::func_PackedArray_add_array<Vector2>, sarray("array"), varray());
+	bind_functionnc(PackedVector2Array, multiply, _VariantCall::func_PackedVectorArray_multiply<Vector2>, sarray("value"), varray());
+	bind_functionnc(PackedVector2Array, multiply_array, _VariantCall::func_PackedArray_multiply_array<Vector2>, sarray("array"), varray());
+	bind_functionnc(PackedVector2Array, lerp_array, _VariantCall::func_PackedArray_lerp_array<Vector2>, sarray("to", "weight"), varray());
+	bind_functionnc(PackedVector2Array, clamp, _VariantCall::func_PackedVectorArray_clamp<Vector2>, sarray("min", "max"), varray());
+	bind_function(PackedVector2Array, dot, _VariantCall::func_PackedVectorArray_dot<Vector2>, sarray("vector"), varray());
+	bind_function(PackedVector2Array, sum, _VariantCall::func_PackedVectorArray_sum<Vector2>, sarray(), varray());
+	bind_functionnc(PackedVector2Array, transform, _VariantCall::func_PackedVector2Array_transform, sarray("transform"), varray());
 
 	/* Vector3 Array */
 
@@ -2010,6 +2146,15 @@ static void _register_variant_builtin_methods() {
 	bind_method(PackedVector3Array, to_byte_array, sarray(), varray());
 	bind_method(PackedVector3Array, sort, sarray(), varray());
 	bind_method(PackedVector3Array, duplicate, sarray(), varray());
+	bind_functionnc(PackedVector3Array, add, _VariantCall::func_PackedVectorArray_add<Vector3>, sarray("value"), varray());
+	bind_functionnc(PackedVector3Array, add_array, _VariantCall::func_PackedArray_add_array<Vector3>, sarray("array"), varray());
+	bind_functionnc(PackedVector3Array, multiply, _VariantCall::func_PackedVectorArray_multiply<Vector3>, sarray("value"), varray());
+	bind_functionnc(PackedVector3Array, multiply_array, _VariantCall::func_PackedArray_multiply_array<Vector3>, sarray("array"), varray());
+	bind_functionnc(PackedVector3Array, lerp_array, _VariantCall::func_PackedArray_lerp_array<Vector3>, sarray("to", "weight"), varray());
+	bind_functionnc(PackedVector3Array, clamp, _VariantCall::func_PackedVectorArray_clamp<Vector3>, sarray("min", "max"), varray());
+	bind_function(PackedVector3Array, dot, _VariantCall::func_PackedVectorArray_dot<Vector3>, sarray("vector"), varray());
+	bind_function(PackedVector3Array, sum, _VariantCall::func_PackedVectorArray_sum<Vector3>, sarray(), varray());
+	bind_functionnc(PackedVector3Array, transform, _VariantCall::func_PackedVector3Array_transform, sarray("transform"), varray());
 
 	/* Color Array */
 
@@ -41,6 +41,7 @@
 #include <errno.h>
 
 #if defined(UNIX_ENABLED)
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -71,6 +72,7 @@ void FileAccessUnix::check_errors() const {
 }
 
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
+	_unmap();
 	if (f) {
 		fclose(f);
 	}
@@ -153,6 +155,7 @@ void FileAccessUnix::close() {
 		return;
 	}
 
+	_unmap();
 	fclose(f);
 	f = nullptr;
 
@@ -334,6 +337,44 @@ Error FileAccessUnix::_set_unix_permissions(const String &p_file, uint32_t p_per
 	return FAILED;
 }
 
+const uint8_t *FileAccessUnix::map_read_only() {
+#if defined(UNIX_ENABLED)
+	ERR_FAIL_COND_V_MSG(!f, nullptr, "File must be opened before use.");
+
+	if (mapping) {
+		return mapping;
+	}
+	if (flags != READ) {
+		return nullptr;
+	}
+
+	struct stat st;
+	if (fstat(fileno(f), &st) != 0 || st.st_size <= 0 || uint64_t(st.st_size) > SIZE_MAX) {
+		return nullptr;
+	}
+
+	void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (ptr == MAP_FAILED) {
+		return nullptr;
+	}
+	mapping = (uint8_t *)ptr;
+	mapping_size = st.st_size;
+	return mapping;
+#else
+	return nullptr;
+#endif
+}
+
+void FileAccessUnix::_unmap() {
+#if defined(UNIX_ENABLED)
+	if (mapping) {
+		munmap(mapping, mapping_size);
+		mapping = nullptr;
+		mapping_size = 0;
+	}
+#endif
+}
+
 FileAccess *FileAccessUnix::create_libc() {
 	return memnew(FileAccessUnix);
 }
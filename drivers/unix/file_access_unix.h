@@ -48,7 +48,10 @@ class FileAccessUnix : public FileAccess {
 	String save_path;
 	String path;
 	String path_src;
+	uint8_t *mapping = nullptr;
+	uint64_t mapping_size = 0;
 
+	void _unmap();
 	static FileAccess *create_libc();
 
 public:
@@ -79,6 +82,8 @@ public:
 
 	virtual bool file_exists(const String &p_path); ///< return true if a file exists
 
+	virtual const uint8_t *map_read_only();
+
 	virtual uint64_t _get_modified_time(const String &p_file);
 	virtual uint32_t _get_unix_permissions(const String &p_file);
 	virtual Error _set_unix_permissions(const String &p_file, uint32_t p_permissions);
@@ -65,6 +65,12 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define BACKTRACE_ENABLED
+#include <cxxabi.h>
+#include <execinfo.h>
+#endif
+
 /// Clock Setup function (used by get_ticks_usec)
 static uint64_t _clock_start = 0;
 #if defined(__APPLE__)
@@ -111,6 +117,39 @@ void OS_Unix::initialize_debugging() {
 	}
 }
 
+int OS_Unix::get_backtrace(void **r_frames, int p_max_frames) const {
+#ifdef BACKTRACE_ENABLED
+	return backtrace(r_frames, p_max_frames);
+#else
+	return 0;
+#endif
+}
+
+String OS_Unix::get_backtrace_symbol(void *p_address) const {
+	Dl_info info;
+	if (!dladdr(p_address, &info)) {
+		return String::num_uint64(uint64_t(p_address), 16);
+	}
+	if (!info.dli_sname) {
+		// Not exported, report the offset within the binary so it can be resolved offline.
+		return String::utf8(info.dli_fname).get_file() + "+" + String::num_uint64(uint64_t(p_address) - uint64_t(info.dli_fbase), 16);
+	}
+	String name = String::utf8(info.dli_sname);
+#ifdef BACKTRACE_ENABLED
+	if (info.dli_sname[0] == '_') {
+		int status;
+		char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+		if (status == 0 && demangled) {
+			name = String::utf8(demangled);
+		}
+		if (demangled) {
+			free(demangled);
+		}
+	}
+#endif
+	return name;
+}
+
 int OS_Unix::unix_initialize_audio(int p_audio_driver) {
 	return 0;
 }
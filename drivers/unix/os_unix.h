@@ -95,6 +95,8 @@ public:
 
 	virtual void debug_break() override;
 	virtual void initialize_debugging() override;
+	virtual int get_backtrace(void **r_frames, int p_max_frames) const override;
+	virtual String get_backtrace_symbol(void *p_address) const override;
 
 	virtual String get_executable_path() const override;
 	virtual String get_user_data_dir() const override;
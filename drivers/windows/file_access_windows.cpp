@@ -39,6 +39,7 @@
 #include <windows.h>
 
 #include <errno.h>
+#include <io.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <tchar.h>
@@ -132,11 +133,51 @@ Error FileAccessWindows::_open(const String &p_path, int p_mode_flags) {
 	}
 }
 
+const uint8_t *FileAccessWindows::map_read_only() {
+	ERR_FAIL_COND_V_MSG(!f, nullptr, "File must be opened before use.");
+
+	if (mapping) {
+		return mapping;
+	}
+	if (flags != READ) {
+		return nullptr;
+	}
+
+	HANDLE file_handle = (HANDLE)_get_osfhandle(_fileno(f));
+	LARGE_INTEGER size;
+	if (file_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_handle, &size) || size.QuadPart <= 0 || uint64_t(size.QuadPart) > SIZE_MAX) {
+		return nullptr;
+	}
+
+	mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_handle) {
+		return nullptr;
+	}
+	mapping = (const uint8_t *)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if (!mapping) {
+		CloseHandle(mapping_handle);
+		mapping_handle = nullptr;
+	}
+	return mapping;
+}
+
+void FileAccessWindows::_unmap() {
+	if (mapping) {
+		UnmapViewOfFile(mapping);
+		mapping = nullptr;
+	}
+	if (mapping_handle) {
+		CloseHandle(mapping_handle);
+		mapping_handle = nullptr;
+	}
+}
+
 void FileAccessWindows::close() {
 	if (!f) {
 		return;
 	}
 
+	_unmap();
 	fclose(f);
 	f = nullptr;
 
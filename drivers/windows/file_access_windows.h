@@ -47,6 +47,10 @@ class FileAccessWindows : public FileAccess {
 	String path;
 	String path_src;
 	String save_path;
+	void *mapping_handle = nullptr;
+	const uint8_t *mapping = nullptr;
+
+	void _unmap();
 
 public:
 	virtual Error _open(const String &p_path, int p_mode_flags); ///< open a file
@@ -74,6 +78,8 @@ public:
 
 	virtual bool file_exists(const String &p_name); ///< return true if a file exists
 
+	virtual const uint8_t *map_read_only();
+
 	uint64_t _get_modified_time(const String &p_file);
 	virtual uint32_t _get_unix_permissions(const String &p_file);
 	virtual Error _set_unix_permissions(const String &p_file, uint32_t p_permissions);
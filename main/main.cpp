@@ -34,6 +34,9 @@
 #include "core/core_string_names.h"
 #include "core/crypto/crypto.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/debugger/sampling_profiler.h"
+#include "core/debugger/thread_buffer_registry.h"
+#include "core/debugger/trace.h"
 #include "core/extension/extension_api_dump.h"
 #include "core/input/input.h"
 #include "core/input/input_map.h"
@@ -47,6 +50,7 @@
 #include "core/object/message_queue.h"
 #include "core/os/os.h"
 #include "core/os/time.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/register_core_types.h"
 #include "core/string/translation.h"
 #include "core/version.h"
@@ -175,6 +179,9 @@ static int frame_delay = 0;
 static bool disable_render_loop = false;
 static int fixed_fps = -1;
 static bool print_fps = false;
+static String trace_path;
+static String sampling_profile_path;
+static uint32_t sampling_interval_usec = SamplingProfiler::DEFAULT_INTERVAL_USEC;
 #ifdef TOOLS_ENABLED
 static bool dump_extension_api = false;
 #endif
@@ -362,6 +369,9 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  --fixed-fps <fps>                            Force a fixed number of frames per second. This setting disables real-time synchronization.\n");
 	OS::get_singleton()->print("  --print-fps                                  Print the frames per second to the stdout.\n");
 	OS::get_singleton()->print("  --profile-gpu                                Show a simple profile of the tasks that took more time during frame rendering.\n");
+	OS::get_singleton()->print("  --trace <file>                               Record trace zones and save the most recent ones to a Chrome/Perfetto JSON trace file on exit.\n");
+	OS::get_singleton()->print("  --sample-scripts <file>                      Sample the script call stacks and save them in the collapsed flamegraph format on exit.\n");
+	OS::get_singleton()->print("  --sample-interval <usec>                     Time between two script stack samples, in microseconds (default: 1000).\n");
 	OS::get_singleton()->print("\n");
 
 	OS::get_singleton()->print("Standalone tools:\n");
@@ -401,6 +411,10 @@ Error Main::test_setup() {
 
 	globals = memnew(ProjectSettings);
 
+	register_core_settings(); //here globals are present
+
+	WorkerThreadPool::get_singleton()->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+
 	GLOBAL_DEF("debug/settings/crash_handler/message",
 			String("Please include this when reporting the bug on https://github.com/godotengine/godot/issues"));
 
@@ -1028,6 +1042,31 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 			print_fps = true;
 		} else if (I->get() == "--profile-gpu") {
 			profile_gpu = true;
+		} else if (I->get() == "--trace") {
+			if (I->next()) {
+				trace_path = I->next()->get();
+				Trace::start();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing trace file argument, aborting.\n");
+				goto error;
+			}
+		} else if (I->get() == "--sample-scripts") {
+			if (I->next()) {
+				sampling_profile_path = I->next()->get();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing sampling profile file argument, aborting.\n");
+				goto error;
+			}
+		} else if (I->get() == "--sample-interval") {
+			if (I->next() && I->next()->get().to_int() > 0) {
+				sampling_interval_usec = I->next()->get().to_int();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing or invalid sampling interval argument, aborting.\n");
+				goto error;
+			}
 		} else if (I->get() == "--disable-crash-handler") {
 			OS::get_singleton()->disable_crash_handler();
 		} else if (I->get() == "--skip-breakpoints") {
@@ -1039,6 +1078,10 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 		I = N;
 	}
 
+	if (!sampling_profile_path.is_empty()) {
+		SamplingProfiler::start(sampling_interval_usec);
+	}
+
 #ifdef TOOLS_ENABLED
 	if (editor && project_manager) {
 		OS::get_singleton()->print(
@@ -1090,6 +1133,8 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 
 	ResourceUID::get_singleton()->load_from_cache(); // load UUIDs from cache.
 
+	WorkerThreadPool::get_singleton()->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+
 	GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc",
 			PropertyInfo(Variant::INT,
@@ -1406,6 +1451,9 @@ error:
 
 	EngineDebugger::deinitialize();
 
+	SamplingProfiler::finish();
+	DebugThreadNames::cleanup();
+
 	if (performance) {
 		memdelete(performance);
 	}
@@ -2456,6 +2504,8 @@ bool Main::iteration() {
 
 	iterating++;
 
+	TRACE_ZONE("Main::iteration");
+
 	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
 	Engine::get_singleton()->_frame_ticks = ticks;
 	main_timer_sync.set_cpu_ticks_usec(ticks);
@@ -2493,6 +2543,7 @@ bool Main::iteration() {
 	Engine::get_singleton()->_in_physics = true;
 
 	for (int iters = 0; iters < advance.physics_steps; ++iters) {
+		TRACE_ZONE("Main::physics_step");
 		uint64_t physics_begin = OS::get_singleton()->get_ticks_usec();
 
 		PhysicsServer3D::get_singleton()->sync();
@@ -2577,6 +2628,7 @@ bool Main::iteration() {
 		Engine::get_singleton()->_fps = frames;
 		performance->set_process_time(USEC_TO_SEC(process_max));
 		performance->set_physics_process_time(USEC_TO_SEC(physics_process_max));
+		performance->update_allocation_rates();
 		process_max = 0;
 		physics_process_max = 0;
 
@@ -2627,6 +2679,16 @@ void Main::cleanup(bool p_force) {
 
 	EngineDebugger::deinitialize();
 
+	if (!trace_path.is_empty()) {
+		Trace::stop();
+		Trace::save(trace_path);
+	}
+
+	if (!sampling_profile_path.is_empty()) {
+		SamplingProfiler::stop();
+		SamplingProfiler::save(sampling_profile_path);
+	}
+
 	ResourceLoader::remove_custom_loaders();
 	ResourceSaver::remove_custom_savers();
 
@@ -2730,5 +2792,9 @@ void Main::cleanup(bool p_force) {
 	unregister_core_driver_types();
 	unregister_core_types();
 
+	Trace::finish();
+	SamplingProfiler::finish();
+	DebugThreadNames::cleanup();
+
 	OS::get_singleton()->finalize_core();
 }
@@ -73,6 +73,20 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_DEFAULT);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_VARIANT);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_SCRIPT);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_RESOURCE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_IMAGE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_RENDERING);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_PHYSICS);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_DEFAULT_ALLOCATION_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_VARIANT_ALLOCATION_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_SCRIPT_ALLOCATION_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_RESOURCE_ALLOCATION_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_IMAGE_ALLOCATION_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_RENDERING_ALLOCATION_RATE);
+	BIND_ENUM_CONSTANT(MEMORY_TAG_PHYSICS_ALLOCATION_RATE);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -112,6 +126,20 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/driver/output_latency",
+		"memory_tags/default",
+		"memory_tags/variant",
+		"memory_tags/script",
+		"memory_tags/resource",
+		"memory_tags/image",
+		"memory_tags/rendering",
+		"memory_tags/physics",
+		"memory_tag_allocations/default",
+		"memory_tag_allocations/variant",
+		"memory_tag_allocations/script",
+		"memory_tag_allocations/resource",
+		"memory_tag_allocations/image",
+		"memory_tag_allocations/rendering",
+		"memory_tag_allocations/physics",
 
 	};
 
@@ -166,6 +194,22 @@ double Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case MEMORY_TAG_DEFAULT:
+		case MEMORY_TAG_VARIANT:
+		case MEMORY_TAG_SCRIPT:
+		case MEMORY_TAG_RESOURCE:
+		case MEMORY_TAG_IMAGE:
+		case MEMORY_TAG_RENDERING:
+		case MEMORY_TAG_PHYSICS:
+			return Memory::get_tag_usage(Memory::Tag(p_monitor - MEMORY_TAG_DEFAULT));
+		case MEMORY_TAG_DEFAULT_ALLOCATION_RATE:
+		case MEMORY_TAG_VARIANT_ALLOCATION_RATE:
+		case MEMORY_TAG_SCRIPT_ALLOCATION_RATE:
+		case MEMORY_TAG_RESOURCE_ALLOCATION_RATE:
+		case MEMORY_TAG_IMAGE_ALLOCATION_RATE:
+		case MEMORY_TAG_RENDERING_ALLOCATION_RATE:
+		case MEMORY_TAG_PHYSICS_ALLOCATION_RATE:
+			return _allocation_rates[p_monitor - MEMORY_TAG_DEFAULT_ALLOCATION_RATE];
 
 		default: {
 		}
@@ -201,6 +245,20 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -215,6 +273,20 @@ void Performance::set_physics_process_time(double p_pt) {
 	_physics_process_time = p_pt;
 }
 
+// Called about once per second from the main loop.
+void Performance::update_allocation_rates() {
+	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+	double elapsed = USEC_TO_SEC(ticks - _allocation_rate_ticks);
+	for (int i = 0; i < Memory::TAG_MAX; i++) {
+		uint64_t count = Memory::get_tag_allocation_count(Memory::Tag(i));
+		if (_allocation_rate_ticks > 0 && elapsed > 0) {
+			_allocation_rates[i] = (count - _allocation_counts[i]) / elapsed;
+		}
+		_allocation_counts[i] = count;
+	}
+	_allocation_rate_ticks = ticks;
+}
+
 void Performance::add_custom_monitor(const StringName &p_id, const Callable &p_callable, const Vector<Variant> &p_args) {
 	ERR_FAIL_COND_MSG(has_custom_monitor(p_id), "Custom monitor with id '" + String(p_id) + "' already exists.");
 	_monitor_map.insert(p_id, MonitorCall(p_callable, p_args));
@@ -48,6 +48,10 @@ class Performance : public Object {
 	double _process_time;
 	double _physics_process_time;
 
+	uint64_t _allocation_rate_ticks = 0;
+	uint64_t _allocation_counts[Memory::TAG_MAX] = {};
+	double _allocation_rates[Memory::TAG_MAX] = {};
+
 	class MonitorCall {
 		Callable _callable;
 		Vector<Variant> _arguments;
@@ -87,6 +91,22 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		// Live bytes per allocation tag, only tracked in debug builds.
+		MEMORY_TAG_DEFAULT,
+		MEMORY_TAG_VARIANT,
+		MEMORY_TAG_SCRIPT,
+		MEMORY_TAG_RESOURCE,
+		MEMORY_TAG_IMAGE,
+		MEMORY_TAG_RENDERING,
+		MEMORY_TAG_PHYSICS,
+		// Allocations per second per tag.
+		MEMORY_TAG_DEFAULT_ALLOCATION_RATE,
+		MEMORY_TAG_VARIANT_ALLOCATION_RATE,
+		MEMORY_TAG_SCRIPT_ALLOCATION_RATE,
+		MEMORY_TAG_RESOURCE_ALLOCATION_RATE,
+		MEMORY_TAG_IMAGE_ALLOCATION_RATE,
+		MEMORY_TAG_RENDERING_ALLOCATION_RATE,
+		MEMORY_TAG_PHYSICS_ALLOCATION_RATE,
 		MONITOR_MAX
 	};
 
@@ -103,6 +123,7 @@ public:
 
 	void set_process_time(double p_pt);
 	void set_physics_process_time(double p_pt);
+	void update_allocation_rates();
 
 	void add_custom_monitor(const StringName &p_id, const Callable &p_callable, const Vector<Variant> &p_args);
 	void remove_custom_monitor(const StringName &p_id);
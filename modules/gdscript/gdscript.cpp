@@ -40,6 +40,7 @@
 #include "core/io/file_access_encrypted.h"
 #include "core/os/os.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode.h"
 #include "gdscript_cache.h"
 #include "gdscript_compiler.h"
 #include "gdscript_parser.h"
@@ -101,6 +102,7 @@ void GDScript::_super_implicit_constructor(GDScript *p_script, GDScriptInstance
 GDScriptInstance *GDScript::_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_is_ref_counted, Callable::CallError &r_error) {
 	/* STEP 1, CREATE */
 
+	MemoryTagScope tag_scope(Memory::TAG_SCRIPT);
 	GDScriptInstance *instance = memnew(GDScriptInstance);
 	instance->base_ref_counted = p_is_ref_counted;
 	instance->members.resize(member_indices.size());
@@ -386,6 +388,7 @@ void GDScript::set_source_code(const String &p_code) {
 		return;
 	}
 	source = p_code;
+	byte_code.clear();
 #ifdef TOOLS_ENABLED
 	source_changed_cache = true;
 #endif
@@ -784,6 +787,8 @@ Error GDScript::reload(bool p_keep_state) {
 
 	ERR_FAIL_COND_V(!p_keep_state && has_instances, ERR_ALREADY_IN_USE);
 
+	GDScriptCache::CompileScope compile_scope;
+
 	String basedir = path;
 
 	if (basedir == "") {
@@ -805,13 +810,42 @@ Error GDScript::reload(bool p_keep_state) {
 			source_path = get_path();
 		}
 		if (!source_path.is_empty()) {
-			MutexLock lock(GDScriptCache::singleton->lock);
+			MutexLock lock(GDScriptCache::get_lock());
 			if (!GDScriptCache::singleton->shallow_gdscript_cache.has(source_path)) {
 				GDScriptCache::singleton->shallow_gdscript_cache[source_path] = this;
 			}
 		}
 	}
 
+	if (!byte_code.is_empty()) {
+		if (valid) {
+			return OK; // Precompiled scripts can't change.
+		}
+
+		String error;
+		Error err = GDScriptBytecode::deserialize(this, byte_code, &error);
+		if (err == OK) {
+			err = GDScriptCache::finish_compiling(get_path());
+			if (err) {
+				return err;
+			}
+
+			for (Map<StringName, Ref<GDScript>>::Element *E = subclasses.front(); E; E = E->next()) {
+				_set_subclass_path(E->get(), path);
+			}
+			_init_rpc_methods_properties();
+			return OK;
+		}
+
+		// Fall back to the embedded source.
+		if (err == ERR_FILE_UNRECOGNIZED) {
+			print_verbose("Compiling '" + path + "' from source: " + error);
+		} else {
+			WARN_PRINT("Can't load precompiled script '" + path + "', compiling it from source: " + error);
+		}
+		byte_code.clear();
+	}
+
 	valid = false;
 	GDScriptParser parser;
 	Error err = parser.parse(source, path, false);
@@ -840,10 +874,15 @@ Error GDScript::reload(bool p_keep_state) {
 		ERR_FAIL_V(ERR_PARSE_ERROR);
 	}
 
-	bool can_run = ScriptServer::is_scripting_enabled() || parser.is_tool();
+	return _compile(&parser, p_keep_state);
+}
+
+// Generates the code from an analyzed parser, also used when compiling in a batch.
+Error GDScript::_compile(const GDScriptParser *p_parser, bool p_keep_state) {
+	bool can_run = ScriptServer::is_scripting_enabled() || p_parser->is_tool();
 
 	GDScriptCompiler compiler;
-	err = compiler.compile(&parser, this, p_keep_state);
+	Error err = compiler.compile(p_parser, this, p_keep_state);
 
 #ifdef TOOLS_ENABLED
 	_update_doc();
@@ -861,7 +900,7 @@ Error GDScript::reload(bool p_keep_state) {
 		}
 	}
 #ifdef DEBUG_ENABLED
-	for (const GDScriptWarning &warning : parser.get_warnings()) {
+	for (const GDScriptWarning &warning : p_parser->get_warnings()) {
 		if (EngineDebugger::is_active()) {
 			Vector<ScriptLanguage::StackInfo> si;
 			EngineDebugger::get_script_debugger()->send_error("", get_path(), warning.start_line, warning.get_name(), warning.get_message(), ERR_HANDLER_WARNING, si);
@@ -974,12 +1013,32 @@ void GDScript::_bind_methods() {
 }
 
 Vector<uint8_t> GDScript::get_as_byte_code() const {
-	return Vector<uint8_t>();
-};
+	ERR_FAIL_COND_V_MSG(!valid, Vector<uint8_t>(), "Script '" + path + "' must be compiled before it can be saved as bytecode.");
+
+	String error;
+	Vector<uint8_t> buffer = GDScriptBytecode::serialize(this, &error);
+	if (buffer.is_empty() && !error.is_empty()) {
+		WARN_PRINT("Can't save script '" + path + "' as bytecode: " + error);
+	}
+	return buffer;
+}
 
-// TODO: Fully remove this. There's not this kind of "bytecode" anymore.
 Error GDScript::load_byte_code(const String &p_path) {
-	return ERR_COMPILATION_FAILED;
+	Error err;
+	Vector<uint8_t> buffer = FileAccess::get_file_as_array(p_path, &err);
+	ERR_FAIL_COND_V_MSG(err, err, "Cannot open file '" + p_path + "'.");
+
+	set_byte_code(buffer);
+	return OK;
+}
+
+void GDScript::set_byte_code(const Vector<uint8_t> &p_byte_code) {
+	byte_code = p_byte_code;
+	// Kept in case the bytecode can't be used.
+	source = GDScriptBytecode::get_source_code(byte_code);
+#ifdef TOOLS_ENABLED
+	source_changed_cache = true;
+#endif
 }
 
 Error GDScript::load_source_code(const String &p_path) {
@@ -1683,6 +1742,7 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 }
 
 void GDScriptLanguage::finish() {
+	GDScriptBytecode::finish();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -2243,10 +2303,9 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 		*r_error = ERR_FILE_CANT_OPEN;
 	}
 
+	// Precompiled scripts are remapped, keep using the original path so they are cached like the source.
 	Error err;
-	Ref<GDScript> script = GDScriptCache::get_full_script(p_path, err);
-
-	// TODO: Reintroduce binary and encrypted scripts.
+	Ref<GDScript> script = GDScriptCache::get_full_script(p_original_path, err);
 
 	if (script.is_null()) {
 		// Don't fail loading because of parsing error.
@@ -2262,9 +2321,7 @@ RES ResourceFormatLoaderGDScript::load(const String &p_path, const String &p_ori
 
 void ResourceFormatLoaderGDScript::get_recognized_extensions(List<String> *p_extensions) const {
 	p_extensions->push_back("gd");
-	// TODO: Reintroduce binary and encrypted scripts.
-	// p_extensions->push_back("gdc");
-	// p_extensions->push_back("gde");
+	p_extensions->push_back("gdc");
 }
 
 bool ResourceFormatLoaderGDScript::handles_type(const String &p_type) const {
@@ -2273,18 +2330,21 @@ bool ResourceFormatLoaderGDScript::handles_type(const String &p_type) const {
 
 String ResourceFormatLoaderGDScript::get_resource_type(const String &p_path) const {
 	String el = p_path.get_extension().to_lower();
-	// TODO: Reintroduce binary and encrypted scripts.
-	if (el == "gd" /*|| el == "gdc" || el == "gde"*/) {
+	if (el == "gd" || el == "gdc") {
 		return "GDScript";
 	}
 	return "";
 }
 
 void ResourceFormatLoaderGDScript::get_dependencies(const String &p_path, List<String> *p_dependencies, bool p_add_types) {
-	FileAccessRef file = FileAccess::open(p_path, FileAccess::READ);
-	ERR_FAIL_COND_MSG(!file, "Cannot open file '" + p_path + "'.");
-
-	String source = file->get_as_utf8_string();
+	String source;
+	if (p_path.get_extension().to_lower() == "gdc") {
+		source = GDScriptBytecode::get_source_code(FileAccess::get_file_as_array(p_path));
+	} else {
+		FileAccessRef file = FileAccess::open(p_path, FileAccess::READ);
+		ERR_FAIL_COND_MSG(!file, "Cannot open file '" + p_path + "'.");
+		source = file->get_as_utf8_string();
+	}
 	if (source.is_empty()) {
 		return;
 	}
@@ -39,6 +39,8 @@
 #include "core/object/script_language.h"
 #include "gdscript_function.h"
 
+class GDScriptParser;
+
 class GDScriptNativeClass : public RefCounted {
 	GDCLASS(GDScriptNativeClass, RefCounted);
 
@@ -72,6 +74,8 @@ class GDScript : public Script {
 	friend class GDScriptAnalyzer;
 	friend class GDScriptCompiler;
 	friend class GDScriptLanguage;
+	friend class GDScriptBytecode;
+	friend class GDScriptCompileBatch;
 	friend struct GDScriptUtilityFunctionsDefinitions;
 
 	Ref<GDScriptNativeClass> native;
@@ -123,6 +127,7 @@ class GDScript : public Script {
 	Set<Object *> instances;
 	//exported members
 	String source;
+	Vector<uint8_t> byte_code; // Precompiled on export, used instead of the source when compatible.
 	String path;
 	String name;
 	String fully_qualified_name;
@@ -151,6 +156,7 @@ class GDScript : public Script {
 
 	void _save_orphaned_subclasses();
 	void _init_rpc_methods_properties();
+	Error _compile(const GDScriptParser *p_parser, bool p_keep_state);
 
 	void _get_script_property_list(List<PropertyInfo> *r_list, bool p_include_base) const;
 	void _get_script_method_list(List<MethodInfo> *r_list, bool p_include_base) const;
@@ -220,6 +226,8 @@ public:
 	void set_script_path(const String &p_path) { path = p_path; } //because subclasses need a path too...
 	Error load_source_code(const String &p_path);
 	Error load_byte_code(const String &p_path);
+	void set_byte_code(const Vector<uint8_t> &p_byte_code);
+	bool is_precompiled() const { return !byte_code.is_empty(); } // False again if the byte code was rejected on reload.
 
 	Vector<uint8_t> get_as_byte_code() const;
 
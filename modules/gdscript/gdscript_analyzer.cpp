@@ -1007,6 +1007,7 @@ void GDScriptAnalyzer::resolve_for(GDScriptParser::ForNode *p_for) {
 			GDScriptParser::IdentifierNode *callee = static_cast<GDScriptParser::IdentifierNode *>(call->callee);
 			if (callee->name == "range") {
 				list_resolved = true;
+				bool list_typed = false;
 				if (call->arguments.size() < 1) {
 					push_error(R"*(Invalid call for "range()" function. Expected at least 1 argument, none given.)*", call->callee);
 				} else if (call->arguments.size() > 3) {
@@ -1014,6 +1015,7 @@ void GDScriptAnalyzer::resolve_for(GDScriptParser::ForNode *p_for) {
 				} else {
 					// Now we can optimize it.
 					bool all_is_constant = true;
+					bool all_is_hard_number = true;
 					Vector<Variant> args;
 					args.resize(call->arguments.size());
 					for (int i = 0; i < call->arguments.size(); i++) {
@@ -1026,6 +1028,9 @@ void GDScriptAnalyzer::resolve_for(GDScriptParser::ForNode *p_for) {
 						}
 
 						GDScriptParser::DataType arg_type = call->arguments[i]->get_datatype();
+						if (!arg_type.is_hard_type() || arg_type.kind != GDScriptParser::DataType::BUILTIN || (arg_type.builtin_type != Variant::INT && arg_type.builtin_type != Variant::FLOAT)) {
+							all_is_hard_number = false;
+						}
 						if (!arg_type.is_variant()) {
 							if (arg_type.kind != GDScriptParser::DataType::BUILTIN) {
 								all_is_constant = false;
@@ -1053,12 +1058,21 @@ void GDScriptAnalyzer::resolve_for(GDScriptParser::ForNode *p_for) {
 						}
 						p_for->list->is_constant = true;
 						p_for->list->reduced_value = reduced;
+					} else if (all_is_hard_number) {
+						// Bounds only known at runtime, but still typed as numbers: the compiler
+						// builds the same int, Vector2i or Vector3i instead of calling range().
+						GDScriptParser::DataType range_type;
+						range_type.type_source = GDScriptParser::DataType::ANNOTATED_EXPLICIT;
+						range_type.kind = GDScriptParser::DataType::BUILTIN;
+						range_type.builtin_type = call->arguments.size() == 1 ? Variant::INT : (call->arguments.size() == 2 ? Variant::VECTOR2I : Variant::VECTOR3I);
+						p_for->list->set_datatype(range_type);
+						list_typed = true;
 					}
 				}
 
 				if (p_for->list->is_constant) {
 					p_for->list->set_datatype(type_from_variant(p_for->list->reduced_value, p_for->list));
-				} else {
+				} else if (!list_typed) {
 					GDScriptParser::DataType list_type;
 					list_type.type_source = GDScriptParser::DataType::ANNOTATED_EXPLICIT;
 					list_type.kind = GDScriptParser::DataType::BUILTIN;
@@ -2703,11 +2717,14 @@ void GDScriptAnalyzer::reduce_preload(GDScriptParser::PreloadNode *p_preload) {
 			p_preload->resolved_path = parser->script_path.get_base_dir().plus_file(p_preload->resolved_path);
 		}
 		p_preload->resolved_path = p_preload->resolved_path.simplify_path();
-		if (!FileAccess::exists(p_preload->resolved_path)) {
+		if (!ResourceLoader::exists(p_preload->resolved_path)) {
 			push_error(vformat(R"(Preload file "%s" does not exist.)", p_preload->resolved_path), p_preload->path);
 		} else {
 			// TODO: Don't load if validating: use completion cache.
-			p_preload->resource = ResourceLoader::load(p_preload->resolved_path);
+			p_preload->resource = GDScriptCache::get_batch_script(p_preload->resolved_path);
+			if (p_preload->resource.is_null()) {
+				p_preload->resource = ResourceLoader::load(p_preload->resolved_path);
+			}
 			if (p_preload->resource.is_null()) {
 				push_error(vformat(R"(Could not p_preload resource file "%s".)", p_preload->resolved_path), p_preload->path);
 			}
@@ -3100,7 +3117,9 @@ GDScriptParser::DataType GDScriptAnalyzer::type_from_variant(const Variant &p_va
 			scr = obj->get_script();
 		}
 		if (scr.is_valid()) {
-			if (scr->is_valid()) {
+			// Scripts from the same compile batch are compiled before the scripts using them, their parser gives the type meanwhile.
+			const bool batch_script = !scr->is_valid() && scr.ptr() == GDScriptCache::get_batch_script(scr->get_path()).ptr();
+			if (scr->is_valid() || batch_script) {
 				result.script_type = scr;
 				result.script_path = scr->get_path();
 				Ref<GDScript> gds = scr;
@@ -3131,7 +3150,7 @@ GDScriptParser::DataType GDScriptAnalyzer::type_from_variant(const Variant &p_va
 				} else {
 					result.kind = GDScriptParser::DataType::SCRIPT;
 				}
-				result.native_type = scr->get_instance_base_type();
+				result.native_type = batch_script ? result.class_type->get_datatype().native_type : scr->get_instance_base_type();
 			} else {
 				push_error(vformat(R"(Constant value uses script from "%s" which is loaded but not compiled.)", scr->get_path()), p_source);
 				result.kind = GDScriptParser::DataType::VARIANT;
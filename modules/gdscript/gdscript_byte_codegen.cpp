@@ -33,6 +33,99 @@
 #include "core/debugger/engine_debugger.h"
 #include "gdscript.h"
 
+static GDScriptFunction::Opcode _get_typed_operator_opcode(Variant::Operator p_operator, Variant::Type p_type) {
+	if (p_type == Variant::INT) {
+		switch (p_operator) {
+			case Variant::OP_ADD:
+				return GDScriptFunction::OPCODE_ADD_INT;
+			case Variant::OP_SUBTRACT:
+				return GDScriptFunction::OPCODE_SUBTRACT_INT;
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_MULTIPLY_INT;
+			case Variant::OP_EQUAL:
+				return GDScriptFunction::OPCODE_EQUAL_INT;
+			case Variant::OP_NOT_EQUAL:
+				return GDScriptFunction::OPCODE_NOT_EQUAL_INT;
+			case Variant::OP_LESS:
+				return GDScriptFunction::OPCODE_LESS_INT;
+			case Variant::OP_LESS_EQUAL:
+				return GDScriptFunction::OPCODE_LESS_EQUAL_INT;
+			case Variant::OP_GREATER:
+				return GDScriptFunction::OPCODE_GREATER_INT;
+			case Variant::OP_GREATER_EQUAL:
+				return GDScriptFunction::OPCODE_GREATER_EQUAL_INT;
+			default:
+				break; // Division and modulo check for zero, keep them validated.
+		}
+	} else if (p_type == Variant::FLOAT) {
+		switch (p_operator) {
+			case Variant::OP_ADD:
+				return GDScriptFunction::OPCODE_ADD_FLOAT;
+			case Variant::OP_SUBTRACT:
+				return GDScriptFunction::OPCODE_SUBTRACT_FLOAT;
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_MULTIPLY_FLOAT;
+			case Variant::OP_DIVIDE:
+				return GDScriptFunction::OPCODE_DIVIDE_FLOAT;
+			case Variant::OP_EQUAL:
+				return GDScriptFunction::OPCODE_EQUAL_FLOAT;
+			case Variant::OP_NOT_EQUAL:
+				return GDScriptFunction::OPCODE_NOT_EQUAL_FLOAT;
+			case Variant::OP_LESS:
+				return GDScriptFunction::OPCODE_LESS_FLOAT;
+			case Variant::OP_LESS_EQUAL:
+				return GDScriptFunction::OPCODE_LESS_EQUAL_FLOAT;
+			case Variant::OP_GREATER:
+				return GDScriptFunction::OPCODE_GREATER_FLOAT;
+			case Variant::OP_GREATER_EQUAL:
+				return GDScriptFunction::OPCODE_GREATER_EQUAL_FLOAT;
+			default:
+				break;
+		}
+	}
+	return GDScriptFunction::OPCODE_END;
+}
+
+// Jumps when the comparison is false, like a JUMP_IF_NOT on its result.
+static GDScriptFunction::Opcode _get_jump_if_not_opcode(Variant::Operator p_operator, Variant::Type p_type) {
+	if (p_type == Variant::INT) {
+		switch (p_operator) {
+			case Variant::OP_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_EQUAL_INT;
+			case Variant::OP_NOT_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_EQUAL_INT;
+			case Variant::OP_LESS:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_LESS_INT;
+			case Variant::OP_LESS_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_LESS_EQUAL_INT;
+			case Variant::OP_GREATER:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_GREATER_INT;
+			case Variant::OP_GREATER_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_GREATER_EQUAL_INT;
+			default:
+				break;
+		}
+	} else if (p_type == Variant::FLOAT) {
+		switch (p_operator) {
+			case Variant::OP_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_EQUAL_FLOAT;
+			case Variant::OP_NOT_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_EQUAL_FLOAT;
+			case Variant::OP_LESS:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_LESS_FLOAT;
+			case Variant::OP_LESS_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_LESS_EQUAL_FLOAT;
+			case Variant::OP_GREATER:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_GREATER_FLOAT;
+			case Variant::OP_GREATER_EQUAL:
+				return GDScriptFunction::OPCODE_JUMP_IF_NOT_GREATER_EQUAL_FLOAT;
+			default:
+				break;
+		}
+	}
+	return GDScriptFunction::OPCODE_END;
+}
+
 uint32_t GDScriptByteCodeGenerator::add_parameter(const StringName &p_name, bool p_is_optional, const GDScriptDataType &p_type) {
 #ifdef TOOLS_ENABLED
 	function->arg_names.push_back(p_name);
@@ -399,6 +492,7 @@ GDScriptFunction *GDScriptByteCodeGenerator::write_end() {
 	function->_stack_size = RESERVED_STACK + max_locals + temporaries.size();
 	function->_instruction_args_size = instr_args_max;
 	function->_ptrcall_args_size = ptrcall_max;
+	function->_alloc_inline_caches(inline_cache_count);
 
 	ended = true;
 	return function;
@@ -562,6 +656,14 @@ void GDScriptByteCodeGenerator::write_binary_operator(const Address &p_target, V
 			}
 		}
 
+		if (specialize_instructions && p_left_operand.type.builtin_type == p_right_operand.type.builtin_type) {
+			GDScriptFunction::Opcode opcode = _get_typed_operator_opcode(p_operator, p_left_operand.type.builtin_type);
+			if (opcode != GDScriptFunction::OPCODE_END) {
+				write_typed_operator(opcode, p_operator, p_left_operand.type.builtin_type, p_target, p_left_operand, p_right_operand);
+				return;
+			}
+		}
+
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, p_right_operand.type.builtin_type);
 
@@ -581,6 +683,22 @@ void GDScriptByteCodeGenerator::write_binary_operator(const Address &p_target, V
 	append(p_operator);
 }
 
+void GDScriptByteCodeGenerator::write_typed_operator(GDScriptFunction::Opcode p_opcode, Variant::Operator p_operator, Variant::Type p_type, const Address &p_target, const Address &p_left_operand, const Address &p_right_operand) {
+	int position = opcodes.size();
+	append(p_opcode, 3);
+	append(p_left_operand);
+	append(p_right_operand);
+	append(p_target);
+
+	last_typed_operator.position = position;
+	last_typed_operator.opcode = p_opcode;
+	last_typed_operator.op = p_operator;
+	last_typed_operator.type = p_type;
+	last_typed_operator.left = p_left_operand;
+	last_typed_operator.right = p_right_operand;
+	last_typed_operator.target = p_target;
+}
+
 void GDScriptByteCodeGenerator::write_type_test(const Address &p_target, const Address &p_source, const Address &p_type) {
 	append(GDScriptFunction::OPCODE_EXTENDS_TEST, 3);
 	append(p_source);
@@ -758,6 +876,7 @@ void GDScriptByteCodeGenerator::write_set_named(const Address &p_target, const S
 	append(p_target);
 	append(p_source);
 	append(p_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const StringName &p_name, const Address &p_source) {
@@ -773,6 +892,7 @@ void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const S
 	append(p_source);
 	append(p_target);
 	append(p_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_set_member(const Address &p_value, const StringName &p_name) {
@@ -832,6 +952,18 @@ void GDScriptByteCodeGenerator::write_assign_with_conversion(const Address &p_ta
 }
 
 void GDScriptByteCodeGenerator::write_assign(const Address &p_target, const Address &p_source) {
+	if (can_fuse_typed_operator(p_source) && (p_target.mode == Address::LOCAL_VARIABLE || p_target.mode == Address::FUNCTION_PARAMETER || p_target.mode == Address::MEMBER)) {
+		// Store the result directly, unless the assignment converts it.
+		TypedOperator last = last_typed_operator;
+		Variant::Type result_type = Variant::get_operator_return_type(last.op, last.type, last.type);
+		if (!p_target.type.has_type || (p_target.type.kind == GDScriptDataType::BUILTIN && p_target.type.builtin_type == result_type)) {
+			rollback_to(last.position);
+			write_typed_operator(last.opcode, last.op, last.type, p_target, last.left, last.right);
+			last_typed_operator.position = -1;
+			return;
+		}
+	}
+
 	if (p_target.type.kind == GDScriptDataType::BUILTIN && p_target.type.builtin_type == Variant::ARRAY && p_target.type.has_container_element_type()) {
 		append(GDScriptFunction::OPCODE_ASSIGN_TYPED_ARRAY, 2);
 		append(p_target);
@@ -862,6 +994,7 @@ void GDScriptByteCodeGenerator::write_assign_false(const Address &p_target) {
 void GDScriptByteCodeGenerator::write_assign_default_parameter(const Address &p_dst, const Address &p_src) {
 	write_assign(p_dst, p_src);
 	function->default_arguments.push_back(opcodes.size());
+	last_typed_operator.position = -1;
 }
 
 void GDScriptByteCodeGenerator::write_store_named_global(const Address &p_dst, const StringName &p_global) {
@@ -910,6 +1043,7 @@ void GDScriptByteCodeGenerator::write_call(const Address &p_target, const Addres
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_super_call(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -931,6 +1065,7 @@ void GDScriptByteCodeGenerator::write_call_async(const Address &p_target, const
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_call_gdscript_utility(const Address &p_target, GDScriptUtilityFunctions::FunctionPtr p_function, const Vector<Address> &p_arguments) {
@@ -1160,6 +1295,7 @@ void GDScriptByteCodeGenerator::write_call_self(const Address &p_target, const S
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1171,6 +1307,7 @@ void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, c
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_target, const Address &p_base, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1182,6 +1319,7 @@ void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_targ
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append_inline_cache();
 }
 
 void GDScriptByteCodeGenerator::write_lambda(const Address &p_target, GDScriptFunction *p_function, const Vector<Address> &p_captures) {
@@ -1289,9 +1427,26 @@ void GDScriptByteCodeGenerator::write_await(const Address &p_target, const Addre
 	append(p_target);
 }
 
-void GDScriptByteCodeGenerator::write_if(const Address &p_condition) {
+void GDScriptByteCodeGenerator::write_jump_if_not(const Address &p_condition) {
+	if (can_fuse_typed_operator(p_condition)) {
+		TypedOperator last = last_typed_operator;
+		GDScriptFunction::Opcode opcode = _get_jump_if_not_opcode(last.op, last.type);
+		if (opcode != GDScriptFunction::OPCODE_END) {
+			// The condition is only used by the jump, compare right there.
+			rollback_to(last.position);
+			append(opcode, 2);
+			append(last.left);
+			append(last.right);
+			return;
+		}
+	}
+
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
 	append(p_condition);
+}
+
+void GDScriptByteCodeGenerator::write_if(const Address &p_condition) {
+	write_jump_if_not(p_condition);
 	if_jmp_addrs.push_back(opcodes.size());
 	append(0); // Jump destination, will be patched.
 }
@@ -1473,12 +1628,12 @@ void GDScriptByteCodeGenerator::write_endfor() {
 void GDScriptByteCodeGenerator::start_while_condition() {
 	current_breaks_to_patch.push_back(List<int>());
 	continue_addrs.push_back(opcodes.size());
+	last_typed_operator.position = -1;
 }
 
 void GDScriptByteCodeGenerator::write_while(const Address &p_condition) {
 	// Condition check.
-	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
-	append(p_condition);
+	write_jump_if_not(p_condition);
 	while_jmp_addrs.push_back(opcodes.size());
 	append(0); // End of loop address, will be patched.
 }
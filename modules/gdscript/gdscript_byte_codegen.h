@@ -71,6 +71,23 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	int current_line = 0;
 	int instr_args_max = 0;
 	int ptrcall_max = 0;
+	int inline_cache_count = 0;
+
+	// Typed operators on ints and floats get their own opcodes, which can be
+	// fused with the assignment or the conditional jump using their result.
+	bool specialize_instructions = true;
+
+	// Last typed operator written, while it's still the last instruction.
+	struct TypedOperator {
+		int position = -1;
+		GDScriptFunction::Opcode opcode = GDScriptFunction::OPCODE_END;
+		Variant::Operator op = Variant::OP_MAX;
+		Variant::Type type = Variant::NIL;
+		Address left;
+		Address right;
+		Address target;
+	};
+	TypedOperator last_typed_operator;
 
 #ifdef DEBUG_ENABLED
 	List<int> temp_stack;
@@ -348,6 +365,10 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 		opcodes.push_back(get_name_map_pos(p_name));
 	}
 
+	void append_inline_cache() {
+		opcodes.push_back(inline_cache_count++);
+	}
+
 	void append(const Variant::ValidatedOperatorEvaluator p_operation) {
 		opcodes.push_back(get_operation_pos(p_operation));
 	}
@@ -402,8 +423,30 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 
 	void patch_jump(int p_address) {
 		opcodes.write[p_address] = opcodes.size();
+		// Code jumping here expects the previous result to be stored already.
+		last_typed_operator.position = -1;
+	}
+
+	bool can_fuse_typed_operator(const Address &p_result) const {
+		const TypedOperator &last = last_typed_operator;
+		return last.position >= 0 && last.position + 4 == opcodes.size() && p_result.mode == Address::TEMPORARY && last.target.mode == Address::TEMPORARY && last.target.address == p_result.address;
 	}
 
+	// Removes the instructions written from the given position on.
+	void rollback_to(int p_position) {
+		for (int i = 0; i < temporaries.size(); i++) {
+			Vector<int> &indices = temporaries.write[i].bytecode_indices;
+			while (!indices.is_empty() && indices[indices.size() - 1] >= p_position) {
+				indices.resize(indices.size() - 1);
+			}
+		}
+		opcodes.resize(p_position);
+		last_typed_operator.position = -1;
+	}
+
+	void write_jump_if_not(const Address &p_condition);
+	void write_typed_operator(GDScriptFunction::Opcode p_opcode, Variant::Operator p_operator, Variant::Type p_type, const Address &p_target, const Address &p_left_operand, const Address &p_right_operand);
+
 public:
 	virtual uint32_t add_parameter(const StringName &p_name, bool p_is_optional, const GDScriptDataType &p_type) override;
 	virtual uint32_t add_local(const StringName &p_name, const GDScriptDataType &p_type) override;
@@ -495,6 +538,9 @@ public:
 	virtual void write_return(const Address &p_return_value) override;
 	virtual void write_assert(const Address &p_test, const Address &p_message) override;
 
+	void set_specialize_instructions(bool p_enabled) { specialize_instructions = p_enabled; }
+	bool is_specializing_instructions() const { return specialize_instructions; }
+
 	virtual ~GDScriptByteCodeGenerator();
 };
 
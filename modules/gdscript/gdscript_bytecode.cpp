@@ -0,0 +1,1293 @@
+/*************************************************************************/
+/*  gdscript_bytecode.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_bytecode.h"
+
+#include "core/io/compression.h"
+#include "core/io/marshalls.h"
+#include "core/io/resource_loader.h"
+#include "core/os/mutex.h"
+#include "core/version.h"
+#include "gdscript_cache.h"
+#include "gdscript_utility_functions.h"
+
+#ifdef DEBUG_ENABLED
+#include "core/debugger/engine_debugger.h"
+#endif
+
+// Magic, version, compatibility hash and flags, followed by the source block.
+// This part of the layout must stay the same across versions.
+static const uint8_t BYTECODE_MAGIC[4] = { 'G', 'D', 'S', 'C' };
+static const uint32_t HEADER_SIZE = 16;
+static const uint32_t SOURCE_OFFSET = HEADER_SIZE + 8;
+
+enum {
+	FLAG_HAS_SOURCE = 1,
+};
+
+enum ScriptRefKind {
+	SCRIPT_REF_NONE,
+	SCRIPT_REF_LOCAL, // The script being loaded, or one of its inner classes.
+	SCRIPT_REF_GDSCRIPT, // Another script file, or one of its inner classes.
+	SCRIPT_REF_RESOURCE, // A script in another language.
+};
+
+enum ConstantKind {
+	CONSTANT_VARIANT,
+	CONSTANT_NULL_OBJECT,
+	CONSTANT_SCRIPT,
+	CONSTANT_GLOBAL, // Native class or singleton, looked up by name.
+	CONSTANT_RESOURCE,
+	CONSTANT_ARRAY,
+	CONSTANT_DICTIONARY,
+};
+
+template <class T>
+static _FORCE_INLINE_ uint64_t _ptr_key(T p_ptr) {
+	return (uint64_t)(uintptr_t)p_ptr;
+}
+
+/* Symbols */
+
+// Reverse lookup of the pointers the compiler bakes into functions. Only needed
+// when writing, built on first use.
+struct GDScriptBytecode::SymbolTables {
+	HashMap<uint64_t, Symbol> operators;
+	HashMap<uint64_t, Symbol> setters;
+	HashMap<uint64_t, Symbol> getters;
+	HashMap<uint64_t, Symbol> keyed_setters;
+	HashMap<uint64_t, Symbol> keyed_getters;
+	HashMap<uint64_t, Symbol> indexed_setters;
+	HashMap<uint64_t, Symbol> indexed_getters;
+	HashMap<uint64_t, Symbol> builtin_methods;
+	HashMap<uint64_t, Symbol> constructors;
+	HashMap<uint64_t, Symbol> utilities;
+	HashMap<uint64_t, Symbol> gds_utilities;
+
+	template <class T>
+	static void add(HashMap<uint64_t, Symbol> &r_table, T p_ptr, uint32_t p_type, uint32_t p_a = 0, uint32_t p_b = 0, const StringName &p_name = StringName()) {
+		if (!p_ptr || r_table.has(_ptr_key(p_ptr))) {
+			return;
+		}
+		Symbol symbol;
+		symbol.type = p_type;
+		symbol.a = p_a;
+		symbol.b = p_b;
+		symbol.name = p_name;
+		r_table[_ptr_key(p_ptr)] = symbol;
+	}
+};
+
+GDScriptBytecode::SymbolTables *GDScriptBytecode::symbol_tables = nullptr;
+static BinaryMutex symbol_tables_mutex;
+
+const GDScriptBytecode::SymbolTables *GDScriptBytecode::_get_symbol_tables() {
+	MutexLock lock(symbol_tables_mutex);
+	if (symbol_tables) {
+		return symbol_tables;
+	}
+
+	SymbolTables *tables = memnew(SymbolTables);
+
+	for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+		Variant::Type type = Variant::Type(i);
+
+		for (int op = 0; op < Variant::OP_MAX; op++) {
+			for (int j = 0; j < Variant::VARIANT_MAX; j++) {
+				SymbolTables::add(tables->operators, Variant::get_validated_operator_evaluator(Variant::Operator(op), type, Variant::Type(j)), op, i, j);
+			}
+		}
+
+		List<StringName> members;
+		Variant::get_member_list(type, &members);
+		for (const StringName &E : members) {
+			SymbolTables::add(tables->setters, Variant::get_member_validated_setter(type, E), i, 0, 0, E);
+			SymbolTables::add(tables->getters, Variant::get_member_validated_getter(type, E), i, 0, 0, E);
+		}
+
+		SymbolTables::add(tables->keyed_setters, Variant::get_member_validated_keyed_setter(type), i);
+		SymbolTables::add(tables->keyed_getters, Variant::get_member_validated_keyed_getter(type), i);
+		SymbolTables::add(tables->indexed_setters, Variant::get_member_validated_indexed_setter(type), i);
+		SymbolTables::add(tables->indexed_getters, Variant::get_member_validated_indexed_getter(type), i);
+
+		List<StringName> methods;
+		Variant::get_builtin_method_list(type, &methods);
+		for (const StringName &E : methods) {
+			SymbolTables::add(tables->builtin_methods, Variant::get_validated_builtin_method(type, E), i, 0, 0, E);
+		}
+
+		for (int j = 0; j < Variant::get_constructor_count(type); j++) {
+			SymbolTables::add(tables->constructors, Variant::get_validated_constructor(type, j), i, j);
+		}
+	}
+
+	List<StringName> utilities;
+	Variant::get_utility_function_list(&utilities);
+	for (const StringName &E : utilities) {
+		SymbolTables::add(tables->utilities, Variant::get_validated_utility_function(E), 0, 0, 0, E);
+	}
+
+	List<StringName> gds_utilities;
+	GDScriptUtilityFunctions::get_function_list(&gds_utilities);
+	for (const StringName &E : gds_utilities) {
+		SymbolTables::add(tables->gds_utilities, GDScriptUtilityFunctions::get_function(E), 0, 0, 0, E);
+	}
+
+	symbol_tables = tables;
+	return symbol_tables;
+}
+
+uint32_t GDScriptBytecode::_get_compatibility_hash() {
+	// Opcodes, addresses, types and operators are stored as plain numbers,
+	// the engine version covers everything else.
+	uint32_t hash = hash_djb2(VERSION_FULL_CONFIG);
+	hash = hash_djb2_one_32(BYTECODE_VERSION, hash);
+	hash = hash_djb2_one_32(GDScriptFunction::OPCODE_END, hash);
+	hash = hash_djb2_one_32(GDScriptFunction::ADDR_BITS, hash);
+	hash = hash_djb2_one_32(GDScriptFunction::INSTR_BITS, hash);
+	hash = hash_djb2_one_32(Variant::VARIANT_MAX, hash);
+	hash = hash_djb2_one_32(Variant::OP_MAX, hash);
+	return hash;
+}
+
+/* Writing */
+
+struct GDScriptBytecode::Writer {
+	const GDScript *root = nullptr;
+	const SymbolTables *symbols = nullptr;
+	LocalVector<uint8_t> data;
+	HashMap<String, uint32_t> string_map;
+	Vector<String> strings;
+	HashMap<ObjectID, StringName> globals;
+	bool globals_mapped = false;
+	String error;
+
+	void put_8(uint8_t p_value) {
+		data.push_back(p_value);
+	}
+
+	void put_32(uint32_t p_value) {
+		uint32_t pos = data.size();
+		data.resize(pos + 4);
+		encode_uint32(p_value, &data[pos]);
+	}
+
+	void put_data(const uint8_t *p_data, uint32_t p_size) {
+		if (p_size == 0) {
+			return;
+		}
+		uint32_t pos = data.size();
+		data.resize(pos + p_size);
+		memcpy(&data[pos], p_data, p_size);
+	}
+
+	void put_string(const String &p_string) {
+		const uint32_t *index = string_map.getptr(p_string);
+		if (index) {
+			put_32(*index);
+			return;
+		}
+		uint32_t new_index = strings.size();
+		string_map[p_string] = new_index;
+		strings.push_back(p_string);
+		put_32(new_index);
+	}
+
+	// Names of the objects in the language globals (native classes, singletons).
+	const StringName *get_global_name(const Object *p_object) {
+		if (!globals_mapped) {
+			GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+			for (const Map<StringName, int>::Element *E = language->get_global_map().front(); E; E = E->next()) {
+				const Variant &global = language->get_global_array()[E->get()];
+				Object *object = global.get_type() == Variant::OBJECT ? global.get_validated_object() : nullptr;
+				if (object) {
+					globals[object->get_instance_id()] = E->key();
+				}
+			}
+			globals_mapped = true;
+		}
+		return globals.getptr(p_object->get_instance_id());
+	}
+
+	void fail(const String &p_error) {
+		if (error.is_empty()) {
+			error = p_error;
+		}
+	}
+};
+
+template <class T>
+void GDScriptBytecode::_write_symbols(Writer &w, const Vector<T> &p_pointers, const HashMap<uint64_t, Symbol> &p_table, const char *p_what) {
+	w.put_32(p_pointers.size());
+	for (int i = 0; i < p_pointers.size(); i++) {
+		const Symbol *symbol = p_table.getptr(_ptr_key(p_pointers[i]));
+		if (!symbol) {
+			w.fail(vformat("Unknown %s pointer.", p_what));
+			return;
+		}
+		w.put_32(symbol->type);
+		w.put_32(symbol->a);
+		w.put_32(symbol->b);
+		w.put_string(symbol->name);
+	}
+}
+
+void GDScriptBytecode::_write_script_ref(Writer &w, const Script *p_script) {
+	if (!p_script) {
+		w.put_8(SCRIPT_REF_NONE);
+		return;
+	}
+
+	const GDScript *gdscript = Object::cast_to<GDScript>(p_script);
+	if (!gdscript) {
+		if (!p_script->get_path().is_resource_file()) {
+			w.fail("Reference to a built-in script.");
+			return;
+		}
+		w.put_8(SCRIPT_REF_RESOURCE);
+		w.put_string(p_script->get_path());
+		return;
+	}
+
+	// Inner classes are referenced by their names, starting from the top-level class.
+	Vector<StringName> names;
+	const GDScript *top = gdscript;
+	while (top->_owner) {
+		names.push_back(top->name);
+		top = top->_owner;
+	}
+
+	if (top == w.root) {
+		w.put_8(SCRIPT_REF_LOCAL);
+	} else {
+		if (!top->get_path().is_resource_file()) {
+			w.fail("Reference to a built-in script.");
+			return;
+		}
+		w.put_8(SCRIPT_REF_GDSCRIPT);
+		w.put_string(top->get_path());
+	}
+	w.put_32(names.size());
+	for (int i = names.size() - 1; i >= 0; i--) {
+		w.put_string(names[i]);
+	}
+}
+
+void GDScriptBytecode::_write_data_type(Writer &w, const GDScriptDataType &p_type) {
+	w.put_8(p_type.has_type);
+	w.put_8(p_type.kind);
+	w.put_32(p_type.builtin_type);
+	w.put_string(p_type.native_type);
+	_write_script_ref(w, p_type.script_type);
+	// The compiler doesn't hold a reference to the class owning the type, to avoid cycles.
+	w.put_8(p_type.script_type && p_type.script_type_ref.is_null());
+	w.put_8(p_type.has_container_element_type());
+	if (p_type.has_container_element_type()) {
+		_write_data_type(w, p_type.get_container_element_type());
+	}
+}
+
+void GDScriptBytecode::_write_constant(Writer &w, const Variant &p_value) {
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			Object *object = p_value.get_validated_object();
+			if (!object) {
+				w.put_8(CONSTANT_NULL_OBJECT);
+				return;
+			}
+
+			const Script *script = Object::cast_to<Script>(object);
+			if (script) {
+				w.put_8(CONSTANT_SCRIPT);
+				_write_script_ref(w, script);
+				return;
+			}
+
+			const StringName *global = w.get_global_name(object);
+			if (global) {
+				w.put_8(CONSTANT_GLOBAL);
+				w.put_string(*global);
+				return;
+			}
+
+			const Resource *resource = Object::cast_to<Resource>(object);
+			if (resource && resource->get_path().is_resource_file()) {
+				w.put_8(CONSTANT_RESOURCE);
+				w.put_string(resource->get_path());
+				return;
+			}
+
+			w.fail("Constant of type '" + object->get_class() + "' can't be stored.");
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_value;
+			w.put_8(CONSTANT_ARRAY);
+			w.put_32(array.get_typed_builtin());
+			w.put_string(array.get_typed_class_name());
+			_write_constant(w, array.get_typed_script());
+			w.put_32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				_write_constant(w, array[i]);
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dictionary = p_value;
+			w.put_8(CONSTANT_DICTIONARY);
+			w.put_32(dictionary.size());
+			const Variant *K = nullptr;
+			while ((K = dictionary.next(K))) {
+				_write_constant(w, *K);
+				_write_constant(w, dictionary[*K]);
+			}
+		} break;
+		case Variant::RID:
+		case Variant::CALLABLE:
+		case Variant::SIGNAL: {
+			w.fail("Constant of type '" + Variant::get_type_name(p_value.get_type()) + "' can't be stored.");
+		} break;
+		default: {
+			int len = 0;
+			Error err = encode_variant(p_value, nullptr, len);
+			if (err != OK) {
+				w.fail("Constant of type '" + Variant::get_type_name(p_value.get_type()) + "' can't be encoded.");
+				return;
+			}
+			w.put_8(CONSTANT_VARIANT);
+			w.put_32(len);
+			uint32_t pos = w.data.size();
+			w.data.resize(pos + len);
+			encode_variant(p_value, &w.data[pos], len);
+		} break;
+	}
+}
+
+void GDScriptBytecode::_write_function(Writer &w, const GDScriptFunction *p_function) {
+	w.put_string(p_function->name);
+	w.put_8(p_function->_static);
+	w.put_string(p_function->rpc_config.name);
+	w.put_32(p_function->rpc_config.rpc_mode);
+	w.put_8(p_function->rpc_config.sync);
+	w.put_32(p_function->rpc_config.transfer_mode);
+	w.put_32(p_function->rpc_config.channel);
+	w.put_32(p_function->_initial_line);
+	w.put_32(p_function->_argument_count);
+
+	w.put_32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		_write_data_type(w, p_function->argument_types[i]);
+	}
+	_write_data_type(w, p_function->return_type);
+
+	w.put_32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		w.put_32(p_function->default_arguments[i]);
+	}
+
+	w.put_32(p_function->code.size());
+	for (int i = 0; i < p_function->code.size(); i++) {
+		w.put_32(p_function->code[i]);
+	}
+
+	w.put_32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		_write_constant(w, p_function->constants[i]);
+	}
+
+	w.put_32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		w.put_string(p_function->global_names[i]);
+	}
+
+	_write_symbols(w, p_function->operator_funcs, w.symbols->operators, "operator");
+	_write_symbols(w, p_function->setters, w.symbols->setters, "setter");
+	_write_symbols(w, p_function->getters, w.symbols->getters, "getter");
+	_write_symbols(w, p_function->keyed_setters, w.symbols->keyed_setters, "keyed setter");
+	_write_symbols(w, p_function->keyed_getters, w.symbols->keyed_getters, "keyed getter");
+	_write_symbols(w, p_function->indexed_setters, w.symbols->indexed_setters, "indexed setter");
+	_write_symbols(w, p_function->indexed_getters, w.symbols->indexed_getters, "indexed getter");
+	_write_symbols(w, p_function->builtin_methods, w.symbols->builtin_methods, "built-in method");
+	_write_symbols(w, p_function->constructors, w.symbols->constructors, "constructor");
+	_write_symbols(w, p_function->utilities, w.symbols->utilities, "utility function");
+	_write_symbols(w, p_function->gds_utilities, w.symbols->gds_utilities, "GDScript utility function");
+
+	w.put_32(p_function->methods.size());
+	for (int i = 0; i < p_function->methods.size(); i++) {
+		w.put_string(p_function->methods[i]->get_instance_class());
+		w.put_string(p_function->methods[i]->get_name());
+	}
+
+	w.put_32(p_function->lambdas.size());
+	for (int i = 0; i < p_function->lambdas.size(); i++) {
+		_write_function(w, p_function->lambdas[i]);
+	}
+
+	w.put_32(p_function->_stack_size);
+	w.put_32(p_function->_instruction_args_size);
+	w.put_32(p_function->_ptrcall_args_size);
+	w.put_32(p_function->_inline_caches_count);
+
+	w.put_32(p_function->temporary_slots.size());
+	for (const Map<int, Variant::Type>::Element *E = p_function->temporary_slots.front(); E; E = E->next()) {
+		w.put_32(E->key());
+		w.put_32(E->get());
+	}
+
+	w.put_32(p_function->stack_debug.size());
+	for (const GDScriptFunction::StackDebug &E : p_function->stack_debug) {
+		w.put_32(E.line);
+		w.put_32(E.pos);
+		w.put_8(E.added);
+		w.put_string(E.identifier);
+	}
+
+#ifdef TOOLS_ENABLED
+	w.put_32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		w.put_string(p_function->arg_names[i]);
+	}
+#else
+	w.put_32(0);
+#endif
+}
+
+void GDScriptBytecode::_write_class_tree(Writer &w, const GDScript *p_script) {
+	w.put_32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_class_tree(w, E->get().ptr());
+	}
+}
+
+void GDScriptBytecode::_write_class(Writer &w, const GDScript *p_script) {
+	w.put_8(p_script->tool);
+	w.put_string(p_script->name);
+	w.put_string(p_script->native.is_valid() ? p_script->native->get_name() : StringName());
+	_write_script_ref(w, p_script->base.ptr());
+
+	w.put_32(p_script->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().index);
+		w.put_string(E->get().setter);
+		w.put_string(E->get().getter);
+		_write_data_type(w, E->get().data_type);
+	}
+
+	w.put_32(p_script->members.size());
+	for (const Set<StringName>::Element *E = p_script->members.front(); E; E = E->next()) {
+		w.put_string(E->get());
+	}
+
+	w.put_32(p_script->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_script->member_info.front(); E; E = E->next()) {
+		const PropertyInfo &info = E->get();
+		w.put_string(E->key());
+		w.put_32(info.type);
+		w.put_string(info.name);
+		w.put_string(info.class_name);
+		w.put_32(info.hint);
+		w.put_string(info.hint_string);
+		w.put_32(info.usage);
+	}
+
+	w.put_32(p_script->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_script->constants.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_constant(w, E->get());
+	}
+
+	w.put_32(p_script->_signals.size());
+	for (const Map<StringName, Vector<StringName>>::Element *E = p_script->_signals.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_32(E->get().size());
+		for (int i = 0; i < E->get().size(); i++) {
+			w.put_string(E->get()[i]);
+		}
+	}
+
+	w.put_32(p_script->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_function(w, E->get());
+	}
+
+	w.put_32(p_script->subclasses.size());
+	for (const Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_class(w, E->get().ptr());
+	}
+}
+
+Vector<uint8_t> GDScriptBytecode::serialize(const GDScript *p_script, String *r_error) {
+	ERR_FAIL_NULL_V(p_script, Vector<uint8_t>());
+	ERR_FAIL_COND_V_MSG(p_script->_owner, Vector<uint8_t>(), "Inner classes are serialized along with their top-level class.");
+	ERR_FAIL_COND_V_MSG(!p_script->valid, Vector<uint8_t>(), "Only successfully compiled scripts can be serialized.");
+
+	Writer w;
+	w.root = p_script;
+	w.symbols = _get_symbol_tables();
+
+	_write_class_tree(w, p_script);
+	_write_class(w, p_script);
+
+	if (!w.error.is_empty()) {
+		if (r_error) {
+			*r_error = w.error;
+		}
+		return Vector<uint8_t>();
+	}
+
+	Writer file;
+	file.put_data(BYTECODE_MAGIC, 4);
+	file.put_32(BYTECODE_VERSION);
+	file.put_32(_get_compatibility_hash());
+	file.put_32(FLAG_HAS_SOURCE);
+
+	CharString source = p_script->source.utf8();
+	file.put_32(source.length());
+	if (source.length()) {
+		Vector<uint8_t> compressed;
+		compressed.resize(Compression::get_max_compressed_buffer_size(source.length(), Compression::MODE_ZSTD));
+		int compressed_size = Compression::compress(compressed.ptrw(), (const uint8_t *)source.get_data(), source.length(), Compression::MODE_ZSTD);
+		ERR_FAIL_COND_V(compressed_size < 0, Vector<uint8_t>());
+		file.put_32(compressed_size);
+		file.put_data(compressed.ptr(), compressed_size);
+	} else {
+		file.put_32(0);
+	}
+
+	file.put_32(w.strings.size());
+	for (int i = 0; i < w.strings.size(); i++) {
+		CharString utf8 = w.strings[i].utf8();
+		file.put_32(utf8.length());
+		file.put_data((const uint8_t *)utf8.get_data(), utf8.length());
+	}
+
+	file.put_data(w.data.ptr(), w.data.size());
+
+	Vector<uint8_t> buffer;
+	buffer.resize(file.data.size());
+	memcpy(buffer.ptrw(), file.data.ptr(), file.data.size());
+	return buffer;
+}
+
+/* Reading */
+
+struct GDScriptBytecode::Reader {
+	GDScript *root = nullptr;
+	const uint8_t *data = nullptr;
+	uint32_t size = 0;
+	uint32_t pos = 0;
+	Vector<StringName> strings;
+	String error;
+
+	bool has(uint32_t p_size) {
+		if (p_size > size - pos) {
+			fail("Unexpected end of file.");
+			return false;
+		}
+		return true;
+	}
+
+	uint8_t get_8() {
+		if (!has(1)) {
+			return 0;
+		}
+		return data[pos++];
+	}
+
+	uint32_t get_32() {
+		if (!has(4)) {
+			return 0;
+		}
+		uint32_t value = decode_uint32(&data[pos]);
+		pos += 4;
+		return value;
+	}
+
+	// Element count, checked against the remaining data so corrupt files can't cause huge allocations.
+	uint32_t get_count(uint32_t p_element_size = 1) {
+		uint32_t count = get_32();
+		if (count > (size - pos) / p_element_size) {
+			fail("Invalid element count.");
+			return 0;
+		}
+		return count;
+	}
+
+	StringName get_string() {
+		uint32_t index = get_32();
+		if (index >= (uint32_t)strings.size()) {
+			fail("Invalid string index.");
+			return StringName();
+		}
+		return strings[index];
+	}
+
+	bool failed() const {
+		return !error.is_empty();
+	}
+
+	void fail(const String &p_error) {
+		if (error.is_empty()) {
+			error = p_error;
+		}
+	}
+};
+
+template <class T>
+void GDScriptBytecode::_read_symbols(Reader &r, Vector<T> &r_pointers, T (*p_resolve)(const Symbol &), const char *p_what) {
+	uint32_t count = r.get_count(16);
+	r_pointers.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		Symbol symbol;
+		symbol.type = r.get_32();
+		symbol.a = r.get_32();
+		symbol.b = r.get_32();
+		symbol.name = r.get_string();
+		if (r.failed()) {
+			return;
+		}
+		T pointer = p_resolve(symbol);
+		if (!pointer) {
+			r.fail(vformat("Can't find %s '%s'.", p_what, symbol.name));
+			return;
+		}
+		r_pointers.write[i] = pointer;
+	}
+}
+
+Ref<Script> GDScriptBytecode::_read_script_ref(Reader &r, bool p_full) {
+	uint8_t kind = r.get_8();
+	switch (kind) {
+		case SCRIPT_REF_NONE: {
+			return Ref<Script>();
+		}
+		case SCRIPT_REF_RESOURCE: {
+			String path = r.get_string();
+			if (r.failed()) {
+				return Ref<Script>();
+			}
+			Ref<Script> script = ResourceLoader::load(path);
+			if (script.is_null()) {
+				r.fail("Can't load script '" + path + "'.");
+			}
+			return script;
+		}
+		case SCRIPT_REF_LOCAL:
+		case SCRIPT_REF_GDSCRIPT: {
+			String path;
+			if (kind == SCRIPT_REF_GDSCRIPT) {
+				path = r.get_string();
+			}
+			Vector<StringName> names;
+			uint32_t count = r.get_count(4);
+			for (uint32_t i = 0; i < count; i++) {
+				names.push_back(r.get_string());
+			}
+			if (r.failed()) {
+				return Ref<Script>();
+			}
+
+			Ref<GDScript> script;
+			if (kind == SCRIPT_REF_LOCAL) {
+				script = Ref<GDScript>(r.root);
+			} else if (p_full || names.size()) {
+				// Inner classes only exist once the script is compiled.
+				Error err = OK;
+				script = GDScriptCache::get_full_script(path, err, r.root->path);
+				if (err != OK || script.is_null() || !script->is_valid()) {
+					r.fail("Can't load script '" + path + "'.");
+					return Ref<Script>();
+				}
+			} else {
+				// Like the compiler, the script is compiled once this one is done.
+				script = GDScriptCache::get_shallow_script(path, r.root->path);
+			}
+
+			for (int i = 0; i < names.size(); i++) {
+				const Map<StringName, Ref<GDScript>>::Element *E = script->subclasses.find(names[i]);
+				if (!E) {
+					r.fail("Can't find inner class '" + String(names[i]) + "'.");
+					return Ref<Script>();
+				}
+				script = E->get();
+			}
+			return script;
+		}
+		default: {
+			r.fail("Invalid script reference.");
+			return Ref<Script>();
+		}
+	}
+}
+
+GDScriptDataType GDScriptBytecode::_read_data_type(Reader &r) {
+	GDScriptDataType type;
+	type.has_type = r.get_8();
+	uint8_t kind = r.get_8();
+	uint32_t builtin_type = r.get_32();
+	if (kind > GDScriptDataType::GDSCRIPT || builtin_type >= Variant::VARIANT_MAX) {
+		r.fail("Invalid data type.");
+		return GDScriptDataType();
+	}
+	type.kind = GDScriptDataType::Kind(kind);
+	type.builtin_type = Variant::Type(builtin_type);
+	type.native_type = r.get_string();
+
+	Ref<Script> script = _read_script_ref(r, false);
+	bool weak = r.get_8();
+	type.script_type = script.ptr();
+	if (!weak) {
+		type.script_type_ref = script;
+	}
+
+	if (r.get_8()) {
+		type.set_container_element_type(_read_data_type(r));
+	}
+	return type;
+}
+
+Variant GDScriptBytecode::_read_constant(Reader &r) {
+	switch (r.get_8()) {
+		case CONSTANT_VARIANT: {
+			uint32_t len = r.get_count();
+			if (r.failed()) {
+				return Variant();
+			}
+			Variant value;
+			Error err = decode_variant(value, &r.data[r.pos], len);
+			if (err != OK) {
+				r.fail("Invalid constant.");
+			}
+			r.pos += len;
+			return value;
+		}
+		case CONSTANT_NULL_OBJECT: {
+			return Variant((Object *)nullptr);
+		}
+		case CONSTANT_SCRIPT: {
+			return _read_script_ref(r, false);
+		}
+		case CONSTANT_GLOBAL: {
+			StringName name = r.get_string();
+			GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+			const Map<StringName, int>::Element *E = language->get_global_map().find(name);
+			if (!E) {
+				r.fail("Can't find global '" + String(name) + "'.");
+				return Variant();
+			}
+			return language->get_global_array()[E->get()];
+		}
+		case CONSTANT_RESOURCE: {
+			String path = r.get_string();
+			if (r.failed()) {
+				return Variant();
+			}
+			RES resource = ResourceLoader::load(path);
+			if (resource.is_null()) {
+				r.fail("Can't load resource '" + path + "'.");
+			}
+			return resource;
+		}
+		case CONSTANT_ARRAY: {
+			uint32_t builtin_type = r.get_32();
+			StringName class_name = r.get_string();
+			Variant script = _read_constant(r);
+			uint32_t count = r.get_count();
+			if (r.failed() || builtin_type >= Variant::VARIANT_MAX) {
+				r.fail("Invalid array.");
+				return Variant();
+			}
+			Array array;
+			if (builtin_type != Variant::NIL) {
+				array.set_typed(builtin_type, class_name, script);
+			}
+			array.resize(count);
+			for (uint32_t i = 0; i < count; i++) {
+				array[i] = _read_constant(r);
+			}
+			return array;
+		}
+		case CONSTANT_DICTIONARY: {
+			uint32_t count = r.get_count(2);
+			Dictionary dictionary;
+			for (uint32_t i = 0; i < count; i++) {
+				Variant key = _read_constant(r);
+				dictionary[key] = _read_constant(r);
+			}
+			return dictionary;
+		}
+		default: {
+			r.fail("Invalid constant.");
+			return Variant();
+		}
+	}
+}
+
+GDScriptFunction *GDScriptBytecode::_read_function(Reader &r, GDScript *p_script) {
+	GDScriptFunction *function = memnew(GDScriptFunction);
+	function->_script = p_script;
+	function->source = p_script->get_path();
+
+	function->name = r.get_string();
+	function->_static = r.get_8();
+	function->rpc_config.name = r.get_string();
+	function->rpc_config.rpc_mode = MultiplayerAPI::RPCMode(r.get_32());
+	function->rpc_config.sync = r.get_8();
+	function->rpc_config.transfer_mode = MultiplayerPeer::TransferMode(r.get_32());
+	function->rpc_config.channel = r.get_32();
+	function->_initial_line = r.get_32();
+	function->_argument_count = r.get_32();
+
+	uint32_t count = r.get_count();
+	for (uint32_t i = 0; i < count; i++) {
+		function->argument_types.push_back(_read_data_type(r));
+	}
+	function->return_type = _read_data_type(r);
+
+	count = r.get_count(4);
+	function->default_arguments.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		function->default_arguments.write[i] = r.get_32();
+	}
+
+	// The code is copied as is, only the tables it indexes need fixing up.
+	count = r.get_count(4);
+	function->code.resize(count);
+	if (count && r.has(count * 4)) {
+		memcpy(function->code.ptrw(), &r.data[r.pos], count * 4);
+		r.pos += count * 4;
+#ifdef BIG_ENDIAN_ENABLED
+		int *code = function->code.ptrw();
+		for (uint32_t i = 0; i < count; i++) {
+			code[i] = BSWAP32(code[i]);
+		}
+#endif
+	}
+
+	count = r.get_count();
+	function->constants.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		function->constants.write[i] = _read_constant(r);
+	}
+
+	count = r.get_count(4);
+	function->global_names.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		function->global_names.write[i] = r.get_string();
+	}
+
+	_read_symbols<Variant::ValidatedOperatorEvaluator>(
+			r, function->operator_funcs, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::OP_MAX && p_symbol.a < Variant::VARIANT_MAX && p_symbol.b < Variant::VARIANT_MAX ? Variant::get_validated_operator_evaluator(Variant::Operator(p_symbol.type), Variant::Type(p_symbol.a), Variant::Type(p_symbol.b)) : nullptr;
+			},
+			"operator");
+	_read_symbols<Variant::ValidatedSetter>(
+			r, function->setters, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_member_validated_setter(Variant::Type(p_symbol.type), p_symbol.name) : nullptr;
+			},
+			"setter");
+	_read_symbols<Variant::ValidatedGetter>(
+			r, function->getters, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_member_validated_getter(Variant::Type(p_symbol.type), p_symbol.name) : nullptr;
+			},
+			"getter");
+	_read_symbols<Variant::ValidatedKeyedSetter>(
+			r, function->keyed_setters, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_member_validated_keyed_setter(Variant::Type(p_symbol.type)) : nullptr;
+			},
+			"keyed setter");
+	_read_symbols<Variant::ValidatedKeyedGetter>(
+			r, function->keyed_getters, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_member_validated_keyed_getter(Variant::Type(p_symbol.type)) : nullptr;
+			},
+			"keyed getter");
+	_read_symbols<Variant::ValidatedIndexedSetter>(
+			r, function->indexed_setters, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_member_validated_indexed_setter(Variant::Type(p_symbol.type)) : nullptr;
+			},
+			"indexed setter");
+	_read_symbols<Variant::ValidatedIndexedGetter>(
+			r, function->indexed_getters, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_member_validated_indexed_getter(Variant::Type(p_symbol.type)) : nullptr;
+			},
+			"indexed getter");
+	_read_symbols<Variant::ValidatedBuiltInMethod>(
+			r, function->builtin_methods, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_validated_builtin_method(Variant::Type(p_symbol.type), p_symbol.name) : nullptr;
+			},
+			"built-in method");
+	_read_symbols<Variant::ValidatedConstructor>(
+			r, function->constructors, [](const Symbol &p_symbol) {
+				return p_symbol.type < Variant::VARIANT_MAX ? Variant::get_validated_constructor(Variant::Type(p_symbol.type), p_symbol.a) : nullptr;
+			},
+			"constructor");
+	_read_symbols<Variant::ValidatedUtilityFunction>(
+			r, function->utilities, [](const Symbol &p_symbol) {
+				return Variant::get_validated_utility_function(p_symbol.name);
+			},
+			"utility function");
+	_read_symbols<GDScriptUtilityFunctions::FunctionPtr>(
+			r, function->gds_utilities, [](const Symbol &p_symbol) {
+				return GDScriptUtilityFunctions::get_function(p_symbol.name);
+			},
+			"GDScript utility function");
+
+	count = r.get_count(8);
+	function->methods.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		StringName class_name = r.get_string();
+		StringName method_name = r.get_string();
+		MethodBind *method = r.failed() ? nullptr : ClassDB::get_method(class_name, method_name);
+		if (!method) {
+			r.fail("Can't find method '" + String(class_name) + "." + String(method_name) + "'.");
+			break;
+		}
+		function->methods.write[i] = method;
+	}
+
+	count = r.get_count();
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		// Owned by the function right away, so it's freed along with it on failure.
+		function->lambdas.push_back(_read_function(r, p_script));
+	}
+
+	function->_stack_size = r.get_32();
+	function->_instruction_args_size = r.get_32();
+	function->_ptrcall_args_size = r.get_32();
+	// Every cache is referenced by its own instruction.
+	uint32_t inline_caches = r.get_32();
+	if (inline_caches > uint32_t(function->code.size())) {
+		r.fail("Invalid inline cache count.");
+		inline_caches = 0;
+	}
+	function->_alloc_inline_caches(inline_caches);
+
+	count = r.get_count(8);
+	for (uint32_t i = 0; i < count; i++) {
+		int slot = r.get_32();
+		uint32_t type = r.get_32();
+		function->temporary_slots[slot] = type < Variant::VARIANT_MAX ? Variant::Type(type) : Variant::NIL;
+	}
+
+	count = r.get_count(13);
+	for (uint32_t i = 0; i < count; i++) {
+		GDScriptFunction::StackDebug sd;
+		sd.line = r.get_32();
+		sd.pos = r.get_32();
+		sd.added = r.get_8();
+		sd.identifier = r.get_string();
+		function->stack_debug.push_back(sd);
+	}
+
+	count = r.get_count(4);
+	for (uint32_t i = 0; i < count; i++) {
+		StringName arg_name = r.get_string();
+#ifdef TOOLS_ENABLED
+		function->arg_names.push_back(arg_name);
+#endif
+	}
+
+	// Same as GDScriptByteCodeGenerator::write_end().
+	function->_constants_ptr = function->constants.ptrw();
+	function->_constant_count = function->constants.size();
+	function->_global_names_ptr = function->global_names.ptr();
+	function->_global_names_count = function->global_names.size();
+	function->_code_ptr = function->code.ptr();
+	function->_code_size = function->code.size();
+	function->_default_arg_ptr = function->default_arguments.ptr();
+	function->_default_arg_count = MAX(function->default_arguments.size() - 1, 0);
+	function->_operator_funcs_ptr = function->operator_funcs.ptr();
+	function->_operator_funcs_count = function->operator_funcs.size();
+	function->_setters_ptr = function->setters.ptr();
+	function->_setters_count = function->setters.size();
+	function->_getters_ptr = function->getters.ptr();
+	function->_getters_count = function->getters.size();
+	function->_keyed_setters_ptr = function->keyed_setters.ptr();
+	function->_keyed_setters_count = function->keyed_setters.size();
+	function->_keyed_getters_ptr = function->keyed_getters.ptr();
+	function->_keyed_getters_count = function->keyed_getters.size();
+	function->_indexed_setters_ptr = function->indexed_setters.ptr();
+	function->_indexed_setters_count = function->indexed_setters.size();
+	function->_indexed_getters_ptr = function->indexed_getters.ptr();
+	function->_indexed_getters_count = function->indexed_getters.size();
+	function->_builtin_methods_ptr = function->builtin_methods.ptr();
+	function->_builtin_methods_count = function->builtin_methods.size();
+	function->_constructors_ptr = function->constructors.ptr();
+	function->_constructors_count = function->constructors.size();
+	function->_utilities_ptr = function->utilities.ptr();
+	function->_utilities_count = function->utilities.size();
+	function->_gds_utilities_ptr = function->gds_utilities.ptr();
+	function->_gds_utilities_count = function->gds_utilities.size();
+	function->_methods_ptr = function->methods.ptrw();
+	function->_methods_count = function->methods.size();
+	function->_lambdas_ptr = function->lambdas.ptrw();
+	function->_lambdas_count = function->lambdas.size();
+
+#ifdef DEBUG_ENABLED
+	function->func_cname = (String(function->source) + " - " + String(function->name)).utf8();
+	function->_func_cname = function->func_cname.get_data();
+
+	if (EngineDebugger::is_active()) {
+		String signature = String(function->source) + "::" + itos(function->_initial_line) + "::";
+		if (p_script->name != String()) {
+			signature += p_script->name + ".";
+		}
+		function->profile.signature = signature + String(function->name);
+	}
+#endif
+
+	return function;
+}
+
+void GDScriptBytecode::_read_class_tree(Reader &r, GDScript *p_script) {
+	uint32_t count = r.get_count(8);
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		StringName name = r.get_string();
+		Ref<GDScript> subclass;
+		subclass.instantiate();
+		subclass->_owner = p_script;
+		subclass->fully_qualified_name = p_script->fully_qualified_name + "::" + name;
+		p_script->subclasses.insert(name, subclass);
+		_read_class_tree(r, subclass.ptr());
+	}
+}
+
+void GDScriptBytecode::_read_class(Reader &r, GDScript *p_script) {
+	p_script->tool = r.get_8();
+	p_script->name = r.get_string();
+
+	StringName native_name = r.get_string();
+	if (native_name != StringName()) {
+		GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+		const Map<StringName, int>::Element *E = language->get_global_map().find(native_name);
+		if (E) {
+			p_script->native = language->get_global_array()[E->get()];
+		}
+		if (p_script->native.is_null()) {
+			r.fail("Can't find native class '" + String(native_name) + "'.");
+			return;
+		}
+	}
+
+	Ref<GDScript> base = _read_script_ref(r, true);
+	p_script->base = base;
+	p_script->_base = base.ptr();
+
+	uint32_t count = r.get_count();
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		StringName name = r.get_string();
+		GDScript::MemberInfo info;
+		info.index = r.get_32();
+		info.setter = r.get_string();
+		info.getter = r.get_string();
+		info.data_type = _read_data_type(r);
+		p_script->member_indices[name] = info;
+	}
+
+	count = r.get_count(4);
+	for (uint32_t i = 0; i < count; i++) {
+		p_script->members.insert(r.get_string());
+	}
+
+	count = r.get_count(28);
+	for (uint32_t i = 0; i < count; i++) {
+		StringName name = r.get_string();
+		PropertyInfo info;
+		uint32_t type = r.get_32();
+		info.type = type < Variant::VARIANT_MAX ? Variant::Type(type) : Variant::NIL;
+		info.name = r.get_string();
+		info.class_name = r.get_string();
+		info.hint = PropertyHint(r.get_32());
+		info.hint_string = r.get_string();
+		info.usage = r.get_32();
+		p_script->member_info[name] = info;
+	}
+
+	count = r.get_count();
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		StringName name = r.get_string();
+		p_script->constants[name] = _read_constant(r);
+	}
+
+	count = r.get_count();
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		StringName name = r.get_string();
+		Vector<StringName> parameters;
+		uint32_t parameter_count = r.get_count(4);
+		for (uint32_t j = 0; j < parameter_count; j++) {
+			parameters.push_back(r.get_string());
+		}
+		p_script->_signals[name] = parameters;
+	}
+
+	count = r.get_count();
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		StringName name = r.get_string();
+		p_script->member_functions[name] = _read_function(r, p_script);
+	}
+
+	const Map<StringName, GDScriptFunction *>::Element *initializer = p_script->member_functions.find(GDScriptLanguage::get_singleton()->strings._init);
+	p_script->initializer = initializer ? initializer->get() : nullptr;
+	const Map<StringName, GDScriptFunction *>::Element *implicit_initializer = p_script->member_functions.find("@implicit_new");
+	p_script->implicit_initializer = implicit_initializer ? implicit_initializer->get() : nullptr;
+
+	count = r.get_count();
+	for (uint32_t i = 0; i < count && !r.failed(); i++) {
+		StringName name = r.get_string();
+		Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.find(name);
+		if (!E) {
+			r.fail("Can't find inner class '" + String(name) + "'.");
+			return;
+		}
+		_read_class(r, E->get().ptr());
+	}
+
+	p_script->valid = !r.failed();
+}
+
+void GDScriptBytecode::_clear_class(GDScript *p_script) {
+	for (Map<StringName, Ref<GDScript>>::Element *E = p_script->subclasses.front(); E; E = E->next()) {
+		_clear_class(E->get().ptr());
+	}
+	for (Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	p_script->member_functions.clear();
+	p_script->initializer = nullptr;
+	p_script->implicit_initializer = nullptr;
+	p_script->member_indices.clear();
+	p_script->members.clear();
+	p_script->member_info.clear();
+	p_script->constants.clear();
+	p_script->_signals.clear();
+	p_script->subclasses.clear();
+	p_script->base = Ref<GDScript>();
+	p_script->_base = nullptr;
+	p_script->native = Ref<GDScriptNativeClass>();
+	p_script->valid = false;
+}
+
+Error GDScriptBytecode::deserialize(GDScript *p_script, const Vector<uint8_t> &p_buffer, String *r_error) {
+	ERR_FAIL_NULL_V(p_script, ERR_INVALID_PARAMETER);
+
+	if (!is_compatible(p_buffer)) {
+		if (r_error) {
+			*r_error = "Bytecode was written by a different engine version.";
+		}
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	Reader r;
+	r.root = p_script;
+	r.data = p_buffer.ptr();
+	r.size = p_buffer.size();
+	r.pos = HEADER_SIZE + 4;
+
+	// Skip the source.
+	uint32_t compressed_source_size = r.get_32();
+	if (r.has(compressed_source_size)) {
+		r.pos += compressed_source_size;
+	}
+
+	uint32_t string_count = r.get_count(4);
+	r.strings.resize(string_count);
+	for (uint32_t i = 0; i < string_count; i++) {
+		uint32_t len = r.get_count();
+		if (r.failed()) {
+			break;
+		}
+		String string;
+		string.parse_utf8((const char *)&r.data[r.pos], len);
+		r.strings.write[i] = string;
+		r.pos += len;
+	}
+
+	p_script->_owner = nullptr;
+	p_script->fully_qualified_name = p_script->path;
+
+	GDScriptFunction::invalidate_inline_caches();
+	_read_class_tree(r, p_script);
+	if (!r.failed()) {
+		_read_class(r, p_script);
+	}
+	GDScriptFunction::invalidate_inline_caches();
+
+	if (r.failed()) {
+		_clear_class(p_script);
+		if (r_error) {
+			*r_error = r.error;
+		}
+		return ERR_FILE_CORRUPT;
+	}
+
+	return OK;
+}
+
+bool GDScriptBytecode::is_compatible(const Vector<uint8_t> &p_buffer) {
+	if ((uint32_t)p_buffer.size() < SOURCE_OFFSET || memcmp(p_buffer.ptr(), BYTECODE_MAGIC, 4) != 0) {
+		return false;
+	}
+	return decode_uint32(&p_buffer[4]) == BYTECODE_VERSION && decode_uint32(&p_buffer[8]) == _get_compatibility_hash();
+}
+
+String GDScriptBytecode::get_source_code(const Vector<uint8_t> &p_buffer) {
+	if ((uint32_t)p_buffer.size() < SOURCE_OFFSET || memcmp(p_buffer.ptr(), BYTECODE_MAGIC, 4) != 0) {
+		return String();
+	}
+	if (!(decode_uint32(&p_buffer[12]) & FLAG_HAS_SOURCE)) {
+		return String();
+	}
+
+	uint32_t source_size = decode_uint32(&p_buffer[HEADER_SIZE]);
+	uint32_t compressed_size = decode_uint32(&p_buffer[HEADER_SIZE + 4]);
+	ERR_FAIL_COND_V(compressed_size > p_buffer.size() - SOURCE_OFFSET, String());
+	if (source_size == 0) {
+		return String();
+	}
+
+	Vector<uint8_t> source;
+	source.resize(source_size);
+	int result = Compression::decompress(source.ptrw(), source_size, &p_buffer[SOURCE_OFFSET], compressed_size, Compression::MODE_ZSTD);
+	ERR_FAIL_COND_V(result != (int)source_size, String());
+
+	String string;
+	string.parse_utf8((const char *)source.ptr(), source_size);
+	return string;
+}
+
+void GDScriptBytecode::finish() {
+	MutexLock lock(symbol_tables_mutex);
+	if (symbol_tables) {
+		memdelete(symbol_tables);
+		symbol_tables = nullptr;
+	}
+}
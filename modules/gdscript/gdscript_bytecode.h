@@ -0,0 +1,106 @@
+/*************************************************************************/
+/*  gdscript_bytecode.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_H
+#define GDSCRIPT_BYTECODE_H
+
+#include "core/templates/hash_map.h"
+#include "gdscript.h"
+
+// Precompiled form of a script (.gdc), written on export so projects don't
+// need to tokenize, parse, analyze and compile every script when starting.
+//
+// It holds the class layout, constants, type information and the bytecode of
+// every function. Strings go through a shared table, turned into StringNames
+// once when loading. Pointers baked in by the compiler (operator evaluators,
+// method binds, utility functions...) are stored by name and resolved again,
+// so loading is mostly copying the code arrays as they are.
+//
+// The source code is embedded as well: files written by a different engine
+// build, or referencing something that can't be resolved anymore, are compiled
+// from source instead.
+
+class GDScriptBytecode {
+public:
+	enum {
+		// Bump when the layout or the meaning of the bytecode changes.
+		BYTECODE_VERSION = 3,
+	};
+
+private:
+	struct Symbol {
+		uint32_t type = 0;
+		uint32_t a = 0;
+		uint32_t b = 0;
+		StringName name;
+	};
+
+	struct SymbolTables;
+	struct Writer;
+	struct Reader;
+
+	static SymbolTables *symbol_tables;
+
+	static const SymbolTables *_get_symbol_tables();
+	static uint32_t _get_compatibility_hash();
+
+	template <class T>
+	static void _write_symbols(Writer &w, const Vector<T> &p_pointers, const HashMap<uint64_t, Symbol> &p_table, const char *p_what);
+	static void _write_script_ref(Writer &w, const Script *p_script);
+	static void _write_data_type(Writer &w, const GDScriptDataType &p_type);
+	static void _write_constant(Writer &w, const Variant &p_value);
+	static void _write_function(Writer &w, const GDScriptFunction *p_function);
+	static void _write_class_tree(Writer &w, const GDScript *p_script);
+	static void _write_class(Writer &w, const GDScript *p_script);
+
+	template <class T>
+	static void _read_symbols(Reader &r, Vector<T> &r_pointers, T (*p_resolve)(const Symbol &), const char *p_what);
+	static Ref<Script> _read_script_ref(Reader &r, bool p_full);
+	static GDScriptDataType _read_data_type(Reader &r);
+	static Variant _read_constant(Reader &r);
+	static GDScriptFunction *_read_function(Reader &r, GDScript *p_script);
+	static void _read_class_tree(Reader &r, GDScript *p_script);
+	static void _read_class(Reader &r, GDScript *p_script);
+	static void _clear_class(GDScript *p_script);
+
+public:
+	// Only top-level scripts can be serialized, inner classes are stored along with them.
+	static Vector<uint8_t> serialize(const GDScript *p_script, String *r_error = nullptr);
+	static Error deserialize(GDScript *p_script, const Vector<uint8_t> &p_buffer, String *r_error = nullptr);
+
+	// Whether the buffer was written by this engine build and can be deserialized.
+	static bool is_compatible(const Vector<uint8_t> &p_buffer);
+	// Works for any bytecode version, the header and source never move.
+	static String get_source_code(const Vector<uint8_t> &p_buffer);
+
+	static void finish();
+};
+
+#endif // GDSCRIPT_BYTECODE_H
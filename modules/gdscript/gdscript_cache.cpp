@@ -30,10 +30,15 @@
 
 #include "gdscript_cache.h"
 
+#include "core/config/project_settings.h"
 #include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/vector.h"
 #include "gdscript.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode.h"
 #include "gdscript_parser.h"
 
 bool GDScriptParserRef::is_valid() const {
@@ -41,7 +46,7 @@ bool GDScriptParserRef::is_valid() const {
 }
 
 GDScriptParserRef::Status GDScriptParserRef::get_status() const {
-	return status;
+	return Status(status.get());
 }
 
 GDScriptParser *GDScriptParserRef::get_parser() const {
@@ -49,34 +54,42 @@ GDScriptParser *GDScriptParserRef::get_parser() const {
 }
 
 Error GDScriptParserRef::raise_status(Status p_new_status) {
+	// The status is only published once the step is done, so other threads can skip locking.
+	if (p_new_status <= get_status()) {
+		ERR_FAIL_COND_V(parser == nullptr, ERR_INVALID_DATA);
+		return OK;
+	}
+
+	MutexLock lock(mutex);
 	ERR_FAIL_COND_V(parser == nullptr, ERR_INVALID_DATA);
 
 	Error result = OK;
 
-	while (p_new_status > status) {
-		switch (status) {
+	while (p_new_status > get_status()) {
+		Status new_status = get_status();
+		switch (get_status()) {
 			case EMPTY:
 				result = parser->parse(GDScriptCache::get_source_code(path), path, false);
-				status = PARSED;
+				new_status = PARSED;
 				break;
 			case PARSED: {
 				analyzer = memnew(GDScriptAnalyzer(parser));
 				Error inheritance_result = analyzer->resolve_inheritance();
-				status = INHERITANCE_SOLVED;
+				new_status = INHERITANCE_SOLVED;
 				if (result == OK) {
 					result = inheritance_result;
 				}
 			} break;
 			case INHERITANCE_SOLVED: {
 				Error interface_result = analyzer->resolve_interface();
-				status = INTERFACE_SOLVED;
+				new_status = INTERFACE_SOLVED;
 				if (result == OK) {
 					result = interface_result;
 				}
 			} break;
 			case INTERFACE_SOLVED: {
 				Error body_result = analyzer->resolve_body();
-				status = FULLY_SOLVED;
+				new_status = FULLY_SOLVED;
 				if (result == OK) {
 					result = body_result;
 				}
@@ -94,8 +107,10 @@ Error GDScriptParserRef::raise_status(Status p_new_status) {
 				memdelete(analyzer);
 				analyzer = nullptr;
 			}
+			status.set(new_status);
 			return result;
 		}
+		status.set(new_status);
 	}
 
 	return result;
@@ -108,20 +123,379 @@ GDScriptParserRef::~GDScriptParserRef() {
 	if (analyzer != nullptr) {
 		memdelete(analyzer);
 	}
-	MutexLock lock(GDScriptCache::singleton->lock);
+	MutexLock lock(GDScriptCache::get_lock());
 	GDScriptCache::singleton->parser_map.erase(path);
 }
 
+// Compiles a set of scripts, along with the scripts they depend on, using the
+// worker threads. Scripts are parsed in parallel, then their interfaces are
+// resolved on the calling thread (scripts can depend on each other cyclically
+// there). Bodies are analyzed in parallel, and each script is compiled once the
+// scripts it depends on are. Scripts that can't be handled this way (because
+// they load other kinds of resources, which can load scripts too, or because
+// they have errors) are compiled afterwards on the calling thread.
+class GDScriptCompileBatch {
+	struct Entry {
+		String path;
+		Ref<GDScriptParserRef> parser;
+		Ref<GDScript> script;
+		Vector<String> dependency_paths;
+		Vector<int> dependencies;
+		bool compile = false; // Dependencies which were already compiled are only parsed.
+		bool serial = false;
+		bool failed = false;
+		bool done = false; // Protected by the cache lock.
+		Error error = OK;
+		WorkerThreadPool::TaskID task = WorkerThreadPool::INVALID_TASK_ID;
+		bool visited = false;
+	};
+
+	struct WorkerScope {
+		WorkerScope() { GDScriptCache::batch_worker = true; }
+		~WorkerScope() { GDScriptCache::batch_worker = false; }
+	};
+
+	LocalVector<Entry> entries;
+	HashMap<String, int> entry_map;
+	Vector<int> pending;
+	Vector<int> order;
+
+	int _add_script(const String &p_path);
+	void _add_global_dependency(Entry &p_entry, const StringName &p_name);
+	void _get_dependencies(Entry &p_entry);
+	void _sort(int p_index);
+	void _propagate_serial();
+
+	void _parse_script(uint32_t p_index, Vector<int> *p_round);
+	void _analyze_script(uint32_t p_index, Vector<int> *p_list);
+	void _compile_script(int p_index);
+
+public:
+	bool is_pending(const String &p_path) const;
+	Ref<GDScript> get_shallow_script(const String &p_path) const;
+	Ref<GDScript> get_script(const String &p_path, Error &r_error);
+	void compile(const Vector<String> &p_paths);
+};
+
+int GDScriptCompileBatch::_add_script(const String &p_path) {
+	const int *index = entry_map.getptr(p_path);
+	if (index) {
+		return *index;
+	}
+
+	// Precompiled scripts are loaded as usual.
+	String remapped_path = ResourceLoader::path_remap(p_path);
+	if (remapped_path.get_extension() == "gdc" || !FileAccess::exists(remapped_path)) {
+		return -1;
+	}
+
+	Error err = OK;
+	Ref<GDScriptParserRef> parser = GDScriptCache::get_parser(p_path, GDScriptParserRef::EMPTY, err);
+	if (parser.is_null()) {
+		return -1;
+	}
+
+	Entry entry;
+	entry.path = p_path;
+	entry.parser = parser;
+	entry.compile = !GDScriptCache::singleton->full_gdscript_cache.has(p_path);
+
+	int new_index = entries.size();
+	entries.push_back(entry);
+	entry_map[p_path] = new_index;
+	pending.push_back(new_index);
+	return new_index;
+}
+
+void GDScriptCompileBatch::_add_global_dependency(Entry &p_entry, const StringName &p_name) {
+	if (ScriptServer::is_global_class(p_name)) {
+		String path = ScriptServer::get_global_class_path(p_name);
+		if (path.get_extension() == "gd") {
+			p_entry.dependency_paths.push_back(path);
+		}
+	} else if (ProjectSettings::get_singleton()->has_autoload(p_name)) {
+		const ProjectSettings::AutoloadInfo &info = ProjectSettings::get_singleton()->get_autoload(p_name);
+		if (info.path.get_extension() == "gd") {
+			p_entry.dependency_paths.push_back(info.path);
+		} else {
+			p_entry.serial = true;
+		}
+	}
+}
+
+// Lists every script the analyzer could load, from all the nodes of the
+// script. This is conservative, identifiers may not refer to global names.
+void GDScriptCompileBatch::_get_dependencies(Entry &p_entry) {
+	const GDScriptParser *parser = p_entry.parser->get_parser();
+
+	for (const GDScriptParser::Node *node = parser->list; node != nullptr; node = node->next) {
+		switch (node->type) {
+			case GDScriptParser::Node::IDENTIFIER: {
+				_add_global_dependency(p_entry, static_cast<const GDScriptParser::IdentifierNode *>(node)->name);
+			} break;
+			case GDScriptParser::Node::CLASS: {
+				const GDScriptParser::ClassNode *class_node = static_cast<const GDScriptParser::ClassNode *>(node);
+				if (!class_node->extends_path.is_empty()) {
+					p_entry.dependency_paths.push_back(class_node->extends_path);
+				}
+				if (!class_node->extends.is_empty()) {
+					_add_global_dependency(p_entry, class_node->extends[0]);
+				}
+			} break;
+			case GDScriptParser::Node::PRELOAD: {
+				const GDScriptParser::PreloadNode *preload = static_cast<const GDScriptParser::PreloadNode *>(node);
+				if (preload->path == nullptr || preload->path->type != GDScriptParser::Node::LITERAL) {
+					// Resolved from constants by the analyzer.
+					p_entry.serial = true;
+					break;
+				}
+				String path = static_cast<const GDScriptParser::LiteralNode *>(preload->path)->value;
+				if (path.is_rel_path()) {
+					path = p_entry.path.get_base_dir().plus_file(path);
+				}
+				path = path.simplify_path();
+
+				String extension = path.get_extension();
+				if (extension == "gd") {
+					p_entry.dependency_paths.push_back(path);
+				} else if (extension == "tscn" || extension == "scn" || extension == "tres" || extension == "res") {
+					// May load scripts on its own.
+					p_entry.serial = true;
+				}
+			} break;
+			default:
+				break;
+		}
+	}
+}
+
+void GDScriptCompileBatch::_parse_script(uint32_t p_index, Vector<int> *p_round) {
+	WorkerScope scope;
+	Entry &entry = entries[(*p_round)[p_index]];
+
+	if (entry.parser->raise_status(GDScriptParserRef::PARSED) != OK) {
+		entry.failed = true;
+		return;
+	}
+	if (entry.compile) {
+		_get_dependencies(entry);
+	}
+}
+
+void GDScriptCompileBatch::_analyze_script(uint32_t p_index, Vector<int> *p_list) {
+	WorkerScope scope;
+	Entry &entry = entries[(*p_list)[p_index]];
+
+	if (entry.parser->raise_status(GDScriptParserRef::FULLY_SOLVED) != OK) {
+		entry.failed = true;
+	}
+}
+
+void GDScriptCompileBatch::_compile_script(int p_index) {
+	WorkerScope scope;
+	Entry &entry = entries[p_index];
+
+	{
+		MutexLock lock(GDScriptCache::get_lock());
+		if (GDScriptCache::singleton->full_gdscript_cache.has(entry.path)) {
+			// Already compiled by a script depending on it cyclically.
+			entry.done = true;
+			return;
+		}
+	}
+
+	Error err = entry.script->_compile(entry.parser->get_parser(), false);
+
+	MutexLock lock(GDScriptCache::get_lock());
+	entry.error = err;
+	entry.done = true;
+}
+
+// Depth first, so dependencies come before the scripts using them. Cycles are
+// broken where they are found, the compiler loads the missing script in place.
+void GDScriptCompileBatch::_sort(int p_index) {
+	Entry &entry = entries[p_index];
+	if (entry.visited) {
+		return;
+	}
+	entry.visited = true;
+	for (int i = 0; i < entry.dependencies.size(); i++) {
+		_sort(entry.dependencies[i]);
+	}
+	if (entry.compile) {
+		order.push_back(p_index);
+	}
+}
+
+// Scripts using scripts that must be compiled on the calling thread would compile them in place.
+void GDScriptCompileBatch::_propagate_serial() {
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (uint32_t i = 0; i < entries.size(); i++) {
+			Entry &entry = entries[i];
+			if (!entry.compile || entry.serial) {
+				continue;
+			}
+			if (entry.failed) {
+				entry.serial = true;
+				changed = true;
+				continue;
+			}
+			for (int j = 0; j < entry.dependencies.size(); j++) {
+				const Entry &dependency = entries[entry.dependencies[j]];
+				if (dependency.compile && dependency.serial) {
+					entry.serial = true;
+					changed = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+bool GDScriptCompileBatch::is_pending(const String &p_path) const {
+	const int *index = entry_map.getptr(p_path);
+	return index && entries[*index].compile && !entries[*index].done;
+}
+
+Ref<GDScript> GDScriptCompileBatch::get_shallow_script(const String &p_path) const {
+	const int *index = entry_map.getptr(p_path);
+	if (index) {
+		return entries[*index].script;
+	}
+	return Ref<GDScript>();
+}
+
+Ref<GDScript> GDScriptCompileBatch::get_script(const String &p_path, Error &r_error) {
+	const int *index = entry_map.getptr(p_path);
+	if (index && entries[*index].done && entries[*index].script.is_valid()) {
+		r_error = entries[*index].error;
+		return entries[*index].script;
+	}
+	return GDScriptCache::get_full_script(p_path, r_error);
+}
+
+void GDScriptCompileBatch::compile(const Vector<String> &p_paths) {
+	// Fill the parser's lazily initialized tables before it's used from several threads.
+	GDScriptParser::get_builtin_type(StringName());
+	GDScriptParser::get_real_class_name(StringName());
+
+	for (int i = 0; i < p_paths.size(); i++) {
+		_add_script(p_paths[i]);
+	}
+
+	// Parse in rounds, the dependencies are only known once parsed.
+	while (!pending.is_empty()) {
+		Vector<int> round = pending;
+		pending.clear();
+		WorkerThreadPool::get_singleton()->do_work(round.size(), this, &GDScriptCompileBatch::_parse_script, &round);
+
+		for (int i = 0; i < round.size(); i++) {
+			const Vector<String> dependency_paths = entries[round[i]].dependency_paths;
+			for (int j = 0; j < dependency_paths.size(); j++) {
+				if (ResourceLoader::path_remap(dependency_paths[j]).get_extension() == "gdc") {
+					// Loading it compiles the scripts it depends on in place.
+					entries[round[i]].serial = true;
+					continue;
+				}
+				int index = _add_script(dependency_paths[j]);
+				if (index >= 0 && index != round[i] && entries[round[i]].dependencies.find(index) == -1) {
+					entries[round[i]].dependencies.push_back(index);
+				}
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		Entry &entry = entries[i];
+		if (entry.compile) {
+			entry.script = GDScriptCache::get_shallow_script(entry.path);
+		}
+	}
+
+	// Interfaces can depend on each other, they are resolved here so the
+	// parallel steps only read the other scripts' parsers.
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		Entry &entry = entries[i];
+		if (!entry.failed && entry.parser->raise_status(GDScriptParserRef::INTERFACE_SOLVED) != OK) {
+			entry.failed = true;
+		}
+	}
+	_propagate_serial();
+
+	Vector<int> parallel;
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		if (entries[i].compile && !entries[i].serial) {
+			parallel.push_back(i);
+		}
+	}
+	WorkerThreadPool::get_singleton()->do_work(parallel.size(), this, &GDScriptCompileBatch::_analyze_script, &parallel);
+	_propagate_serial();
+
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		_sort(i);
+	}
+
+	// Each task depends on the tasks of the scripts it uses, except the ones
+	// still being visited (cyclic dependencies).
+	for (int i = 0; i < order.size(); i++) {
+		Entry &entry = entries[order[i]];
+		if (entry.serial) {
+			continue;
+		}
+		Vector<WorkerThreadPool::TaskID> tasks;
+		for (int j = 0; j < entry.dependencies.size(); j++) {
+			WorkerThreadPool::TaskID task = entries[entry.dependencies[j]].task;
+			if (task != WorkerThreadPool::INVALID_TASK_ID) {
+				tasks.push_back(task);
+			}
+		}
+		entry.task = WorkerThreadPool::get_singleton()->add_template_task(this, &GDScriptCompileBatch::_compile_script, order[i], false, "Compile " + entry.path, tasks);
+	}
+	for (int i = 0; i < order.size(); i++) {
+		if (entries[order[i]].task != WorkerThreadPool::INVALID_TASK_ID) {
+			WorkerThreadPool::get_singleton()->wait_for_task_completion(entries[order[i]].task);
+		}
+	}
+
+	// Everything else is compiled as usual.
+	for (int i = 0; i < order.size(); i++) {
+		Entry &entry = entries[order[i]];
+		if (!entry.done) {
+			entry.script = GDScriptCache::get_full_script(entry.path, entry.error);
+			entry.done = true;
+		}
+	}
+}
+
 GDScriptCache *GDScriptCache::singleton = nullptr;
+thread_local bool GDScriptCache::batch_worker = false;
+thread_local int GDScriptCache::compile_depth = 0;
+
+bool GDScriptCache::can_compile_batch() {
+	// Loads done while compiling another script are compiled in place. Worker
+	// threads don't start batches either, they run unrelated tasks while waiting.
+	return singleton->threaded_compilation && compile_depth == 0 && !batch_worker && WorkerThreadPool::get_thread_index() == -1 && WorkerThreadPool::get_singleton()->get_thread_count() > 1;
+}
+
+// Exported projects remap scripts to their precompiled version.
+static Error _load_script_code(GDScript *p_script, const String &p_path) {
+	String remapped_path = ResourceLoader::path_remap(p_path);
+	if (remapped_path.get_extension() == "gdc") {
+		return p_script->load_byte_code(remapped_path);
+	}
+	return p_script->load_source_code(p_path);
+}
 
 void GDScriptCache::remove_script(const String &p_path) {
-	MutexLock lock(singleton->lock);
+	MutexLock lock(get_lock());
 	singleton->shallow_gdscript_cache.erase(p_path);
 	singleton->full_gdscript_cache.erase(p_path);
 }
 
 Ref<GDScriptParserRef> GDScriptCache::get_parser(const String &p_path, GDScriptParserRef::Status p_status, Error &r_error, const String &p_owner) {
-	MutexLock lock(singleton->lock);
+	MutexLock lock(get_lock());
 	Ref<GDScriptParserRef> ref;
 	if (p_owner != String()) {
 		singleton->dependencies[p_owner].insert(p_path);
@@ -129,7 +503,7 @@ Ref<GDScriptParserRef> GDScriptCache::get_parser(const String &p_path, GDScriptP
 	if (singleton->parser_map.has(p_path)) {
 		ref = Ref<GDScriptParserRef>(singleton->parser_map[p_path]);
 	} else {
-		if (!FileAccess::exists(p_path)) {
+		if (!FileAccess::exists(ResourceLoader::path_remap(p_path))) {
 			r_error = ERR_FILE_NOT_FOUND;
 			return ref;
 		}
@@ -146,6 +520,11 @@ Ref<GDScriptParserRef> GDScriptCache::get_parser(const String &p_path, GDScriptP
 }
 
 String GDScriptCache::get_source_code(const String &p_path) {
+	String remapped_path = ResourceLoader::path_remap(p_path);
+	if (remapped_path.get_extension() == "gdc") {
+		return GDScriptBytecode::get_source_code(FileAccess::get_file_as_array(remapped_path));
+	}
+
 	Vector<uint8_t> source_file;
 	Error err;
 	FileAccessRef f = FileAccess::open(p_path, FileAccess::READ, &err);
@@ -168,7 +547,7 @@ String GDScriptCache::get_source_code(const String &p_path) {
 }
 
 Ref<GDScript> GDScriptCache::get_shallow_script(const String &p_path, const String &p_owner) {
-	MutexLock lock(singleton->lock);
+	MutexLock lock(get_lock());
 	if (p_owner != String()) {
 		singleton->dependencies[p_owner].insert(p_path);
 	}
@@ -183,14 +562,31 @@ Ref<GDScript> GDScriptCache::get_shallow_script(const String &p_path, const Stri
 	script.instantiate();
 	script->set_path(p_path, true);
 	script->set_script_path(p_path);
-	script->load_source_code(p_path);
+	_load_script_code(script.ptr(), p_path);
 
 	singleton->shallow_gdscript_cache[p_path] = script.ptr();
 	return script;
 }
 
 Ref<GDScript> GDScriptCache::get_full_script(const String &p_path, Error &r_error, const String &p_owner) {
-	MutexLock lock(singleton->lock);
+	if (p_owner.is_empty() && can_compile_batch()) {
+		{
+			MutexLock lock(singleton->lock);
+			if (singleton->full_gdscript_cache.has(p_path)) {
+				r_error = OK;
+				return singleton->full_gdscript_cache[p_path];
+			}
+		}
+
+		Vector<String> paths;
+		paths.push_back(p_path);
+		Vector<Error> errors;
+		Ref<GDScript> script = get_full_scripts(paths, errors)[0];
+		r_error = errors[0];
+		return script;
+	}
+
+	MutexLock lock(get_lock());
 
 	if (p_owner != String()) {
 		singleton->dependencies[p_owner].insert(p_path);
@@ -202,7 +598,7 @@ Ref<GDScript> GDScriptCache::get_full_script(const String &p_path, Error &r_erro
 	}
 	Ref<GDScript> script = get_shallow_script(p_path);
 
-	r_error = script->load_source_code(p_path);
+	r_error = _load_script_code(script.ptr(), p_path);
 
 	if (r_error) {
 		return script;
@@ -219,16 +615,72 @@ Ref<GDScript> GDScriptCache::get_full_script(const String &p_path, Error &r_erro
 	return script;
 }
 
+Vector<Ref<GDScript>> GDScriptCache::get_full_scripts(const Vector<String> &p_paths, Vector<Error> &r_errors) {
+	Vector<Ref<GDScript>> scripts;
+	scripts.resize(p_paths.size());
+	r_errors.resize(p_paths.size());
+
+	if (!can_compile_batch()) {
+		for (int i = 0; i < p_paths.size(); i++) {
+			scripts.write[i] = get_full_script(p_paths[i], r_errors.write[i]);
+		}
+		return scripts;
+	}
+
+	// Other threads loading scripts wait for the batch to finish.
+	MutexLock lock(singleton->lock);
+	CompileScope compile_scope;
+
+	GDScriptCompileBatch batch;
+	singleton->batch = &batch;
+	batch.compile(p_paths);
+	singleton->batch = nullptr;
+
+	for (int i = 0; i < p_paths.size(); i++) {
+		scripts.write[i] = batch.get_script(p_paths[i], r_errors.write[i]);
+	}
+	return scripts;
+}
+
+Ref<GDScript> GDScriptCache::get_batch_script(const String &p_path) {
+	if (!batch_worker) {
+		return Ref<GDScript>();
+	}
+
+	// The thread running the batch may be loading it, waiting for it there would deadlock.
+	MutexLock lock(singleton->batch_lock);
+	if (singleton->full_gdscript_cache.has(p_path)) {
+		return singleton->full_gdscript_cache[p_path];
+	}
+	if (singleton->batch) {
+		return singleton->batch->get_shallow_script(p_path);
+	}
+	return Ref<GDScript>();
+}
+
 Error GDScriptCache::finish_compiling(const String &p_owner) {
-	// Mark this as compiled.
-	Ref<GDScript> script = get_shallow_script(p_owner);
-	singleton->full_gdscript_cache[p_owner] = script.ptr();
-	singleton->shallow_gdscript_cache.erase(p_owner);
+	Set<String> depends;
+	{
+		MutexLock lock(get_lock());
 
-	Set<String> depends = singleton->dependencies[p_owner];
+		// Mark this as compiled.
+		Ref<GDScript> script = get_shallow_script(p_owner);
+		singleton->full_gdscript_cache[p_owner] = script.ptr();
+		singleton->shallow_gdscript_cache.erase(p_owner);
+
+		depends = singleton->dependencies[p_owner];
+		singleton->dependencies.erase(p_owner);
+	}
 
 	Error err = OK;
 	for (const Set<String>::Element *E = depends.front(); E != nullptr; E = E->next()) {
+		{
+			MutexLock lock(get_lock());
+			if (singleton->batch && singleton->batch->is_pending(E->get())) {
+				continue; // Compiled by the batch.
+			}
+		}
+
 		Error this_err = OK;
 		// No need to save the script. We assume it's already referenced in the owner.
 		get_full_script(E->get(), this_err);
@@ -238,8 +690,6 @@ Error GDScriptCache::finish_compiling(const String &p_owner) {
 		}
 	}
 
-	singleton->dependencies.erase(p_owner);
-
 	return err;
 }
 
@@ -34,6 +34,7 @@
 #include "core/object/ref_counted.h"
 #include "core/os/mutex.h"
 #include "core/templates/hash_map.h"
+#include "core/templates/safe_refcount.h"
 #include "core/templates/set.h"
 #include "gdscript.h"
 
@@ -53,7 +54,8 @@ public:
 private:
 	GDScriptParser *parser = nullptr;
 	GDScriptAnalyzer *analyzer = nullptr;
-	Status status = EMPTY;
+	SafeNumeric<uint32_t> status; // Once a status is reached, the parser is only read.
+	Mutex mutex; // Held while raising the status.
 	String path;
 
 	friend class GDScriptCache;
@@ -68,6 +70,8 @@ public:
 	~GDScriptParserRef();
 };
 
+class GDScriptCompileBatch;
+
 class GDScriptCache {
 	// String key is full path.
 	HashMap<String, GDScriptParserRef *> parser_map;
@@ -77,19 +81,44 @@ class GDScriptCache {
 
 	friend class GDScript;
 	friend class GDScriptParserRef;
+	friend class GDScriptCompileBatch;
 
 	static GDScriptCache *singleton;
 
 	Mutex lock;
+	// While a batch compiles, the thread that started it holds `lock` so no
+	// other thread can load scripts, and its worker tasks use this one instead.
+	Mutex batch_lock;
+	GDScriptCompileBatch *batch = nullptr;
+	bool threaded_compilation = true;
+
+	static thread_local bool batch_worker;
+	static thread_local int compile_depth;
+
+	static Mutex &get_lock() { return batch_worker ? singleton->batch_lock : singleton->lock; }
+	static bool can_compile_batch();
 	static void remove_script(const String &p_path);
 
+	// Marks the calling thread as compiling, scripts it loads meanwhile are compiled in place.
+	struct CompileScope {
+		CompileScope() { compile_depth++; }
+		~CompileScope() { compile_depth--; }
+	};
+
 public:
 	static Ref<GDScriptParserRef> get_parser(const String &p_path, GDScriptParserRef::Status status, Error &r_error, const String &p_owner = String());
 	static String get_source_code(const String &p_path);
 	static Ref<GDScript> get_shallow_script(const String &p_path, const String &p_owner = String());
 	static Ref<GDScript> get_full_script(const String &p_path, Error &r_error, const String &p_owner = String());
+	// Compiles the scripts and the scripts they depend on using the worker threads.
+	static Vector<Ref<GDScript>> get_full_scripts(const Vector<String> &p_paths, Vector<Error> &r_errors);
+	// Scripts from the batch the calling worker thread compiles, which must not be loaded from there.
+	static Ref<GDScript> get_batch_script(const String &p_path);
 	static Error finish_compiling(const String &p_owner);
 
+	static void set_threaded_compilation(bool p_enabled) { singleton->threaded_compilation = p_enabled; }
+	static bool is_threaded_compilation() { return singleton->threaded_compilation; }
+
 	GDScriptCache();
 	~GDScriptCache();
 };
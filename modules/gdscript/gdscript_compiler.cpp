@@ -335,7 +335,11 @@ GDScriptCodeGenerator::Address GDScriptCompiler::_parse_expression(CodeGen &code
 				if (class_node->identifier && class_node->identifier->name == identifier) {
 					res = Ref<GDScript>(main_script);
 				} else {
-					res = ResourceLoader::load(ScriptServer::get_global_class_path(identifier));
+					String global_path = ScriptServer::get_global_class_path(identifier);
+					res = GDScriptCache::get_batch_script(global_path);
+					if (res.is_null()) {
+						res = ResourceLoader::load(global_path);
+					}
 					if (res.is_null()) {
 						_set_error("Can't load global class " + String(identifier) + ", cyclic reference?", p_expression);
 						r_error = ERR_COMPILATION_FAILED;
@@ -489,6 +493,10 @@ GDScriptCodeGenerator::Address GDScriptCompiler::_parse_expression(CodeGen &code
 				Variant::Type vtype = GDScriptParser::get_builtin_type(static_cast<GDScriptParser::IdentifierNode *>(call->callee)->name);
 
 				gen->write_construct(result, vtype, arguments);
+			} else if (!call->is_super && call->callee->type == GDScriptParser::Node::IDENTIFIER && call->function_name == "range" && type.has_type && type.kind == GDScriptDataType::BUILTIN && type.builtin_type != Variant::ARRAY) {
+				// A for loop over range() with runtime bounds. The analyzer typed it as the
+				// int, Vector2i or Vector3i the loop iterates over, so build that instead of an array.
+				gen->write_construct(result, type.builtin_type, arguments);
 			} else if (!call->is_super && call->callee->type == GDScriptParser::Node::IDENTIFIER && Variant::has_utility_function(call->function_name)) {
 				// Variant utility function.
 				gen->write_call_utility(result, call->function_name, arguments);
@@ -1850,7 +1858,9 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Sui
 GDScriptFunction *GDScriptCompiler::_parse_function(Error &r_error, GDScript *p_script, const GDScriptParser::ClassNode *p_class, const GDScriptParser::FunctionNode *p_func, bool p_for_ready, bool p_for_lambda) {
 	r_error = OK;
 	CodeGen codegen;
-	codegen.generator = memnew(GDScriptByteCodeGenerator);
+	GDScriptByteCodeGenerator *generator = memnew(GDScriptByteCodeGenerator);
+	generator->set_specialize_instructions(specialize_instructions);
+	codegen.generator = generator;
 
 	codegen.class_node = p_class;
 	codegen.script = p_script;
@@ -2063,7 +2073,9 @@ GDScriptFunction *GDScriptCompiler::_parse_function(Error &r_error, GDScript *p_
 Error GDScriptCompiler::_parse_setter_getter(GDScript *p_script, const GDScriptParser::ClassNode *p_class, const GDScriptParser::VariableNode *p_variable, bool p_is_setter) {
 	Error error = OK;
 	CodeGen codegen;
-	codegen.generator = memnew(GDScriptByteCodeGenerator);
+	GDScriptByteCodeGenerator *generator = memnew(GDScriptByteCodeGenerator);
+	generator->set_specialize_instructions(specialize_instructions);
+	codegen.generator = generator;
 
 	codegen.class_node = p_class;
 	codegen.script = p_script;
@@ -2610,17 +2622,20 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 	// The best fully qualified name for a base level script is its file path
 	p_script->fully_qualified_name = p_script->path;
 
+	GDScriptFunction::invalidate_inline_caches();
+
 	// Create scripts for subclasses beforehand so they can be referenced
 	_make_scripts(p_script, root, p_keep_state);
 
 	p_script->_owner = nullptr;
 	Error err = _parse_class_level(p_script, root, p_keep_state);
 
-	if (err) {
-		return err;
+	if (err == OK) {
+		err = _parse_class_blocks(p_script, root, p_keep_state);
 	}
 
-	err = _parse_class_blocks(p_script, root, p_keep_state);
+	// Lookups may have been cached from the partially compiled script.
+	GDScriptFunction::invalidate_inline_caches();
 
 	if (err) {
 		return err;
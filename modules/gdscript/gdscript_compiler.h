@@ -138,10 +138,14 @@ class GDScriptCompiler {
 	StringName source;
 	String error;
 	bool within_await = false;
+	bool specialize_instructions = true;
 
 public:
 	Error compile(const GDScriptParser *p_parser, GDScript *p_script, bool p_keep_state = false);
 
+	// Only turned off to compare against the generic opcodes.
+	void set_specialize_instructions(bool p_enabled) { specialize_instructions = p_enabled; }
+
 	String get_error() const;
 	int get_error_line() const;
 	int get_error_column() const;
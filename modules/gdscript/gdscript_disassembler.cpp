@@ -134,6 +134,38 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr += 5;
 			} break;
+
+#define DISASSEMBLE_TYPED_OPERATOR(m_name, m_op)  \
+	case OPCODE_##m_name: {                       \
+		text += "typed operator ";                \
+		text += DADDR(3);                         \
+		text += " = ";                            \
+		text += DADDR(1);                         \
+		text += " " m_op " ";                     \
+		text += DADDR(2);                         \
+		incr = 4;                                 \
+	} break
+
+				DISASSEMBLE_TYPED_OPERATOR(ADD_INT, "+");
+				DISASSEMBLE_TYPED_OPERATOR(SUBTRACT_INT, "-");
+				DISASSEMBLE_TYPED_OPERATOR(MULTIPLY_INT, "*");
+				DISASSEMBLE_TYPED_OPERATOR(EQUAL_INT, "==");
+				DISASSEMBLE_TYPED_OPERATOR(NOT_EQUAL_INT, "!=");
+				DISASSEMBLE_TYPED_OPERATOR(LESS_INT, "<");
+				DISASSEMBLE_TYPED_OPERATOR(LESS_EQUAL_INT, "<=");
+				DISASSEMBLE_TYPED_OPERATOR(GREATER_INT, ">");
+				DISASSEMBLE_TYPED_OPERATOR(GREATER_EQUAL_INT, ">=");
+				DISASSEMBLE_TYPED_OPERATOR(ADD_FLOAT, "+");
+				DISASSEMBLE_TYPED_OPERATOR(SUBTRACT_FLOAT, "-");
+				DISASSEMBLE_TYPED_OPERATOR(MULTIPLY_FLOAT, "*");
+				DISASSEMBLE_TYPED_OPERATOR(DIVIDE_FLOAT, "/");
+				DISASSEMBLE_TYPED_OPERATOR(EQUAL_FLOAT, "==");
+				DISASSEMBLE_TYPED_OPERATOR(NOT_EQUAL_FLOAT, "!=");
+				DISASSEMBLE_TYPED_OPERATOR(LESS_FLOAT, "<");
+				DISASSEMBLE_TYPED_OPERATOR(LESS_EQUAL_FLOAT, "<=");
+				DISASSEMBLE_TYPED_OPERATOR(GREATER_FLOAT, ">");
+				DISASSEMBLE_TYPED_OPERATOR(GREATER_EQUAL_FLOAT, ">=");
+
 			case OPCODE_EXTENDS_TEST: {
 				text += "is object ";
 				text += DADDR(3);
@@ -225,7 +257,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				text += "\"] = ";
 				text += DADDR(2);
 
-				incr += 4;
+				incr += 5;
 			} break;
 			case OPCODE_SET_NAMED_VALIDATED: {
 				text += "set_named validated ";
@@ -246,7 +278,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				text += _global_names_ptr[_code_ptr[ip + 3]];
 				text += "\"]";
 
-				incr += 4;
+				incr += 5;
 			} break;
 			case OPCODE_GET_NAMED_VALIDATED: {
 				text += "get_named validated ";
@@ -509,7 +541,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				}
 				text += ")";
 
-				incr = 5 + argc;
+				incr = 6 + argc;
 			} break;
 			case OPCODE_CALL_METHOD_BIND:
 			case OPCODE_CALL_METHOD_BIND_RET: {
@@ -792,6 +824,31 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr = 3;
 			} break;
+
+#define DISASSEMBLE_JUMP_IF_NOT_COMPARE(m_name, m_op)  \
+	case OPCODE_##m_name: {                            \
+		text += "jump-if-not ";                        \
+		text += DADDR(1);                              \
+		text += " " m_op " ";                          \
+		text += DADDR(2);                              \
+		text += " to ";                                \
+		text += itos(_code_ptr[ip + 3]);               \
+		incr = 4;                                      \
+	} break
+
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_EQUAL_INT, "==");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_EQUAL_INT, "!=");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_INT, "<");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_EQUAL_INT, "<=");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_INT, ">");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_EQUAL_INT, ">=");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_EQUAL_FLOAT, "==");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_EQUAL_FLOAT, "!=");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_FLOAT, "<");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_EQUAL_FLOAT, "<=");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_FLOAT, ">");
+				DISASSEMBLE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_EQUAL_FLOAT, ">=");
+
 			case OPCODE_JUMP_TO_DEF_ARGUMENT: {
 				text += "jump-to-default-argument ";
 
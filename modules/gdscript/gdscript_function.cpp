@@ -30,6 +30,8 @@
 
 #include "gdscript_function.h"
 
+#include "core/debugger/sampling_profiler.h"
+#include "core/debugger/trace.h"
 #include "gdscript.h"
 
 const int *GDScriptFunction::get_code() const {
@@ -138,6 +140,53 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+const char *GDScriptFunction::_get_trace_name() {
+	if (!_trace_name) {
+		_trace_name = Trace::intern(String(source) + "::" + String(name));
+	}
+	return _trace_name;
+}
+
+const char *GDScriptFunction::_get_sampling_name() {
+	if (!_sampling_name) {
+		_sampling_name = SamplingProfiler::intern(String(source) + "::" + String(name));
+	}
+	return _sampling_name;
+}
+
+SafeNumeric<uint32_t> GDScriptFunction::InlineCache::generation(1);
+
+void GDScriptFunction::InlineCache::store(uint32_t p_generation, uint64_t p_script, const void *p_class_name, const Target &p_target) {
+	for (int i = 0; i < ENTRY_MAX; i++) {
+		Entry &e = entries[i];
+		uint32_t sequence = e.sequence.load(std::memory_order_relaxed);
+		if (sequence & 1) {
+			continue; // Another thread is filling it.
+		}
+		if (e.generation.load(std::memory_order_relaxed) == generation.get()) {
+			continue; // Holds another receiver type, or the same one stored meanwhile.
+		}
+		if (!e.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed)) {
+			continue;
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+		e.generation.store(p_generation, std::memory_order_relaxed);
+		e.script.store(p_script, std::memory_order_relaxed);
+		e.class_name.store(p_class_name, std::memory_order_relaxed);
+		e.kind.store(p_target.kind, std::memory_order_relaxed);
+		e.index.store(p_target.index, std::memory_order_relaxed);
+		e.target.store(p_target.target, std::memory_order_relaxed);
+		e.sequence.store(sequence + 2, std::memory_order_release);
+		return;
+	}
+	megamorphic.store(p_generation, std::memory_order_relaxed);
+}
+
+void GDScriptFunction::_alloc_inline_caches(int p_count) {
+	_inline_caches_count = p_count;
+	_inline_caches_ptr = p_count > 0 ? memnew_arr(InlineCache, p_count) : nullptr;
+}
+
 GDScriptFunction::GDScriptFunction() {
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -153,6 +202,10 @@ GDScriptFunction::~GDScriptFunction() {
 		memdelete(lambdas[i]);
 	}
 
+	if (_inline_caches_ptr) {
+		memdelete_arr(_inline_caches_ptr);
+	}
+
 #ifdef DEBUG_ENABLED
 
 	MutexLock lock(GDScriptLanguage::get_singleton()->lock);
@@ -36,10 +36,13 @@
 #include "core/os/thread.h"
 #include "core/string/string_name.h"
 #include "core/templates/pair.h"
+#include "core/templates/safe_refcount.h"
 #include "core/templates/self_list.h"
 #include "core/variant/variant.h"
 #include "gdscript_utility_functions.h"
 
+#include <atomic>
+
 class GDScriptInstance;
 class GDScript;
 
@@ -224,6 +227,25 @@ public:
 	enum Opcode {
 		OPCODE_OPERATOR,
 		OPCODE_OPERATOR_VALIDATED,
+		OPCODE_ADD_INT,
+		OPCODE_SUBTRACT_INT,
+		OPCODE_MULTIPLY_INT,
+		OPCODE_EQUAL_INT,
+		OPCODE_NOT_EQUAL_INT,
+		OPCODE_LESS_INT,
+		OPCODE_LESS_EQUAL_INT,
+		OPCODE_GREATER_INT,
+		OPCODE_GREATER_EQUAL_INT,
+		OPCODE_ADD_FLOAT,
+		OPCODE_SUBTRACT_FLOAT,
+		OPCODE_MULTIPLY_FLOAT,
+		OPCODE_DIVIDE_FLOAT,
+		OPCODE_EQUAL_FLOAT,
+		OPCODE_NOT_EQUAL_FLOAT,
+		OPCODE_LESS_FLOAT,
+		OPCODE_LESS_EQUAL_FLOAT,
+		OPCODE_GREATER_FLOAT,
+		OPCODE_GREATER_EQUAL_FLOAT,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET_KEYED,
@@ -306,6 +328,18 @@ public:
 		OPCODE_JUMP,
 		OPCODE_JUMP_IF,
 		OPCODE_JUMP_IF_NOT,
+		OPCODE_JUMP_IF_NOT_EQUAL_INT,
+		OPCODE_JUMP_IF_EQUAL_INT,
+		OPCODE_JUMP_IF_NOT_LESS_INT,
+		OPCODE_JUMP_IF_NOT_LESS_EQUAL_INT,
+		OPCODE_JUMP_IF_NOT_GREATER_INT,
+		OPCODE_JUMP_IF_NOT_GREATER_EQUAL_INT,
+		OPCODE_JUMP_IF_NOT_EQUAL_FLOAT,
+		OPCODE_JUMP_IF_EQUAL_FLOAT,
+		OPCODE_JUMP_IF_NOT_LESS_FLOAT,
+		OPCODE_JUMP_IF_NOT_LESS_EQUAL_FLOAT,
+		OPCODE_JUMP_IF_NOT_GREATER_FLOAT,
+		OPCODE_JUMP_IF_NOT_GREATER_EQUAL_FLOAT,
 		OPCODE_JUMP_TO_DEF_ARGUMENT,
 		OPCODE_RETURN,
 		OPCODE_RETURN_TYPED_BUILTIN,
@@ -427,6 +461,88 @@ public:
 private:
 	friend class GDScriptCompiler;
 	friend class GDScriptByteCodeGenerator;
+	friend class GDScriptBytecode;
+
+	// Remembers what a named get, set or call resolved to for the last few
+	// receiver types an instruction saw, so running it again on one of them
+	// skips the script member and ClassDB lookups.
+	struct InlineCache {
+		enum {
+			ENTRY_MAX = 4,
+		};
+
+		enum Kind {
+			KIND_NONE, // Resolved through the regular path.
+			KIND_MEMBER, // Script member variable, by index.
+			KIND_PROPERTY, // Native property setter or getter, with its index argument if any.
+			KIND_SCRIPT_METHOD,
+			KIND_NATIVE_METHOD,
+		};
+
+		struct Target {
+			Kind kind = KIND_NONE;
+			int index = -1;
+			void *target = nullptr; // GDScriptFunction or MethodBind.
+		};
+
+		// Entries are written by whichever thread runs the instruction. The
+		// sequence is odd while an entry is written, readers skip it then.
+		struct Entry {
+			std::atomic<uint32_t> sequence{ 0 };
+			std::atomic<uint32_t> generation{ 0 };
+			std::atomic<uint64_t> script{ 0 }; // Receiver script ID, zero without one.
+			std::atomic<const void *> class_name{ nullptr };
+			std::atomic<uint32_t> kind{ KIND_NONE };
+			std::atomic<int32_t> index{ -1 };
+			std::atomic<void *> target{ nullptr };
+		};
+
+		Entry entries[ENTRY_MAX];
+		std::atomic<uint32_t> megamorphic{ 0 }; // Generation in which it saw more receiver types than it holds.
+
+		// Bumped whenever a script is compiled, which invalidates every entry.
+		static SafeNumeric<uint32_t> generation;
+
+		_FORCE_INLINE_ bool lookup(uint64_t p_script, const void *p_class_name, Target &r_target) const {
+			uint32_t current = generation.get();
+			for (int i = 0; i < ENTRY_MAX; i++) {
+				const Entry &e = entries[i];
+				uint32_t sequence = e.sequence.load(std::memory_order_acquire);
+				if (sequence & 1) {
+					continue;
+				}
+				if (e.generation.load(std::memory_order_relaxed) != current || e.script.load(std::memory_order_relaxed) != p_script || e.class_name.load(std::memory_order_relaxed) != p_class_name) {
+					continue;
+				}
+				r_target.kind = Kind(e.kind.load(std::memory_order_relaxed));
+				r_target.index = e.index.load(std::memory_order_relaxed);
+				r_target.target = e.target.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (e.sequence.load(std::memory_order_relaxed) == sequence) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		_FORCE_INLINE_ bool is_megamorphic() const { return megamorphic.load(std::memory_order_relaxed) == generation.get(); }
+
+		void store(uint32_t p_generation, uint64_t p_script, const void *p_class_name, const Target &p_target);
+	};
+
+	struct Receiver {
+		Object *object = nullptr;
+		GDScriptInstance *instance = nullptr;
+		uint64_t script = 0;
+		const void *class_name = nullptr;
+	};
+
+	_FORCE_INLINE_ static bool _get_receiver(Object *p_object, Receiver &r_receiver);
+	static InlineCache::Target _resolve_named(const Receiver &p_receiver, const StringName &p_name, bool p_set);
+	static InlineCache::Target _resolve_call(const Receiver &p_receiver, const StringName &p_method);
+	_FORCE_INLINE_ bool _get_named_cached(InlineCache *p_cache, const Variant *p_base, const StringName &p_name, Variant &r_ret) const;
+	_FORCE_INLINE_ bool _set_named_cached(InlineCache *p_cache, Variant *p_base, const StringName &p_name, const Variant &p_value, bool &r_valid) const;
+	_FORCE_INLINE_ bool _call_cached(InlineCache *p_cache, const Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) const;
 
 	StringName source;
 
@@ -463,6 +579,8 @@ private:
 	MethodBind **_methods_ptr = nullptr;
 	int _lambdas_count = 0;
 	GDScriptFunction **_lambdas_ptr = nullptr;
+	int _inline_caches_count = 0;
+	InlineCache *_inline_caches_ptr = nullptr; // Owned, not copyable.
 	const int *_code_ptr = nullptr;
 	int _code_size = 0;
 	int _argument_count = 0;
@@ -472,6 +590,8 @@ private:
 
 	int _initial_line = 0;
 	bool _static = false;
+	const char *_trace_name = nullptr; // Interned, so it outlives the function in saved traces.
+	const char *_sampling_name = nullptr; // Same, for the sampling profiler.
 	MultiplayerAPI::RPCConfig rpc_config;
 
 	GDScript *_script = nullptr;
@@ -506,8 +626,12 @@ private:
 
 	List<StackDebug> stack_debug;
 
+	void _alloc_inline_caches(int p_count);
+
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Callable::CallError &p_err, const String &p_where, const Variant **argptrs) const;
+	const char *_get_trace_name();
+	const char *_get_sampling_name();
 
 	friend class GDScriptLanguage;
 
@@ -592,6 +716,9 @@ public:
 	void disassemble(const Vector<String> &p_code_lines) const;
 #endif
 
+	// Called when scripts are compiled, the cached member indices and functions may be replaced.
+	static void invalidate_inline_caches() { InlineCache::generation.increment(); }
+
 	_FORCE_INLINE_ MultiplayerAPI::RPCConfig get_rpc_config() const { return rpc_config; }
 	GDScriptFunction();
 	~GDScriptFunction();
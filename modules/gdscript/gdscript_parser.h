@@ -1184,6 +1184,7 @@ public:
 
 private:
 	friend class GDScriptAnalyzer;
+	friend class GDScriptCompileBatch;
 
 	bool _is_tool = false;
 	String script_path;
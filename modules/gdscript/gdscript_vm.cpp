@@ -31,6 +31,8 @@
 #include "gdscript_function.h"
 
 #include "core/core_string_names.h"
+#include "core/debugger/sampling_profiler.h"
+#include "core/debugger/trace.h"
 #include "core/os/os.h"
 #include "gdscript.h"
 #include "gdscript_lambda_callable.h"
@@ -152,6 +154,275 @@ String GDScriptFunction::_get_call_error(const Callable::CallError &p_err, const
 	return err_text;
 }
 
+bool GDScriptFunction::_get_receiver(Object *p_object, Receiver &r_receiver) {
+	r_receiver.object = p_object;
+	ScriptInstance *script_instance = p_object->get_script_instance();
+	if (script_instance) {
+		// Other languages (and placeholders) are only reached through the regular path.
+		if (script_instance->is_placeholder() || script_instance->get_language() != GDScriptLanguage::get_singleton()) {
+			return false;
+		}
+		r_receiver.instance = static_cast<GDScriptInstance *>(script_instance);
+		r_receiver.script = uint64_t(r_receiver.instance->script->get_instance_id());
+	}
+	r_receiver.class_name = p_object->get_class_name().data_unique_pointer();
+	return true;
+}
+
+// Mirrors Object::get() and Object::set(), but only for what can be cached.
+GDScriptFunction::InlineCache::Target GDScriptFunction::_resolve_named(const Receiver &p_receiver, const StringName &p_name, bool p_set) {
+	InlineCache::Target target;
+
+	if (p_receiver.instance) {
+		const GDScript *script = p_receiver.instance->script.ptr();
+		const Map<StringName, GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
+		if (E) {
+			const GDScript::MemberInfo &member = E->get();
+			// Typed members may need a conversion when set.
+			if ((p_set ? member.setter : member.getter) == StringName() && !(p_set && member.data_type.has_type)) {
+				target.kind = InlineCache::KIND_MEMBER;
+				target.index = member.index;
+			}
+			return target;
+		}
+
+		const StringName &handler = p_set ? GDScriptLanguage::get_singleton()->strings._set : GDScriptLanguage::get_singleton()->strings._get;
+		for (const GDScript *sptr = script; sptr; sptr = sptr->_base) {
+			if (sptr->member_functions.has(handler)) {
+				return target;
+			}
+			if (!p_set && (sptr->constants.has(p_name) || sptr->_signals.has(p_name) || sptr->member_functions.has(p_name))) {
+				return target;
+			}
+		}
+	}
+
+	ClassDB::ClassInfo *type = ClassDB::classes.getptr(p_receiver.object->get_class_name());
+	for (ClassDB::ClassInfo *check = type; check; check = check->inherits_ptr) {
+		if (check->native_extension) {
+			return target; // May handle any property itself.
+		}
+	}
+	for (ClassDB::ClassInfo *check = type; check; check = check->inherits_ptr) {
+		const ClassDB::PropertySetGet *psg = check->property_setget.getptr(p_name);
+		if (psg) {
+			MethodBind *method = p_set ? psg->_setptr : psg->_getptr;
+			if (method) {
+				target.kind = InlineCache::KIND_PROPERTY;
+				target.index = psg->index;
+				target.target = method;
+			}
+			return target;
+		}
+		if (!p_set && (check->constant_map.has(p_name) || check->method_map.has(p_name) || check->signal_map.has(p_name))) {
+			return target;
+		}
+	}
+
+	return target;
+}
+
+// Mirrors Object::call().
+GDScriptFunction::InlineCache::Target GDScriptFunction::_resolve_call(const Receiver &p_receiver, const StringName &p_method) {
+	InlineCache::Target target;
+
+	if (p_method == CoreStringNames::get_singleton()->_free) {
+		return target;
+	}
+
+	if (p_receiver.instance) {
+		for (const GDScript *sptr = p_receiver.instance->script.ptr(); sptr; sptr = sptr->_base) {
+			const Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_method);
+			if (E) {
+				target.kind = InlineCache::KIND_SCRIPT_METHOD;
+				target.target = E->get();
+				return target;
+			}
+		}
+	}
+
+	MethodBind *method = ClassDB::get_method(p_receiver.object->get_class_name(), p_method);
+	if (method) {
+		target.kind = InlineCache::KIND_NATIVE_METHOD;
+		target.target = method;
+	}
+	return target;
+}
+
+bool GDScriptFunction::_get_named_cached(InlineCache *p_cache, const Variant *p_base, const StringName &p_name, Variant &r_ret) const {
+	if (p_base->get_type() != Variant::OBJECT || p_cache->is_megamorphic()) {
+		return false;
+	}
+	Object *object = p_base->get_validated_object();
+	Receiver receiver;
+	if (!object || !_get_receiver(object, receiver)) {
+		return false;
+	}
+
+	InlineCache::Target target;
+	if (!p_cache->lookup(receiver.script, receiver.class_name, target)) {
+		uint32_t generation = InlineCache::generation.get();
+		target = _resolve_named(receiver, p_name, false);
+		p_cache->store(generation, receiver.script, receiver.class_name, target);
+	}
+
+	switch (target.kind) {
+		case InlineCache::KIND_MEMBER: {
+			if (unlikely(target.index >= receiver.instance->members.size())) {
+				return false;
+			}
+			r_ret = receiver.instance->members[target.index];
+			return true;
+		}
+		case InlineCache::KIND_PROPERTY: {
+			MethodBind *getter = static_cast<MethodBind *>(target.target);
+			Callable::CallError ce;
+			if (target.index >= 0) {
+				Variant index = target.index;
+				const Variant *args[1] = { &index };
+				r_ret = getter->call(object, args, 1, ce);
+			} else {
+				r_ret = getter->call(object, nullptr, 0, ce);
+			}
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+bool GDScriptFunction::_set_named_cached(InlineCache *p_cache, Variant *p_base, const StringName &p_name, const Variant &p_value, bool &r_valid) const {
+	if (p_base->get_type() != Variant::OBJECT || p_cache->is_megamorphic()) {
+		return false;
+	}
+	Object *object = p_base->get_validated_object();
+	Receiver receiver;
+	if (!object || !_get_receiver(object, receiver)) {
+		return false;
+	}
+
+	InlineCache::Target target;
+	if (!p_cache->lookup(receiver.script, receiver.class_name, target)) {
+		uint32_t generation = InlineCache::generation.get();
+		target = _resolve_named(receiver, p_name, true);
+		p_cache->store(generation, receiver.script, receiver.class_name, target);
+	}
+
+	switch (target.kind) {
+		case InlineCache::KIND_MEMBER: {
+			if (unlikely(target.index >= receiver.instance->members.size())) {
+				return false;
+			}
+			receiver.instance->members.write[target.index] = p_value;
+			r_valid = true;
+		} break;
+		case InlineCache::KIND_PROPERTY: {
+			MethodBind *setter = static_cast<MethodBind *>(target.target);
+			Callable::CallError ce;
+			if (target.index >= 0) {
+				Variant index = target.index;
+				const Variant *args[2] = { &index, &p_value };
+				setter->call(object, args, 2, ce);
+			} else {
+				const Variant *args[1] = { &p_value };
+				setter->call(object, args, 1, ce);
+			}
+			r_valid = ce.error == Callable::CallError::CALL_OK;
+		} break;
+		default:
+			return false;
+	}
+
+#ifdef TOOLS_ENABLED
+	if (!object->is_edited()) {
+		object->set_edited(true);
+	}
+#endif
+	return true;
+}
+
+bool GDScriptFunction::_call_cached(InlineCache *p_cache, const Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_error) const {
+	if (p_base->get_type() != Variant::OBJECT || p_cache->is_megamorphic()) {
+		return false;
+	}
+	// Same checks as Variant::call().
+	Object *object = const_cast<Object *>(*VariantInternal::get_object(p_base));
+	if (!object) {
+		return false;
+	}
+#ifdef DEBUG_ENABLED
+	if (EngineDebugger::is_active() && !VariantInternal::get_object_id(p_base).is_ref_counted() && ObjectDB::get_instance(VariantInternal::get_object_id(p_base)) == nullptr) {
+		return false;
+	}
+#endif
+	Receiver receiver;
+	if (!_get_receiver(object, receiver)) {
+		return false;
+	}
+
+	InlineCache::Target target;
+	if (!p_cache->lookup(receiver.script, receiver.class_name, target)) {
+		uint32_t generation = InlineCache::generation.get();
+		target = _resolve_call(receiver, p_method);
+		p_cache->store(generation, receiver.script, receiver.class_name, target);
+	}
+
+	switch (target.kind) {
+		case InlineCache::KIND_SCRIPT_METHOD: {
+#ifdef DEBUG_ENABLED
+			_ObjectDebugLock debug_lock(object);
+#endif
+			r_error.error = Callable::CallError::CALL_OK;
+			r_ret = static_cast<GDScriptFunction *>(target.target)->call(receiver.instance, p_args, p_argcount, r_error);
+			return true;
+		}
+		case InlineCache::KIND_NATIVE_METHOD: {
+#ifdef DEBUG_ENABLED
+			_ObjectDebugLock debug_lock(object);
+#endif
+			r_error.error = Callable::CallError::CALL_OK;
+			r_ret = static_cast<MethodBind *>(target.target)->call(object, p_args, p_argcount, r_error);
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+#ifdef DEBUG_ENABLED
+// Keeps the function on the sampled script stack of the thread while it runs.
+struct GDScriptSamplingScope {
+	SamplingProfiler::Frame *frame = nullptr;
+
+	_FORCE_INLINE_ ~GDScriptSamplingScope() {
+		if (unlikely(frame)) {
+			SamplingProfiler::pop();
+		}
+	}
+};
+#endif
+
+// Writes a loop value into the iterator variable. The loop body may have assigned
+// something of another type to it, so only reuse the storage when the type still matches.
+template <class T, class V>
+static _FORCE_INLINE_ void _set_iterator(Variant *p_iterator, const V &p_value) {
+	VariantTypeChanger<T>::change(p_iterator);
+	*VariantGetInternalPtr<T>::get_ptr(p_iterator) = p_value;
+}
+
+// Advances a for loop over a packed array, reading the next element in place.
+// Returns false once the end of the array is reached.
+template <class T>
+static _FORCE_INLINE_ bool _iterate_packed_array(const Vector<T> *p_array, Variant *p_counter, Variant *p_iterator) {
+	int64_t *idx = VariantInternal::get_int(p_counter);
+	(*idx)++;
+	if (*idx >= p_array->size()) {
+		return false;
+	}
+	_set_iterator<T>(p_iterator, p_array->ptr()[*idx]);
+	return true;
+}
+
 void (*type_init_function_table[])(Variant *) = {
 	nullptr, // NIL (shouldn't be called).
 	&VariantInitializer<bool>::init, // BOOL.
@@ -195,6 +466,25 @@ void (*type_init_function_table[])(Variant *) = {
 	static const void *switch_table_ops[] = {        \
 		&&OPCODE_OPERATOR,                           \
 		&&OPCODE_OPERATOR_VALIDATED,                 \
+		&&OPCODE_ADD_INT,                            \
+		&&OPCODE_SUBTRACT_INT,                       \
+		&&OPCODE_MULTIPLY_INT,                       \
+		&&OPCODE_EQUAL_INT,                          \
+		&&OPCODE_NOT_EQUAL_INT,                      \
+		&&OPCODE_LESS_INT,                           \
+		&&OPCODE_LESS_EQUAL_INT,                     \
+		&&OPCODE_GREATER_INT,                        \
+		&&OPCODE_GREATER_EQUAL_INT,                  \
+		&&OPCODE_ADD_FLOAT,                          \
+		&&OPCODE_SUBTRACT_FLOAT,                     \
+		&&OPCODE_MULTIPLY_FLOAT,                     \
+		&&OPCODE_DIVIDE_FLOAT,                       \
+		&&OPCODE_EQUAL_FLOAT,                        \
+		&&OPCODE_NOT_EQUAL_FLOAT,                    \
+		&&OPCODE_LESS_FLOAT,                         \
+		&&OPCODE_LESS_EQUAL_FLOAT,                   \
+		&&OPCODE_GREATER_FLOAT,                      \
+		&&OPCODE_GREATER_EQUAL_FLOAT,                \
 		&&OPCODE_EXTENDS_TEST,                       \
 		&&OPCODE_IS_BUILTIN,                         \
 		&&OPCODE_SET_KEYED,                          \
@@ -276,6 +566,18 @@ void (*type_init_function_table[])(Variant *) = {
 		&&OPCODE_JUMP,                               \
 		&&OPCODE_JUMP_IF,                            \
 		&&OPCODE_JUMP_IF_NOT,                        \
+		&&OPCODE_JUMP_IF_NOT_EQUAL_INT,              \
+		&&OPCODE_JUMP_IF_EQUAL_INT,                  \
+		&&OPCODE_JUMP_IF_NOT_LESS_INT,               \
+		&&OPCODE_JUMP_IF_NOT_LESS_EQUAL_INT,         \
+		&&OPCODE_JUMP_IF_NOT_GREATER_INT,            \
+		&&OPCODE_JUMP_IF_NOT_GREATER_EQUAL_INT,      \
+		&&OPCODE_JUMP_IF_NOT_EQUAL_FLOAT,            \
+		&&OPCODE_JUMP_IF_EQUAL_FLOAT,                \
+		&&OPCODE_JUMP_IF_NOT_LESS_FLOAT,             \
+		&&OPCODE_JUMP_IF_NOT_LESS_EQUAL_FLOAT,       \
+		&&OPCODE_JUMP_IF_NOT_GREATER_FLOAT,          \
+		&&OPCODE_JUMP_IF_NOT_GREATER_EQUAL_FLOAT,    \
 		&&OPCODE_JUMP_TO_DEF_ARGUMENT,               \
 		&&OPCODE_RETURN,                             \
 		&&OPCODE_RETURN_TYPED_BUILTIN,               \
@@ -432,6 +734,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	r_err.error = Callable::CallError::CALL_OK;
 
+	MemoryTagScope tag_scope(Memory::TAG_SCRIPT);
+	TRACE_ZONE(Trace::is_enabled() ? _get_trace_name() : nullptr);
+
 	Variant retvalue;
 	Variant *stack = nullptr;
 	Variant **instruction_args = nullptr;
@@ -542,6 +847,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		GDScriptLanguage::get_singleton()->enter_function(p_instance, this, stack, &ip, &line);
 	}
 
+	GDScriptSamplingScope sampling;
+	if (unlikely(SamplingProfiler::is_running())) {
+		sampling.frame = SamplingProfiler::push(_get_sampling_name(), line);
+	}
+
 #define GD_ERR_BREAK(m_cond)                                                                                           \
 	{                                                                                                                  \
 		if (unlikely(m_cond)) {                                                                                        \
@@ -652,6 +962,44 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			// Operands are known to hold the types, but the result may be stored
+			// directly in a variable holding anything.
+#define OPCODE_TYPED_OPERATOR(m_name, m_op, m_get, m_ret_type, m_ret_get)         \
+	OPCODE(OPCODE_##m_name) {                                                     \
+		CHECK_SPACE(4);                                                           \
+		GET_INSTRUCTION_ARG(a, 0);                                                \
+		GET_INSTRUCTION_ARG(b, 1);                                                \
+		GET_INSTRUCTION_ARG(dst, 2);                                              \
+		auto result = *VariantInternal::m_get(a) m_op *VariantInternal::m_get(b); \
+		if (likely(dst->get_type() == Variant::m_ret_type)) {                     \
+			*VariantInternal::m_ret_get(dst) = result;                            \
+		} else {                                                                  \
+			*dst = result;                                                        \
+		}                                                                         \
+		ip += 4;                                                                  \
+	}                                                                             \
+	DISPATCH_OPCODE
+
+			OPCODE_TYPED_OPERATOR(ADD_INT, +, get_int, INT, get_int);
+			OPCODE_TYPED_OPERATOR(SUBTRACT_INT, -, get_int, INT, get_int);
+			OPCODE_TYPED_OPERATOR(MULTIPLY_INT, *, get_int, INT, get_int);
+			OPCODE_TYPED_OPERATOR(EQUAL_INT, ==, get_int, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(NOT_EQUAL_INT, !=, get_int, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(LESS_INT, <, get_int, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(LESS_EQUAL_INT, <=, get_int, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(GREATER_INT, >, get_int, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(GREATER_EQUAL_INT, >=, get_int, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(ADD_FLOAT, +, get_float, FLOAT, get_float);
+			OPCODE_TYPED_OPERATOR(SUBTRACT_FLOAT, -, get_float, FLOAT, get_float);
+			OPCODE_TYPED_OPERATOR(MULTIPLY_FLOAT, *, get_float, FLOAT, get_float);
+			OPCODE_TYPED_OPERATOR(DIVIDE_FLOAT, /, get_float, FLOAT, get_float);
+			OPCODE_TYPED_OPERATOR(EQUAL_FLOAT, ==, get_float, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(NOT_EQUAL_FLOAT, !=, get_float, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(LESS_FLOAT, <, get_float, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(LESS_EQUAL_FLOAT, <=, get_float, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(GREATER_FLOAT, >, get_float, BOOL, get_bool);
+			OPCODE_TYPED_OPERATOR(GREATER_EQUAL_FLOAT, >=, get_float, BOOL, get_bool);
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 				CHECK_SPACE(4);
 
@@ -930,7 +1278,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_SET_NAMED) {
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_INSTRUCTION_ARG(dst, 0);
 				GET_INSTRUCTION_ARG(value, 1);
@@ -940,8 +1288,13 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+
 				bool valid;
-				dst->set_named(*index, *value, valid);
+				if (!_set_named_cached(&_inline_caches_ptr[cache_idx], dst, *index, *value, valid)) {
+					dst->set_named(*index, *value, valid);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -950,7 +1303,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -970,7 +1323,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_INSTRUCTION_ARG(src, 0);
 				GET_INSTRUCTION_ARG(dst, 1);
@@ -980,13 +1333,25 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
-				Variant ret = src->get_named(*index, valid);
+				Variant ret;
+				if (_get_named_cached(&_inline_caches_ptr[cache_idx], src, *index, ret)) {
+					valid = true;
+				} else {
+					ret = src->get_named(*index, valid);
+				}
 
 #else
-				*dst = src->get_named(*index, valid);
+				if (_get_named_cached(&_inline_caches_ptr[cache_idx], src, *index, *dst)) {
+					valid = true;
+				} else {
+					*dst = src->get_named(*index, valid);
+				}
 #endif
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -999,7 +1364,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1439,7 +1804,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_CALL_ASYNC)
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
-				CHECK_SPACE(3 + instr_arg_count);
+				CHECK_SPACE(4 + instr_arg_count);
 				bool call_ret = (_code_ptr[ip] & INSTR_MASK) != OPCODE_CALL;
 #ifdef DEBUG_ENABLED
 				bool call_async = (_code_ptr[ip] & INSTR_MASK) == OPCODE_CALL_ASYNC;
@@ -1454,6 +1819,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(methodname_idx < 0 || methodname_idx >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[methodname_idx];
 
+				int cache_idx = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache_idx < 0 || cache_idx >= _inline_caches_count);
+				InlineCache *cache = &_inline_caches_ptr[cache_idx];
+
 				GET_INSTRUCTION_ARG(base, argc);
 				Variant **argptrs = instruction_args;
 
@@ -1468,7 +1837,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				Callable::CallError err;
 				if (call_ret) {
 					GET_INSTRUCTION_ARG(ret, argc + 1);
-					base->call(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					if (!_call_cached(cache, base, *methodname, (const Variant **)argptrs, argc, *ret, err)) {
+						base->call(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					}
 #ifdef DEBUG_ENABLED
 					if (!call_async && ret->get_type() == Variant::OBJECT) {
 						// Check if getting a function state without await.
@@ -1487,7 +1858,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 				} else {
 					Variant ret;
-					base->call(*methodname, (const Variant **)argptrs, argc, ret, err);
+					if (!_call_cached(cache, base, *methodname, (const Variant **)argptrs, argc, ret, err)) {
+						base->call(*methodname, (const Variant **)argptrs, argc, ret, err);
+					}
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -1532,7 +1905,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
-				ip += 3;
+				ip += 4;
 			}
 			DISPATCH_OPCODE;
 
@@ -2222,6 +2595,35 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			// Typed comparison fused with the conditional jump using its result.
+#define OPCODE_JUMP_IF_NOT_COMPARE(m_name, m_op, m_get)                      \
+	OPCODE(OPCODE_##m_name) {                                                \
+		CHECK_SPACE(4);                                                      \
+		GET_INSTRUCTION_ARG(a, 0);                                           \
+		GET_INSTRUCTION_ARG(b, 1);                                           \
+		if (!(*VariantInternal::m_get(a) m_op *VariantInternal::m_get(b))) { \
+			int to = _code_ptr[ip + 3];                                      \
+			GD_ERR_BREAK(to < 0 || to > _code_size);                         \
+			ip = to;                                                         \
+		} else {                                                             \
+			ip += 4;                                                         \
+		}                                                                    \
+	}                                                                        \
+	DISPATCH_OPCODE
+
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_EQUAL_INT, ==, get_int);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_EQUAL_INT, !=, get_int);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_INT, <, get_int);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_EQUAL_INT, <=, get_int);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_INT, >, get_int);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_EQUAL_INT, >=, get_int);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_EQUAL_FLOAT, ==, get_float);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_EQUAL_FLOAT, !=, get_float);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_FLOAT, <, get_float);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_LESS_EQUAL_FLOAT, <=, get_float);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_FLOAT, >, get_float);
+			OPCODE_JUMP_IF_NOT_COMPARE(JUMP_IF_NOT_GREATER_EQUAL_FLOAT, >=, get_float);
+
 			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT) {
 				CHECK_SPACE(2);
 				ip = _default_arg_ptr[defarg];
@@ -2536,7 +2938,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				Vector2i *bounds = VariantInternal::get_vector2i(container);
 
-				VariantInternal::initialize(counter, Variant::FLOAT);
+				VariantInternal::initialize(counter, Variant::INT);
 				*VariantInternal::get_int(counter) = bounds->x;
 
 				if (bounds->x < bounds->y) {
@@ -2709,7 +3111,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			GET_INSTRUCTION_ARG(iterator, 2);                                                                              \
 			VariantInternal::initialize(iterator, Variant::m_var_ret_type);                                                \
 			m_ret_type *it = VariantInternal::m_ret_get_func(iterator);                                                    \
-			*it = array->get(0);                                                                                           \
+			*it = array->ptr()[0];                                                                                         \
 			ip += 5;                                                                                                       \
 		} else {                                                                                                           \
 			int jumpto = _code_ptr[ip + 4];                                                                                \
@@ -2790,6 +3192,55 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				GET_INSTRUCTION_ARG(counter, 0);
 				GET_INSTRUCTION_ARG(container, 1);
+				GET_INSTRUCTION_ARG(iterator, 2);
+
+				// The container type was not known at compile time, but packed arrays can still be
+				// read in place instead of going through iter_next() and iter_get().
+				bool packed = true;
+				bool has_next = false;
+				switch (container->get_type()) {
+					case Variant::PACKED_BYTE_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_byte_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_INT32_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_int32_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_INT64_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_int64_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_FLOAT32_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_float32_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_FLOAT64_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_float64_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_STRING_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_string_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_VECTOR2_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_vector2_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_VECTOR3_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_vector3_array(container), counter, iterator);
+						break;
+					case Variant::PACKED_COLOR_ARRAY:
+						has_next = _iterate_packed_array(VariantInternal::get_color_array(container), counter, iterator);
+						break;
+					default:
+						packed = false;
+						break;
+				}
+
+				if (packed) {
+					if (!has_next) {
+						int jumpto = _code_ptr[ip + 4];
+						GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+						ip = jumpto;
+					} else {
+						ip += 5; // Loop again.
+					}
+					DISPATCH_OPCODE;
+				}
 
 				bool valid;
 				if (!container->iter_next(*counter, valid)) {
@@ -2803,8 +3254,6 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
 					ip = jumpto;
 				} else {
-					GET_INSTRUCTION_ARG(iterator, 2);
-
 					*iterator = container->iter_get(*counter, valid);
 #ifdef DEBUG_ENABLED
 					if (!valid) {
@@ -2834,7 +3283,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_int(iterator) = *count;
+					_set_iterator<int64_t>(iterator, *count);
 
 					ip += 5; // Loop again.
 				}
@@ -2858,7 +3307,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_float(iterator) = *count;
+					_set_iterator<double>(iterator, *count);
 
 					ip += 5; // Loop again.
 				}
@@ -2882,7 +3331,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_float(iterator) = *count;
+					_set_iterator<double>(iterator, *count);
 
 					ip += 5; // Loop again.
 				}
@@ -2906,7 +3355,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_int(iterator) = *count;
+					_set_iterator<int64_t>(iterator, *count);
 
 					ip += 5; // Loop again.
 				}
@@ -2930,7 +3379,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_float(iterator) = *count;
+					_set_iterator<double>(iterator, *count);
 
 					ip += 5; // Loop again.
 				}
@@ -2954,7 +3403,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_int(iterator) = *count;
+					_set_iterator<int64_t>(iterator, *count);
 
 					ip += 5; // Loop again.
 				}
@@ -2977,7 +3426,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					ip = jumpto;
 				} else {
 					GET_INSTRUCTION_ARG(iterator, 2);
-					*VariantInternal::get_string(iterator) = str->substr(*idx, 1);
+					_set_iterator<String>(iterator, str->substr(*idx, 1));
 
 					ip += 5; // Loop again.
 				}
@@ -3030,35 +3479,32 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
-#define OPCODE_ITERATE_PACKED_ARRAY(m_var_type, m_elem_type, m_get_func, m_ret_get_func)            \
+#define OPCODE_ITERATE_PACKED_ARRAY(m_var_type, m_elem_type, m_get_func)                            \
 	OPCODE(OPCODE_ITERATE_PACKED_##m_var_type##_ARRAY) {                                            \
 		CHECK_SPACE(4);                                                                             \
 		GET_INSTRUCTION_ARG(counter, 0);                                                            \
 		GET_INSTRUCTION_ARG(container, 1);                                                          \
+		GET_INSTRUCTION_ARG(iterator, 2);                                                           \
 		const Vector<m_elem_type> *array = VariantInternal::m_get_func((const Variant *)container); \
-		int64_t *idx = VariantInternal::get_int(counter);                                           \
-		(*idx)++;                                                                                   \
-		if (*idx >= array->size()) {                                                                \
+		if (!_iterate_packed_array(array, counter, iterator)) {                                     \
 			int jumpto = _code_ptr[ip + 4];                                                         \
 			GD_ERR_BREAK(jumpto<0 || jumpto> _code_size);                                           \
 			ip = jumpto;                                                                            \
 		} else {                                                                                    \
-			GET_INSTRUCTION_ARG(iterator, 2);                                                       \
-			*VariantInternal::m_ret_get_func(iterator) = array->get(*idx);                          \
 			ip += 5;                                                                                \
 		}                                                                                           \
 	}                                                                                               \
 	DISPATCH_OPCODE
 
-			OPCODE_ITERATE_PACKED_ARRAY(BYTE, uint8_t, get_byte_array, get_int);
-			OPCODE_ITERATE_PACKED_ARRAY(INT32, int32_t, get_int32_array, get_int);
-			OPCODE_ITERATE_PACKED_ARRAY(INT64, int64_t, get_int64_array, get_int);
-			OPCODE_ITERATE_PACKED_ARRAY(FLOAT32, float, get_float32_array, get_float);
-			OPCODE_ITERATE_PACKED_ARRAY(FLOAT64, double, get_float64_array, get_float);
-			OPCODE_ITERATE_PACKED_ARRAY(STRING, String, get_string_array, get_string);
-			OPCODE_ITERATE_PACKED_ARRAY(VECTOR2, Vector2, get_vector2_array, get_vector2);
-			OPCODE_ITERATE_PACKED_ARRAY(VECTOR3, Vector3, get_vector3_array, get_vector3);
-			OPCODE_ITERATE_PACKED_ARRAY(COLOR, Color, get_color_array, get_color);
+			OPCODE_ITERATE_PACKED_ARRAY(BYTE, uint8_t, get_byte_array);
+			OPCODE_ITERATE_PACKED_ARRAY(INT32, int32_t, get_int32_array);
+			OPCODE_ITERATE_PACKED_ARRAY(INT64, int64_t, get_int64_array);
+			OPCODE_ITERATE_PACKED_ARRAY(FLOAT32, float, get_float32_array);
+			OPCODE_ITERATE_PACKED_ARRAY(FLOAT64, double, get_float64_array);
+			OPCODE_ITERATE_PACKED_ARRAY(STRING, String, get_string_array);
+			OPCODE_ITERATE_PACKED_ARRAY(VECTOR2, Vector2, get_vector2_array);
+			OPCODE_ITERATE_PACKED_ARRAY(VECTOR3, Vector3, get_vector3_array);
+			OPCODE_ITERATE_PACKED_ARRAY(COLOR, Color, get_color_array);
 
 			OPCODE(OPCODE_ITERATE_OBJECT) {
 				CHECK_SPACE(4);
@@ -3123,7 +3569,19 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				const StringName *globalname = &_global_names_ptr[globalname_idx];
 
 				GET_INSTRUCTION_ARG(dst, 0);
-				*dst = GDScriptLanguage::get_singleton()->get_named_globals_map()[*globalname];
+				const Map<StringName, Variant>::Element *E = GDScriptLanguage::get_singleton()->get_named_globals_map().find(*globalname);
+				if (E) {
+					*dst = E->get();
+				} else {
+					// Autoloads are named globals in the editor but regular globals when running,
+					// which matters for code compiled in the editor (precompiled on export).
+					const Map<StringName, int>::Element *G = GDScriptLanguage::get_singleton()->get_global_map().find(*globalname);
+					if (unlikely(!G)) {
+						err_text = "Global '" + String(*globalname) + "' not found.";
+						OPCODE_BREAK;
+					}
+					*dst = GDScriptLanguage::get_singleton()->get_global_array()[G->get()];
+				}
 
 				ip += 3;
 			}
@@ -3215,6 +3673,12 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				line = _code_ptr[ip + 1];
 				ip += 2;
 
+#ifdef DEBUG_ENABLED
+				if (unlikely(sampling.frame)) {
+					sampling.frame->line.store(line, std::memory_order_relaxed);
+				}
+#endif
+
 				if (EngineDebugger::is_active()) {
 					// line
 					bool do_break = false;
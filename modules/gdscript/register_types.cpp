@@ -85,8 +85,19 @@ public:
 			return;
 		}
 
-		// TODO: Re-add compiled GDScript on export.
-		return;
+		Ref<GDScript> script = ResourceLoader::load(p_path);
+		if (script.is_null() || !script->is_valid()) {
+			return; // Exported as text, errors will show when running.
+		}
+
+		// Empty when it can't be precompiled (e.g. it has constants only known at runtime), exported as text then.
+		Vector<uint8_t> file = script->get_as_byte_code();
+		if (file.is_empty()) {
+			return;
+		}
+
+		add_file(p_path.get_basename() + ".gdc", file, true);
+		skip();
 	}
 };
 
@@ -178,8 +189,18 @@ void test_bytecode() {
 	GDScriptTests::test(GDScriptTests::TestType::TEST_BYTECODE);
 }
 
+void test_load_benchmark() {
+	GDScriptTests::test_load_benchmark();
+}
+
+void test_numeric_benchmark() {
+	GDScriptTests::test_numeric_benchmark();
+}
+
 REGISTER_TEST_COMMAND("gdscript-tokenizer", &test_tokenizer);
 REGISTER_TEST_COMMAND("gdscript-parser", &test_parser);
 REGISTER_TEST_COMMAND("gdscript-compiler", &test_compiler);
 REGISTER_TEST_COMMAND("gdscript-bytecode", &test_bytecode);
+REGISTER_TEST_COMMAND("gdscript-load-benchmark", &test_load_benchmark);
+REGISTER_TEST_COMMAND("gdscript-numeric-benchmark", &test_numeric_benchmark);
 #endif
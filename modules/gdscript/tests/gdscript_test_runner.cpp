@@ -122,9 +122,10 @@ void finish_language() {
 
 StringName GDScriptTestRunner::test_function_name;
 
-GDScriptTestRunner::GDScriptTestRunner(const String &p_source_dir, bool p_init_language) {
+GDScriptTestRunner::GDScriptTestRunner(const String &p_source_dir, bool p_init_language, bool p_use_bytecode) {
 	test_function_name = StaticCString::create("test");
 	do_init_languages = p_init_language;
+	use_bytecode = p_use_bytecode;
 
 	source_dir = p_source_dir;
 	if (!source_dir.ends_with("/")) {
@@ -238,7 +239,7 @@ bool GDScriptTestRunner::make_tests_for_dir(const String &p_dir) {
 				if (!is_generating && !dir->file_exists(out_file)) {
 					ERR_FAIL_V_MSG(false, "Could not find output file for " + next);
 				}
-				GDScriptTest test(current_dir.plus_file(next), current_dir.plus_file(out_file), source_dir);
+				GDScriptTest test(current_dir.plus_file(next), current_dir.plus_file(out_file), source_dir, use_bytecode);
 				tests.push_back(test);
 			}
 		}
@@ -279,10 +280,11 @@ bool GDScriptTestRunner::generate_class_index() {
 	return true;
 }
 
-GDScriptTest::GDScriptTest(const String &p_source_path, const String &p_output_path, const String &p_base_dir) {
+GDScriptTest::GDScriptTest(const String &p_source_path, const String &p_output_path, const String &p_base_dir, bool p_use_bytecode) {
 	source_file = p_source_path;
 	output_file = p_output_path;
 	base_dir = p_base_dir;
+	use_bytecode = p_use_bytecode;
 	_print_handler.printfunc = print_handler;
 	_error_handler.errfunc = error_handler;
 }
@@ -509,6 +511,24 @@ GDScriptTest::TestResult GDScriptTest::execute_test_code(bool p_is_generating) {
 
 	script->reload();
 
+	if (use_bytecode) {
+		// Replace the script with one loaded from its byte code.
+		Vector<uint8_t> byte_code = script->get_as_byte_code();
+		script = Ref<GDScript>(); // Frees the path for the precompiled script.
+
+		script.instantiate();
+		script->set_path(source_file);
+		script->set_script_path(source_file);
+		script->set_byte_code(byte_code);
+		script->reload();
+		if (!script->is_precompiled() || !script->is_valid()) {
+			enable_stdout();
+			result.status = GDTEST_LOAD_ERROR;
+			result.passed = false;
+			ERR_FAIL_V_MSG(result, "\nCould not load byte code for: '" + source_file + "'");
+		}
+	}
+
 	// Create object instance for test.
 	Object *obj = ClassDB::instantiate(script->get_native()->get_name());
 	Ref<RefCounted> obj_ref;
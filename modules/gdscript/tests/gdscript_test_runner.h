@@ -74,6 +74,7 @@ private:
 	String source_file;
 	String output_file;
 	String base_dir;
+	bool use_bytecode = false;
 
 	PrintHandlerList _print_handler;
 	ErrorHandlerList _error_handler;
@@ -94,7 +95,7 @@ public:
 	const String &get_source_file() const { return source_file; }
 	const String &get_output_file() const { return output_file; }
 
-	GDScriptTest(const String &p_source_path, const String &p_output_path, const String &p_base_dir);
+	GDScriptTest(const String &p_source_path, const String &p_output_path, const String &p_base_dir, bool p_use_bytecode = false);
 	GDScriptTest() :
 			GDScriptTest(String(), String(), String()) {} // Needed to use in Vector.
 };
@@ -105,6 +106,7 @@ class GDScriptTestRunner {
 
 	bool is_generating = false;
 	bool do_init_languages = false;
+	bool use_bytecode = false;
 
 	bool make_tests();
 	bool make_tests_for_dir(const String &p_dir);
@@ -117,7 +119,8 @@ public:
 	int run_tests();
 	bool generate_outputs();
 
-	GDScriptTestRunner(const String &p_source_dir, bool p_init_language);
+	// If p_use_bytecode is set, tests run from the precompiled byte code, as exported scripts do.
+	GDScriptTestRunner(const String &p_source_dir, bool p_init_language, bool p_use_bytecode = false);
 	~GDScriptTestRunner();
 };
 
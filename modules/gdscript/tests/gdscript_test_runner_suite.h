@@ -32,6 +32,13 @@
 #define GDSCRIPT_TEST_RUNNER_SUITE_H
 
 #include "gdscript_test_runner.h"
+#include "modules/gdscript/gdscript_bytecode.h"
+#include "modules/gdscript/gdscript_cache.h"
+
+#include "core/debugger/sampling_profiler.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
 #include "tests/test_macros.h"
 
 namespace GDScriptTests {
@@ -46,6 +53,13 @@ TEST_SUITE("[Modules][GDScript]") {
 		INFO("Make sure `*.out` files have expected results.");
 		REQUIRE_MESSAGE(fail_count == 0, "All GDScript tests should pass.");
 	}
+
+	TEST_CASE("Script compilation and runtime (byte code)") {
+		GDScriptTestRunner runner("modules/gdscript/tests/scripts", true, true);
+		int fail_count = runner.run_tests();
+		INFO("Make sure `*.out` files have expected results.");
+		REQUIRE_MESSAGE(fail_count == 0, "All GDScript tests should pass from byte code too.");
+	}
 }
 
 TEST_CASE("[Modules][GDScript] Load source code dynamically and run it") {
@@ -69,6 +83,243 @@ func _init():
 	CHECK_MESSAGE(int(ref_counted->get_meta("result")) == 42, "The script should assign object metadata successfully.");
 }
 
+TEST_CASE("[Modules][GDScript] Save and load byte code") {
+	Ref<GDScript> gdscript = memnew(GDScript);
+	gdscript->set_source_code(R"(
+extends RefCounted
+
+signal done(value)
+
+enum Mode { FIRST, SECOND = 5 }
+
+class Inner:
+	var factor := 3
+	func scale(p_value: int) -> int:
+		return p_value * factor
+
+var total: int = 0:
+	set(value):
+		total = value + 1
+
+var items: Array[int] = [1, 2, 3]
+
+func _init():
+	var inner := Inner.new()
+	var add := func(a, b): return a + b
+	for item in items:
+		total = add.call(total, inner.scale(item))
+	set_meta("result", [total, Mode.SECOND, "text", Vector2(1, 2)])
+)");
+	ERR_PRINT_OFF;
+	Error error = gdscript->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should parse successfully.");
+
+	const Vector<uint8_t> byte_code = gdscript->get_as_byte_code();
+	REQUIRE_MESSAGE(!byte_code.is_empty(), "The script should be serialized to byte code.");
+	CHECK(GDScriptBytecode::is_compatible(byte_code));
+	CHECK(GDScriptBytecode::get_source_code(byte_code) == gdscript->get_source_code());
+
+	Ref<GDScript> precompiled = memnew(GDScript);
+	precompiled->set_byte_code(byte_code);
+	error = precompiled->reload();
+	CHECK_MESSAGE(error == OK, "The byte code should load successfully.");
+	CHECK_MESSAGE(precompiled->is_precompiled(), "The script should not be recompiled from source.");
+	CHECK(precompiled->get_source_code() == gdscript->get_source_code());
+	CHECK(precompiled->has_script_signal("done"));
+
+	Array expected;
+	expected.push_back(21); // Each call adds the scaled item and the setter adds one.
+	expected.push_back(5);
+	expected.push_back("text");
+	expected.push_back(Vector2(1, 2));
+
+	Ref<RefCounted> ref_counted = memnew(RefCounted);
+	ref_counted->set_script(precompiled);
+	Array result = ref_counted->get_meta("result");
+	CHECK_MESSAGE(result.hash() == expected.hash(), "The precompiled script should run like the original one.");
+
+	// Byte code from another version is compiled from its embedded source instead.
+	Vector<uint8_t> outdated = byte_code;
+	outdated.write[4] ^= 0xFF;
+	CHECK_FALSE(GDScriptBytecode::is_compatible(outdated));
+
+	Ref<GDScript> fallback = memnew(GDScript);
+	fallback->set_byte_code(outdated);
+	ERR_PRINT_OFF;
+	error = fallback->reload();
+	ERR_PRINT_ON;
+	CHECK_MESSAGE(error == OK, "The embedded source should be used when the byte code is outdated.");
+	CHECK_FALSE(fallback->is_precompiled());
+
+	ref_counted = Ref<RefCounted>(memnew(RefCounted));
+	ref_counted->set_script(fallback);
+	result = ref_counted->get_meta("result");
+	CHECK(result.hash() == expected.hash());
+}
+
+TEST_CASE("[Modules][GDScript] Named access follows recompiled scripts") {
+	Ref<GDScript> reader = memnew(GDScript);
+	reader->set_source_code(R"(
+extends RefCounted
+
+func read(object):
+	return [object.second, object.pick()]
+)");
+	Ref<GDScript> target = memnew(GDScript);
+	target->set_source_code(R"(
+extends RefCounted
+
+var first = 1
+var second = 2
+
+func pick():
+	return "old"
+)");
+	ERR_PRINT_OFF;
+	Error error = reader->reload();
+	ERR_PRINT_ON;
+	REQUIRE(error == OK);
+	ERR_PRINT_OFF;
+	error = target->reload();
+	ERR_PRINT_ON;
+	REQUIRE(error == OK);
+
+	Ref<RefCounted> reader_object = memnew(RefCounted);
+	reader_object->set_script(reader);
+
+	Array expected;
+	expected.push_back(2);
+	expected.push_back("old");
+	for (int i = 0; i < 2; i++) {
+		Ref<RefCounted> target_object = memnew(RefCounted);
+		target_object->set_script(target);
+		Array result = reader_object->call("read", target_object);
+		CHECK(result.hash() == expected.hash());
+	}
+
+	// Same script object, but the member moved and the function was replaced.
+	target->set_source_code(R"(
+extends RefCounted
+
+var second = 3
+var first = 4
+
+func pick():
+	return "new"
+)");
+	ERR_PRINT_OFF;
+	error = target->reload();
+	ERR_PRINT_ON;
+	REQUIRE(error == OK);
+
+	expected.clear();
+	expected.push_back(3);
+	expected.push_back("new");
+	Ref<RefCounted> target_object = memnew(RefCounted);
+	target_object->set_script(target);
+	Array result = reader_object->call("read", target_object);
+	CHECK_MESSAGE(result.hash() == expected.hash(), "Lookups cached before the script was recompiled should not be used.");
+}
+
+static void write_script(const String &p_path, const String &p_source) {
+	FileAccessRef file = FileAccess::open(p_path, FileAccess::WRITE);
+	REQUIRE(file);
+	file->store_string(p_source);
+}
+
+TEST_CASE("[Modules][GDScript] Compile scripts with the worker threads") {
+	DirAccessRef dir_access = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	// Preloads are resolved from the script path, which must not depend on the resource path.
+	String dir = OS::get_singleton()->get_cache_path();
+	if (dir.is_rel_path()) {
+		dir = dir_access->get_current_dir().plus_file(dir).simplify_path();
+	}
+	const String base_path = dir.plus_file("batch_base.gd");
+	const String child_path = dir.plus_file("batch_child.gd");
+	const String helper_path = dir.plus_file("batch_helper.gd");
+	const String independent_path = dir.plus_file("batch_independent.gd");
+	const String sibling_path = dir.plus_file("batch_sibling.gd");
+
+	write_script(base_path, "extends RefCounted\nfunc value():\n\treturn 1\n");
+	write_script(child_path, vformat("extends \"%s\"\nconst Helper = preload(\"batch_helper.gd\")\nfunc value():\n\treturn super() + Helper.new().value()\n", base_path));
+	write_script(helper_path, "extends RefCounted\nfunc value():\n\treturn 10\n");
+	write_script(independent_path, "extends RefCounted\nfunc value():\n\treturn 100\n");
+	write_script(sibling_path, vformat("extends \"%s\"\nfunc value():\n\treturn preload(\"batch_helper.gd\").new().value() * 2\n", base_path));
+
+	Vector<String> paths;
+	paths.push_back(child_path);
+	paths.push_back(independent_path);
+	paths.push_back(sibling_path);
+
+	const int expected[] = { 11, 100, 20 };
+
+	for (int pass = 0; pass < 2; pass++) {
+		// Same results when compiled on the calling thread.
+		const bool threaded = GDScriptCache::is_threaded_compilation();
+		GDScriptCache::set_threaded_compilation(pass == 0);
+
+		Vector<Error> errors;
+		Vector<Ref<GDScript>> scripts = GDScriptCache::get_full_scripts(paths, errors);
+		GDScriptCache::set_threaded_compilation(threaded);
+
+		REQUIRE(scripts.size() == paths.size());
+		for (int i = 0; i < paths.size(); i++) {
+			CHECK_MESSAGE(errors[i] == OK, vformat("%s should compile.", paths[i]));
+			REQUIRE(scripts[i].is_valid());
+			CHECK(scripts[i]->is_valid());
+
+			Ref<RefCounted> instance = memnew(RefCounted);
+			instance->set_script(scripts[i]);
+			CHECK_MESSAGE(int(instance->call("value")) == expected[i], vformat("%s should run.", paths[i]));
+		}
+		// Frees the scripts, so the next pass compiles them again.
+	}
+
+	dir_access->remove(base_path);
+	dir_access->remove(child_path);
+	dir_access->remove(helper_path);
+	dir_access->remove(independent_path);
+	dir_access->remove(sibling_path);
+}
+
+TEST_CASE("[Modules][GDScript] Sampling profiler attributes samples to script lines") {
+	Ref<GDScript> gdscript = memnew(GDScript);
+	gdscript->set_source_code(R"(
+extends RefCounted
+
+func spin(n):
+	var total = 0
+	for i in n:
+		total += inner(i)
+	return total
+
+func inner(i):
+	return i % 7
+)");
+	ERR_PRINT_OFF;
+	const Error error = gdscript->reload();
+	ERR_PRINT_ON;
+	REQUIRE(error == OK);
+
+	Ref<RefCounted> ref_counted = memnew(RefCounted);
+	ref_counted->set_script(gdscript);
+
+	SamplingProfiler::clear();
+	SamplingProfiler::start(100);
+	for (int i = 0; i < 1000 && SamplingProfiler::get_sample_count() < 50; i++) {
+		ref_counted->call("spin", 10000);
+	}
+	SamplingProfiler::stop();
+	REQUIRE(SamplingProfiler::get_sample_count() >= 50);
+
+	// The caller frame is at the line of the call while the callee runs.
+	const String collapsed = SamplingProfiler::get_collapsed_stacks();
+	CHECK(collapsed.find("::spin:7;::inner:11 ") != -1);
+	CHECK(collapsed.find("::inner:11;") == -1);
+	SamplingProfiler::clear();
+}
+
 } // namespace GDScriptTests
 
 #endif // GDSCRIPT_TEST_RUNNER_SUITE_H
@@ -0,0 +1,61 @@
+# For loops over packed arrays, with and without a static type for the
+# container, and over range() with bounds only known at runtime.
+
+func sum_range(from: int, to: int, step: int) -> Array:
+	var values := []
+	for i in range(from, to, step):
+		values.append(i)
+	return values
+
+
+func test():
+	var bytes := PackedByteArray([1, 2, 255])
+	for b in bytes:
+		print(b)
+
+	var ints32 := PackedInt32Array([-4, 5])
+	var ints64 := PackedInt64Array([9223372036854775807])
+	var floats32 := PackedFloat32Array([0.5, 1.25])
+	var floats64 := PackedFloat64Array([0.125])
+	var strings := PackedStringArray(["a", "bc"])
+	var vectors2 := PackedVector2Array([Vector2(1, 2)])
+	var vectors3 := PackedVector3Array([Vector3(1, 2, 3), Vector3(4, 5, 6)])
+	var colors := PackedColorArray([Color(1, 0, 0)])
+	for container in [ints32, ints64, floats32, floats64, strings, vectors2, vectors3, colors]:
+		# Untyped container, the element type is only known at runtime.
+		for element in container:
+			print(element)
+
+	var total := 0.0
+	for f in floats32:
+		total += f
+	print(total)
+
+	# Reassigning the loop variable must not corrupt the next iteration.
+	for v in vectors3:
+		print(v)
+		v = "replaced"
+	for i in ints32:
+		i = null
+	for i in 2:
+		i = "text"
+		print(i)
+
+	var empty := PackedVector3Array()
+	for v in empty:
+		print("unreachable")
+
+	var count := 3
+	for i in range(count):
+		print(i)
+	var half := 2.5
+	for i in range(half):
+		print(i)
+	print(sum_range(2, 5, 1))
+	print(sum_range(5, -4, -3))
+	print(sum_range(3, 3, 1))
+	var from := -2
+	var to := 1
+	for i in range(from, to):
+		to = 100
+		print(i)
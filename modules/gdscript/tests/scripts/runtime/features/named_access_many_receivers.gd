@@ -0,0 +1,63 @@
+# The same get, set and call instructions run on more receiver types than
+# they can remember, with the members at different indices.
+
+class A:
+	var value = "a"
+	func describe():
+		return "A " + str(value)
+
+class B:
+	var padding = 0
+	var value = "b"
+	func describe():
+		return "B " + str(value)
+
+class C extends B:
+	var extra = "c"
+	func describe():
+		return "C " + extra
+
+class WithSetter:
+	var value = "s":
+		set(v):
+			value = "set " + str(v)
+	func describe():
+		return "WithSetter " + value
+
+class WithHandlers:
+	var stored = {}
+	func _get(property):
+		if property == "value":
+			return stored.get("value", "h")
+		return null
+	func _set(property, v):
+		if property == "value":
+			stored["value"] = "handled " + str(v)
+			return true
+		return false
+	func describe():
+		return "WithHandlers " + str(stored.get("value", "h"))
+
+
+func update(object, v):
+	object.value = v
+	return object.value
+
+
+func describe(object):
+	return object.describe()
+
+
+func test():
+	var objects = [A.new(), B.new(), C.new(), WithSetter.new(), WithHandlers.new()]
+	for i in 2:
+		for object in objects:
+			print(update(object, i))
+			print(describe(object))
+
+	# Native properties and methods go through the same instructions.
+	var resource = Resource.new()
+	for i in 2:
+		resource.resource_name = "res %d" % i
+		print(resource.resource_name)
+		print(resource.get_class())
@@ -0,0 +1,72 @@
+# Typed int and float operators, stored directly in variables or fused
+# with the conditional jump using them.
+
+var member_total: int = 0
+var untyped_member = "text"
+
+
+func count_down(from: int) -> int:
+	var steps := 0
+	while from > 0:
+		from -= 1
+		steps += 1
+	return steps
+
+
+func test():
+	var a := 7
+	var b := 3
+	var sum := a + b
+	var product := a * b
+	var difference := b - a
+	prints(sum, product, difference)
+
+	# Wraps around like the generic operator.
+	var big := 9223372036854775807
+	prints(big + 1)
+
+	var x := 1.5
+	var y := 0.5
+	var ratio := x / y
+	var fsum := x + y
+	prints(ratio, fsum, x - y, x * y)
+
+	# Any variable can hold the result, whatever it held before.
+	var untyped = "before"
+	untyped = a + b
+	prints(untyped, typeof(untyped) == TYPE_INT)
+	untyped = a < b
+	prints(untyped, typeof(untyped) == TYPE_BOOL)
+	untyped_member = x * y
+	prints(untyped_member, typeof(untyped_member) == TYPE_FLOAT)
+	member_total = a - b
+	member_total += a
+	prints(member_total)
+
+	# Assigning to a float converts the int result.
+	var converted: float = a + b
+	prints(converted, typeof(converted) == TYPE_FLOAT)
+
+	var i := 0
+	var total := 0
+	while i < 10:
+		if i % 2 == 0:
+			total += i
+		if i != 3:
+			total += 1
+		i += 1
+	prints(total, count_down(5))
+
+	# Comparisons with NaN are false, also when fused with the jump.
+	var nan := NAN
+	if nan < 1.0:
+		print("less")
+	if not (nan < 1.0):
+		print("not less")
+	if nan != nan:
+		print("nan is not equal to itself")
+	if nan == nan:
+		print("nan is equal to itself")
+	var le := 1.0
+	if x >= le and x <= 2.0:
+		print("in range")
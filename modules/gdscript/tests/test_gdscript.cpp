@@ -31,6 +31,7 @@
 #include "test_gdscript.h"
 
 #include "core/config/project_settings.h"
+#include "core/io/dir_access.h"
 #include "core/io/file_access.h"
 #include "core/io/file_access_pack.h"
 #include "core/os/main_loop.h"
@@ -39,6 +40,7 @@
 #include "scene/resources/packed_scene.h"
 
 #include "modules/gdscript/gdscript_analyzer.h"
+#include "modules/gdscript/gdscript_cache.h"
 #include "modules/gdscript/gdscript_compiler.h"
 #include "modules/gdscript/gdscript_parser.h"
 #include "modules/gdscript/gdscript_tokenizer.h"
@@ -244,4 +246,161 @@ void test(TestType p_type) {
 
 	finish_language();
 }
+
+static void list_scripts(const String &p_dir, Vector<String> &r_paths) {
+	DirAccessRef dir = DirAccess::open(p_dir);
+	ERR_FAIL_COND_MSG(!dir, "Could not open directory: " + p_dir);
+
+	dir->list_dir_begin();
+	String next = dir->get_next();
+	while (!next.is_empty()) {
+		if (dir->current_is_dir()) {
+			if (next != "." && next != "..") {
+				list_scripts(p_dir.plus_file(next), r_paths);
+			}
+		} else if (next.get_extension().to_lower() == "gd") {
+			r_paths.push_back(p_dir.plus_file(next));
+		}
+		next = dir->get_next();
+	}
+	dir->list_dir_end();
+}
+
+void test_load_benchmark() {
+	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
+
+	if (cmdlargs.is_empty()) {
+		return;
+	}
+
+	String dir = cmdlargs.back()->get();
+	if (!DirAccess::exists(dir)) {
+		print_line("This test expects a path to a directory with GDScript files as its last parameter. Got: " + dir);
+		return;
+	}
+
+	init_language(dir);
+
+	Vector<String> paths;
+	list_scripts(dir, paths);
+
+	const bool threaded = GDScriptCache::is_threaded_compilation();
+	for (int pass = 0; pass < 2; pass++) {
+		GDScriptCache::set_threaded_compilation(pass == 1);
+
+		uint64_t start = OS::get_singleton()->get_ticks_usec();
+		Vector<Error> errors;
+		Vector<Ref<GDScript>> scripts = GDScriptCache::get_full_scripts(paths, errors);
+		uint64_t time = OS::get_singleton()->get_ticks_usec() - start;
+
+		int failed = 0;
+		for (int i = 0; i < errors.size(); i++) {
+			if (errors[i] != OK) {
+				failed++;
+			}
+		}
+		print_line(vformat("%s: %d scripts loaded in %.2f ms, %d failed.", pass == 1 ? "Worker threads" : "Calling thread", paths.size(), time / 1000.0, failed));
+
+		scripts.clear();
+		for (int i = 0; i < paths.size(); i++) {
+			if (ResourceCache::has(paths[i])) {
+				WARN_PRINT("Scripts are still referenced after loading them (cyclic references?), the next pass won't compile them again.");
+				break;
+			}
+		}
+	}
+	GDScriptCache::set_threaded_compilation(threaded);
+
+	finish_language();
+}
+
+static const char *numeric_benchmark_source = R"(
+extends RefCounted
+
+func int_loop(n: int) -> int:
+	var total := 0
+	var i := 0
+	while i < n:
+		total += i * 3 - 1
+		i += 1
+	return total
+
+func float_loop(n: int) -> float:
+	var x := 0.0
+	var i := 0
+	while i < n:
+		x = x * 0.999 + 0.5
+		i += 1
+	return x
+
+func branches(n: int) -> int:
+	var count := 0
+	for i in n:
+		if i * 7 > 3000:
+			count += 2
+		elif i != 5:
+			count -= 1
+	return count
+
+func distance_sum(n: int) -> float:
+	var sum := 0.0
+	var x := 0.0
+	var y := 1.0
+	for i in n:
+		x += 0.25
+		y -= 0.125
+		if x * x + y * y < 100.0:
+			sum += x * y
+	return sum
+)";
+
+void test_numeric_benchmark() {
+	const char *functions[] = { "int_loop", "float_loop", "branches", "distance_sum" };
+	const int function_count = sizeof(functions) / sizeof(functions[0]);
+	const int iterations = 1000000;
+
+	GDScriptLanguage::get_singleton()->init();
+
+	uint64_t times[2][function_count];
+	Variant results[2][function_count];
+
+	for (int pass = 0; pass < 2; pass++) {
+		// Compile with a compiler of our own, so the setting doesn't leak into other compilations.
+		GDScriptParser parser;
+		Error err = parser.parse(numeric_benchmark_source, "", false);
+		GDScriptAnalyzer analyzer(&parser);
+		if (err == OK) {
+			err = analyzer.analyze();
+		}
+
+		Ref<GDScript> script;
+		script.instantiate();
+		if (err == OK) {
+			GDScriptCompiler compiler;
+			compiler.set_specialize_instructions(pass == 1);
+			err = compiler.compile(&parser, script.ptr(), false);
+		}
+		if (err != OK) {
+			print_line("The benchmark script failed to compile.");
+			GDScriptLanguage::get_singleton()->finish();
+			return;
+		}
+
+		Ref<RefCounted> object;
+		object.instantiate();
+		object->set_script(script);
+
+		for (int i = 0; i < function_count; i++) {
+			uint64_t start = OS::get_singleton()->get_ticks_usec();
+			results[pass][i] = object->call(functions[i], iterations);
+			times[pass][i] = OS::get_singleton()->get_ticks_usec() - start;
+		}
+	}
+
+	for (int i = 0; i < function_count; i++) {
+		print_line(vformat("%s: %.2f ms generic, %.2f ms specialized (%.2fx)%s", functions[i], times[0][i] / 1000.0, times[1][i] / 1000.0, double(times[0][i]) / MAX(times[1][i], (uint64_t)1), results[0][i] == results[1][i] ? "" : ", results differ!"));
+	}
+
+	GDScriptLanguage::get_singleton()->finish();
+}
 } // namespace GDScriptTests
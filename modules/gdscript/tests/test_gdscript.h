@@ -44,6 +44,10 @@ enum TestType {
 };
 
 void test(TestType p_type);
+// Compares loading every script of a directory on the calling thread and with the worker threads.
+void test_load_benchmark();
+// Times numeric loops with the generic and the specialized instructions.
+void test_numeric_benchmark();
 
 } // namespace GDScriptTests
 
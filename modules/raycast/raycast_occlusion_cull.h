@@ -35,6 +35,7 @@
 #include "core/math/camera_matrix.h"
 #include "core/object/object.h"
 #include "core/object/ref_counted.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/rid_owner.h"
 #include "scene/resources/mesh.h"
@@ -69,7 +70,7 @@ public:
 		virtual void clear() override;
 		virtual void resize(const Size2i &p_size) override;
 		void sort_rays();
-		void update_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_work_pool);
+		void update_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal);
 	};
 
 private:
@@ -118,8 +119,7 @@ private:
 			Vector3 *write;
 		};
 
-		Thread *commit_thread = nullptr;
-		bool commit_done = true;
+		WorkerThreadPool::TaskID commit_task = WorkerThreadPool::INVALID_TASK_ID;
 		bool dirty = false;
 		bool removed = false;
 
@@ -132,14 +132,14 @@ private:
 		LocalVector<RID> removed_instances;
 
 		void _update_dirty_instance_thread(int p_idx, RID *p_instances);
-		void _update_dirty_instance(int p_idx, RID *p_instances, ThreadWorkPool *p_thread_pool);
+		void _update_dirty_instance(int p_idx, RID *p_instances, bool p_use_threads);
 		void _transform_vertices_thread(uint32_t p_thread, TransformThreadData *p_data);
 		void _transform_vertices_range(const Vector3 *p_read, Vector3 *p_write, const Transform3D &p_xform, int p_from, int p_to);
 		static void _commit_scene(void *p_ud);
-		bool update(ThreadWorkPool &p_thread_pool);
+		bool update();
 
 		void _raycast(uint32_t p_thread, const RaycastThreadData *p_raycast_data) const;
-		void raycast(LocalVector<RayPacket> &r_rays, const LocalVector<uint32_t> p_valid_masks, ThreadWorkPool &p_thread_pool) const;
+		void raycast(LocalVector<RayPacket> &r_rays, const LocalVector<uint32_t> p_valid_masks) const;
 	};
 
 	static RaycastOcclusionCull *raycast_singleton;
@@ -172,7 +172,7 @@ public:
 	virtual HZBuffer *buffer_get_ptr(RID p_buffer) override;
 	virtual void buffer_set_scenario(RID p_buffer, RID p_scenario) override;
 	virtual void buffer_set_size(RID p_buffer, const Vector2i &p_size) override;
-	virtual void buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_pool) override;
+	virtual void buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal) override;
 	virtual RID buffer_get_debug_texture(RID p_buffer) override;
 
 	virtual void set_build_quality(RS::ViewportOcclusionCullingBuildQuality p_quality) override;
@@ -31,7 +31,6 @@
 #include "voxelizer.h"
 #include "core/math/geometry_3d.h"
 #include "core/os/os.h"
-#include "core/os/threaded_array_processor.h"
 
 #include <stdlib.h>
 
@@ -364,9 +364,9 @@ void Node::set_physics_process(bool p_process) {
 	data.physics_process = p_process;
 
 	if (data.physics_process) {
-		add_to_group("physics_process", false);
+		add_to_group(data.process_threaded ? "physics_process_threaded" : "physics_process", false);
 	} else {
-		remove_from_group("physics_process");
+		remove_from_group(data.process_threaded ? "physics_process_threaded" : "physics_process");
 	}
 }
 
@@ -729,9 +729,9 @@ void Node::set_process(bool p_process) {
 	data.process = p_process;
 
 	if (data.process) {
-		add_to_group("process", false);
+		add_to_group(data.process_threaded ? "process_threaded" : "process", false);
 	} else {
-		remove_from_group("process");
+		remove_from_group(data.process_threaded ? "process_threaded" : "process");
 	}
 }
 
@@ -765,7 +765,7 @@ void Node::set_process_priority(int p_priority) {
 		return;
 	}
 
-	if (is_processing()) {
+	if (is_processing() && !data.process_threaded) {
 		data.tree->make_group_changed("process");
 	}
 
@@ -773,7 +773,7 @@ void Node::set_process_priority(int p_priority) {
 		data.tree->make_group_changed("process_internal");
 	}
 
-	if (is_physics_processing()) {
+	if (is_physics_processing() && !data.process_threaded) {
 		data.tree->make_group_changed("physics_process");
 	}
 
@@ -786,6 +786,27 @@ int Node::get_process_priority() const {
 	return data.process_priority;
 }
 
+void Node::set_process_threaded(bool p_enabled) {
+	if (data.process_threaded == p_enabled) {
+		return;
+	}
+
+	// Threaded nodes live in their own processing groups, move over.
+	bool process = data.process;
+	bool physics_process = data.physics_process;
+	set_process(false);
+	set_physics_process(false);
+
+	data.process_threaded = p_enabled;
+
+	set_process(process);
+	set_physics_process(physics_process);
+}
+
+bool Node::is_process_threaded() const {
+	return data.process_threaded;
+}
+
 void Node::set_process_input(bool p_enable) {
 	if (p_enable == data.input) {
 		return;
@@ -1566,17 +1587,13 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 		return;
 	}
 
-	GroupData gd;
+	// The tree stores the index of this node in the group in its GroupData, so it must exist first.
+	GroupData &gd = data.grouped[p_identifier];
+	gd.persistent = p_persistent;
 
 	if (data.tree) {
 		gd.group = data.tree->add_to_group(p_identifier, this);
-	} else {
-		gd.group = nullptr;
 	}
-
-	gd.persistent = p_persistent;
-
-	data.grouped[p_identifier] = gd;
 }
 
 void Node::remove_from_group(const StringName &p_identifier) {
@@ -2589,6 +2606,8 @@ void Node::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_process", "enable"), &Node::set_process);
 	ClassDB::bind_method(D_METHOD("set_process_priority", "priority"), &Node::set_process_priority);
 	ClassDB::bind_method(D_METHOD("get_process_priority"), &Node::get_process_priority);
+	ClassDB::bind_method(D_METHOD("set_process_threaded", "enabled"), &Node::set_process_threaded);
+	ClassDB::bind_method(D_METHOD("is_process_threaded"), &Node::is_process_threaded);
 	ClassDB::bind_method(D_METHOD("is_processing"), &Node::is_processing);
 	ClassDB::bind_method(D_METHOD("set_process_input", "enable"), &Node::set_process_input);
 	ClassDB::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
@@ -2726,6 +2745,7 @@ void Node::_bind_methods() {
 	ADD_GROUP("Process", "process_");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_mode", PROPERTY_HINT_ENUM, "Inherit,Pausable,When Paused,Always,Disabled"), "set_process_mode", "get_process_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "process_priority"), "set_process_priority", "get_process_priority");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "process_threaded"), "set_process_threaded", "is_process_threaded");
 
 	ADD_GROUP("Editor Description", "editor_");
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "editor_description", PROPERTY_HINT_MULTILINE_TEXT, "", PROPERTY_USAGE_EDITOR | PROPERTY_USAGE_INTERNAL), "set_editor_description", "get_editor_description");
@@ -87,6 +87,7 @@ private:
 	struct GroupData {
 		bool persistent = false;
 		SceneTree::Group *group = nullptr;
+		int index = -1; // Position in group->nodes.
 	};
 
 	struct Data {
@@ -127,6 +128,7 @@ private:
 		bool physics_process = false;
 		bool process = false;
 		int process_priority = 0;
+		bool process_threaded = false;
 
 		bool physics_process_internal = false;
 		bool process_internal = false;
@@ -355,6 +357,9 @@ public:
 	void set_process_priority(int p_priority);
 	int get_process_priority() const;
 
+	void set_process_threaded(bool p_enabled);
+	bool is_process_threaded() const;
+
 	void set_process_input(bool p_enable);
 	bool is_processing_input() const;
 
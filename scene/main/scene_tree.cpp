@@ -32,6 +32,7 @@
 
 #include "core/config/project_settings.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/debugger/trace.h"
 #include "core/input/input.h"
 #include "core/io/dir_access.h"
 #include "core/io/marshalls.h"
@@ -39,6 +40,7 @@
 #include "core/object/message_queue.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/string/print_string.h"
 #include "node.h"
 #include "scene/animation/tween.h"
@@ -125,32 +127,52 @@ void SceneTree::node_renamed(Node *p_node) {
 }
 
 SceneTree::Group *SceneTree::add_to_group(const StringName &p_group, Node *p_node) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
-		E = group_map.insert(p_group, Group());
+	Map<StringName, Node::GroupData>::Element *NE = p_node->data.grouped.find(p_group);
+	ERR_FAIL_COND_V_MSG(!NE, nullptr, "Node does not list group: " + p_group + ".");
+
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
+		g = &group_map.set(p_group, Group())->value();
+		g->name = p_group;
 	}
 
-	ERR_FAIL_COND_V_MSG(E->get().nodes.find(p_node) != -1, &E->get(), "Already in group: " + p_group + ".");
-	E->get().nodes.push_back(p_node);
-	//E->get().last_tree_version=0;
-	E->get().changed = true;
-	return &E->get();
+	int index = NE->get().index;
+	ERR_FAIL_COND_V_MSG(index >= 0 && index < g->nodes.size() && g->nodes[index] == p_node, g, "Already in group: " + p_group + ".");
+
+	// Appended unsorted, _update_group_order() merges it in when the group is used.
+	NE->get().index = g->nodes.size();
+	g->nodes.push_back(p_node);
+	return g;
 }
 
 void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	ERR_FAIL_COND(!E);
+	Group *g = group_map.getptr(p_group);
+	ERR_FAIL_COND(!g);
+	Map<StringName, Node::GroupData>::Element *NE = p_node->data.grouped.find(p_group);
+	ERR_FAIL_COND(!NE);
+
+	int index = NE->get().index;
+	ERR_FAIL_COND(index < 0 || index >= g->nodes.size() || g->nodes[index] != p_node);
+	NE->get().index = -1;
+
+	if (g->nodes.size() - g->holes == 1) {
+		group_map.erase(p_group);
+		return;
+	}
 
-	E->get().nodes.erase(p_node);
-	if (E->get().nodes.is_empty()) {
-		group_map.erase(E);
+	if (index == g->nodes.size() - 1) {
+		g->nodes.resize(index);
+		g->sorted_count = MIN(g->sorted_count, index);
+	} else {
+		g->nodes.write[index] = nullptr;
+		g->holes++;
 	}
 }
 
 void SceneTree::make_group_changed(const StringName &p_group) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (E) {
-		E->get().changed = true;
+	Group *g = group_map.getptr(p_group);
+	if (g) {
+		g->changed = true;
 	}
 }
 
@@ -185,33 +207,125 @@ void SceneTree::_flush_ugc() {
 	ugc_locked = false;
 }
 
+void SceneTree::_set_group_index(const Group &g, Node *p_node, int p_index) {
+	Map<StringName, Node::GroupData>::Element *NE = p_node->data.grouped.find(g.name);
+	ERR_FAIL_COND(!NE);
+	NE->get().index = p_index;
+}
+
+template <class C>
+static int _merge_group_tail(Node **p_nodes, int p_sorted_count, int p_node_count, LocalVector<Node *> &r_buffer) {
+	SortArray<Node *, C> node_sort;
+	node_sort.sort(&p_nodes[p_sorted_count], p_node_count - p_sorted_count);
+
+	C compare;
+	if (p_sorted_count == 0 || !compare(p_nodes[p_sorted_count], p_nodes[p_sorted_count - 1])) {
+		return p_sorted_count; // Common case, new nodes were added after the existing ones.
+	}
+
+	// Only the part of the sorted range that goes after the first new node moves.
+	int from = 0;
+	int to = p_sorted_count;
+	while (from < to) {
+		int half = (from + to) / 2;
+		if (compare(p_nodes[p_sorted_count], p_nodes[half])) {
+			to = half;
+		} else {
+			from = half + 1;
+		}
+	}
+
+	r_buffer.resize(p_sorted_count - from);
+	for (int i = from; i < p_sorted_count; i++) {
+		r_buffer[i - from] = p_nodes[i];
+	}
+
+	// The write position never passes the tail read position.
+	uint32_t a = 0;
+	int b = p_sorted_count;
+	to = from;
+	while (a < r_buffer.size() && b < p_node_count) {
+		if (compare(p_nodes[b], r_buffer[a])) {
+			p_nodes[to++] = p_nodes[b++];
+		} else {
+			p_nodes[to++] = r_buffer[a++];
+		}
+	}
+	while (a < r_buffer.size()) {
+		p_nodes[to++] = r_buffer[a++];
+	}
+	r_buffer.clear();
+	return from;
+}
+
 void SceneTree::_update_group_order(Group &g, bool p_use_priority) {
-	if (!g.changed) {
+	if (g.holes) {
+		Node **nodes = g.nodes.ptrw();
+		int node_count = g.nodes.size();
+		int sorted_count = 0;
+		int to = 0;
+		for (int i = 0; i < node_count; i++) {
+			if (i == g.sorted_count) {
+				sorted_count = to;
+			}
+			if (!nodes[i]) {
+				continue;
+			}
+			if (to != i) {
+				nodes[to] = nodes[i];
+				_set_group_index(g, nodes[to], to);
+			}
+			to++;
+		}
+		g.nodes.resize(to);
+		g.sorted_count = g.sorted_count >= node_count ? to : sorted_count;
+		g.holes = 0;
+	}
+
+	int node_count = g.nodes.size();
+	if (node_count == 0) {
 		return;
 	}
-	if (g.nodes.is_empty()) {
+
+	if (!g.changed && g.sorted_with_priority == p_use_priority && g.sorted_count == node_count) {
 		return;
 	}
 
 	Node **nodes = g.nodes.ptrw();
-	int node_count = g.nodes.size();
+	int reindex_from = 0;
 
-	if (p_use_priority) {
-		SortArray<Node *, Node::ComparatorWithPriority> node_sort;
-		node_sort.sort(nodes, node_count);
+	if (g.changed || g.sorted_with_priority != p_use_priority) {
+		if (p_use_priority) {
+			SortArray<Node *, Node::ComparatorWithPriority> node_sort;
+			node_sort.sort(nodes, node_count);
+		} else {
+			SortArray<Node *, Node::Comparator> node_sort;
+			node_sort.sort(nodes, node_count);
+		}
 	} else {
-		SortArray<Node *, Node::Comparator> node_sort;
-		node_sort.sort(nodes, node_count);
+		// Only nodes added since the last sort are out of place, sort them and merge them in.
+		if (p_use_priority) {
+			reindex_from = _merge_group_tail<Node::ComparatorWithPriority>(nodes, g.sorted_count, node_count, group_merge_buffer);
+		} else {
+			reindex_from = _merge_group_tail<Node::Comparator>(nodes, g.sorted_count, node_count, group_merge_buffer);
+		}
 	}
+
+	for (int i = reindex_from; i < node_count; i++) {
+		_set_group_index(g, nodes[i], i);
+	}
+
+	g.sorted_count = node_count;
+	g.sorted_with_priority = p_use_priority;
 	g.changed = false;
 }
 
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *gp = group_map.getptr(p_group);
+	if (!gp) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.is_empty()) {
 		return;
 	}
@@ -283,11 +397,11 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
 }
 
 void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_group, int p_notification) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *gp = group_map.getptr(p_group);
+	if (!gp) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.is_empty()) {
 		return;
 	}
@@ -334,11 +448,11 @@ void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_gr
 }
 
 void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group, const String &p_name, const Variant &p_value) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *gp = group_map.getptr(p_group);
+	if (!gp) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.is_empty()) {
 		return;
 	}
@@ -404,6 +518,7 @@ void SceneTree::initialize() {
 }
 
 bool SceneTree::physics_process(double p_time) {
+	TRACE_ZONE("SceneTree::physics_process");
 	root_lock++;
 
 	current_frame++;
@@ -417,6 +532,7 @@ bool SceneTree::physics_process(double p_time) {
 
 	_notify_group_pause(SNAME("physics_process_internal"), Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
 	call_group_flags(GROUP_CALL_REALTIME, SNAME("_picking_viewports"), SNAME("_process_picking"));
+	_notify_group_threaded(SNAME("physics_process_threaded"), Node::NOTIFICATION_PHYSICS_PROCESS);
 	_notify_group_pause(SNAME("physics_process"), Node::NOTIFICATION_PHYSICS_PROCESS);
 	_flush_ugc();
 	MessageQueue::get_singleton()->flush(); //small little hack
@@ -433,6 +549,7 @@ bool SceneTree::physics_process(double p_time) {
 }
 
 bool SceneTree::process(double p_time) {
+	TRACE_ZONE("SceneTree::process");
 	root_lock++;
 
 	MainLoop::process(p_time);
@@ -450,6 +567,7 @@ bool SceneTree::process(double p_time) {
 	flush_transform_notifications();
 
 	_notify_group_pause(SNAME("process_internal"), Node::NOTIFICATION_INTERNAL_PROCESS);
+	_notify_group_threaded(SNAME("process_threaded"), Node::NOTIFICATION_PROCESS);
 	_notify_group_pause(SNAME("process"), Node::NOTIFICATION_PROCESS);
 
 	_flush_ugc();
@@ -815,11 +933,11 @@ bool SceneTree::is_paused() const {
 }
 
 void SceneTree::_notify_group_pause(const StringName &p_group, int p_notification) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *gp = group_map.getptr(p_group);
+	if (!gp) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.is_empty()) {
 		return;
 	}
@@ -858,6 +976,42 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 	}
 }
 
+void SceneTree::_notify_threaded_node(uint32_t p_index, int p_notification) {
+	threaded_process_nodes[p_index]->notification(p_notification);
+}
+
+void SceneTree::_notify_group_threaded(const StringName &p_group, int p_notification) {
+	Group *gp = group_map.getptr(p_group);
+	if (!gp) {
+		return;
+	}
+	Group &g = *gp;
+
+	_update_group_order(g);
+
+	// Filter on the main thread, processing checks walk up the tree.
+	threaded_process_nodes.clear();
+	Node **nodes = g.nodes.ptrw();
+	int node_count = g.nodes.size();
+	for (int i = 0; i < node_count; i++) {
+		Node *n = nodes[i];
+		if (n->can_process() && n->can_process_notification(p_notification)) {
+			threaded_process_nodes.push_back(n);
+		}
+	}
+
+	if (threaded_process_nodes.is_empty()) {
+		return;
+	}
+
+	// Nodes can't be freed from the threads (queue_free() is deferred), so the list stays valid.
+	WorkerThreadPool::get_singleton()->do_work(threaded_process_nodes.size(), this, &SceneTree::_notify_threaded_node, p_notification);
+	threaded_process_nodes.clear();
+
+	// Apply what the threaded nodes deferred before the main thread nodes run.
+	MessageQueue::get_singleton()->flush();
+}
+
 /*
 void SceneMainLoop::_update_listener_2d() {
 	if (listener_2d.is_valid()) {
@@ -868,11 +1022,11 @@ void SceneMainLoop::_update_listener_2d() {
 */
 
 void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input, Viewport *p_viewport) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *gp = group_map.getptr(p_group);
+	if (!gp) {
 		return;
 	}
-	Group &g = E->get();
+	Group &g = *gp;
 	if (g.nodes.is_empty()) {
 		return;
 	}
@@ -970,20 +1124,20 @@ int64_t SceneTree::get_frame() const {
 
 Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 	Array ret;
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
 		return ret;
 	}
 
-	_update_group_order(E->get()); //update order just in case
-	int nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	int nc = g->nodes.size();
 	if (nc == 0) {
 		return ret;
 	}
 
 	ret.resize(nc);
 
-	Node **ptr = E->get().nodes.ptrw();
+	Node **ptr = g->nodes.ptrw();
 	for (int i = 0; i < nc; i++) {
 		ret[i] = ptr[i];
 	}
@@ -996,32 +1150,32 @@ bool SceneTree::has_group(const StringName &p_identifier) const {
 }
 
 Node *SceneTree::get_first_node_in_group(const StringName &p_group) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
 		return nullptr; //no group
 	}
 
-	_update_group_order(E->get()); //update order just in case
+	_update_group_order(*g); //update order just in case
 
-	if (E->get().nodes.size() == 0) {
+	if (g->nodes.size() == 0) {
 		return nullptr;
 	}
 
-	return E->get().nodes[0];
+	return g->nodes[0];
 }
 
 void SceneTree::get_nodes_in_group(const StringName &p_group, List<Node *> *p_list) {
-	Map<StringName, Group>::Element *E = group_map.find(p_group);
-	if (!E) {
+	Group *g = group_map.getptr(p_group);
+	if (!g) {
 		return;
 	}
 
-	_update_group_order(E->get()); //update order just in case
-	int nc = E->get().nodes.size();
+	_update_group_order(*g); //update order just in case
+	int nc = g->nodes.size();
 	if (nc == 0) {
 		return;
 	}
-	Node **ptr = E->get().nodes.ptrw();
+	Node **ptr = g->nodes.ptrw();
 	for (int i = 0; i < nc; i++) {
 		p_list->push_back(ptr[i]);
 	}
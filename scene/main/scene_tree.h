@@ -34,6 +34,8 @@
 #include "core/io/multiplayer_api.h"
 #include "core/os/main_loop.h"
 #include "core/os/thread_safe.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/self_list.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/world_2d.h"
@@ -84,8 +86,16 @@ public:
 
 private:
 	struct Group {
+		StringName name;
+		// Each member knows its index here (see Node::GroupData), so removing a
+		// node only leaves a null hole. Holes are compacted, keeping the order,
+		// the next time the group is used.
 		Vector<Node *> nodes;
-		bool changed = false;
+		int holes = 0;
+		// Members past this index were added after the group was last sorted.
+		int sorted_count = 0;
+		bool sorted_with_priority = false;
+		bool changed = false; // Tree order of existing members changed, needs a full sort.
 	};
 
 	Window *root = nullptr;
@@ -103,7 +113,9 @@ private:
 	bool paused = false;
 	int root_lock = 0;
 
-	Map<StringName, Group> group_map;
+	HashMap<StringName, Group> group_map;
+	LocalVector<Node *> group_merge_buffer;
+	LocalVector<Node *> threaded_process_nodes;
 	bool _quit = false;
 	bool initialized = false;
 
@@ -135,7 +147,8 @@ private:
 	bool ugc_locked = false;
 	void _flush_ugc();
 
-	_FORCE_INLINE_ void _update_group_order(Group &g, bool p_use_priority = false);
+	_FORCE_INLINE_ void _set_group_index(const Group &g, Node *p_node, int p_index);
+	void _update_group_order(Group &g, bool p_use_priority = false);
 	void _update_listener();
 
 	Array _get_nodes_in_group(const StringName &p_group);
@@ -177,6 +190,8 @@ private:
 	void make_group_changed(const StringName &p_group);
 
 	void _notify_group_pause(const StringName &p_group, int p_notification);
+	void _notify_group_threaded(const StringName &p_group, int p_notification);
+	void _notify_threaded_node(uint32_t p_index, int p_notification);
 	Variant _call_group_flags(const Variant **p_args, int p_argcount, Callable::CallError &r_error);
 	Variant _call_group(const Variant **p_args, int p_argcount, Callable::CallError &r_error);
 
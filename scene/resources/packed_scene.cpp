@@ -45,7 +45,72 @@ bool SceneState::can_instantiate() const {
 	return nodes.size() > 0;
 }
 
+const SceneState::InstancePlan *SceneState::_get_instance_plan() const {
+	if (instance_plan_built.is_set()) {
+		return &instance_plan;
+	}
+
+	MutexLock lock(instance_plan_mutex);
+	if (instance_plan_built.is_set()) {
+		return &instance_plan;
+	}
+
+	instance_plan.nodes.resize(nodes.size());
+	for (int i = 0; i < nodes.size(); i++) {
+		const NodeData &n = nodes[i];
+		InstancePlan::NodePlan &node_plan = instance_plan.nodes.write[i];
+
+		// Only nodes created from their class, not inherited or instantiated scenes.
+		bool created = !(i == 0 && base_scene_idx >= 0) && n.instance < 0 && n.type != TYPE_INSTANCED;
+		if (created && n.type >= 0 && n.type < names.size() && ClassDB::is_parent_class(names[n.type], SNAME("Node"))) {
+			node_plan.creation_func = ClassDB::get_creation_func(names[n.type]);
+		}
+
+		node_plan.properties.resize(n.properties.size());
+		for (int j = 0; j < n.properties.size(); j++) {
+			InstancePlan::PropertyPlan &property_plan = node_plan.properties.write[j];
+			int name = n.properties[j].name;
+			if (name < 0 || name >= names.size()) {
+				continue;
+			}
+			property_plan.is_script = names[name] == CoreStringNames::get_singleton()->_script;
+			if (node_plan.creation_func && !property_plan.is_script) {
+				property_plan.setget = ClassDB::get_property_setget(names[n.type], names[name]);
+			}
+		}
+	}
+
+	instance_plan.connection_binds.resize(connections.size());
+	for (int i = 0; i < connections.size(); i++) {
+		const ConnectionData &c = connections[i];
+		Vector<Variant> &binds = instance_plan.connection_binds.write[i];
+		binds.clear();
+		for (int j = 0; j < c.binds.size(); j++) {
+			ERR_CONTINUE(c.binds[j] < 0 || c.binds[j] >= variants.size());
+			binds.push_back(variants[c.binds[j]]);
+		}
+	}
+
+	instance_plan_built.set();
+	return &instance_plan;
+}
+
+void SceneState::_clear_instance_plan() {
+	MutexLock lock(instance_plan_mutex);
+	instance_plan_built.clear();
+	instance_plan.nodes.clear();
+	instance_plan.connection_binds.clear();
+}
+
 Node *SceneState::instantiate(GenEditState p_edit_state) const {
+	return _instantiate(p_edit_state, true);
+}
+
+Node *SceneState::instantiate_without_plan(GenEditState p_edit_state) const {
+	return _instantiate(p_edit_state, false);
+}
+
+Node *SceneState::_instantiate(GenEditState p_edit_state, bool p_use_plan) const {
 	// nodes where instancing failed (because something is missing)
 	List<Node *> stray_instances;
 
@@ -80,6 +145,11 @@ Node *SceneState::instantiate(GenEditState p_edit_state) const {
 
 	Node **ret_nodes = (Node **)alloca(sizeof(Node *) * nc);
 
+	const InstancePlan *plan = nullptr;
+	if (p_edit_state == GEN_EDIT_STATE_DISABLED && p_use_plan) {
+		plan = _get_instance_plan();
+	}
+
 	bool gen_node_path_cache = p_edit_state != GEN_EDIT_STATE_DISABLED && node_path_cache.is_empty();
 
 	Map<Ref<Resource>, Ref<Resource>> resources_local_to_scene;
@@ -150,7 +220,9 @@ Node *SceneState::instantiate(GenEditState p_edit_state) const {
 		} else {
 			Object *obj = nullptr;
 
-			if (ClassDB::is_class_enabled(snames[n.type])) {
+			if (plan && plan->nodes[i].creation_func) {
+				obj = plan->nodes[i].creation_func();
+			} else if (ClassDB::is_class_enabled(snames[n.type])) {
 				//node belongs to this scene and must be created
 				obj = ClassDB::instantiate(snames[n.type]);
 			}
@@ -187,13 +259,17 @@ Node *SceneState::instantiate(GenEditState p_edit_state) const {
 			int nprop_count = n.properties.size();
 			if (nprop_count) {
 				const NodeData::Property *nprops = &n.properties[0];
+				const InstancePlan::PropertyPlan *pplans = plan ? plan->nodes[i].properties.ptr() : nullptr;
 
 				for (int j = 0; j < nprop_count; j++) {
 					bool valid;
 					ERR_FAIL_INDEX_V(nprops[j].name, sname_count, nullptr);
 					ERR_FAIL_INDEX_V(nprops[j].value, prop_count, nullptr);
 
-					if (snames[nprops[j].name] == CoreStringNames::get_singleton()->_script) {
+					if (pplans && pplans[j].setget && props[nprops[j].value].get_type() != Variant::OBJECT && !node->get_script_instance()) {
+						// Same setter Object::set() would find, as the node was created from the planned class.
+						ClassDB::set_property_setget(node, pplans[j].setget, props[nprops[j].value], &valid);
+					} else if (pplans ? pplans[j].is_script : snames[nprops[j].name] == CoreStringNames::get_singleton()->_script) {
 						//work around to avoid old script variables from disappearing, should be the proper fix to:
 						//https://github.com/godotengine/godot/issues/2958
 
@@ -317,6 +393,11 @@ Node *SceneState::instantiate(GenEditState p_edit_state) const {
 			continue;
 		}
 
+		if (plan) {
+			cfrom->connect(snames[c.signal], Callable(cto, snames[c.method]), plan->connection_binds[i], CONNECT_PERSIST | c.flags);
+			continue;
+		}
+
 		Vector<Variant> binds;
 		if (c.binds.size()) {
 			binds.resize(c.binds.size());
@@ -920,6 +1001,7 @@ void SceneState::clear() {
 	node_paths.clear();
 	editable_instances.clear();
 	base_scene_idx = -1;
+	_clear_instance_plan();
 }
 
 Ref<SceneState> SceneState::_get_base_scene_state() const {
@@ -1062,6 +1144,8 @@ bool SceneState::is_connection(int p_node, const StringName &p_signal, int p_to_
 }
 
 void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
+	_clear_instance_plan();
+
 	ERR_FAIL_COND(!p_dictionary.has("names"));
 	ERR_FAIL_COND(!p_dictionary.has("variants"));
 	ERR_FAIL_COND(!p_dictionary.has("node_count"));
@@ -1515,6 +1599,7 @@ int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int
 	nd.index = p_index;
 
 	nodes.push_back(nd);
+	_clear_instance_plan();
 
 	return nodes.size() - 1;
 }
@@ -1528,6 +1613,7 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 	prop.name = p_name;
 	prop.value = p_value;
 	nodes.write[p_node].properties.push_back(prop);
+	_clear_instance_plan();
 }
 
 void SceneState::add_node_group(int p_node, int p_group) {
@@ -1539,6 +1625,7 @@ void SceneState::add_node_group(int p_node, int p_group) {
 void SceneState::set_base_scene(int p_idx) {
 	ERR_FAIL_INDEX(p_idx, variants.size());
 	base_scene_idx = p_idx;
+	_clear_instance_plan();
 }
 
 void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method, int p_flags, const Vector<int> &p_binds) {
@@ -1556,6 +1643,7 @@ void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method
 	c.flags = p_flags;
 	c.binds = p_binds;
 	connections.push_back(c);
+	_clear_instance_plan();
 }
 
 void SceneState::add_editable_instance(const NodePath &p_path) {
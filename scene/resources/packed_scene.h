@@ -32,6 +32,8 @@
 #define PACKED_SCENE_H
 
 #include "core/io/resource.h"
+#include "core/os/mutex.h"
+#include "core/templates/safe_refcount.h"
 #include "scene/main/node.h"
 
 class SceneState : public RefCounted {
@@ -87,6 +89,31 @@ class SceneState : public RefCounted {
 
 	Vector<ConnectionData> connections;
 
+	// What instantiate() resolves the same way for every instance, built when
+	// first instantiated outside the editor and reused until the state changes.
+	struct InstancePlan {
+		struct PropertyPlan {
+			// Set when the property can skip Object::set(), for nodes without scripts.
+			const ClassDB::PropertySetGet *setget = nullptr;
+			bool is_script = false;
+		};
+
+		struct NodePlan {
+			ClassDB::CreationFunc creation_func = nullptr;
+			Vector<PropertyPlan> properties;
+		};
+
+		Vector<NodePlan> nodes;
+		Vector<Vector<Variant>> connection_binds;
+	};
+
+	mutable InstancePlan instance_plan;
+	mutable SafeFlag instance_plan_built;
+	mutable Mutex instance_plan_mutex;
+
+	const InstancePlan *_get_instance_plan() const;
+	void _clear_instance_plan();
+
 	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 
@@ -119,6 +146,10 @@ public:
 		GEN_EDIT_STATE_MAIN,
 	};
 
+private:
+	Node *_instantiate(GenEditState p_edit_state, bool p_use_plan) const;
+
+public:
 	static void set_disable_placeholders(bool p_disable);
 
 	int find_node_by_path(const NodePath &p_node) const;
@@ -138,6 +169,8 @@ public:
 
 	bool can_instantiate() const;
 	Node *instantiate(GenEditState p_edit_state) const;
+	// Reads the scene state directly, as instantiate() does without its plan. For tests and benchmarks.
+	Node *instantiate_without_plan(GenEditState p_edit_state) const;
 
 	//unbuild API
 
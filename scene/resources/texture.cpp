@@ -346,20 +346,35 @@ Ref<Image> StreamTexture2D::load_image_from_file(FileAccess *f, int p_size_limit
 				continue;
 			}
 
-			Vector<uint8_t> pv;
-			pv.resize(size);
-			{
-				uint8_t *wr = pv.ptrw();
-				f->get_buffer(wr, size);
+			Ref<Image> img;
+
+			// PNG and WebP are decoded straight from the file when it's in memory
+			// (e.g. in a mapped pack), skipping their prefix like the unpackers do.
+			ImageMemLoadFunc mem_loader = nullptr;
+			if (data_format == DATA_FORMAT_PNG) {
+				mem_loader = Image::_png_mem_loader_func;
+			} else if (data_format == DATA_FORMAT_WEBP) {
+				mem_loader = Image::_webp_mem_loader_func;
 			}
+			const uint8_t *view = (mem_loader && size > 4) ? f->get_buffer_view(size) : nullptr;
+
+			if (view) {
+				img = mem_loader(view + 4, size - 4);
+			} else {
+				Vector<uint8_t> pv;
+				pv.resize(size);
+				{
+					uint8_t *wr = pv.ptrw();
+					f->get_buffer(wr, size);
+				}
 
-			Ref<Image> img;
-			if (data_format == DATA_FORMAT_BASIS_UNIVERSAL && Image::basis_universal_unpacker) {
-				img = Image::basis_universal_unpacker(pv);
-			} else if (data_format == DATA_FORMAT_PNG && Image::png_unpacker) {
-				img = Image::png_unpacker(pv);
-			} else if (data_format == DATA_FORMAT_WEBP && Image::webp_unpacker) {
-				img = Image::webp_unpacker(pv);
+				if (data_format == DATA_FORMAT_BASIS_UNIVERSAL && Image::basis_universal_unpacker) {
+					img = Image::basis_universal_unpacker(pv);
+				} else if (data_format == DATA_FORMAT_PNG && Image::png_unpacker) {
+					img = Image::png_unpacker(pv);
+				} else if (data_format == DATA_FORMAT_WEBP && Image::webp_unpacker) {
+					img = Image::webp_unpacker(pv);
+				}
 			}
 
 			if (img.is_null() || img->is_empty()) {
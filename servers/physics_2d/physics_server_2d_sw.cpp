@@ -34,12 +34,14 @@
 #include "collision_solver_2d_sw.h"
 #include "core/config/project_settings.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/debugger/trace.h"
 #include "core/os/os.h"
 
 #define FLUSH_QUERY_CHECK(m_object) \
 	ERR_FAIL_COND_MSG(m_object->get_space() && flushing_queries, "Can't change this state while flushing queries. Use call_deferred() or set_deferred() to change monitoring state instead.");
 
 RID PhysicsServer2DSW::_shape_create(ShapeType p_shape) {
+	MemoryTagScope tag_scope(Memory::TAG_PHYSICS);
 	Shape2DSW *shape = nullptr;
 	switch (p_shape) {
 		case SHAPE_LINE: {
@@ -111,6 +113,7 @@ RID PhysicsServer2DSW::concave_polygon_shape_create() {
 }
 
 void PhysicsServer2DSW::shape_set_data(RID p_shape, const Variant &p_data) {
+	MemoryTagScope tag_scope(Memory::TAG_PHYSICS);
 	Shape2DSW *shape = shape_owner.getornull(p_shape);
 	ERR_FAIL_COND(!shape);
 	shape->set_data(p_data);
@@ -1250,6 +1253,8 @@ void PhysicsServer2DSW::init() {
 };
 
 void PhysicsServer2DSW::step(real_t p_step) {
+	TRACE_ZONE("PhysicsServer2D::step");
+	MemoryTagScope tag_scope(Memory::TAG_PHYSICS);
 	if (!active) {
 		return;
 	}
@@ -31,6 +31,7 @@
 #include "step_2d_sw.h"
 
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 
 #define BODY_ISLAND_COUNT_RESERVE 128
 #define BODY_ISLAND_SIZE_RESERVE 512
@@ -234,7 +235,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	/* SETUP CONSTRAINTS / PROCESS COLLISIONS */
 
 	uint32_t total_contraint_count = all_constraints.size();
-	work_pool.do_work(total_contraint_count, this, &Step2DSW::_setup_contraint, nullptr);
+	WorkerThreadPool::get_singleton()->do_work(total_contraint_count, this, &Step2DSW::_setup_contraint, nullptr);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -254,7 +255,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	// Warning: _solve_island modifies the constraint islands for optimization purpose,
 	// their content is not reliable after these calls and shouldn't be used anymore.
 	if (island_count > 1) {
-		work_pool.do_work(island_count, this, &Step2DSW::_solve_island, nullptr);
+		WorkerThreadPool::get_singleton()->do_work(island_count, this, &Step2DSW::_solve_island, nullptr);
 	} else if (island_count > 0) {
 		_solve_island(0);
 	}
@@ -299,10 +300,7 @@ Step2DSW::Step2DSW() {
 	body_islands.reserve(BODY_ISLAND_COUNT_RESERVE);
 	constraint_islands.reserve(ISLAND_COUNT_RESERVE);
 	all_constraints.reserve(CONSTRAINT_COUNT_RESERVE);
-
-	work_pool.init();
 }
 
 Step2DSW::~Step2DSW() {
-	work_pool.finish();
 }
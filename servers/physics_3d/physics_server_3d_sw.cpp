@@ -32,6 +32,7 @@
 
 #include "broad_phase_3d_bvh.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/debugger/trace.h"
 #include "core/os/os.h"
 #include "joints/cone_twist_joint_3d_sw.h"
 #include "joints/generic_6dof_joint_3d_sw.h"
@@ -43,55 +44,55 @@
 	ERR_FAIL_COND_MSG(m_object->get_space() && flushing_queries, "Can't change this state while flushing queries. Use call_deferred() or set_deferred() to change monitoring state instead.");
 
 RID PhysicsServer3DSW::plane_shape_create() {
-	Shape3DSW *shape = memnew(PlaneShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, PlaneShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::ray_shape_create() {
-	Shape3DSW *shape = memnew(RayShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, RayShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::sphere_shape_create() {
-	Shape3DSW *shape = memnew(SphereShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, SphereShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::box_shape_create() {
-	Shape3DSW *shape = memnew(BoxShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, BoxShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::capsule_shape_create() {
-	Shape3DSW *shape = memnew(CapsuleShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, CapsuleShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::cylinder_shape_create() {
-	Shape3DSW *shape = memnew(CylinderShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, CylinderShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::convex_polygon_shape_create() {
-	Shape3DSW *shape = memnew(ConvexPolygonShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, ConvexPolygonShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::concave_polygon_shape_create() {
-	Shape3DSW *shape = memnew(ConcavePolygonShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, ConcavePolygonShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
 }
 RID PhysicsServer3DSW::heightmap_shape_create() {
-	Shape3DSW *shape = memnew(HeightMapShape3DSW);
+	Shape3DSW *shape = memnew_tagged(Memory::TAG_PHYSICS, HeightMapShape3DSW);
 	RID rid = shape_owner.make_rid(shape);
 	shape->set_self(rid);
 	return rid;
@@ -101,6 +102,7 @@ RID PhysicsServer3DSW::custom_shape_create() {
 }
 
 void PhysicsServer3DSW::shape_set_data(RID p_shape, const Variant &p_data) {
+	MemoryTagScope tag_scope(Memory::TAG_PHYSICS);
 	Shape3DSW *shape = shape_owner.getornull(p_shape);
 	ERR_FAIL_COND(!shape);
 	shape->set_data(p_data);
@@ -1596,6 +1598,8 @@ void PhysicsServer3DSW::init() {
 };
 
 void PhysicsServer3DSW::step(real_t p_step) {
+	TRACE_ZONE("PhysicsServer3D::step");
+	MemoryTagScope tag_scope(Memory::TAG_PHYSICS);
 #ifndef _3D_DISABLED
 
 	if (!active) {
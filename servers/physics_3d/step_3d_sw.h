@@ -33,8 +33,8 @@
 
 #include "space_3d_sw.h"
 
+#include "core/os/frame_allocator.h"
 #include "core/templates/local_vector.h"
-#include "core/templates/thread_work_pool.h"
 
 class Step3DSW {
 	uint64_t _step;
@@ -42,18 +42,20 @@ class Step3DSW {
 	int iterations = 0;
 	real_t delta = 0.0;
 
-	ThreadWorkPool work_pool;
+	// Islands are rebuilt every step, so their contents live in the frame arena.
+	typedef LocalVector<Body3DSW *, uint32_t, false, FrameAllocator> BodyIsland;
+	typedef LocalVector<Constraint3DSW *, uint32_t, false, FrameAllocator> ConstraintIsland;
 
-	LocalVector<LocalVector<Body3DSW *>> body_islands;
-	LocalVector<LocalVector<Constraint3DSW *>> constraint_islands;
+	LocalVector<BodyIsland> body_islands;
+	LocalVector<ConstraintIsland> constraint_islands;
 	LocalVector<Constraint3DSW *> all_constraints;
 
-	void _populate_island(Body3DSW *p_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island);
-	void _populate_island_soft_body(SoftBody3DSW *p_soft_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island);
+	void _populate_island(Body3DSW *p_body, BodyIsland &p_body_island, ConstraintIsland &p_constraint_island);
+	void _populate_island_soft_body(SoftBody3DSW *p_soft_body, BodyIsland &p_body_island, ConstraintIsland &p_constraint_island);
 	void _setup_contraint(uint32_t p_constraint_index, void *p_userdata = nullptr);
-	void _pre_solve_island(LocalVector<Constraint3DSW *> &p_constraint_island) const;
+	void _pre_solve_island(ConstraintIsland &p_constraint_island) const;
 	void _solve_island(uint32_t p_island_index, void *p_userdata = nullptr);
-	void _check_suspend(const LocalVector<Body3DSW *> &p_body_island) const;
+	void _check_suspend(const BodyIsland &p_body_island) const;
 
 public:
 	void step(Space3DSW *p_space, real_t p_delta, int p_iterations);
@@ -31,6 +31,7 @@
 #include "rendering_server_default.h"
 
 #include "core/config/project_settings.h"
+#include "core/debugger/trace.h"
 #include "core/io/marshalls.h"
 #include "core/os/os.h"
 #include "core/templates/sort_array.h"
@@ -72,6 +73,8 @@ void RenderingServerDefault::request_frame_drawn_callback(Object *p_where, const
 }
 
 void RenderingServerDefault::_draw(bool p_swap_buffers, double frame_step) {
+	TRACE_ZONE("RenderingServer::draw");
+	MemoryTagScope tag_scope(Memory::TAG_RENDERING);
 	//needs to be done before changes is reset to 0, to not force the editor to redraw
 	RS::get_singleton()->emit_signal(SNAME("frame_pre_draw"));
 
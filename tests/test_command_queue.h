@@ -426,6 +426,74 @@ TEST_CASE("[Stress][CommandQueue] Stress test command queue") {
 	ProjectSettings::get_singleton()->set_setting(COMMAND_QUEUE_SETTING,
 			ProjectSettings::get_singleton()->property_get_revert(COMMAND_QUEUE_SETTING));
 }
+
+struct ThroughputState {
+	enum {
+		PRODUCERS = 2
+	};
+	CommandQueueMT command_queue = CommandQueueMT(true);
+	uint64_t transform_count = 0;
+	int commands_per_frame = 0;
+	int frames = 0;
+
+	void set_transform(Transform3D p_transform) {
+		transform_count++;
+	}
+
+	uint64_t get_total() const {
+		return uint64_t(PRODUCERS) * frames * (commands_per_frame + 1);
+	}
+
+	static void producer(void *p_state) {
+		ThroughputState *state = static_cast<ThroughputState *>(p_state);
+		Transform3D tr;
+		for (int frame = 0; frame < state->frames; frame++) {
+			for (int i = 0; i < state->commands_per_frame; i++) {
+				state->command_queue.push(state, &ThroughputState::set_transform, tr);
+			}
+			// Same as a frame ending on the main thread.
+			state->command_queue.push_and_sync(state, &ThroughputState::set_transform, tr);
+		}
+	}
+};
+
+// Returns the elapsed time, pushing from several producers while flushing on this thread.
+static uint64_t run_throughput(ThroughputState &p_state) {
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	Thread producers[ThroughputState::PRODUCERS];
+	for (int i = 0; i < ThroughputState::PRODUCERS; i++) {
+		producers[i].start(&ThroughputState::producer, &p_state);
+	}
+	while (p_state.command_queue.get_flushed_command_count() < p_state.get_total()) {
+		p_state.command_queue.wait_and_flush();
+	}
+	for (int i = 0; i < ThroughputState::PRODUCERS; i++) {
+		producers[i].wait_to_finish();
+	}
+	return MAX(OS::get_singleton()->get_ticks_usec() - begin, (uint64_t)1);
+}
+
+TEST_CASE("[CommandQueue] Concurrent producers") {
+	ThroughputState state;
+	state.commands_per_frame = 2000;
+	state.frames = 10;
+	run_throughput(state);
+
+	CHECK_MESSAGE(state.transform_count == state.get_total(),
+			"Every command pushed by every producer should run exactly once.");
+	CHECK(state.command_queue.get_flushed_command_count() == state.get_total());
+}
+
+// Measures command throughput, use with `godot --test command-queue-benchmark`.
+static void test_command_queue_benchmark() {
+	ThroughputState state;
+	state.commands_per_frame = 20000;
+	state.frames = 10;
+	uint64_t elapsed = run_throughput(state);
+	print_line(vformat("CommandQueueMT: %d commands/sec, %d usec per frame of %d commands.", state.get_total() * 1000000 / elapsed, elapsed / (ThroughputState::PRODUCERS * state.frames), state.commands_per_frame));
+}
+
+REGISTER_TEST_COMMAND("command-queue-benchmark", &test_command_queue_benchmark);
 } // namespace TestCommandQueue
 
 #endif // !defined(NO_THREADS)
@@ -0,0 +1,226 @@
+/*************************************************************************/
+/*  test_dense_ordered_hash_map.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_DENSE_ORDERED_HASH_MAP_H
+#define TEST_DENSE_ORDERED_HASH_MAP_H
+
+#include "core/os/os.h"
+#include "core/templates/dense_ordered_hash_map.h"
+#include "core/templates/ordered_hash_map.h"
+#include "core/templates/pair.h"
+#include "core/templates/vector.h"
+#include "core/variant/variant.h"
+
+#include "tests/test_macros.h"
+
+namespace TestDenseOrderedHashMap {
+
+TEST_CASE("[DenseOrderedHashMap] Insert element") {
+	DenseOrderedHashMap<int, int> map;
+	DenseOrderedHashMap<int, int>::Element e = map.insert(42, 84);
+
+	CHECK(e);
+	CHECK(e.key() == 42);
+	CHECK(e.get() == 84);
+	CHECK(e.value() == 84);
+	CHECK(map[42] == 84);
+	CHECK(map.has(42));
+	CHECK(map.find(42));
+}
+
+TEST_CASE("[DenseOrderedHashMap] Overwrite element") {
+	DenseOrderedHashMap<int, int> map;
+	map.insert(42, 84);
+	map.insert(42, 1234);
+
+	CHECK(map[42] == 1234);
+	CHECK(map.size() == 1);
+}
+
+TEST_CASE("[DenseOrderedHashMap] Erase") {
+	DenseOrderedHashMap<int, int> map;
+	map.insert(42, 84);
+	CHECK(map.erase(42));
+	CHECK(!map.erase(42));
+	CHECK(!map.has(42));
+	CHECK(!map.find(42));
+	CHECK(map.is_empty());
+}
+
+TEST_CASE("[DenseOrderedHashMap] Iteration order after erasing") {
+	DenseOrderedHashMap<int, int> map;
+	for (int i = 0; i < 1000; i++) {
+		map.insert(i, i * 2);
+	}
+	// Erase most of them, so holes get compacted away.
+	for (int i = 0; i < 1000; i++) {
+		if (i % 10 != 0) {
+			map.erase(i);
+		}
+	}
+	// Erased keys go back at the end when inserted again.
+	map.insert(5, 55);
+	map[0] = -1;
+
+	CHECK(map.size() == 101);
+
+	int expected = 0;
+	for (DenseOrderedHashMap<int, int>::Element E = map.front(); E; E = E.next()) {
+		if (expected < 1000) {
+			CHECK(E.key() == expected);
+			CHECK(E.value() == (expected == 0 ? -1 : expected * 2));
+			expected += 10;
+		} else {
+			CHECK(E.key() == 5);
+			CHECK(E.value() == 55);
+		}
+	}
+
+	CHECK(map.get_element_at(0).key() == 0);
+	CHECK(map.get_element_at(99).key() == 990);
+	CHECK(map.get_element_at(100).key() == 5);
+	CHECK(!map.get_element_at(101));
+}
+
+TEST_CASE("[DenseOrderedHashMap] Values are not moved") {
+	DenseOrderedHashMap<int, int> map;
+	int &value = map[1];
+	value = 10;
+
+	// Growing the map and compacting holes must not move existing values.
+	for (int i = 2; i < 500; i++) {
+		map.insert(i, i);
+	}
+	for (int i = 2; i < 500; i++) {
+		map.erase(i);
+	}
+
+	CHECK(&value == &map[1]);
+	CHECK(map[1] == 10);
+}
+
+TEST_CASE("[DenseOrderedHashMap] Copy") {
+	DenseOrderedHashMap<int, int> map;
+	map.insert(42, 84);
+	map.insert(123, 12385);
+	map.insert(0, 12934);
+	map.erase(123);
+
+	const DenseOrderedHashMap<int, int> const_map = map;
+
+	Vector<Pair<int, int>> expected;
+	expected.push_back(Pair<int, int>(42, 84));
+	expected.push_back(Pair<int, int>(0, 12934));
+
+	int idx = 0;
+	for (DenseOrderedHashMap<int, int>::ConstElement E = const_map.front(); E; E = E.next()) {
+		CHECK(expected[idx] == Pair<int, int>(E.key(), E.value()));
+		++idx;
+	}
+	CHECK(idx == 2);
+}
+
+struct MapTimes {
+	uint64_t insert = 0;
+	uint64_t lookup = 0;
+	uint64_t iterate = 0;
+	uint64_t free = 0;
+};
+
+// Times the operations a Dictionary does most, with the map type it's backed by.
+template <class M>
+static MapTimes benchmark_map(const Vector<Variant> &p_keys) {
+	MapTimes times;
+	M *map = memnew(M);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i++) {
+		map->insert(p_keys[i], i);
+	}
+	times.insert = OS::get_singleton()->get_ticks_usec() - begin;
+
+	int64_t sum = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_keys.size(); i++) {
+		sum += int64_t(map->find(p_keys[i]).value());
+	}
+	times.lookup = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (typename M::Element E = map->front(); E; E = E.next()) {
+		sum += int64_t(E.value());
+	}
+	times.iterate = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	memdelete(map);
+	times.free = OS::get_singleton()->get_ticks_usec() - begin;
+
+	// Using the values keeps the loops from being optimized out, both passes add every value once.
+	ERR_FAIL_COND_V_MSG(sum != int64_t(p_keys.size()) * (p_keys.size() - 1), times, "The map returned wrong values.");
+	return times;
+}
+
+static void print_map_times(const char *p_what, uint64_t p_old, uint64_t p_new) {
+	print_line(vformat("  %s: %d usec OrderedHashMap, %d usec DenseOrderedHashMap (%.2fx)", p_what, p_old, p_new, double(p_old) / MAX(p_new, (uint64_t)1)));
+}
+
+static void benchmark_dictionary_keys(const char *p_what, const Vector<Variant> &p_keys) {
+	MapTimes old_times = benchmark_map<OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>>(p_keys);
+	MapTimes new_times = benchmark_map<DenseOrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>>(p_keys);
+
+	print_line(vformat("%d %s keys:", p_keys.size(), p_what));
+	print_map_times("insert", old_times.insert, new_times.insert);
+	print_map_times("lookup", old_times.lookup, new_times.lookup);
+	print_map_times("iterate", old_times.iterate, new_times.iterate);
+	print_map_times("free", old_times.free, new_times.free);
+}
+
+// Compares the map behind Dictionary with the one it used before, use with `godot --test dictionary-benchmark`.
+static void test_dictionary_benchmark() {
+	const int key_count = 50000;
+
+	Vector<Variant> keys;
+	for (int i = 0; i < key_count; i++) {
+		keys.push_back(vformat("key_%d", i));
+	}
+	benchmark_dictionary_keys("String", keys);
+
+	keys.clear();
+	for (int i = 0; i < key_count; i++) {
+		keys.push_back(i * 7);
+	}
+	benchmark_dictionary_keys("int", keys);
+}
+
+REGISTER_TEST_COMMAND("dictionary-benchmark", &test_dictionary_benchmark);
+} // namespace TestDenseOrderedHashMap
+
+#endif // TEST_DENSE_ORDERED_HASH_MAP_H
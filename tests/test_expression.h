@@ -32,6 +32,9 @@
 #define TEST_EXPRESSION_H
 
 #include "core/math/expression.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/templates/safe_refcount.h"
 
 #include "tests/test_macros.h"
 
@@ -439,6 +442,183 @@ TEST_CASE("[Expression] Unusual expressions") {
 	//		int64_t(expression.execute()) == 0,
 	//		"`(-9223372036854775807 - 1) / -1` should return the expected result.");
 }
+
+// Runs an expression with both the byte code and the node tree, which must agree.
+static Variant execute_both(const String &p_expression, const Vector<String> &p_input_names = Vector<String>(), const Array &p_inputs = Array(), Object *p_base = nullptr) {
+	Expression expression;
+	if (expression.parse(p_expression, p_input_names) != OK) {
+		return Variant();
+	}
+	Variant tree_result = expression.execute_node_tree(p_inputs, p_base, false);
+	bool tree_failed = expression.has_execute_failed();
+	String tree_error = expression.get_error_text();
+
+	// Twice, so the second run goes through the cached operator evaluators.
+	Variant first_result = expression.execute(p_inputs, p_base, false);
+	Variant bytecode_result = expression.execute(p_inputs, p_base, false);
+	bool bytecode_failed = expression.has_execute_failed();
+	String bytecode_error = expression.get_error_text();
+
+	CHECK_MESSAGE(first_result.get_construct_string() == bytecode_result.get_construct_string(), p_expression);
+	CHECK_MESSAGE(tree_result.get_construct_string() == bytecode_result.get_construct_string(), p_expression);
+	CHECK_MESSAGE(tree_failed == bytecode_failed, p_expression);
+	CHECK_MESSAGE(tree_error == bytecode_error, p_expression);
+	return bytecode_result;
+}
+
+TEST_CASE("[Expression] Byte code matches the node tree") {
+	CHECK(int(execute_both("1 + 2 * 3")) == 7);
+	CHECK(Math::is_equal_approx(double(execute_both("sin(PI / 2) + sqrt(16.0)")), 5.0));
+	CHECK(double(execute_both("abs(-2.5) * 2 + floor(0.5)")) == 5.0);
+	CHECK(String(execute_both("\"abc\" + str(1.5)")) == "abc1.5");
+	CHECK(Array(execute_both("[1, \"two\", [3]]")).size() == 3);
+	CHECK(Dictionary(execute_both("{\"a\": 1, 2: [3]}")).size() == 2);
+	CHECK(String(execute_both("\"abc\".to_upper().substr(1)")) == "BC");
+	CHECK(bool(execute_both("not (1 < 2 and 3 >= 4)")));
+	CHECK(int(execute_both("-(5 % 3) * 2 + (6 & 3)")) == -2);
+
+	Vector<String> names;
+	names.push_back("a");
+	names.push_back("b");
+	Array inputs;
+	inputs.push_back(6);
+	inputs.push_back(Vector2(1, 2));
+	CHECK(Vector2(execute_both("b * a + b", names, inputs)) == Vector2(7, 14));
+
+	// Mixed types reach the same operator, the cached evaluator must not be reused.
+	inputs[0] = 1.5;
+	CHECK(Vector2(execute_both("b * a + b", names, inputs)) == Vector2(2.5, 5));
+
+	// Calls must not modify the inputs they are made on.
+	Array values;
+	values.push_back(3);
+	inputs[0] = values;
+	CHECK(int(execute_both("a.size() + a.back()", names, inputs)) == 4);
+
+	Ref<RefCounted> instance;
+	instance.instantiate();
+	CHECK(String(execute_both("get_class()", Vector<String>(), Array(), instance.ptr())) == "RefCounted");
+}
+
+TEST_CASE("[Expression] Byte code errors match the node tree") {
+	ERR_PRINT_OFF;
+	execute_both("1 / 0");
+	execute_both("5 % 0");
+	execute_both("1 << -1");
+	execute_both("[1, 2][5]");
+	execute_both("{1: 2}.w");
+	execute_both("sqrt([])");
+	execute_both("\"abc\".no_such_method()");
+	execute_both("1 + \"a\"");
+	execute_both("get_class()");
+
+	Vector<String> names;
+	names.push_back("a");
+	names.push_back("b");
+	Array inputs;
+	inputs.push_back(1);
+	execute_both("a + b", names, inputs);
+	ERR_PRINT_ON;
+}
+
+TEST_CASE("[Expression] Byte code keeps results independent") {
+	Expression expression;
+	CHECK(expression.parse("[1, 2]") == OK);
+	Array first = expression.execute();
+	first.push_back(3);
+	Array second = expression.execute();
+	CHECK_MESSAGE(second.size() == 2, "Containers in the result must not be shared between executions.");
+
+	// Deeper than the temporaries the byte code can hold. The input prevents
+	// constant folding, so this really runs through the node tree fallback.
+	String deep = "x";
+	for (int i = 0; i < 1200; i++) {
+		deep = "(" + deep + " + 1)";
+	}
+	Vector<String> names;
+	names.push_back("x");
+	Array inputs;
+	inputs.push_back(5);
+	CHECK(expression.parse(deep, names) == OK);
+	CHECK(int(expression.execute(inputs)) == 1205);
+	inputs[0] = 0.5;
+	CHECK(double(expression.execute(inputs)) == 1200.5);
+}
+
+struct SharedExpression {
+	Expression expression;
+	SafeNumeric<uint32_t> mismatches;
+
+	void execute(uint32_t p_index, void *p_userdata) {
+		// Operand types alternate, so threads keep replacing the cached operator evaluators.
+		Array inputs;
+		if (p_index % 2) {
+			inputs.push_back(int64_t(p_index));
+		} else {
+			inputs.push_back(p_index + 0.5);
+		}
+		for (int i = 0; i < 100; i++) {
+			Variant result;
+			String error;
+			if (!expression.try_execute(inputs, nullptr, result, error) || double(result) != double(inputs[0]) * 2 + 1) {
+				mismatches.increment();
+			}
+		}
+	}
+};
+
+TEST_CASE("[Expression] Byte code executed from several threads") {
+	SharedExpression data;
+	Vector<String> names;
+	names.push_back("x");
+	REQUIRE(data.expression.parse("x * 2 + 1", names) == OK);
+
+	WorkerThreadPool::get_singleton()->do_work(64, &data, &SharedExpression::execute, nullptr);
+	CHECK(data.mismatches.get() == 0);
+
+	Variant result;
+	String error;
+	CHECK_MESSAGE(!data.expression.try_execute(Array(), nullptr, result, error), "Missing inputs should fail.");
+	CHECK_MESSAGE(!data.expression.has_execute_failed(), "Errors returned by try_execute() shouldn't be recorded.");
+}
+
+static void benchmark_expression(const String &p_expression, const Vector<String> &p_input_names, const Array &p_inputs, int p_iterations) {
+	Expression expression;
+	ERR_FAIL_COND(expression.parse(p_expression, p_input_names) != OK);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		expression.execute_node_tree(p_inputs);
+	}
+	uint64_t tree_elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		expression.execute(p_inputs);
+	}
+	uint64_t bytecode_elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+	print_line(vformat("%s: node tree %d usec, byte code %d usec", p_expression, tree_elapsed, bytecode_elapsed));
+}
+
+// Compares the byte code against the node tree, use with `godot --test expression-benchmark`.
+static void test_expression_benchmark() {
+	const int iterations = 200000;
+
+	Vector<String> names;
+	names.push_back("x");
+	names.push_back("y");
+	Array inputs;
+	inputs.push_back(3);
+	inputs.push_back(4.5);
+
+	benchmark_expression("x * x + y * 2 - x / 3", names, inputs, iterations);
+	benchmark_expression("x * (2 * PI) + sin(y) * cos(1.0)", names, inputs, iterations);
+	benchmark_expression("abs(x - y) > 1 and x != 0 or y < 0", names, inputs, iterations);
+	benchmark_expression("str(x) + \"/\" + str(y)", names, inputs, iterations);
+}
+
+REGISTER_TEST_COMMAND("expression-benchmark", &test_expression_benchmark);
 } // namespace TestExpression
 
 #endif // TEST_EXPRESSION_H
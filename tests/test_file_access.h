@@ -32,6 +32,8 @@
 #define TEST_FILE_ACCESS_H
 
 #include "core/io/file_access.h"
+#include "core/io/file_access_compressed.h"
+#include "core/os/os.h"
 #include "test_utils.h"
 
 namespace TestFileAccess {
@@ -60,6 +62,76 @@ TEST_CASE("[FileAccess] CSV read") {
 	f->close();
 	memdelete(f);
 }
+
+TEST_CASE("[FileAccess] Compressed file read and seek across blocks") {
+	const String path = OS::get_singleton()->get_cache_path().plus_file("file_access_compressed.bin");
+	// Small blocks, so the reads span several read-ahead windows; the size is not a multiple of the block size.
+	const uint32_t block_size = 4096;
+	Vector<uint8_t> data;
+	data.resize(block_size * 37 + 123);
+	for (int i = 0; i < data.size(); i++) {
+		data.write[i] = (i * 7 + i / 251) & 0xFF;
+	}
+
+	FileAccessCompressed *fw = memnew(FileAccessCompressed);
+	fw->configure("TEST", Compression::MODE_ZSTD, block_size);
+	REQUIRE(fw->_open(path, FileAccess::WRITE) == OK);
+	fw->store_buffer(data.ptr(), data.size());
+	fw->close();
+	memdelete(fw);
+
+	FileAccessCompressed *fr = memnew(FileAccessCompressed);
+	fr->configure("TEST");
+	REQUIRE(fr->_open(path, FileAccess::READ) == OK);
+	CHECK(fr->get_length() == (uint64_t)data.size());
+
+	Vector<uint8_t> read;
+	read.resize(data.size());
+	CHECK(fr->get_buffer(read.ptrw(), 1000) == 1000);
+	CHECK(fr->get_8() == data[1000]);
+	CHECK(fr->get_buffer(read.ptrw() + 1001, data.size() - 1001) == (uint64_t)data.size() - 1001);
+	read.write[1000] = data[1000];
+	CHECK_MESSAGE(read == data, "Sequential reads should return the written data.");
+	CHECK(!fr->eof_reached());
+	CHECK(fr->get_buffer(read.ptrw(), 1) == 0);
+	CHECK(fr->eof_reached());
+
+	// Seeking backwards and forwards, both inside and outside the decompressed window.
+	const uint64_t positions[] = { 5, (uint64_t)data.size() - 10, block_size * 3 - 2, block_size * 20, block_size * 2 + 7 };
+	for (uint64_t position : positions) {
+		fr->seek(position);
+		CHECK(fr->get_position() == position);
+		uint8_t bytes[8] = {};
+		uint64_t count = MIN((uint64_t)8, data.size() - position);
+		CHECK(fr->get_buffer(bytes, count) == count);
+		CHECK(memcmp(bytes, data.ptr() + position, count) == 0);
+	}
+
+	// Reading on after a seek widens the window again.
+	const uint64_t from = block_size * 5 + 3;
+	fr->seek(from);
+	CHECK(fr->get_buffer(read.ptrw(), data.size() - from) == data.size() - from);
+	CHECK(memcmp(read.ptr(), data.ptr() + from, data.size() - from) == 0);
+	fr->close();
+	memdelete(fr);
+
+	// Files whose size is an exact multiple of the block size end with an empty block.
+	fw = memnew(FileAccessCompressed);
+	fw->configure("TEST", Compression::MODE_FASTLZ, block_size);
+	REQUIRE(fw->_open(path, FileAccess::WRITE) == OK);
+	fw->store_buffer(data.ptr(), block_size * 2);
+	fw->close();
+	memdelete(fw);
+
+	fr = memnew(FileAccessCompressed);
+	fr->configure("TEST");
+	REQUIRE(fr->_open(path, FileAccess::READ) == OK);
+	CHECK(fr->get_buffer(read.ptrw(), data.size()) == block_size * 2);
+	CHECK(memcmp(read.ptr(), data.ptr(), block_size * 2) == 0);
+	CHECK(fr->eof_reached());
+	fr->close();
+	memdelete(fr);
+}
 } // namespace TestFileAccess
 
 #endif // TEST_FILE_ACCESS_H
@@ -1,5 +1,5 @@
 /*************************************************************************/
-/*  threaded_array_processor.h                                           */
+/*  test_frame_allocator.h                                               */
 /*************************************************************************/
 /*                       This file is part of:                           */
 /*                           GODOT ENGINE                                */
@@ -28,80 +28,79 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 
-#ifndef THREADED_ARRAY_PROCESSOR_H
-#define THREADED_ARRAY_PROCESSOR_H
-
-#include "core/os/mutex.h"
-#include "core/os/os.h"
-#include "core/os/thread.h"
-#include "core/os/thread_safe.h"
-#include "core/templates/safe_refcount.h"
-
-template <class C, class U>
-struct ThreadArrayProcessData {
-	uint32_t elements;
-	SafeNumeric<uint32_t> index;
-	C *instance;
-	U userdata;
-	void (C::*method)(uint32_t, U);
-
-	void process(uint32_t p_index) {
-		(instance->*method)(p_index, userdata);
-	}
-};
+#ifndef TEST_FRAME_ALLOCATOR_H
+#define TEST_FRAME_ALLOCATOR_H
 
-#ifndef NO_THREADS
+#include "core/os/frame_allocator.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 
-template <class T>
-void process_array_thread(void *ud) {
-	T &data = *(T *)ud;
-	while (true) {
-		uint32_t index = data.index.increment();
-		if (index >= data.elements) {
-			break;
-		}
-		data.process(index);
-	}
-}
+#include "tests/test_macros.h"
 
-template <class C, class M, class U>
-void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-	ThreadArrayProcessData<C, U> data;
-	data.method = p_method;
-	data.instance = p_instance;
-	data.userdata = p_userdata;
-	data.index.set(0);
-	data.elements = p_elements;
-	data.process(0); //process first, let threads increment for next
-
-	int thread_count = OS::get_singleton()->get_processor_count();
-	Thread *threads = memnew_arr(Thread, thread_count);
-
-	for (int i = 0; i < thread_count; i++) {
-		threads[i].start(process_array_thread<ThreadArrayProcessData<C, U>>, &data);
-	}
+namespace TestFrameAllocator {
 
-	for (int i = 0; i < thread_count; i++) {
-		threads[i].wait_to_finish();
-	}
-	memdelete_arr(threads);
+TEST_CASE("[ArenaAllocator] Allocation, reallocation and rewinding") {
+	ArenaAllocator arena;
+	arena.set_chunk_size(256);
+
+	uint8_t *a = (uint8_t *)arena.alloc(10);
+	CHECK((uintptr_t(a) % 16) == 0);
+	memset(a, 0xAB, 10);
+
+	ArenaAllocator::Marker marker = arena.get_marker();
+	size_t used = arena.get_used();
+
+	// Last allocation grows in place.
+	uint8_t *b = (uint8_t *)arena.alloc(16);
+	CHECK(arena.realloc(b, 64) == b);
+
+	// Otherwise it moves and keeps its contents.
+	uint8_t *a2 = (uint8_t *)arena.realloc(a, 100);
+	CHECK(a2 != a);
+	CHECK(a2[0] == 0xAB);
+	CHECK(a2[9] == 0xAB);
+
+	// Larger than a chunk.
+	void *big = arena.alloc(1000);
+	CHECK(big != nullptr);
+
+	arena.rewind(marker);
+	CHECK(arena.get_used() == used);
+	CHECK(a[9] == 0xAB);
+
+	arena.reset();
+	CHECK(arena.get_used() == 0);
 }
 
-#else
-
-template <class C, class M, class U>
-void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-	ThreadArrayProcessData<C, U> data;
-	data.method = p_method;
-	data.instance = p_instance;
-	data.userdata = p_userdata;
-	data.index.set(0);
-	data.elements = p_elements;
-	for (uint32_t i = 0; i < p_elements; i++) {
-		data.process(i);
+TEST_CASE("[FrameAllocator] Containers") {
+	size_t used = FrameAllocator::get_thread_arena().get_used();
+	{
+		FrameAllocatorScope scope;
+
+		LocalVector<int, uint32_t, false, FrameAllocator> vector;
+		for (int i = 0; i < 1000; i++) {
+			vector.push_back(i);
+		}
+		int sum = 0;
+		for (uint32_t i = 0; i < vector.size(); i++) {
+			sum += vector[i];
+		}
+		CHECK(sum == 999 * 1000 / 2);
+
+		HashMap<int, int, HashMapHasherDefault, HashMapComparatorDefault<int>, 3, 8, FrameAllocator> map;
+		for (int i = 0; i < 1000; i++) {
+			map.set(i, i * 2);
+		}
+		map.erase(10);
+		CHECK(map.size() == 999);
+		CHECK(map.getptr(10) == nullptr);
+		CHECK(*map.getptr(500) == 1000);
+
+		CHECK(FrameAllocator::get_thread_arena().get_used() > used);
 	}
+	CHECK(FrameAllocator::get_thread_arena().get_used() == used);
 }
 
-#endif
+} // namespace TestFrameAllocator
 
-#endif // THREADED_ARRAY_PROCESSOR_H
+#endif // TEST_FRAME_ALLOCATOR_H
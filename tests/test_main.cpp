@@ -42,9 +42,11 @@
 #include "test_config_file.h"
 #include "test_crypto.h"
 #include "test_curve.h"
+#include "test_dense_ordered_hash_map.h"
 #include "test_dictionary.h"
 #include "test_expression.h"
 #include "test_file_access.h"
+#include "test_frame_allocator.h"
 #include "test_geometry_2d.h"
 #include "test_geometry_3d.h"
 #include "test_gradient.h"
@@ -57,11 +59,15 @@
 #include "test_lru.h"
 #include "test_marshalls.h"
 #include "test_math.h"
+#include "test_memory.h"
+#include "test_message_queue.h"
 #include "test_method_bind.h"
 #include "test_node_path.h"
 #include "test_oa_hash_map.h"
 #include "test_object.h"
 #include "test_ordered_hash_map.h"
+#include "test_packed_array_math.h"
+#include "test_packed_scene.h"
 #include "test_paged_array.h"
 #include "test_path_3d.h"
 #include "test_pck_packer.h"
@@ -71,14 +77,20 @@
 #include "test_rect2.h"
 #include "test_render.h"
 #include "test_resource.h"
+#include "test_rid.h"
+#include "test_sampling_profiler.h"
+#include "test_scene_tree.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_string_name.h"
 #include "test_text_server.h"
 #include "test_time.h"
+#include "test_trace.h"
 #include "test_translation.h"
 #include "test_validate_testing.h"
 #include "test_variant.h"
 #include "test_vector.h"
+#include "test_worker_thread_pool.h"
 #include "test_xml_parser.h"
 
 #include "modules/modules_tests.gen.h"
@@ -0,0 +1,109 @@
+/*************************************************************************/
+/*  test_memory.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MEMORY_H
+#define TEST_MEMORY_H
+
+#include "core/os/memory.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMemory {
+
+#ifdef DEBUG_ENABLED
+
+TEST_CASE("[Memory] Tagged allocations are accounted to their tag") {
+	uint64_t usage = Memory::get_tag_usage(Memory::TAG_IMAGE);
+	uint64_t count = Memory::get_tag_allocation_count(Memory::TAG_IMAGE);
+
+	void *mem = memalloc_tagged(Memory::TAG_IMAGE, 1000);
+	CHECK(Memory::get_current_tag() == Memory::TAG_DEFAULT);
+	CHECK(Memory::get_tag_usage(Memory::TAG_IMAGE) == usage + 1000);
+	CHECK(Memory::get_tag_allocation_count(Memory::TAG_IMAGE) == count + 1);
+
+	// Reallocating keeps the original tag, whatever the current one is.
+	mem = memrealloc(mem, 3000);
+	CHECK(Memory::get_tag_usage(Memory::TAG_IMAGE) == usage + 3000);
+	mem = memrealloc(mem, 500);
+	CHECK(Memory::get_tag_usage(Memory::TAG_IMAGE) == usage + 500);
+
+	memfree(mem);
+	CHECK(Memory::get_tag_usage(Memory::TAG_IMAGE) == usage);
+	CHECK(Memory::get_tag_allocation_count(Memory::TAG_IMAGE) == count + 1);
+}
+
+TEST_CASE("[Memory] Tag scopes nest") {
+	{
+		MemoryTagScope outer(Memory::TAG_SCRIPT);
+		CHECK(Memory::get_current_tag() == Memory::TAG_SCRIPT);
+		{
+			MemoryTagScope inner(Memory::TAG_VARIANT);
+			CHECK(Memory::get_current_tag() == Memory::TAG_VARIANT);
+		}
+		CHECK(Memory::get_current_tag() == Memory::TAG_SCRIPT);
+	}
+	CHECK(Memory::get_current_tag() == Memory::TAG_DEFAULT);
+}
+
+static uint32_t sample_calls = 0;
+static size_t sampled_bytes = 0;
+
+static void sample_allocation(size_t p_bytes, Memory::Tag p_tag) {
+	if (p_tag == Memory::TAG_PHYSICS) {
+		sample_calls++;
+		sampled_bytes += p_bytes;
+		// Allocating from the sampler must not recurse.
+		memfree(memalloc(16));
+	}
+}
+
+TEST_CASE("[Memory] Allocation sampling") {
+	sample_calls = 0;
+	sampled_bytes = 0;
+	Memory::set_allocation_sampling(sample_allocation, 4);
+
+	void *mem[8];
+	for (int i = 0; i < 8; i++) {
+		mem[i] = memalloc_tagged(Memory::TAG_PHYSICS, 100);
+	}
+	Memory::set_allocation_sampling(nullptr, 0);
+	for (int i = 0; i < 8; i++) {
+		memfree(mem[i]);
+	}
+
+	CHECK(sample_calls == 2);
+	CHECK(sampled_bytes == 200);
+}
+
+#endif // DEBUG_ENABLED
+
+} // namespace TestMemory
+
+#endif // TEST_MEMORY_H
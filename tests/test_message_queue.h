@@ -0,0 +1,105 @@
+/*************************************************************************/
+/*  test_message_queue.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESSAGE_QUEUE_H
+#define TEST_MESSAGE_QUEUE_H
+
+#include "core/object/message_queue.h"
+#include "core/os/worker_thread_pool.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMessageQueue {
+
+struct PushData {
+	Object *target = nullptr;
+	int calls_per_thread = 0;
+
+	void push(uint32_t p_index, void *p_userdata) {
+		for (int i = 0; i < calls_per_thread; i++) {
+			MessageQueue::get_singleton()->push_call(target, "set_meta", "item_" + itos(p_index) + "_" + itos(i), i);
+			// Calls from the same thread keep their order, so the last one wins.
+			MessageQueue::get_singleton()->push_call(target, "set_meta", "last_" + itos(p_index), i);
+		}
+	}
+};
+
+TEST_CASE("[MessageQueue] Calls pushed from several threads") {
+	MessageQueue *own_queue = MessageQueue::get_singleton() ? nullptr : memnew(MessageQueue);
+	// Flush anything queued by previous tests.
+	MessageQueue::get_singleton()->flush();
+
+	Object *target = memnew(Object);
+	PushData data;
+	data.target = target;
+	// Enough calls to span several pages.
+	data.calls_per_thread = 2000;
+
+	WorkerThreadPool::get_singleton()->do_work(8, &data, &PushData::push, nullptr);
+	MessageQueue::get_singleton()->flush();
+
+	int missing = 0;
+	for (int i = 0; i < 8; i++) {
+		for (int j = 0; j < data.calls_per_thread; j++) {
+			String key = "item_" + itos(i) + "_" + itos(j);
+			if (!target->has_meta(key) || int(target->get_meta(key)) != j) {
+				missing++;
+			}
+		}
+		String key = "last_" + itos(i);
+		CHECK_MESSAGE((target->has_meta(key) && int(target->get_meta(key)) == data.calls_per_thread - 1), "Calls from a thread should be processed in order.");
+	}
+	CHECK_MESSAGE(missing == 0, "Every call should have been processed.");
+
+	memdelete(target);
+	if (own_queue) {
+		memdelete(own_queue);
+	}
+}
+
+TEST_CASE("[MessageQueue] Calls pushed while flushing") {
+	MessageQueue *own_queue = MessageQueue::get_singleton() ? nullptr : memnew(MessageQueue);
+
+	Object *target = memnew(Object);
+	// The deferred call defers another call, which runs in the same flush.
+	MessageQueue::get_singleton()->push_call(target, "call_deferred", "set_meta", "reentrant", true);
+	MessageQueue::get_singleton()->flush();
+	CHECK(target->has_meta("reentrant"));
+	CHECK_FALSE(MessageQueue::get_singleton()->is_flushing());
+
+	memdelete(target);
+	if (own_queue) {
+		memdelete(own_queue);
+	}
+}
+
+} // namespace TestMessageQueue
+
+#endif // TEST_MESSAGE_QUEUE_H
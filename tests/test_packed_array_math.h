@@ -0,0 +1,182 @@
+/*************************************************************************/
+/*  test_packed_array_math.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PACKED_ARRAY_MATH_H
+#define TEST_PACKED_ARRAY_MATH_H
+
+#include "core/variant/packed_array_math.h"
+#include "core/variant/variant.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPackedArrayMath {
+
+// Calls a bulk math method through Variant, like scripts do.
+static Variant call(Variant &p_array, const StringName &p_method, const Variant &p_arg1 = Variant(), const Variant &p_arg2 = Variant(), int p_argcount = 0) {
+	const Variant *args[2] = { &p_arg1, &p_arg2 };
+	Variant ret;
+	Callable::CallError ce;
+	p_array.call(p_method, args, p_argcount, ret, ce);
+	CHECK(ce.error == Callable::CallError::CALL_OK);
+	return ret;
+}
+
+TEST_CASE("[PackedArrayMath] Scalar kernels match plain loops") {
+	// Odd sizes, so both the vectorized part and the tail are exercised.
+	for (int count = 0; count < 19; count++) {
+		LocalVector<float> a;
+		LocalVector<float> b;
+		LocalVector<float> expected;
+		for (int i = 0; i < count; i++) {
+			a.push_back(i * 0.5f - 3.0f);
+			b.push_back(10.0f - i);
+		}
+
+		LocalVector<float> values = a;
+		PackedArrayMath::add(values.ptr(), 2.0f, count);
+		PackedArrayMath::multiply_array(values.ptr(), b.ptr(), count);
+		PackedArrayMath::clamp(values.ptr(), -4.0f, 12.0f, count);
+		PackedArrayMath::lerp_array(values.ptr(), b.ptr(), 0.5f, count);
+
+		double sum = 0;
+		double dot = 0;
+		for (int i = 0; i < count; i++) {
+			float value = CLAMP((a[i] + 2.0f) * b[i], -4.0f, 12.0f);
+			value = value + (b[i] - value) * 0.5f;
+			CHECK(values[i] == doctest::Approx(value));
+			sum += a[i];
+			dot += a[i] * b[i];
+		}
+		CHECK(PackedArrayMath::sum(a.ptr(), count) == doctest::Approx(sum));
+		CHECK(PackedArrayMath::dot(a.ptr(), b.ptr(), count) == doctest::Approx(dot));
+		if (count > 0) {
+			CHECK(PackedArrayMath::min(a.ptr(), count) == -3.0f);
+			CHECK(PackedArrayMath::max(a.ptr(), count) == (count - 1) * 0.5f - 3.0f);
+			CHECK(PackedArrayMath::min(b.ptr(), count) == 10.0f - (count - 1));
+			CHECK(PackedArrayMath::max(b.ptr(), count) == 10.0f);
+		}
+	}
+}
+
+TEST_CASE("[PackedArrayMath] Float reductions keep double precision") {
+	// A float accumulator stops growing long before reaching the sum of these.
+	const int count = 1 << 22;
+	LocalVector<float> values;
+	values.resize(count);
+	double expected = 0;
+	for (int i = 0; i < count; i++) {
+		values[i] = 0.1f;
+		expected += 0.1f;
+	}
+	CHECK(PackedArrayMath::sum(values.ptr(), count) == doctest::Approx(expected).epsilon(1e-9));
+	CHECK(PackedArrayMath::dot(values.ptr(), values.ptr(), count) == doctest::Approx(expected * 0.1f).epsilon(1e-9));
+}
+
+TEST_CASE("[PackedArrayMath] Float array methods") {
+	PackedFloat64Array values;
+	values.push_back(1.5);
+	values.push_back(-2.0);
+	values.push_back(4.0);
+	PackedFloat64Array other;
+	other.push_back(2.0);
+	other.push_back(3.0);
+	other.push_back(-1.0);
+
+	Variant array = values;
+	CHECK(double(call(array, "sum")) == 3.5);
+	CHECK(double(call(array, "min")) == -2.0);
+	CHECK(double(call(array, "max")) == 4.0);
+	CHECK(double(call(array, "dot", other, Variant(), 1)) == -7.0);
+
+	call(array, "add", 1.0, Variant(), 1);
+	call(array, "multiply", 2.0, Variant(), 1);
+	call(array, "add_array", other, Variant(), 1);
+	call(array, "clamp", 0.0, 6.0, 2);
+	PackedFloat64Array result = array;
+	CHECK(result[0] == 6.0);
+	CHECK(result[1] == 1.0);
+	CHECK(result[2] == 6.0);
+	CHECK_MESSAGE(values[0] == 1.5, "The original array must not be modified.");
+
+	Variant floats = Variant(result).operator PackedFloat32Array();
+	call(floats, "lerp_array", Variant(other).operator PackedFloat32Array(), 0.5, 2);
+	PackedFloat32Array lerped = floats;
+	CHECK(lerped[0] == 4.0f);
+	CHECK(lerped[1] == 2.0f);
+	CHECK(lerped[2] == 2.5f);
+
+	ERR_PRINT_OFF;
+	Variant empty = PackedFloat32Array();
+	CHECK(double(call(empty, "max")) == 0.0);
+	PackedFloat64Array shorter;
+	shorter.push_back(1.0);
+	call(array, "multiply_array", shorter, Variant(), 1);
+	ERR_PRINT_ON;
+	CHECK_MESSAGE(PackedFloat64Array(array) == result, "Arrays of different sizes must be left untouched.");
+}
+
+TEST_CASE("[PackedArrayMath] Vector array methods") {
+	PackedVector3Array points;
+	points.push_back(Vector3(1, 2, 3));
+	points.push_back(Vector3(-1, 0, 5));
+
+	Variant array = points;
+	CHECK(Vector3(call(array, "sum")) == Vector3(0, 2, 8));
+	PackedFloat32Array dots = call(array, "dot", Vector3(0, 1, 1), Variant(), 1);
+	CHECK(dots.size() == 2);
+	CHECK(dots[0] == 5.0f);
+	CHECK(dots[1] == 5.0f);
+
+	call(array, "add", Vector3(1, 1, 1), Variant(), 1);
+	call(array, "multiply", 2.0, Variant(), 1);
+	call(array, "multiply_array", points, Variant(), 1);
+	call(array, "clamp", Vector3(-100, -100, -100), Vector3(20, 20, 20), 2);
+	PackedVector3Array result = array;
+	CHECK(result[0] == Vector3(4, 12, 20));
+	CHECK(result[1] == Vector3(0, 0, 20));
+
+	Transform3D transform(Basis(Vector3(0, 1, 0), Math_PI / 2), Vector3(10, 0, 0));
+	call(array, "transform", transform, Variant(), 1);
+	result = array;
+	CHECK(result[0].is_equal_approx(transform.xform(Vector3(4, 12, 20))));
+	CHECK(result[1].is_equal_approx(transform.xform(Vector3(0, 0, 20))));
+
+	Variant array_2d = PackedVector2Array();
+	call(array_2d, "push_back", Vector2(2, 4), Variant(), 1);
+	PackedVector2Array to;
+	to.push_back(Vector2(4, 0));
+	call(array_2d, "lerp_array", to, 0.25, 2);
+	call(array_2d, "transform", Transform2D(0, Vector2(1, 1)), Variant(), 1);
+	CHECK(PackedVector2Array(array_2d)[0] == Vector2(3.5, 4));
+}
+
+} // namespace TestPackedArrayMath
+
+#endif // TEST_PACKED_ARRAY_MATH_H
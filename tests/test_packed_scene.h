@@ -0,0 +1,160 @@
+/*************************************************************************/
+/*  test_packed_scene.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PACKED_SCENE_H
+#define TEST_PACKED_SCENE_H
+
+#include "core/os/os.h"
+#include "scene/2d/node_2d.h"
+#include "scene/resources/packed_scene.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPackedScene {
+
+static Ref<PackedScene> _make_bullet_scene() {
+	Node2D *root = memnew(Node2D);
+	root->set_name("Bullet");
+	root->set_position(Vector2(10, 20));
+	root->set_z_index(3);
+
+	Node2D *sprite = memnew(Node2D);
+	sprite->set_name("Sprite");
+	sprite->set_rotation(0.5);
+	sprite->add_to_group("sprites", true);
+	root->add_child(sprite);
+	sprite->set_owner(root);
+
+	Node *timer = memnew(Node);
+	timer->set_name("Timer");
+	root->add_child(timer);
+	timer->set_owner(root);
+
+	Vector<Variant> binds;
+	binds.push_back(42);
+	timer->connect("renamed", Callable(root, "queue_free"), binds, Object::CONNECT_PERSIST);
+
+	Ref<PackedScene> scene;
+	scene.instantiate();
+	CHECK(scene->pack(root) == OK);
+	memdelete(root);
+	return scene;
+}
+
+static void _check_bullet(Node *p_instance, const Vector2 &p_position) {
+	Node2D *root = Object::cast_to<Node2D>(p_instance);
+	REQUIRE(root);
+	CHECK(root->get_name() == "Bullet");
+	CHECK(root->get_position() == p_position);
+	CHECK(root->get_z_index() == 3);
+
+	Node2D *sprite = Object::cast_to<Node2D>(root->get_node_or_null(NodePath("Sprite")));
+	REQUIRE(sprite);
+	CHECK(sprite->get_owner() == root);
+	CHECK(Math::is_equal_approx(sprite->get_rotation(), (real_t)0.5));
+	CHECK(sprite->is_in_group("sprites"));
+
+	Node *timer = root->get_node_or_null(NodePath("Timer"));
+	REQUIRE(timer);
+	List<Object::Connection> connections;
+	timer->get_signal_connection_list("renamed", &connections);
+	REQUIRE(connections.size() == 1);
+	CHECK(connections.front()->get().callable.get_object() == root);
+	REQUIRE(connections.front()->get().binds.size() == 1);
+	CHECK(int(connections.front()->get().binds[0]) == 42);
+}
+
+TEST_CASE("[PackedScene] Instances match with and without the instantiation plan") {
+	Ref<PackedScene> scene = _make_bullet_scene();
+
+	Node *without_plan = scene->get_state()->instantiate_without_plan(SceneState::GEN_EDIT_STATE_DISABLED);
+	_check_bullet(without_plan, Vector2(10, 20));
+	memdelete(without_plan);
+
+	// The plan is built by the first instance and reused by the next ones.
+	for (int i = 0; i < 3; i++) {
+		Node *instance = scene->instantiate();
+		_check_bullet(instance, Vector2(10, 20));
+		memdelete(instance);
+	}
+}
+
+TEST_CASE("[PackedScene] Packing again updates the instantiation plan") {
+	Ref<PackedScene> scene = _make_bullet_scene();
+	Node *instance = scene->instantiate();
+	REQUIRE(instance);
+
+	Object::cast_to<Node2D>(instance)->set_position(Vector2(-5, 7));
+	Node *extra = memnew(Node);
+	extra->set_name("Extra");
+	instance->add_child(extra);
+	extra->set_owner(instance);
+	CHECK(scene->pack(instance) == OK);
+	memdelete(instance);
+
+	instance = scene->instantiate();
+	_check_bullet(instance, Vector2(-5, 7));
+	CHECK(instance->get_node_or_null(NodePath("Extra")) != nullptr);
+	memdelete(instance);
+}
+
+static void _benchmark_instances(const Ref<SceneState> &p_state, bool p_use_plan, int p_instances) {
+	Vector<Node *> spawned;
+	spawned.resize(p_instances);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_instances; i++) {
+		if (p_use_plan) {
+			spawned.write[i] = p_state->instantiate(SceneState::GEN_EDIT_STATE_DISABLED);
+		} else {
+			spawned.write[i] = p_state->instantiate_without_plan(SceneState::GEN_EDIT_STATE_DISABLED);
+		}
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	print_line(vformat("%s: %d instances in %d usec", p_use_plan ? "instantiation plan" : "scene state", p_instances, elapsed));
+
+	for (int i = 0; i < p_instances; i++) {
+		memdelete(spawned[i]);
+	}
+}
+
+// Spawns many copies of the same scene, use with `godot --test packed-scene-benchmark`.
+static void test_packed_scene_benchmark() {
+	const int instances = 20000;
+	Ref<PackedScene> scene = _make_bullet_scene();
+
+	_benchmark_instances(scene->get_state(), false, instances);
+	_benchmark_instances(scene->get_state(), true, instances);
+}
+
+REGISTER_TEST_COMMAND("packed-scene-benchmark", &test_packed_scene_benchmark);
+} // namespace TestPackedScene
+
+#endif // TEST_PACKED_SCENE_H
@@ -32,6 +32,7 @@
 #define TEST_PCK_PACKER_H
 
 #include "core/io/file_access_pack.h"
+#include "core/io/marshalls.h"
 #include "core/io/pck_packer.h"
 #include "core/os/os.h"
 
@@ -109,6 +110,201 @@ TEST_CASE("[PCKPacker] Pack a PCK file with some files and directories") {
 			f->get_length() <= 35000,
 			"The generated non-empty PCK file shouldn't be too large.");
 }
+
+TEST_CASE("[PCKPacker] Read packed files from the mapped pack") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String source_path = cache_path.plus_file("pck_mapped_source.txt");
+	{
+		FileAccessRef source = FileAccess::open(source_path, FileAccess::WRITE);
+		REQUIRE(source);
+		source->store_string("Mapped pack contents.");
+	}
+
+	PCKPacker pck_packer;
+	const String output_pck_path = cache_path.plus_file("output_mapped.pck");
+	CHECK(pck_packer.pck_start(output_pck_path, 32, ENCRYPTION_KEY) == OK);
+	CHECK(pck_packer.add_file("res://pck_mapped/first.txt", source_path) == OK);
+	CHECK(pck_packer.add_file("res://pck_mapped/second.txt", source_path, true) == OK);
+	CHECK(pck_packer.flush() == OK);
+	// A PackedData of its own, so the pack doesn't stay in res:// after the test.
+	PackedData packed_data;
+	REQUIRE(packed_data.add_pack(output_pck_path, false, 0) == OK);
+
+	FileAccess *f = packed_data.try_open_path("res://pck_mapped/first.txt");
+	REQUIRE(f);
+	CHECK(f->get_length() == 21);
+	CHECK(f->get_8() == 'M');
+
+	// Views are only provided where the pack could be mapped.
+	const uint8_t *mapped = f->map_read_only();
+	const uint8_t *view = f->get_buffer_view(6);
+	CHECK(bool(view) == bool(mapped));
+	if (view) {
+		CHECK(view == mapped + 1);
+		CHECK(String::utf8((const char *)view, 6) == "apped ");
+		CHECK(f->get_position() == 7);
+		CHECK_MESSAGE(f->get_buffer_view(100) == nullptr, "Views can't go past the end of the file.");
+		CHECK(f->get_position() == 7);
+	} else {
+		f->seek(7);
+	}
+
+	uint8_t buffer[32];
+	CHECK(f->get_buffer(buffer, 32) == 14);
+	CHECK(String::utf8((const char *)buffer, 14) == "pack contents.");
+	CHECK(f->eof_reached());
+	f->seek(0);
+	CHECK(!f->eof_reached());
+	CHECK(f->get_buffer(buffer, 6) == 6);
+	CHECK(String::utf8((const char *)buffer, 6) == "Mapped");
+	memdelete(f);
+
+	// Encrypted files don't provide views, but are read from the mapping too.
+	f = packed_data.try_open_path("res://pck_mapped/second.txt");
+	REQUIRE(f);
+	CHECK(f->get_buffer_view(1) == nullptr);
+	CHECK(f->get_as_utf8_string() == "Mapped pack contents.");
+	memdelete(f);
+}
+
+TEST_CASE("[PCKPacker] Read compressed files") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+
+	// Several blocks, so reads go through the block index and get decompressed in parallel.
+	const String large_path = cache_path.plus_file("pck_compressed_large.txt");
+	String large_text;
+	for (int i = 0; i < 40000; i++) {
+		large_text += "Line " + itos(i) + " of the compressed file.\n";
+	}
+	const CharString large = large_text.utf8();
+	REQUIRE(large.length() > PACK_COMPRESSED_BLOCK_SIZE * 4);
+	{
+		FileAccessRef source = FileAccess::open(large_path, FileAccess::WRITE);
+		REQUIRE(source);
+		source->store_buffer((const uint8_t *)large.get_data(), large.length());
+	}
+
+	PCKPacker pck_packer;
+	const String output_pck_path = cache_path.plus_file("output_compressed.pck");
+	// The directory is written after the files, encrypting it checks the space reserved for it.
+	CHECK(pck_packer.pck_start(output_pck_path, 32, ENCRYPTION_KEY, true) == OK);
+	CHECK(pck_packer.add_file("res://pck_compressed/large.txt", large_path, false, true) == OK);
+	CHECK(pck_packer.add_file("res://pck_compressed/large_encrypted.txt", large_path, true, true) == OK);
+
+	// Enough small files for the pack to get a dictionary.
+	for (int i = 0; i < 10; i++) {
+		const String small_path = cache_path.plus_file("pck_compressed_small_" + itos(i) + ".tres");
+		FileAccessRef source = FileAccess::open(small_path, FileAccess::WRITE);
+		REQUIRE(source);
+		source->store_string("[gd_resource type=\"Resource\" format=3]\n\n[resource]\nvalue = " + itos(i) + "\n");
+		source->close();
+		CHECK(pck_packer.add_file("res://pck_compressed/small_" + itos(i) + ".tres", small_path, false, true) == OK);
+	}
+	CHECK(pck_packer.flush() == OK);
+
+	{
+		FileAccessRef f = FileAccess::open(output_pck_path, FileAccess::READ);
+		REQUIRE(f);
+		CHECK_MESSAGE(f->get_length() < (uint64_t)large.length(), "Both copies of the large file should compress well.");
+	}
+	PackedData packed_data;
+	REQUIRE(packed_data.add_pack(output_pck_path, false, 0) == OK);
+
+	const char *large_files[] = { "res://pck_compressed/large.txt", "res://pck_compressed/large_encrypted.txt" };
+	for (const char *large_file : large_files) {
+		FileAccess *f = packed_data.try_open_path(large_file);
+		REQUIRE(f);
+		CHECK(f->get_length() == (uint64_t)large.length());
+		CHECK_MESSAGE(f->get_buffer_view(1) == nullptr, "Compressed files don't provide views.");
+
+		Vector<uint8_t> contents;
+		contents.resize(large.length());
+		CHECK(f->get_buffer(contents.ptrw(), contents.size()) == (uint64_t)large.length());
+		CHECK(memcmp(contents.ptr(), large.get_data(), large.length()) == 0);
+		CHECK(!f->eof_reached());
+		CHECK(f->get_8() == 0);
+		CHECK(f->eof_reached());
+
+		// Reads starting and ending in the middle of blocks.
+		const uint64_t from = PACK_COMPRESSED_BLOCK_SIZE - 10;
+		f->seek(from);
+		CHECK(f->get_8() == (uint8_t)large[from]);
+		uint8_t buffer[64];
+		CHECK(f->get_buffer(buffer, 64) == 64);
+		CHECK(memcmp(buffer, large.get_data() + from + 1, 64) == 0);
+
+		f->seek(from);
+		const uint64_t length = PACK_COMPRESSED_BLOCK_SIZE * 2 + 20;
+		CHECK(f->get_buffer(contents.ptrw(), length) == length);
+		CHECK(memcmp(contents.ptr(), large.get_data() + from, length) == 0);
+
+		f->seek_end(-5);
+		CHECK(f->get_buffer(buffer, 64) == 5);
+		CHECK(memcmp(buffer, large.get_data() + large.length() - 5, 5) == 0);
+		CHECK(f->eof_reached());
+		memdelete(f);
+	}
+
+	for (int i = 0; i < 10; i++) {
+		FileAccess *f = packed_data.try_open_path("res://pck_compressed/small_" + itos(i) + ".tres");
+		REQUIRE(f);
+		CHECK(f->get_as_utf8_string() == "[gd_resource type=\"Resource\" format=3]\n\n[resource]\nvalue = " + itos(i) + "\n");
+		memdelete(f);
+	}
+}
+
+TEST_CASE("[PCKPacker] Corrupt compressed files can't be opened") {
+	const String cache_path = OS::get_singleton()->get_cache_path();
+	const String source_path = cache_path.plus_file("pck_corrupt_source.txt");
+	String text;
+	for (int i = 0; i < 10000; i++) {
+		text += "Line " + itos(i) + " of the corrupt file.\n";
+	}
+	const CharString source = text.utf8();
+	const uint32_t block_count = (source.length() + PACK_COMPRESSED_BLOCK_SIZE - 1) / PACK_COMPRESSED_BLOCK_SIZE;
+	REQUIRE(block_count > 1);
+	{
+		FileAccessRef f = FileAccess::open(source_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_buffer((const uint8_t *)source.get_data(), source.length());
+	}
+
+	PCKPacker pck_packer;
+	const String output_pck_path = cache_path.plus_file("output_corrupt.pck");
+	CHECK(pck_packer.pck_start(output_pck_path, 32, ENCRYPTION_KEY) == OK);
+	CHECK(pck_packer.add_file("res://pck_corrupt/file.txt", source_path, false, true) == OK);
+	CHECK(pck_packer.flush() == OK);
+
+	// Zero the block size in the header of the compressed file.
+	Vector<uint8_t> pck = FileAccess::get_file_as_array(output_pck_path);
+	uint8_t header[8];
+	encode_uint32(PACK_COMPRESSED_BLOCK_SIZE, header);
+	encode_uint32(block_count, &header[4]);
+	int header_offset = -1;
+	for (int i = 0; i + 8 <= pck.size(); i++) {
+		if (memcmp(pck.ptr() + i, header, 8) == 0) {
+			header_offset = i;
+			break;
+		}
+	}
+	REQUIRE(header_offset >= 0);
+	encode_uint32(0, pck.ptrw() + header_offset);
+	{
+		FileAccessRef f = FileAccess::open(output_pck_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_buffer(pck.ptr(), pck.size());
+	}
+
+	PackedData packed_data;
+	REQUIRE(packed_data.add_pack(output_pck_path, false, 0) == OK);
+	ERR_PRINT_OFF;
+	FileAccess *f = packed_data.try_open_path("res://pck_corrupt/file.txt");
+	ERR_PRINT_ON;
+	CHECK_MESSAGE(f == nullptr, "Compressed files with a corrupt block index shouldn't be opened.");
+	if (f) {
+		memdelete(f);
+	}
+}
 } // namespace TestPCKPacker
 
 #endif // TEST_PCK_PACKER_H
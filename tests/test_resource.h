@@ -109,6 +109,114 @@ TEST_CASE("[Resource] Saving and loading") {
 			loaded_child_resource_text->get_name() == "I'm a child resource",
 			"The loaded child resource name should be equal to the expected value.");
 }
+
+TEST_CASE("[Resource] Threaded loading") {
+	const String child_path = OS::get_singleton()->get_cache_path().plus_file("threaded_child.res");
+	Vector<String> paths;
+	{
+		Ref<Resource> child = memnew(Resource);
+		child->set_name("Child");
+		ResourceSaver::save(child_path, child);
+		// Having a path makes it an external resource of the parents.
+		child->set_path(child_path);
+
+		for (int i = 0; i < 8; i++) {
+			Ref<Resource> resource = memnew(Resource);
+			resource->set_name(vformat("Resource %d", i));
+			resource->set_meta("child", child);
+			paths.push_back(OS::get_singleton()->get_cache_path().plus_file(vformat("threaded_%d.res", i)));
+			ResourceSaver::save(paths[i], resource);
+		}
+	}
+
+	for (int i = 0; i < paths.size(); i++) {
+		CHECK(ResourceLoader::load_threaded_request(paths[i], "", true, ResourceFormatLoader::CACHE_MODE_REUSE, String(), i) == OK);
+	}
+	CHECK(ResourceLoader::load_threaded_set_priority(paths[0], 100) == OK);
+	CHECK(ResourceLoader::load_threaded_cancel(paths[1]) == OK);
+
+	for (int i = 0; i < paths.size(); i++) {
+		if (i == 1) {
+			// Requesting again after cancelling, whether the load already started or not.
+			CHECK(ResourceLoader::load_threaded_request(paths[i]) == OK);
+		}
+		Error err;
+		Ref<Resource> loaded = ResourceLoader::load_threaded_get(paths[i], &err);
+		CHECK(err == OK);
+		REQUIRE(loaded.is_valid());
+		CHECK(loaded->get_name() == vformat("Resource %d", i));
+		Ref<Resource> child = loaded->get_meta("child");
+		REQUIRE(child.is_valid());
+		CHECK_MESSAGE(
+				child->get_name() == "Child",
+				"Sub-resources should be loaded.");
+	}
+
+	// Requests are reference counted, getting twice needs two requests.
+	CHECK(ResourceLoader::load_threaded_request(paths[2]) == OK);
+	CHECK(ResourceLoader::load_threaded_request(paths[2]) == OK);
+	CHECK(ResourceLoader::load_threaded_get(paths[2]).is_valid());
+	CHECK(ResourceLoader::load_threaded_get(paths[2]).is_valid());
+
+	ERR_PRINT_OFF;
+	CHECK(ResourceLoader::load_threaded_cancel(paths[2]) == ERR_INVALID_PARAMETER);
+	ERR_PRINT_ON;
+}
+
+TEST_CASE("[Resource] Loading a single sub-resource") {
+	Ref<Resource> resource = memnew(Resource);
+	resource->set_name("Main");
+	Ref<Resource> first = memnew(Resource);
+	first->set_name("First");
+	Ref<Resource> nested = memnew(Resource);
+	nested->set_name("Nested");
+	first->set_meta("nested", nested);
+	Ref<Resource> second = memnew(Resource);
+	second->set_name("Second");
+	resource->set_meta("first", first);
+	resource->set_meta("second", second);
+
+	const String save_path = OS::get_singleton()->get_cache_path().plus_file("resource_sub_resources.res");
+	REQUIRE(ResourceSaver::save(save_path, resource) == OK);
+	// Saving gives sub-resources the IDs they are indexed with.
+	REQUIRE(first->get_scene_unique_id() != String());
+	const String first_id = first->get_scene_unique_id();
+	const String second_id = second->get_scene_unique_id();
+	resource.unref();
+	first.unref();
+	nested.unref();
+	second.unref();
+
+	Ref<Resource> loaded_first = ResourceLoader::load(save_path + "::" + first_id);
+	REQUIRE(loaded_first.is_valid());
+	CHECK(loaded_first->get_name() == "First");
+	// Cached with the same path as when the whole file is loaded.
+	const String first_path = loaded_first->get_path();
+	CHECK(first_path.ends_with("resource_sub_resources.res::" + first_id));
+	Ref<Resource> loaded_nested = loaded_first->get_meta("nested");
+	REQUIRE(loaded_nested.is_valid());
+	CHECK_MESSAGE(
+			loaded_nested->get_name() == "Nested",
+			"Resources referenced by the sub-resource should be loaded with it.");
+	CHECK_MESSAGE(
+			!ResourceCache::has(first_path.replace(first_id, second_id)),
+			"Sub-resources that aren't referenced shouldn't be loaded.");
+	CHECK_MESSAGE(
+			!ResourceCache::has(first_path.get_slice("::", 0)),
+			"The main resource shouldn't be loaded.");
+
+	Ref<Resource> loaded = ResourceLoader::load(save_path);
+	REQUIRE(loaded.is_valid());
+	CHECK(loaded->get_name() == "Main");
+	CHECK_MESSAGE(
+			Ref<Resource>(loaded->get_meta("first")) == loaded_first,
+			"Loading the whole file should reuse the cached sub-resource.");
+	CHECK(Ref<Resource>(loaded->get_meta("second"))->get_name() == "Second");
+
+	ERR_PRINT_OFF;
+	CHECK(ResourceLoader::load(save_path + "::Resource_missing").is_null());
+	ERR_PRINT_ON;
+}
 } // namespace TestResource
 
 #endif // TEST_RESOURCE
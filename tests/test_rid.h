@@ -0,0 +1,140 @@
+/*************************************************************************/
+/*  test_rid.h                                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RID_H
+#define TEST_RID_H
+
+#include "core/os/thread.h"
+#include "core/templates/rid_owner.h"
+#include "core/templates/safe_refcount.h"
+
+#include "tests/test_macros.h"
+
+namespace TestRID {
+
+TEST_CASE("[RID_Owner] Validation") {
+	RID_Owner<int, true> owner(sizeof(int) * 4); // Small chunks, so growing is exercised.
+
+	RID a = owner.make_rid(1);
+	RID b = owner.make_rid(2);
+	CHECK(owner.owns(a));
+	CHECK(*owner.getornull(a) == 1);
+	CHECK(*owner.getornull(b) == 2);
+	CHECK(owner.get_rid_count() == 2);
+
+	owner.free(a);
+	CHECK_FALSE(owner.owns(a));
+	CHECK(owner.getornull(a) == nullptr);
+
+	// The slot is reused, but the old RID stays invalid.
+	RID c = owner.make_rid(3);
+	CHECK(c != a);
+	CHECK(owner.getornull(a) == nullptr);
+	CHECK(*owner.getornull(c) == 3);
+
+	// Allocated but not initialized yet.
+	RID d = owner.allocate_rid();
+	CHECK(owner.owns(d));
+	ERR_PRINT_OFF;
+	CHECK(owner.getornull(d) == nullptr);
+	ERR_PRINT_ON;
+	owner.initialize_rid(d, 4);
+	CHECK(*owner.getornull(d) == 4);
+
+	for (int i = 0; i < 64; i++) {
+		owner.free(owner.make_rid(i));
+	}
+	CHECK(*owner.getornull(b) == 2);
+	CHECK(owner.get_rid_count() == 3);
+
+	owner.free(b);
+	owner.free(c);
+	owner.free(d);
+	CHECK(owner.get_rid_count() == 0);
+}
+
+struct ConcurrentData {
+	RID_Owner<uint64_t, true> owner = RID_Owner<uint64_t, true>(sizeof(uint64_t) * 16);
+	LocalVector<RID> shared;
+	SafeNumeric<uint32_t> errors;
+
+	static void worker(void *p_data) {
+		ConcurrentData *data = static_cast<ConcurrentData *>(p_data);
+		LocalVector<RID> own;
+		for (uint32_t i = 0; i < 20000; i++) {
+			// Growing the tables while others look up must not break their lookups.
+			own.push_back(data->owner.make_rid(i));
+			const RID &shared = data->shared[i % data->shared.size()];
+			uint64_t *value = data->owner.getornull(shared);
+			if (!value || *value != shared.get_id()) {
+				data->errors.increment();
+			}
+			if (i % 3 == 0) {
+				RID rid = own[own.size() - 1];
+				own.remove(own.size() - 1);
+				data->owner.free(rid);
+				if (data->owner.owns(rid)) {
+					data->errors.increment();
+				}
+			}
+		}
+		for (uint32_t i = 0; i < own.size(); i++) {
+			data->owner.free(own[i]);
+		}
+	}
+};
+
+TEST_CASE("[RID_Owner] Concurrent lookups while allocating and freeing") {
+	ConcurrentData data;
+	for (int i = 0; i < 32; i++) {
+		RID rid = data.owner.allocate_rid();
+		data.owner.initialize_rid(rid, rid.get_id());
+		data.shared.push_back(rid);
+	}
+
+	const int THREADS = 4;
+	Thread threads[THREADS];
+	for (int i = 0; i < THREADS; i++) {
+		threads[i].start(&ConcurrentData::worker, &data);
+	}
+	for (int i = 0; i < THREADS; i++) {
+		threads[i].wait_to_finish();
+	}
+
+	CHECK(data.errors.get() == 0);
+	CHECK(data.owner.get_rid_count() == 32);
+	for (uint32_t i = 0; i < data.shared.size(); i++) {
+		data.owner.free(data.shared[i]);
+	}
+}
+
+} // namespace TestRID
+
+#endif // TEST_RID_H
@@ -0,0 +1,109 @@
+/*************************************************************************/
+/*  test_sampling_profiler.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_SAMPLING_PROFILER_H
+#define TEST_SAMPLING_PROFILER_H
+
+#include "core/debugger/sampling_profiler.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/templates/safe_refcount.h"
+
+#include "tests/test_macros.h"
+
+namespace TestSamplingProfiler {
+
+static SafeFlag thread_in_frames;
+static SafeFlag thread_exit;
+
+static void sampled_thread(void *p_userdata) {
+	Thread::set_name("Sampled thread");
+	SamplingProfiler::Frame *outer = SamplingProfiler::push(SamplingProfiler::intern("outer"), 1);
+	outer->line.store(3);
+	SamplingProfiler::push(SamplingProfiler::intern("inner"), 7);
+	thread_in_frames.set();
+	while (!thread_exit.is_set()) {
+		OS::get_singleton()->delay_usec(100);
+	}
+	SamplingProfiler::pop();
+	SamplingProfiler::pop();
+}
+
+TEST_CASE("[SamplingProfiler] Stacks are sampled from another thread") {
+	thread_in_frames.clear();
+	thread_exit.clear();
+	SamplingProfiler::clear();
+
+	Thread thread;
+	thread.start(sampled_thread, nullptr);
+	while (!thread_in_frames.is_set()) {
+		OS::get_singleton()->delay_usec(100);
+	}
+
+	SamplingProfiler::start(100);
+	CHECK(SamplingProfiler::is_running());
+	for (int i = 0; i < 1000 && SamplingProfiler::get_sample_count() < 10; i++) {
+		OS::get_singleton()->delay_usec(1000);
+	}
+	SamplingProfiler::stop();
+	CHECK_FALSE(SamplingProfiler::is_running());
+
+	thread_exit.set();
+	thread.wait_to_finish();
+
+	const uint64_t samples = SamplingProfiler::get_sample_count();
+	REQUIRE(samples >= 10);
+
+	// The only stack is the one of the sampled thread, so every sample is counted on it.
+	const String collapsed = SamplingProfiler::get_collapsed_stacks();
+	CHECK(collapsed == "Sampled thread;outer:3;inner:7 " + String::num_uint64(samples) + "\n");
+
+	const String path = OS::get_singleton()->get_cache_path().plus_file("sampling_profile.txt");
+	REQUIRE(SamplingProfiler::save(path) == OK);
+	CHECK(FileAccess::get_file_as_string(path) == collapsed);
+	DirAccess::remove_file_or_error(path);
+
+	SamplingProfiler::clear();
+	CHECK(SamplingProfiler::get_sample_count() == 0);
+	CHECK(SamplingProfiler::get_collapsed_stacks().is_empty());
+}
+
+TEST_CASE("[SamplingProfiler] Interned names are shared") {
+	const char *a = SamplingProfiler::intern("Script::function");
+	const char *b = SamplingProfiler::intern(String("Script::") + "function");
+	CHECK(a == b);
+	CHECK(String::utf8(a) == "Script::function");
+}
+
+} // namespace TestSamplingProfiler
+
+#endif // TEST_SAMPLING_PROFILER_H
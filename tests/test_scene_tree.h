@@ -0,0 +1,467 @@
+/*************************************************************************/
+/*  test_scene_tree.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_SCENE_TREE_H
+#define TEST_SCENE_TREE_H
+
+#include "core/input/input.h"
+#include "core/object/message_queue.h"
+#include "core/templates/safe_refcount.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/window.h"
+#include "servers/display_server.h"
+#include "servers/navigation_server_2d.h"
+#include "servers/navigation_server_3d.h"
+#include "servers/physics_server_2d.h"
+#include "servers/physics_server_3d.h"
+#include "servers/rendering/rendering_server_default.h"
+
+#include "tests/test_macros.h"
+
+// Declared in global namespace because of GDCLASS macro warning (Windows).
+class _TestGroupNode : public Node {
+	GDCLASS(_TestGroupNode, Node);
+
+protected:
+	void _notification(int p_what) {
+		if (p_what != NOTIFICATION_GROUP_TEST && p_what != NOTIFICATION_PROCESS) {
+			return;
+		}
+		if (log) {
+			log->push_back(this);
+		}
+		if (remove_on_notification) {
+			remove_on_notification->get_parent()->remove_child(remove_on_notification);
+			remove_on_notification = nullptr;
+		}
+		if (add_on_notification) {
+			add_on_notification->add_to_group("group");
+			add_on_notification = nullptr;
+		}
+	}
+
+public:
+	enum {
+		NOTIFICATION_GROUP_TEST = 10000,
+	};
+
+	Vector<Node *> *log = nullptr;
+	Node *remove_on_notification = nullptr; // Removed from the tree.
+	Node *add_on_notification = nullptr; // Added to "group".
+};
+
+// Declared in global namespace because of GDCLASS macro warning (Windows).
+class _TestThreadedNode : public Node {
+	GDCLASS(_TestThreadedNode, Node);
+
+	void _deferred() {
+		deferred_after = threaded_processed ? threaded_processed->get() : 0;
+	}
+
+protected:
+	void _notification(int p_what) {
+		switch (p_what) {
+			case NOTIFICATION_PROCESS: {
+				process_count.increment();
+				if (threaded_processed && is_process_threaded()) {
+					threaded_processed->increment();
+				}
+				if (defer_on_process) {
+					callable_mp(this, &_TestThreadedNode::_deferred).call_deferred(nullptr, 0);
+				}
+				if (toggle_on_process) {
+					toggle_on_process->set_process_threaded(!toggle_on_process->is_process_threaded());
+					toggle_on_process = nullptr;
+				}
+				if (deferred_node) {
+					deferred_seen = deferred_node->deferred_after;
+				}
+			} break;
+			case NOTIFICATION_PHYSICS_PROCESS: {
+				physics_process_count.increment();
+			} break;
+		}
+	}
+
+public:
+	SafeNumeric<uint32_t> process_count;
+	SafeNumeric<uint32_t> physics_process_count;
+
+	SafeNumeric<uint32_t> *threaded_processed = nullptr; // Shared by the threaded nodes.
+	bool defer_on_process = false;
+	uint32_t deferred_after = 0; // Threaded nodes processed when the deferred call ran.
+
+	_TestThreadedNode *toggle_on_process = nullptr;
+	_TestThreadedNode *deferred_node = nullptr; // Checked from the main thread pass.
+	uint32_t deferred_seen = 0;
+};
+
+namespace TestSceneTree {
+
+// The test runner doesn't start the servers a SceneTree needs, this starts
+// headless ones along with the tree, and stops them at the end of the test.
+struct SceneTreeEnvironment {
+	MessageQueue *message_queue = nullptr;
+	Input *input = nullptr;
+	DisplayServer *display_server = nullptr;
+	RenderingServer *rendering_server = nullptr;
+	PhysicsServer3D *physics_server_3d = nullptr;
+	PhysicsServer2D *physics_server_2d = nullptr;
+	NavigationServer3D *navigation_server_3d = nullptr;
+	NavigationServer2D *navigation_server_2d = nullptr;
+	SceneTree *tree = nullptr;
+
+	SceneTreeEnvironment() {
+		if (!MessageQueue::get_singleton()) {
+			message_queue = memnew(MessageQueue);
+		}
+		if (!Input::get_singleton()) {
+			input = memnew(Input);
+		}
+		if (!DisplayServer::get_singleton()) {
+			Error err = OK;
+			for (int i = 0; i < DisplayServer::get_create_function_count(); i++) {
+				if (String(DisplayServer::get_create_function_name(i)) == "headless") {
+					display_server = DisplayServer::create(i, "", DisplayServer::WINDOW_MODE_MINIMIZED, DisplayServer::VSYNC_ENABLED, 0, Vector2i(), err);
+					break;
+				}
+			}
+		}
+		if (!RenderingServer::get_singleton()) {
+			rendering_server = memnew(RenderingServerDefault);
+			rendering_server->init();
+			rendering_server->set_render_loop_enabled(false);
+		}
+		if (!PhysicsServer3D::get_singleton()) {
+			physics_server_3d = PhysicsServer3DManager::new_default_server();
+			physics_server_3d->init();
+		}
+		if (!PhysicsServer2D::get_singleton()) {
+			physics_server_2d = PhysicsServer2DManager::new_default_server();
+			physics_server_2d->init();
+		}
+		if (!NavigationServer3D::get_singleton()) {
+			navigation_server_3d = NavigationServer3DManager::new_default_server();
+			navigation_server_2d = memnew(NavigationServer2D);
+		}
+
+		tree = memnew(SceneTree);
+		tree->initialize();
+	}
+
+	~SceneTreeEnvironment() {
+		tree->finalize();
+		MessageQueue::get_singleton()->flush();
+		memdelete(tree);
+
+		if (navigation_server_3d) {
+			memdelete(navigation_server_2d);
+			memdelete(navigation_server_3d);
+		}
+		if (physics_server_2d) {
+			physics_server_2d->finish();
+			memdelete(physics_server_2d);
+		}
+		if (physics_server_3d) {
+			physics_server_3d->finish();
+			memdelete(physics_server_3d);
+		}
+		if (rendering_server) {
+			rendering_server->finish();
+			memdelete(rendering_server);
+		}
+		if (display_server) {
+			memdelete(display_server);
+		}
+		if (input) {
+			memdelete(input);
+		}
+		if (message_queue) {
+			memdelete(message_queue);
+		}
+	}
+};
+
+static Vector<Node *> _get_group(SceneTree *p_tree, const StringName &p_group) {
+	List<Node *> list;
+	p_tree->get_nodes_in_group(p_group, &list);
+	Vector<Node *> nodes;
+	for (Node *E : list) {
+		nodes.push_back(E);
+	}
+	return nodes;
+}
+
+static _TestGroupNode *_add_node(Node *p_parent, const String &p_name, Vector<Node *> *p_log = nullptr) {
+	_TestGroupNode *node = memnew(_TestGroupNode);
+	node->set_name(p_name);
+	node->log = p_log;
+	p_parent->add_child(node);
+	return node;
+}
+
+TEST_CASE("[SceneTree] Group order after removals") {
+	SceneTreeEnvironment env;
+	Window *root = env.tree->get_root();
+
+	Vector<Node *> nodes;
+	for (int i = 0; i < 6; i++) {
+		nodes.push_back(_add_node(root, "Node" + itos(i)));
+		nodes[i]->add_to_group("group");
+	}
+	CHECK(_get_group(env.tree, "group") == nodes);
+
+	// Removing leaves holes, the other members keep their order.
+	nodes[1]->remove_from_group("group");
+	nodes[3]->remove_from_group("group");
+	Vector<Node *> expected;
+	expected.push_back(nodes[0]);
+	expected.push_back(nodes[2]);
+	expected.push_back(nodes[4]);
+	expected.push_back(nodes[5]);
+	CHECK(_get_group(env.tree, "group") == expected);
+
+	// Nodes added again after compaction go back to their place in the tree.
+	nodes[5]->remove_from_group("group");
+	nodes[1]->add_to_group("group");
+	nodes[5]->add_to_group("group");
+	nodes[0]->remove_from_group("group");
+	expected.clear();
+	expected.push_back(nodes[1]);
+	expected.push_back(nodes[2]);
+	expected.push_back(nodes[4]);
+	expected.push_back(nodes[5]);
+	CHECK(_get_group(env.tree, "group") == expected);
+	CHECK(nodes[1]->is_in_group("group"));
+	CHECK(!nodes[3]->is_in_group("group"));
+
+	// The group goes away with its last member.
+	for (int i = 0; i < expected.size(); i++) {
+		expected[i]->remove_from_group("group");
+	}
+	CHECK(!env.tree->has_group("group"));
+
+	for (int i = 0; i < nodes.size(); i++) {
+		memdelete(nodes[i]);
+	}
+}
+
+TEST_CASE("[SceneTree] Group order after moving and reparenting") {
+	SceneTreeEnvironment env;
+	Window *root = env.tree->get_root();
+
+	_TestGroupNode *first = _add_node(root, "First");
+	_TestGroupNode *second = _add_node(root, "Second");
+	_TestGroupNode *a = _add_node(first, "A");
+	_TestGroupNode *b = _add_node(first, "B");
+	_TestGroupNode *c = _add_node(second, "C");
+	a->add_to_group("group");
+	b->add_to_group("group");
+	c->add_to_group("group");
+
+	Vector<Node *> expected;
+	expected.push_back(a);
+	expected.push_back(b);
+	expected.push_back(c);
+	CHECK(_get_group(env.tree, "group") == expected);
+
+	// Moving a member in the tree sorts the group again.
+	first->move_child(b, 0);
+	expected.clear();
+	expected.push_back(b);
+	expected.push_back(a);
+	expected.push_back(c);
+	CHECK(_get_group(env.tree, "group") == expected);
+
+	// Reparented nodes leave and join the group again, and are merged in.
+	second->remove_child(c);
+	first->add_child(c);
+	first->move_child(c, 1);
+	expected.clear();
+	expected.push_back(b);
+	expected.push_back(c);
+	expected.push_back(a);
+	CHECK(_get_group(env.tree, "group") == expected);
+
+	first->remove_child(b);
+	second->add_child(b);
+	expected.clear();
+	expected.push_back(c);
+	expected.push_back(a);
+	expected.push_back(b);
+	CHECK(_get_group(env.tree, "group") == expected);
+
+	memdelete(first);
+	memdelete(second);
+}
+
+TEST_CASE("[SceneTree] Nodes added and removed while a group is notified") {
+	SceneTreeEnvironment env;
+	Window *root = env.tree->get_root();
+
+	Vector<Node *> log;
+	_TestGroupNode *a = _add_node(root, "A", &log);
+	_TestGroupNode *b = _add_node(root, "B", &log);
+	_TestGroupNode *c = _add_node(root, "C", &log);
+	_TestGroupNode *d = _add_node(root, "D", &log);
+	a->add_to_group("group");
+	b->add_to_group("group");
+	c->add_to_group("group");
+	_TestGroupNode *added = _add_node(root, "Added", &log);
+
+	// Nodes removed from the tree aren't notified anymore, nodes added to the group
+	// are notified from the next time on.
+	a->remove_on_notification = b;
+	a->add_on_notification = added;
+	env.tree->notify_group_flags(SceneTree::GROUP_CALL_REALTIME, "group", _TestGroupNode::NOTIFICATION_GROUP_TEST);
+	Vector<Node *> expected;
+	expected.push_back(a);
+	expected.push_back(c);
+	CHECK(log == expected);
+
+	log.clear();
+	d->add_to_group("group");
+	env.tree->notify_group("group", _TestGroupNode::NOTIFICATION_GROUP_TEST);
+	MessageQueue::get_singleton()->flush();
+	expected.clear();
+	expected.push_back(a);
+	expected.push_back(c);
+	expected.push_back(d);
+	expected.push_back(added);
+	CHECK(log == expected);
+
+	// Every member removing itself while the group is called.
+	env.tree->call_group_flags(SceneTree::GROUP_CALL_REALTIME, "group", "remove_from_group", "group");
+	CHECK(!env.tree->has_group("group"));
+	CHECK(!a->is_in_group("group"));
+	CHECK(!added->is_in_group("group"));
+
+	// Deferred calls reach the members of the group when it was called.
+	a->add_to_group("group");
+	c->add_to_group("group");
+	env.tree->call_group("group", "add_to_group", "called");
+	c->remove_from_group("group");
+	MessageQueue::get_singleton()->flush();
+	CHECK(a->is_in_group("called"));
+	CHECK(c->is_in_group("called"));
+	CHECK(_get_group(env.tree, "group").size() == 1);
+
+	memdelete(a);
+	memdelete(b);
+	memdelete(c);
+	memdelete(d);
+	memdelete(added);
+}
+
+TEST_CASE("[SceneTree] Threaded processing") {
+	SceneTreeEnvironment env;
+	Window *root = env.tree->get_root();
+
+	const uint32_t node_count = 8;
+	SafeNumeric<uint32_t> threaded_processed;
+	Vector<_TestThreadedNode *> nodes;
+	for (uint32_t i = 0; i < node_count; i++) {
+		_TestThreadedNode *node = memnew(_TestThreadedNode);
+		node->threaded_processed = &threaded_processed;
+		root->add_child(node);
+		node->set_process(true);
+		node->set_physics_process(true);
+		node->set_process_threaded(true);
+		nodes.push_back(node);
+	}
+	CHECK(nodes[0]->is_in_group("process_threaded"));
+	CHECK(nodes[0]->is_in_group("physics_process_threaded"));
+	CHECK(!nodes[0]->is_in_group("process"));
+	CHECK(!nodes[0]->is_in_group("physics_process"));
+
+	SUBCASE("Each node is processed once per frame") {
+		for (int frame = 1; frame <= 3; frame++) {
+			env.tree->physics_process(1.0 / 60.0);
+			env.tree->process(1.0 / 60.0);
+			for (uint32_t i = 0; i < node_count; i++) {
+				CHECK(nodes[i]->process_count.get() == uint32_t(frame));
+				CHECK(nodes[i]->physics_process_count.get() == uint32_t(frame));
+			}
+		}
+	}
+
+	SUBCASE("Toggling while processing moves the node between groups") {
+		_TestThreadedNode *main = memnew(_TestThreadedNode);
+		root->add_child(main);
+		main->set_process(true);
+		main->set_physics_process(true);
+		CHECK(main->is_in_group("process"));
+
+		main->toggle_on_process = nodes[0];
+		env.tree->process(1.0 / 60.0);
+		CHECK(!nodes[0]->is_process_threaded());
+		CHECK(nodes[0]->is_in_group("process"));
+		CHECK(nodes[0]->is_in_group("physics_process"));
+		CHECK(!nodes[0]->is_in_group("process_threaded"));
+		CHECK(!nodes[0]->is_in_group("physics_process_threaded"));
+		CHECK(nodes[0]->process_count.get() == 1);
+
+		main->toggle_on_process = nodes[0];
+		env.tree->process(1.0 / 60.0);
+		CHECK(nodes[0]->is_process_threaded());
+		CHECK(nodes[0]->is_in_group("process_threaded"));
+		CHECK(!nodes[0]->is_in_group("process"));
+		CHECK(nodes[0]->process_count.get() == 2);
+
+		env.tree->process(1.0 / 60.0);
+		CHECK(nodes[0]->process_count.get() == 3);
+		CHECK(main->process_count.get() == 3);
+
+		memdelete(main);
+	}
+
+	SUBCASE("Deferred calls run after the threaded pass") {
+		_TestThreadedNode *main = memnew(_TestThreadedNode);
+		root->add_child(main);
+		main->set_process(true);
+		main->deferred_node = nodes[0];
+		nodes[0]->defer_on_process = true;
+
+		env.tree->process(1.0 / 60.0);
+		CHECK(nodes[0]->deferred_after == node_count);
+		// The main thread nodes see the result in the same frame.
+		CHECK(main->deferred_seen == node_count);
+
+		memdelete(main);
+	}
+
+	for (uint32_t i = 0; i < node_count; i++) {
+		memdelete(nodes[i]);
+	}
+}
+
+} // namespace TestSceneTree
+
+#endif // TEST_SCENE_TREE_H
@@ -0,0 +1,141 @@
+/*************************************************************************/
+/*  test_string_name.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_STRING_NAME_H
+#define TEST_STRING_NAME_H
+
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/string/string_name.h"
+
+#include "tests/test_macros.h"
+
+namespace TestStringName {
+
+TEST_CASE("[StringName] Interning") {
+	StringName a = "test_interning";
+	StringName b = String("test_interning");
+	StringName c = StaticCString::create("test_interning");
+
+	CHECK(a == b);
+	CHECK(b == c);
+	CHECK(a.data_unique_pointer() == c.data_unique_pointer());
+	CHECK(a == "test_interning");
+	CHECK(StringName::search("test_interning") == a);
+	CHECK(StringName::search(U"test_interning") == a);
+
+	CHECK(StringName() == StringName(""));
+	CHECK(StringName::search("test_interning_not_created") == StringName());
+}
+
+struct ConcurrentNames {
+	enum {
+		NAME_COUNT = 64,
+		ROUNDS = 200,
+	};
+	SafeNumeric<uint32_t> mismatches;
+
+	void intern(uint32_t p_index, void *p_userdata) {
+		for (int round = 0; round < ROUNDS; round++) {
+			// Names are created and released again, so they get inserted and removed concurrently.
+			int n = (p_index + round) % NAME_COUNT;
+			StringName name = vformat("concurrent_name_%d", n);
+			StringName again = name.operator String();
+			if (name != again || name != vformat("concurrent_name_%d", n)) {
+				mismatches.increment();
+			}
+		}
+	}
+};
+
+TEST_CASE("[StringName] Concurrent interning") {
+	ConcurrentNames data;
+	WorkerThreadPool::get_singleton()->do_work(256, &data, &ConcurrentNames::intern, nullptr);
+	CHECK_MESSAGE(data.mismatches.get() == 0, "The same name should be interned once, even when created from several threads.");
+
+	for (int i = 0; i < ConcurrentNames::NAME_COUNT; i++) {
+		CHECK_MESSAGE(
+				StringName::search(vformat("concurrent_name_%d", i)) == StringName(),
+				"Names should be released once no longer referenced.");
+	}
+}
+
+struct NameBenchmark {
+	enum {
+		NAME_COUNT = 1024,
+		ITERATIONS = 2000,
+	};
+	Vector<String> names;
+
+	void create(uint32_t p_index, void *p_userdata) {
+		for (int i = 0; i < ITERATIONS; i++) {
+			StringName name = names[(p_index * 7 + i) % NAME_COUNT];
+		}
+	}
+};
+
+static void benchmark_names(NameBenchmark &p_data, const char *p_what) {
+	const uint32_t elements = 256;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < elements; i++) {
+		p_data.create(i, nullptr);
+	}
+	uint64_t serial = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	WorkerThreadPool::get_singleton()->do_work(elements, &p_data, &NameBenchmark::create, nullptr);
+	uint64_t parallel = OS::get_singleton()->get_ticks_usec() - begin;
+
+	print_line(vformat("%s: %d usec on one thread, %d usec on %d threads", p_what, serial, parallel, WorkerThreadPool::get_singleton()->get_thread_count()));
+}
+
+// Measures interning with and without contention, use with `godot --test string-name-benchmark`.
+static void test_string_name_benchmark() {
+	NameBenchmark data;
+	for (int i = 0; i < NameBenchmark::NAME_COUNT; i++) {
+		data.names.push_back(vformat("benchmark_name_%d", i));
+	}
+
+	// Nothing else references the names, so each one is inserted and removed again.
+	benchmark_names(data, "insert and remove");
+
+	// The names stay interned, so creating them only looks them up.
+	Vector<StringName> interned;
+	for (int i = 0; i < NameBenchmark::NAME_COUNT; i++) {
+		interned.push_back(data.names[i]);
+	}
+	benchmark_names(data, "lookup");
+}
+
+REGISTER_TEST_COMMAND("string-name-benchmark", &test_string_name_benchmark);
+} // namespace TestStringName
+
+#endif // TEST_STRING_NAME_H
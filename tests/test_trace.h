@@ -0,0 +1,161 @@
+/*************************************************************************/
+/*  test_trace.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_TRACE_H
+#define TEST_TRACE_H
+
+#include "core/debugger/trace.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+#include "core/os/os.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+
+#include "tests/test_macros.h"
+
+namespace TestTrace {
+
+static void traced_thread(void *p_userdata) {
+	Thread::set_name("Trace test thread");
+	TRACE_ZONE("thread_zone");
+}
+
+TEST_CASE("[Trace] Zones are saved as Chrome trace events") {
+	Trace::start();
+	{
+		TRACE_ZONE("outer_zone");
+	}
+	Thread thread;
+	thread.start(traced_thread, nullptr);
+	thread.wait_to_finish();
+	Trace::stop();
+
+	// Disabled zones record nothing.
+	{
+		TRACE_ZONE("disabled_zone");
+	}
+
+	const String path = OS::get_singleton()->get_cache_path().plus_file("trace.json");
+	REQUIRE(Trace::save(path) == OK);
+
+	JSON json;
+	REQUIRE(json.parse(FileAccess::get_file_as_string(path)) == OK);
+	Array events = Dictionary(json.get_data())["traceEvents"];
+
+	bool has_outer = false;
+	bool has_thread = false;
+	bool has_thread_name = false;
+	for (int i = 0; i < events.size(); i++) {
+		Dictionary event = events[i];
+		CHECK(String(event["name"]) != "disabled_zone");
+		if (event["name"] == "outer_zone") {
+			has_outer = true;
+			CHECK(event["ph"] == "X");
+			CHECK(int64_t(event["dur"]) >= 0);
+		} else if (event["name"] == "thread_zone") {
+			has_thread = true;
+		} else if (event["ph"] == "M" && Dictionary(event["args"])["name"] == "Trace test thread") {
+			has_thread_name = true;
+		}
+	}
+	CHECK(has_outer);
+	CHECK(has_thread);
+	CHECK(has_thread_name);
+
+	DirAccess::remove_file_or_error(path);
+}
+
+TEST_CASE("[Trace] Interned names are shared") {
+	const char *a = Trace::intern("Script::function");
+	const char *b = Trace::intern(String("Script::") + "function");
+	CHECK(a == b);
+	CHECK(String::utf8(a) == "Script::function");
+}
+
+struct RestartData {
+	Semaphore recorded;
+	Semaphore restarted;
+};
+
+static void restarted_thread(void *p_userdata) {
+	RestartData *data = static_cast<RestartData *>(p_userdata);
+	{
+		TRACE_ZONE("before_finish");
+	}
+	data->recorded.post();
+	data->restarted.wait();
+	TRACE_ZONE("after_restart");
+}
+
+TEST_CASE("[Trace] Tracing can be restarted after finishing") {
+	RestartData data;
+	Trace::start();
+	Thread thread;
+	thread.start(restarted_thread, &data);
+	data.recorded.wait();
+
+	// The thread keeps running, it must not write to the buffer freed here.
+	Trace::finish();
+	Trace::start();
+	data.restarted.post();
+	thread.wait_to_finish();
+	Trace::stop();
+
+	const String path = OS::get_singleton()->get_cache_path().plus_file("trace_restart.json");
+	REQUIRE(Trace::save(path) == OK);
+	const String saved = FileAccess::get_file_as_string(path);
+	CHECK(saved.find("after_restart") != -1);
+	CHECK(saved.find("before_finish") == -1);
+
+	DirAccess::remove_file_or_error(path);
+	Trace::finish();
+}
+
+TEST_CASE("[Trace] Restarting with a buffer size that isn't a power of two") {
+	Trace::finish();
+	Trace::start(1000);
+	{
+		TRACE_ZONE("first_run");
+	}
+	Trace::stop();
+	CHECK(!Trace::is_enabled());
+
+	// Rounded up to the size the buffers already have.
+	Trace::start(1000);
+	CHECK(Trace::is_enabled());
+	Trace::stop();
+
+	Trace::finish();
+}
+
+} // namespace TestTrace
+
+#endif // TEST_TRACE_H
@@ -0,0 +1,151 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_WORKER_THREAD_POOL_H
+#define TEST_WORKER_THREAD_POOL_H
+
+#include "core/os/worker_thread_pool.h"
+#include "core/templates/safe_refcount.h"
+
+#include "tests/test_macros.h"
+
+namespace TestWorkerThreadPool {
+
+struct GroupData {
+	SafeNumeric<uint32_t> sum;
+	uint32_t visits[256] = {};
+
+	void process(uint32_t p_index, uint32_t *p_userdata) {
+		visits[p_index]++;
+		sum.add(p_index + *p_userdata);
+	}
+};
+
+TEST_CASE("[WorkerThreadPool] Group task processes every index once") {
+	GroupData data;
+	uint32_t offset = 1;
+
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(&data, &GroupData::process, &offset, 256);
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+
+	for (uint32_t i = 0; i < 256; i++) {
+		CHECK_MESSAGE(data.visits[i] == 1, "Each index should be processed exactly once.");
+	}
+	// Sum of 1..256.
+	CHECK(data.sum.get() == 256 * 257 / 2);
+
+	// Empty groups complete right away.
+	group = WorkerThreadPool::get_singleton()->add_template_group_task(&data, &GroupData::process, &offset, 0);
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	CHECK(data.sum.get() == 256 * 257 / 2);
+}
+
+struct ChainData {
+	SafeNumeric<uint32_t> step;
+	uint32_t order[3] = {};
+
+	void first(int p_slot) {
+		order[p_slot] = step.increment();
+	}
+};
+
+TEST_CASE("[WorkerThreadPool] Task dependencies") {
+	ChainData data;
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	WorkerThreadPool::TaskID a = pool->add_template_task(&data, &ChainData::first, 0);
+	Vector<WorkerThreadPool::TaskID> deps;
+	deps.push_back(a);
+	WorkerThreadPool::TaskID b = pool->add_template_task(&data, &ChainData::first, 1, false, String(), deps);
+	deps.push_back(b);
+	WorkerThreadPool::TaskID c = pool->add_template_task(&data, &ChainData::first, 2, false, String(), deps);
+
+	pool->wait_for_task_completion(c);
+	CHECK(data.order[0] < data.order[1]);
+	CHECK(data.order[1] < data.order[2]);
+	CHECK(pool->is_task_completed(a));
+	CHECK(pool->is_task_completed(b));
+
+	pool->wait_for_task_completion(b);
+	pool->wait_for_task_completion(a);
+}
+
+struct NestedData {
+	SafeNumeric<uint32_t> inner_count;
+
+	void inner(uint32_t p_index, void *p_userdata) {
+		inner_count.increment();
+	}
+
+	void outer(uint32_t p_index, void *p_userdata) {
+		// Waiting from a worker must not deadlock, the worker helps instead.
+		WorkerThreadPool::get_singleton()->do_work(16, this, &NestedData::inner, nullptr);
+	}
+};
+
+TEST_CASE("[WorkerThreadPool] Nested group tasks") {
+	NestedData data;
+	WorkerThreadPool::get_singleton()->do_work(32, &data, &NestedData::outer, nullptr);
+	CHECK(data.inner_count.get() == 32 * 16);
+}
+
+struct ClaimData {
+	SafeNumeric<uint32_t> runs[256];
+
+	void run(uint32_t p_slot) {
+		runs[p_slot].increment();
+	}
+};
+
+TEST_CASE("[WorkerThreadPool] Tasks claimed by their waiter run once") {
+	// Waiting right away makes the waiter claim most tasks while their queue
+	// entries are still around, and the task slots get reused by the next ones.
+	ClaimData data;
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	for (uint32_t round = 0; round < 64; round++) {
+		WorkerThreadPool::TaskID ids[4];
+		for (uint32_t i = 0; i < 4; i++) {
+			ids[i] = pool->add_template_task(&data, &ClaimData::run, round * 4 + i);
+		}
+		for (int i = 3; i >= 0; i--) {
+			pool->wait_for_task_completion(ids[i]);
+		}
+	}
+
+	bool once = true;
+	for (uint32_t i = 0; i < 256; i++) {
+		once = once && data.runs[i].get() == 1;
+	}
+	CHECK_MESSAGE(once, "Each task should run exactly once.");
+}
+
+} // namespace TestWorkerThreadPool
+
+#endif // TEST_WORKER_THREAD_POOL_H